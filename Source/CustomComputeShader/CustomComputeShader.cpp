@@ -1,11 +1,11 @@
-// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
-
-#include "CustomComputeShader.h"
-#include "Modules/ModuleManager.h"
-#include "Misc/Paths.h"
-#include "GlobalShader.h"
-
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CustomComputeShader, "CustomComputeShader" );
-
-
-
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "CustomComputeShader.h"
+#include "Modules/ModuleManager.h"
+#include "Misc/Paths.h"
+#include "GlobalShader.h"
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CustomComputeShader, "CustomComputeShader" );
+
+
+
@@ -1,5 +1,5 @@
-// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
-
-
-#include "CustomComputeShaderGameModeBase.h"
-
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+
+#include "CustomComputeShaderGameModeBase.h"
+
@@ -1,17 +1,17 @@
-// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/GameModeBase.h"
-#include "CustomComputeShaderGameModeBase.generated.h"
-
-/**
- * 
- */
-UCLASS()
-class CUSTOMCOMPUTESHADER_API ACustomComputeShaderGameModeBase : public AGameModeBase
-{
-	GENERATED_BODY()
-	
-};
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "CustomComputeShaderGameModeBase.generated.h"
+
+/**
+ * 
+ */
+UCLASS()
+class CUSTOMCOMPUTESHADER_API ACustomComputeShaderGameModeBase : public AGameModeBase
+{
+	GENERATED_BODY()
+	
+};
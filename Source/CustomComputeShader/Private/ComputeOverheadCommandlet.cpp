@@ -0,0 +1,388 @@
+#include "ComputeOverheadCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderingThread.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "WhiteNoiseConsumer.h"
+#include "CustomShadersDeclarations/Private/ComputeShaderDeclaration.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComputeOverhead, Log, All);
+
+namespace
+{
+	//Exit code when the run couldn't measure UpdateResults, so its steady state allocations weren't checked
+	const int32 NotMeasuredExitCode = 2;
+
+	//Metrics of one consumer count, in microseconds per frame. Ordered like they are measured
+	struct FOverheadResult
+	{
+		int32 NumConsumers = 0;
+		TArray<TPair<FString, double>> Metrics;
+	};
+
+	//Mean game thread time of Frame over NumFrames frames, after one warm up frame. Render commands are flushed between frames, outside the timing
+	template <typename FrameFunc>
+	double MeasureGameThread(int32 NumFrames, FrameFunc&& Frame)
+	{
+		Frame();
+		FlushRenderingCommands();
+		double Seconds = 0.0;
+		for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+		{
+			const double Start = FPlatformTime::Seconds();
+			Frame();
+			Seconds += FPlatformTime::Seconds() - Start;
+			FlushRenderingCommands();
+		}
+		return Seconds * 1e6 / NumFrames;
+	}
+
+	//Same for a measurement done by the render thread itself, Measure returns the seconds it took
+	template <typename MeasureFunc>
+	double MeasureRenderThread(int32 NumFrames, MeasureFunc Measure)
+	{
+		double Seconds = 0.0;
+		for (int32 FrameIndex = 0; FrameIndex <= NumFrames; ++FrameIndex)
+		{
+			double FrameSeconds = 0.0;
+			double* FrameSecondsPtr = &FrameSeconds;
+			ENQUEUE_RENDER_COMMAND(MeasureComputeOverhead)(
+				[Measure, FrameSecondsPtr](FRHICommandListImmediate& RHICmdList)
+				{
+					*FrameSecondsPtr = Measure(RHICmdList);
+				});
+			FlushRenderingCommands();
+			//The first frame warms the pool and the shader map up
+			Seconds += FrameIndex > 0 ? FrameSeconds : 0.0;
+		}
+		return Seconds * 1e6 / NumFrames;
+	}
+
+	//Heap allocations of NumCalls UpdateResults per frame over NumFrames frames, after one warm up frame that may still take the output
+	//from the pool. Zero when the allocation tracker isn't installed
+	FAllocationCount CountUpdateResultsAllocations(int32 NumFrames, int32 NumCalls)
+	{
+		FAllocationCount Total;
+		for (int32 FrameIndex = 0; FrameIndex <= NumFrames; ++FrameIndex)
+		{
+			FAllocationCount FrameCount;
+			FAllocationCount* FrameCountPtr = &FrameCount;
+			ENQUEUE_RENDER_COMMAND(CountComputeAllocations)(
+				[NumCalls, FrameCountPtr](FRHICommandListImmediate& RHICmdList)
+				{
+					FWhiteNoiseCSManager::Get()->MeasureUpdateResults(RHICmdList, NumCalls, FrameCountPtr);
+				});
+			FlushRenderingCommands();
+			if (FrameIndex > 0)
+			{
+				Total.NumAllocations += FrameCount.NumAllocations;
+				Total.NumBytes += FrameCount.NumBytes;
+			}
+		}
+		return Total;
+	}
+
+	TSharedRef<FJsonObject> ToJson(const TArray<FOverheadResult>& Results, int32 NumFrames)
+	{
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		//Where the numbers come from, the baseline is only meaningful on the machine it was measured on
+		Root->SetStringField(TEXT("Note"), FString::Printf(TEXT("Measured on %s, %s, %s"), *FPlatformMisc::GetCPUBrand().TrimStartAndEnd(),
+			*FPlatformMisc::GetOSVersion(), *FDateTime::Now().ToString(TEXT("%Y-%m-%d"))));
+		Root->SetBoolField(TEXT("ThreadedRendering"), GIsThreadedRendering);
+		Root->SetNumberField(TEXT("Frames"), NumFrames);
+		TArray<TSharedPtr<FJsonValue>> Entries;
+		for (const FOverheadResult& Result : Results)
+		{
+			TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+			Entry->SetNumberField(TEXT("Consumers"), Result.NumConsumers);
+			for (const TPair<FString, double>& Metric : Result.Metrics)
+			{
+				Entry->SetNumberField(Metric.Key, Metric.Value);
+			}
+			Entries.Add(MakeShared<FJsonValueObject>(Entry));
+		}
+		Root->SetArrayField(TEXT("Results"), Entries);
+		return Root;
+	}
+
+	bool SaveJson(const TSharedRef<FJsonObject>& Root, const FString& Path)
+	{
+		FString Text;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+		return FJsonSerializer::Serialize(Root, Writer) && FFileHelper::SaveStringToFile(Text, *Path);
+	}
+
+	//Compares every metric with the baseline entry of the same consumer count and counts the regressions, metrics or counts
+	//missing from the baseline are only logged. Returns false when there is no readable baseline, the timings weren't gated then
+	bool CompareWithBaseline(const TArray<FOverheadResult>& Results, const FString& BaselinePath, double MaxRegressionPercent, int32& OutNumRegressions)
+	{
+		OutNumRegressions = 0;
+		if (!FPaths::FileExists(BaselinePath))
+		{
+			UE_LOG(LogComputeOverhead, Error, TEXT("No baseline at %s, the timings were not gated. Run with -UpdateBaseline on the reference machine to create it"), *BaselinePath);
+			return false;
+		}
+
+		FString Text;
+		TSharedPtr<FJsonObject> Baseline;
+		if (!FFileHelper::LoadFileToString(Text, *BaselinePath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Baseline) || !Baseline.IsValid())
+		{
+			UE_LOG(LogComputeOverhead, Error, TEXT("Could not read the baseline %s, the timings were not gated"), *BaselinePath);
+			return false;
+		}
+
+		FString Note;
+		if (Baseline->TryGetStringField(TEXT("Note"), Note))
+		{
+			UE_LOG(LogComputeOverhead, Display, TEXT("Baseline %s: %s"), *BaselinePath, *Note);
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* BaselineEntries = nullptr;
+		Baseline->TryGetArrayField(TEXT("Results"), BaselineEntries);
+		for (const FOverheadResult& Result : Results)
+		{
+			const TSharedPtr<FJsonObject>* BaselineEntry = nullptr;
+			for (int32 Index = 0; BaselineEntries && Index < BaselineEntries->Num() && !BaselineEntry; ++Index)
+			{
+				const TSharedPtr<FJsonObject>* Candidate = nullptr;
+				int32 NumConsumers = 0;
+				if ((*BaselineEntries)[Index]->TryGetObject(Candidate) && (*Candidate)->TryGetNumberField(TEXT("Consumers"), NumConsumers)
+					&& NumConsumers == Result.NumConsumers)
+				{
+					BaselineEntry = Candidate;
+				}
+			}
+			if (!BaselineEntry)
+			{
+				UE_LOG(LogComputeOverhead, Display, TEXT("%d consumers: no baseline"), Result.NumConsumers);
+				continue;
+			}
+
+			for (const TPair<FString, double>& Metric : Result.Metrics)
+			{
+				double BaselineValue = 0.0;
+				if (!(*BaselineEntry)->TryGetNumberField(Metric.Key, BaselineValue) || BaselineValue <= 0.0)
+				{
+					UE_LOG(LogComputeOverhead, Display, TEXT("%d consumers, %s: no baseline"), Result.NumConsumers, *Metric.Key);
+					continue;
+				}
+				const double ChangePercent = (Metric.Value / BaselineValue - 1.0) * 100.0;
+				if (ChangePercent > MaxRegressionPercent)
+				{
+					UE_LOG(LogComputeOverhead, Error, TEXT("%d consumers, %s: %.1f us against %.1f us in the baseline (+%.1f%%, limit %.1f%%)"),
+						Result.NumConsumers, *Metric.Key, Metric.Value, BaselineValue, ChangePercent, MaxRegressionPercent);
+					++OutNumRegressions;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+UComputeOverheadCommandlet::UComputeOverheadCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UComputeOverheadCommandlet::Main(const FString& Params)
+{
+	TArray<int32> ConsumerCounts = { 1, 100, 1000, 10000 };
+	FString ConsumerCountsText;
+	if (FParse::Value(*Params, TEXT("Consumers="), ConsumerCountsText, false))
+	{
+		TArray<FString> Fields;
+		ConsumerCountsText.ParseIntoArray(Fields, TEXT(","));
+		ConsumerCounts.Reset();
+		for (const FString& Field : Fields)
+		{
+			ConsumerCounts.Add(FMath::Max(FCString::Atoi(*Field), 1));
+		}
+		ConsumerCounts.Sort();
+	}
+	int32 NumFrames = 10;
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	NumFrames = FMath::Max(NumFrames, 1);
+	FString OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ComputeOverhead.json"));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FString BaselinePath = FPaths::Combine(FPaths::ProjectConfigDir(), TEXT("ComputeOverheadBaseline.json"));
+	FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+	double MaxRegressionPercent = 10.0;
+	FParse::Value(*Params, TEXT("MaxRegression="), MaxRegressionPercent);
+	const bool bAllowSteadyStateAllocations = FParse::Param(*Params, TEXT("AllowSteadyStateAllocations"));
+
+	if (ConsumerCounts.Num() == 0 || !GEngine)
+	{
+		UE_LOG(LogComputeOverhead, Error, TEXT("Usage: -run=ComputeOverhead -nullrhi [-Consumers=1,100,1000,10000] [-Frames=N] [-Output=File.json] [-Baseline=File.json] [-MaxRegression=Percent] [-UpdateBaseline] [-AllowSteadyStateAllocations]"));
+		return 1;
+	}
+	if (!FApp::ShouldUseNullRHI())
+	{
+		UE_LOG(LogComputeOverhead, Warning, TEXT("Not running with -nullrhi, the render thread metrics include the work of the real RHI"));
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ComputeOverhead"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	//Output of the render thread metrics. The consumers tick without a render target so the game thread metrics don't include the graph
+	UTextureRenderTarget2D* RenderTarget = NewObject<UTextureRenderTarget2D>();
+	RenderTarget->AddToRoot();
+	RenderTarget->InitCustomFormat(256, 256, PF_A32B32G32R32F, true);
+	RenderTarget->UpdateResourceImmediate(false);
+
+	bool bHasCompiledShaders = false;
+	bool* bHasCompiledShadersPtr = &bHasCompiledShaders;
+	ENQUEUE_RENDER_COMMAND(CheckComputeOverheadShaders)(
+		[bHasCompiledShadersPtr](FRHICommandListImmediate& RHICmdList)
+		{
+			*bHasCompiledShadersPtr = FWhiteNoiseCSManager::Get()->HasCompiledShaders();
+		});
+	FlushRenderingCommands();
+	if (!bHasCompiledShaders)
+	{
+		UE_LOG(LogComputeOverhead, Warning, TEXT("The white noise shader isn't compiled, UpdateResults and its allocations are not measured"));
+	}
+
+	//Counts the allocations of the render thread metrics
+	FAllocationTracker::Install();
+
+	FWhiteNoiseCSManager* Manager = FWhiteNoiseCSManager::Get();
+	int32 NumAllocatingCounts = 0;
+	TArray<AWhiteNoiseConsumer*> Consumers;
+	TArray<FOverheadResult> Results;
+	for (const int32 NumConsumers : ConsumerCounts)
+	{
+		while (Consumers.Num() < NumConsumers)
+		{
+			Consumers.Add(World->SpawnActor<AWhiteNoiseConsumer>());
+		}
+
+		FOverheadResult& Result = Results.AddDefaulted_GetRef();
+		Result.NumConsumers = NumConsumers;
+
+		Result.Metrics.Emplace(TEXT("TickUs"), MeasureGameThread(NumFrames, [&Consumers, NumConsumers]()
+		{
+			for (int32 Index = 0; Index < NumConsumers; ++Index)
+			{
+				Consumers[Index]->Tick(1.f / 60.f);
+			}
+		}));
+
+		FWhiteNoiseCSParameters EmptyParameters(nullptr);
+		EmptyParameters.TimeStamp = 1;
+		Result.Metrics.Emplace(TEXT("UpdateParametersUs"), MeasureGameThread(NumFrames, [Manager, &EmptyParameters, NumConsumers]()
+		{
+			for (int32 Index = 0; Index < NumConsumers; ++Index)
+			{
+				Manager->UpdateParameters(EmptyParameters);
+			}
+		}));
+
+		Result.Metrics.Emplace(TEXT("BeginRenderingUs"), MeasureGameThread(NumFrames, [Manager, NumConsumers]()
+		{
+			for (int32 Index = 0; Index < NumConsumers; ++Index)
+			{
+				Manager->BeginRendering();
+			}
+		}));
+
+		FWhiteNoiseCSParameters Parameters(RenderTarget);
+		Parameters.TimeStamp = 1;
+		Manager->UpdateParameters(Parameters);
+		if (bHasCompiledShaders)
+		{
+			Result.Metrics.Emplace(TEXT("UpdateResultsUs"), MeasureRenderThread(NumFrames, [NumConsumers](FRHICommandListImmediate& RHICmdList)
+			{
+				return FWhiteNoiseCSManager::Get()->MeasureUpdateResults(RHICmdList, NumConsumers);
+			}));
+
+			//Once the output is cached, UpdateResults should not touch the heap at all
+			const FAllocationCount Allocations = CountUpdateResultsAllocations(NumFrames, NumConsumers);
+			Result.Metrics.Emplace(TEXT("UpdateResultsAllocations"), double(Allocations.NumAllocations) / NumFrames);
+			Result.Metrics.Emplace(TEXT("UpdateResultsAllocatedBytes"), double(Allocations.NumBytes) / NumFrames);
+			if (Allocations.NumAllocations > 0)
+			{
+				UE_LOG(LogComputeOverhead, Error, TEXT("%d consumers: UpdateResults allocated %llu times (%llu bytes) over %d steady state frames"),
+					NumConsumers, Allocations.NumAllocations, Allocations.NumBytes, NumFrames);
+				++NumAllocatingCounts;
+			}
+		}
+		Result.Metrics.Emplace(TEXT("PoolLookupUs"), MeasureRenderThread(NumFrames, [NumConsumers](FRHICommandListImmediate& RHICmdList)
+		{
+			return FWhiteNoiseCSManager::Get()->MeasurePoolLookups(RHICmdList, NumConsumers);
+		}));
+		Manager->UpdateParameters(EmptyParameters);
+
+		FString Line = FString::Printf(TEXT("%5d consumers:"), NumConsumers);
+		for (const TPair<FString, double>& Metric : Result.Metrics)
+		{
+			Line += FString::Printf(TEXT(" %s %.1f"), *Metric.Key, Metric.Value);
+		}
+		UE_LOG(LogComputeOverhead, Display, TEXT("%s"), *Line);
+	}
+
+	for (AWhiteNoiseConsumer* Consumer : Consumers)
+	{
+		World->DestroyActor(Consumer);
+	}
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	RenderTarget->RemoveFromRoot();
+
+	const TSharedRef<FJsonObject> Json = ToJson(Results, NumFrames);
+	if (!SaveJson(Json, OutputPath))
+	{
+		UE_LOG(LogComputeOverhead, Error, TEXT("Could not write %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogComputeOverhead, Display, TEXT("Results written to %s"), *OutputPath);
+
+	if (FParse::Param(*Params, TEXT("UpdateBaseline")))
+	{
+		if (!bHasCompiledShaders)
+		{
+			UE_LOG(LogComputeOverhead, Error, TEXT("UpdateResults was not measured, the baseline %s is left as it is"), *BaselinePath);
+			return NotMeasuredExitCode;
+		}
+		if (!SaveJson(Json, BaselinePath))
+		{
+			UE_LOG(LogComputeOverhead, Error, TEXT("Could not write %s"), *BaselinePath);
+			return 1;
+		}
+		UE_LOG(LogComputeOverhead, Display, TEXT("Baseline %s updated"), *BaselinePath);
+		return 0;
+	}
+
+	int32 NumRegressions = 0;
+	const bool bHasBaseline = CompareWithBaseline(Results, BaselinePath, MaxRegressionPercent, NumRegressions);
+	const bool bAllocationsFailed = NumAllocatingCounts > 0 && !bAllowSteadyStateAllocations;
+	if (NumRegressions > 0 || bAllocationsFailed)
+	{
+		return 1;
+	}
+	//Passing without having looked at UpdateResults, or without thresholds for the timings, would hide a regression
+	if (!bHasCompiledShaders)
+	{
+		UE_LOG(LogComputeOverhead, Error, TEXT("The steady state allocations of UpdateResults were not checked"));
+		return NotMeasuredExitCode;
+	}
+	if (!bHasBaseline)
+	{
+		return NotMeasuredExitCode;
+	}
+	return 0;
+}
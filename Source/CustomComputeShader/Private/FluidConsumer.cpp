@@ -0,0 +1,66 @@
+#include "FluidConsumer.h"
+
+#include "Engine/TextureRenderTarget2D.h"
+#include "CustomShadersDeclarations/Private/FluidSimulation.h"
+
+// Sets default values
+AFluidConsumer::AFluidConsumer()
+{
+ 	// Set this pawn to call Tick() every frame.
+	PrimaryActorTick.bCanEverTick = true;
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent = Root;
+
+	static_mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Static Mesh"));
+
+	PressureIterations = 40;
+	bUseMultigrid = false;
+	MultigridCycles = 2;
+	bUseSparseTiles = false;
+	VelocityDissipation = 0.999f;
+	DyeDissipation = 0.995f;
+	EmitterUV = FVector2D(0.5f, 0.1f);
+	EmitterForce = FVector2D(0.f, 2000.f);
+	EmitterRadius = 8.f;
+	EmitterDye = 10.f;
+}
+
+// Called when the game starts or when spawned
+void AFluidConsumer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//Assuming that the static mesh is already using the material that we're targeting, we create an instance and assign it to it
+	UMaterialInstanceDynamic* MID = static_mesh->CreateAndSetMaterialInstanceDynamic(0);
+	MID->SetTextureParameterValue("InputTexture", (UTexture*)RenderTarget);
+}
+
+void AFluidConsumer::BeginDestroy()
+{
+	FFluidCSManager::Get()->EndRendering();
+	Super::BeginDestroy();
+}
+
+// Called every frame
+void AFluidConsumer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	//Update parameters
+	FFluidCSParameters parameters(RenderTarget);
+	FFluidSimulationParameters& Simulation = parameters.Simulation;
+	//Large hitches would make the semi-Lagrangian backtrace jump across the whole domain
+	Simulation.DeltaTime = FMath::Min(DeltaTime, 1.f / 30.f);
+	Simulation.PressureIterations = PressureIterations;
+	Simulation.bUseMultigrid = bUseMultigrid;
+	Simulation.Multigrid.NumCycles = MultigridCycles;
+	Simulation.bUseSparseTiles = bUseSparseTiles;
+	Simulation.VelocityDissipation = VelocityDissipation;
+	Simulation.DyeDissipation = DyeDissipation;
+	Simulation.EmitterPosition = EmitterUV * FVector2D(Simulation.SimulationSize);
+	Simulation.EmitterForce = EmitterForce;
+	Simulation.EmitterRadius = EmitterRadius;
+	Simulation.EmitterDye = EmitterDye;
+	FFluidCSManager::Get()->UpdateParameters(parameters);
+	FFluidCSManager::Get()->BeginRendering();
+}
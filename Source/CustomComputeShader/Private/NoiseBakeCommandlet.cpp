@@ -0,0 +1,455 @@
+#include "NoiseBakeCommandlet.h"
+
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "CustomShadersDeclarations/Private/BlockCompression.h"
+#include "CustomShadersDeclarations/Private/FFTCPU.h"
+#include "CustomShadersDeclarations/Private/FluidSimulationCPU.h"
+#include "CustomShadersDeclarations/Private/NoiseImageWriter.h"
+#include "CustomShadersDeclarations/Private/OceanSpectrum.h"
+#include "CustomShadersDeclarations/Private/PrimitivesCPU.h"
+#include "CustomShadersDeclarations/Private/SummedAreaTableCPU.h"
+#include "CustomShadersDeclarations/Private/WhiteNoiseCPU.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogNoiseBake, Log, All);
+
+namespace
+{
+	struct FNoiseBakeJob
+	{
+		ENoiseType Type;
+		FIntPoint Size;
+		uint32 Seed;
+		uint32 Frame;
+		ENoiseImageFormat Format;
+		FString TypeName;
+	};
+
+	bool ParseManifest(const FString& ManifestPath, ENoiseImageFormat DefaultFormat, TArray<FNoiseBakeJob>& OutJobs)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *ManifestPath))
+		{
+			UE_LOG(LogNoiseBake, Error, TEXT("Could not read manifest %s"), *ManifestPath);
+			return false;
+		}
+
+		for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex)
+		{
+			const FString Line = Lines[LineIndex].TrimStartAndEnd();
+			if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+			{
+				continue;
+			}
+
+			TArray<FString> Fields;
+			Line.ParseIntoArrayWS(Fields);
+
+			FNoiseBakeJob Job;
+			Job.Format = DefaultFormat;
+			const bool bValid = (Fields.Num() == 5 || Fields.Num() == 6)
+				&& FWhiteNoiseCPU::ParseNoiseType(Fields[0], Job.Type)
+				&& (Fields.Num() == 5 || FNoiseImageWriteQueue::ParseFormat(Fields[5], Job.Format));
+			if (!bValid)
+			{
+				UE_LOG(LogNoiseBake, Error, TEXT("%s(%d): expected 'Type Width Height Seed Frame [Format]', got '%s'"), *ManifestPath, LineIndex + 1, *Line);
+				return false;
+			}
+
+			Job.TypeName = Fields[0];
+			Job.Size = FIntPoint(FCString::Atoi(*Fields[1]), FCString::Atoi(*Fields[2]));
+			Job.Seed = (uint32)FCString::Strtoui64(*Fields[3], nullptr, 10);
+			Job.Frame = (uint32)FCString::Strtoui64(*Fields[4], nullptr, 10);
+			if (Job.Size.X <= 0 || Job.Size.Y <= 0)
+			{
+				UE_LOG(LogNoiseBake, Error, TEXT("%s(%d): invalid size %dx%d"), *ManifestPath, LineIndex + 1, Job.Size.X, Job.Size.Y);
+				return false;
+			}
+
+			OutJobs.Add(MoveTemp(Job));
+		}
+		return true;
+	}
+
+	//Bakes one white noise volume as raw float slices and logs its statistics, the headless counterpart of FVolumeNoiseCSManager
+	int32 BakeVolume(const FString& SizeText, const FString& Params, const FString& OutDir)
+	{
+		TArray<FString> Fields;
+		SizeText.ParseIntoArray(Fields, TEXT(","));
+		FIntVector Size = FIntVector::ZeroValue;
+		if (Fields.Num() == 1)
+		{
+			Size = FIntVector(FCString::Atoi(*Fields[0]));
+		}
+		else if (Fields.Num() == 3)
+		{
+			Size = FIntVector(FCString::Atoi(*Fields[0]), FCString::Atoi(*Fields[1]), FCString::Atoi(*Fields[2]));
+		}
+		if (Size.X <= 0 || Size.Y <= 0 || Size.Z <= 0)
+		{
+			UE_LOG(LogNoiseBake, Error, TEXT("Invalid volume size '%s', expected -Volume=N or -Volume=X,Y,Z"), *SizeText);
+			return 1;
+		}
+
+		uint32 Seed = 0;
+		uint32 Frame = 1;
+		FParse::Value(*Params, TEXT("Seed="), Seed);
+		FParse::Value(*Params, TEXT("Frame="), Frame);
+
+		FNoiseImage Image;
+		const double GenerateStart = FPlatformTime::Seconds();
+		FWhiteNoiseCPU::GenerateVolume(Size, Seed, Frame, Image.Values);
+		const double GenerateSeconds = FPlatformTime::Seconds() - GenerateStart;
+
+		float MinValue = TNumericLimits<float>::Max();
+		float MaxValue = TNumericLimits<float>::Lowest();
+		double Sum = 0.0;
+		for (float Value : Image.Values)
+		{
+			MinValue = FMath::Min(MinValue, Value);
+			MaxValue = FMath::Max(MaxValue, Value);
+			Sum += Value;
+		}
+		const double Megavoxels = Image.Values.Num() / 1.0e6;
+		UE_LOG(LogNoiseBake, Display, TEXT("Volume %dx%dx%d: %.1f MVoxel/s, min %f, max %f, mean %f"), Size.X, Size.Y, Size.Z,
+			GenerateSeconds > 0.0 ? Megavoxels / GenerateSeconds : 0.0, MinValue, MaxValue, Sum / Image.Values.Num());
+
+		//The slices are stacked vertically, the raw file is the volume in X, Y, Z order
+		IFileManager::Get().MakeDirectory(*OutDir, true);
+		Image.Size = FIntPoint(Size.X, Size.Y * Size.Z);
+		Image.Format = ENoiseImageFormat::Raw;
+		Image.Filename = FPaths::Combine(OutDir, FString::Printf(TEXT("White3D_%dx%dx%d_s%u_f%u.raw"), Size.X, Size.Y, Size.Z, Seed, Frame));
+
+		FNoiseImageWriteQueue WriteQueue(1);
+		WriteQueue.Enqueue(MoveTemp(Image));
+		WriteQueue.Flush();
+		return WriteQueue.GetNumFailedWrites() > 0 ? 1 : 0;
+	}
+
+	//Bakes the ocean heightfield with the CPU FFT, the headless counterpart of FOceanCSManager
+	int32 BakeOcean(int32 Resolution, const FString& Params, const FString& OutDir)
+	{
+		if (!FMath::IsPowerOfTwo(Resolution) || Resolution < 4)
+		{
+			UE_LOG(LogNoiseBake, Error, TEXT("Invalid ocean resolution %d, expected a power of two"), Resolution);
+			return 1;
+		}
+
+		FOceanSpectrumSettings Settings;
+		Settings.Resolution = Resolution;
+		Settings.Spectrum = FParse::Param(*Params, TEXT("JONSWAP")) ? EOceanSpectrum::JONSWAP : EOceanSpectrum::Phillips;
+		FParse::Value(*Params, TEXT("PatchSize="), Settings.PatchSize);
+		FParse::Value(*Params, TEXT("WindSpeed="), Settings.WindSpeed);
+		FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+		float Time = 0.f;
+		float Choppiness = 1.f;
+		FParse::Value(*Params, TEXT("Time="), Time);
+		FParse::Value(*Params, TEXT("Choppiness="), Choppiness);
+
+		TArray<FVector> Displacement;
+		const double GenerateStart = FPlatformTime::Seconds();
+		FOceanSpectrumCPU::GenerateDisplacement(Settings, Time, Choppiness, Displacement);
+		const double GenerateSeconds = FPlatformTime::Seconds() - GenerateStart;
+
+		FNoiseImage Image;
+		Image.Size = FIntPoint(Resolution, Resolution);
+		Image.Format = ENoiseImageFormat::Raw;
+		Image.Values.SetNumUninitialized(Displacement.Num());
+		double SumSquares = 0.0;
+		for (int32 Index = 0; Index < Displacement.Num(); ++Index)
+		{
+			Image.Values[Index] = Displacement[Index].Z;
+			SumSquares += FMath::Square(Displacement[Index].Z);
+		}
+		//Significant wave height, 4 standard deviations of the surface
+		UE_LOG(LogNoiseBake, Display, TEXT("Ocean %dx%d %s: %.2f ms on the CPU, significant wave height %.2f m"), Resolution, Resolution,
+			Settings.Spectrum == EOceanSpectrum::JONSWAP ? TEXT("JONSWAP") : TEXT("Phillips"), GenerateSeconds * 1000.0,
+			4.0 * FMath::Sqrt(SumSquares / Displacement.Num()));
+
+		IFileManager::Get().MakeDirectory(*OutDir, true);
+		Image.Filename = FPaths::Combine(OutDir, FString::Printf(TEXT("OceanHeight_%dx%d_s%u_t%.2f.raw"), Resolution, Resolution, Settings.Seed, Time));
+
+		FNoiseImageWriteQueue WriteQueue(1);
+		WriteQueue.Enqueue(MoveTemp(Image));
+		WriteQueue.Flush();
+		return WriteQueue.GetNumFailedWrites() > 0 ? 1 : 0;
+	}
+
+	//Checks the Stockham FFT the GPU transforms mirror against the direct DFT for every size FFTCS supports
+	int32 ValidateFFT()
+	{
+		//Relative to the magnitude of the outputs, which grows like sqrt(N) for random inputs
+		const float Tolerance = 1e-4f;
+		bool bPassed = true;
+		for (int32 Size = 128; Size <= 1024; Size *= 2)
+		{
+			for (EFFTDirection Direction : { EFFTDirection::Forward, EFFTDirection::Inverse })
+			{
+				const float MaxError = FFFTCPU::MeasureMaxError(Size, Direction, Size);
+				const bool bSizePassed = MaxError <= Tolerance * FMath::Sqrt((float)Size);
+				bPassed &= bSizePassed;
+				UE_LOG(LogNoiseBake, Display, TEXT("FFT %4d %s: max error %g %s"), Size, Direction == EFFTDirection::Forward ? TEXT("forward") : TEXT("inverse"),
+					MaxError, bSizePassed ? TEXT("") : TEXT("FAILED"));
+			}
+		}
+		return bPassed ? 0 : 1;
+	}
+
+	//Times the CPU primitives on the same random input the GPU benchmark uses, CustomShaders.Primitives.Benchmark reports both
+	int32 BenchmarkPrimitives(const FString& Params)
+	{
+		int32 NumElements = 1 << 22;
+		FParse::Value(*Params, TEXT("Elements="), NumElements);
+		NumElements = FMath::Max(NumElements, 1);
+
+		TArray<float> Floats;
+		TArray<uint32> Uints;
+		FPrimitivesCPU::FillRandom(1, NumElements, Floats, Uints);
+
+		auto Time = [NumElements](const TCHAR* Name, TFunctionRef<void()> Run)
+		{
+			const double Start = FPlatformTime::Seconds();
+			Run();
+			const double Milliseconds = (FPlatformTime::Seconds() - Start) * 1000.0;
+			UE_LOG(LogNoiseBake, Display, TEXT("%-16s %8.3f ms (%6.2f GElements/s)"), Name, Milliseconds, NumElements / FMath::Max(Milliseconds * 1.0e6, 1e-9));
+		};
+
+		TArray<uint32> Output;
+		Time(TEXT("Reduce sum"), [&]() { FPrimitivesCPU::Reduce(Floats, EReduceOp::Sum); });
+		Time(TEXT("Reduce max"), [&]() { FPrimitivesCPU::Reduce(Floats, EReduceOp::Max); });
+		Time(TEXT("Exclusive scan"), [&]() { FPrimitivesCPU::Scan(Uints, Output, EScanType::Exclusive); });
+		Time(TEXT("Compact"), [&]() { FPrimitivesCPU::Compact(Floats, 0.5f, Output); });
+		Time(TEXT("Histogram"), [&]() { FPrimitivesCPU::Histogram(Floats, 0.f, 1.f, Output); });
+		return 0;
+	}
+
+	//Times the CPU summed-area table box filter against the separable blur it replaces, and reports how far the table drifts from it
+	int32 BenchmarkSummedAreaTable(const FString& Params)
+	{
+		int32 Size = 2048;
+		FParse::Value(*Params, TEXT("Size="), Size);
+		Size = FMath::Max(Size, 16);
+
+		TArray<float> Values;
+		TArray<uint32> Unused;
+		FPrimitivesCPU::FillRandom(1, Size * Size, Values, Unused);
+
+		for (int32 Radius = 4; Radius <= 64; Radius *= 2)
+		{
+			TArray<float> Separable;
+			double Start = FPlatformTime::Seconds();
+			FSummedAreaTableCPU::SeparableBoxBlur(Values, Size, Size, Radius, Separable);
+			const double SeparableMilliseconds = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+			TArray<float> Table;
+			TArray<float> Filtered;
+			Start = FPlatformTime::Seconds();
+			const float Offset = FSummedAreaTableCPU::Build(Values, Size, Size, Table);
+			FSummedAreaTableCPU::BoxFilter(Table, Offset, Size, Size, Radius, Filtered);
+			const double TableMilliseconds = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+			UE_LOG(LogNoiseBake, Display, TEXT("Radius %2d: table %8.3f ms, separable %8.3f ms, max difference %g"), Radius, TableMilliseconds,
+				SeparableMilliseconds, FSummedAreaTableCPU::MaxAbsDifference(Filtered, Separable));
+		}
+		return 0;
+	}
+
+	//Times the CPU fluid step with 1, 2, 4... workers up to every task graph thread, to see how FFluidSimulationCPU scales with the cores
+	int32 BenchmarkFluid(const FString& Params)
+	{
+		int32 Size = 512;
+		int32 NumSteps = 20;
+		FParse::Value(*Params, TEXT("Size="), Size);
+		FParse::Value(*Params, TEXT("Steps="), NumSteps);
+		Size = FMath::Max(Size, 16);
+		NumSteps = FMath::Max(NumSteps, 1);
+
+		//The emitter of CustomShaders.Fluid.Validate
+		FFluidSimulationParameters Parameters;
+		Parameters.SimulationSize = FIntPoint(Size, Size);
+		Parameters.bUseMultigrid = FParse::Param(*Params, TEXT("Multigrid"));
+		Parameters.bUseSparseTiles = FParse::Param(*Params, TEXT("Sparse"));
+		Parameters.EmitterPosition = FVector2D(Size * 0.5f, Size * 0.25f);
+		Parameters.EmitterForce = FVector2D(0.f, 120.f);
+		Parameters.EmitterRadius = Size / 32.f;
+
+		//The thread that calls ParallelFor runs tasks too
+		const int32 MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		TArray<int32> WorkerCounts;
+		for (int32 NumWorkers = 1; NumWorkers < MaxWorkers; NumWorkers *= 2)
+		{
+			WorkerCounts.Add(NumWorkers);
+		}
+		WorkerCounts.Add(MaxWorkers);
+
+		UE_LOG(LogNoiseBake, Display, TEXT("Fluid %dx%d %s%s, %d steps"), Size, Size, Parameters.bUseMultigrid ? TEXT("multigrid") : TEXT("Jacobi"),
+			Parameters.bUseSparseTiles ? TEXT(" sparse") : TEXT(""), NumSteps);
+		double SingleWorkerMilliseconds = 0.0;
+		for (int32 NumWorkers : WorkerCounts)
+		{
+			FFluidSimulationCPU Simulation;
+			Simulation.SetMaxWorkers(NumWorkers);
+			//The first step allocates the fields
+			Simulation.Step(Parameters);
+
+			const double Start = FPlatformTime::Seconds();
+			for (int32 StepIndex = 0; StepIndex < NumSteps; ++StepIndex)
+			{
+				Simulation.Step(Parameters);
+			}
+			const double Milliseconds = (FPlatformTime::Seconds() - Start) * 1000.0 / NumSteps;
+			if (NumWorkers == 1)
+			{
+				SingleWorkerMilliseconds = Milliseconds;
+			}
+
+			const double Speedup = SingleWorkerMilliseconds / FMath::Max(Milliseconds, 1e-9);
+			UE_LOG(LogNoiseBake, Display, TEXT("%3d workers: %8.3f ms per step, speedup %5.2fx, efficiency %3.0f%%"), NumWorkers, Milliseconds, Speedup,
+				Speedup * 100.0 / NumWorkers);
+		}
+		return 0;
+	}
+}
+
+UNoiseBakeCommandlet::UNoiseBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UNoiseBakeCommandlet::Main(const FString& Params)
+{
+	FString OutDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("NoiseBake"));
+	FParse::Value(*Params, TEXT("OutDir="), OutDir);
+
+	FString VolumeSizeText;
+	if (FParse::Value(*Params, TEXT("Volume="), VolumeSizeText, false))
+	{
+		return BakeVolume(VolumeSizeText, Params, OutDir);
+	}
+
+	int32 OceanResolution = 0;
+	if (FParse::Value(*Params, TEXT("Ocean="), OceanResolution))
+	{
+		return BakeOcean(OceanResolution, Params, OutDir);
+	}
+
+	if (FParse::Param(*Params, TEXT("ValidateFFT")))
+	{
+		return ValidateFFT();
+	}
+
+	if (FParse::Param(*Params, TEXT("BenchmarkPrimitives")))
+	{
+		return BenchmarkPrimitives(Params);
+	}
+
+	if (FParse::Param(*Params, TEXT("BenchmarkSummedAreaTable")))
+	{
+		return BenchmarkSummedAreaTable(Params);
+	}
+
+	if (FParse::Param(*Params, TEXT("BenchmarkFluid")))
+	{
+		return BenchmarkFluid(Params);
+	}
+
+	FString ManifestPath;
+	if (!FParse::Value(*Params, TEXT("Manifest="), ManifestPath))
+	{
+		UE_LOG(LogNoiseBake, Error, TEXT("Usage: -run=NoiseBake -Manifest=Jobs.txt [-OutDir=Dir] [-Format=png|exr|raw|bc4] [-MaxPendingWrites=N] [-BenchmarkCompression]"));
+		UE_LOG(LogNoiseBake, Error, TEXT("       -run=NoiseBake -Volume=N|X,Y,Z [-Seed=N] [-Frame=N] [-OutDir=Dir]"));
+		UE_LOG(LogNoiseBake, Error, TEXT("       -run=NoiseBake -Ocean=N [-JONSWAP] [-PatchSize=M] [-WindSpeed=M/S] [-Seed=N] [-Time=S] [-Choppiness=C] [-OutDir=Dir]"));
+		UE_LOG(LogNoiseBake, Error, TEXT("       -run=NoiseBake -ValidateFFT"));
+		UE_LOG(LogNoiseBake, Error, TEXT("       -run=NoiseBake -BenchmarkPrimitives [-Elements=N]"));
+		UE_LOG(LogNoiseBake, Error, TEXT("       -run=NoiseBake -BenchmarkSummedAreaTable [-Size=N]"));
+		UE_LOG(LogNoiseBake, Error, TEXT("       -run=NoiseBake -BenchmarkFluid [-Size=N] [-Steps=N] [-Multigrid] [-Sparse]"));
+		return 1;
+	}
+
+	ENoiseImageFormat DefaultFormat = ENoiseImageFormat::PNG;
+	FString FormatName;
+	if (FParse::Value(*Params, TEXT("Format="), FormatName) && !FNoiseImageWriteQueue::ParseFormat(FormatName, DefaultFormat))
+	{
+		UE_LOG(LogNoiseBake, Error, TEXT("Unknown format %s"), *FormatName);
+		return 1;
+	}
+
+	//Enough images in flight to keep every pool thread busy encoding while the next job is generated
+	int32 MaxPendingWrites = FPlatformMisc::NumberOfCoresIncludingHyperthreads() * 2;
+	FParse::Value(*Params, TEXT("MaxPendingWrites="), MaxPendingWrites);
+
+	//Times the CPU BC4 encoder on every job and reports its PSNR
+	const bool bBenchmarkCompression = FParse::Param(*Params, TEXT("BenchmarkCompression"));
+	double CompressSeconds = 0.0;
+	double SumPSNR = 0.0;
+	double MinPSNR = TNumericLimits<double>::Max();
+
+	TArray<FNoiseBakeJob> Jobs;
+	if (!ParseManifest(ManifestPath, DefaultFormat, Jobs))
+	{
+		return 1;
+	}
+
+	IFileManager::Get().MakeDirectory(*OutDir, true);
+
+	double GenerateSeconds = 0.0;
+	int64 NumTexels = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	{
+		FNoiseImageWriteQueue WriteQueue(MaxPendingWrites);
+		for (const FNoiseBakeJob& Job : Jobs)
+		{
+			FNoiseImage Image;
+			Image.Size = Job.Size;
+			Image.Format = Job.Format;
+			Image.Filename = FPaths::Combine(OutDir, FString::Printf(TEXT("%s_%dx%d_s%u_f%u.%s"),
+				*Job.TypeName, Job.Size.X, Job.Size.Y, Job.Seed, Job.Frame, FNoiseImageWriteQueue::GetExtension(Job.Format)));
+
+			const double GenerateStart = FPlatformTime::Seconds();
+			FWhiteNoiseCPU::Generate(Job.Type, Job.Size, Job.Seed, Job.Frame, Image.Values);
+			GenerateSeconds += FPlatformTime::Seconds() - GenerateStart;
+			NumTexels += (int64)Job.Size.X * Job.Size.Y;
+
+			if (bBenchmarkCompression)
+			{
+				TArray<uint8> Blocks;
+				TArray<float> Decoded;
+				const double CompressStart = FPlatformTime::Seconds();
+				FBlockCompressionCPU::EncodeBC4(Image.Values, Job.Size, Blocks);
+				CompressSeconds += FPlatformTime::Seconds() - CompressStart;
+
+				FBlockCompressionCPU::DecodeBC4(Blocks, Job.Size, Decoded);
+				const double PSNR = FBlockCompressionCPU::ComputePSNR(Image.Values, Decoded);
+				SumPSNR += PSNR;
+				MinPSNR = FMath::Min(MinPSNR, PSNR);
+			}
+
+			WriteQueue.Enqueue(MoveTemp(Image));
+		}
+		WriteQueue.Flush();
+
+		const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+		const double Megapixels = NumTexels / 1.0e6;
+		UE_LOG(LogNoiseBake, Display, TEXT("Baked %d jobs (%.2f MP, %.2f MB written) in %.3f s"),
+			Jobs.Num(), Megapixels, WriteQueue.GetBytesWritten() / (1024.0 * 1024.0), TotalSeconds);
+		UE_LOG(LogNoiseBake, Display, TEXT("Generation: %.1f MP/s, end to end including writes: %.1f MP/s"),
+			GenerateSeconds > 0.0 ? Megapixels / GenerateSeconds : 0.0, TotalSeconds > 0.0 ? Megapixels / TotalSeconds : 0.0);
+		if (bBenchmarkCompression && Jobs.Num() > 0)
+		{
+			UE_LOG(LogNoiseBake, Display, TEXT("BC4 encode: %.1f MP/s, PSNR mean %.2f dB, min %.2f dB"),
+				CompressSeconds > 0.0 ? Megapixels / CompressSeconds : 0.0, SumPSNR / Jobs.Num(), MinPSNR);
+		}
+
+		if (WriteQueue.GetNumFailedWrites() > 0)
+		{
+			UE_LOG(LogNoiseBake, Error, TEXT("%d files could not be written"), WriteQueue.GetNumFailedWrites());
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include "OceanConsumer.h"
+
+#include "Engine/TextureRenderTarget2D.h"
+#include "CustomShadersDeclarations/Private/Ocean.h"
+
+// Sets default values
+AOceanConsumer::AOceanConsumer()
+{
+ 	// Set this pawn to call Tick() every frame.
+	PrimaryActorTick.bCanEverTick = true;
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent = Root;
+
+	static_mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Static Mesh"));
+
+	DisplacementTarget = nullptr;
+	NormalTarget = nullptr;
+	Resolution = 512;
+	bUseJONSWAP = false;
+	PatchSize = 500.f;
+	WindSpeed = 20.f;
+	WindDirection = FVector2D(1.f, 0.f);
+	PhillipsAmplitude = 0.0081f;
+	Fetch = 100000.f;
+	PeakEnhancement = 3.3f;
+	SmallWaveLength = 0.5f;
+	Seed = 0;
+	Choppiness = 1.f;
+	Time = 0.f;
+}
+
+// Called when the game starts or when spawned
+void AOceanConsumer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const int32 Size = FMath::RoundUpToPowerOfTwo(FMath::Clamp(Resolution, 128, 1024));
+	if (!DisplacementTarget)
+	{
+		DisplacementTarget = NewObject<UTextureRenderTarget2D>(this);
+		DisplacementTarget->InitCustomFormat(Size, Size, PF_FloatRGBA, true);
+		DisplacementTarget->UpdateResourceImmediate(false);
+	}
+	if (!NormalTarget)
+	{
+		NormalTarget = NewObject<UTextureRenderTarget2D>(this);
+		NormalTarget->InitCustomFormat(Size, Size, PF_FloatRGBA, true);
+		NormalTarget->UpdateResourceImmediate(false);
+	}
+
+	//Assuming that the static mesh is already using the material that we're targeting, we create an instance and assign it to it
+	UMaterialInstanceDynamic* MID = static_mesh->CreateAndSetMaterialInstanceDynamic(0);
+	MID->SetTextureParameterValue("Displacement", (UTexture*)DisplacementTarget);
+	MID->SetTextureParameterValue("Normal", (UTexture*)NormalTarget);
+}
+
+void AOceanConsumer::BeginDestroy()
+{
+	FOceanCSManager::Get()->EndRendering();
+	Super::BeginDestroy();
+}
+
+// Called every frame
+void AOceanConsumer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Time += DeltaTime;
+
+	//Update parameters, the spectrum is only regenerated when one of its settings changes
+	FOceanCSParameters parameters(DisplacementTarget, NormalTarget);
+	FOceanSpectrumSettings& Spectrum = parameters.Spectrum;
+	Spectrum.Spectrum = bUseJONSWAP ? EOceanSpectrum::JONSWAP : EOceanSpectrum::Phillips;
+	Spectrum.PatchSize = PatchSize;
+	Spectrum.WindSpeed = WindSpeed;
+	Spectrum.WindDirection = WindDirection.GetSafeNormal();
+	Spectrum.PhillipsAmplitude = PhillipsAmplitude;
+	Spectrum.Fetch = Fetch;
+	Spectrum.PeakEnhancement = PeakEnhancement;
+	Spectrum.SmallWaveLength = SmallWaveLength;
+	Spectrum.Seed = (uint32)Seed;
+	parameters.Time = Time;
+	parameters.Choppiness = Choppiness;
+	FOceanCSManager::Get()->UpdateParameters(parameters);
+	FOceanCSManager::Get()->BeginRendering();
+}
@@ -0,0 +1,306 @@
+#include "ParameterReplayCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/TextureRenderTarget2DArray.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "RenderingThread.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "CustomShadersDeclarations/Private/ComputeShaderDeclaration.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogParameterReplay, Log, All);
+
+namespace
+{
+	//Textures matching the recorded targets, rooted for the duration of the replay
+	struct FReplayTargets
+	{
+		UTextureRenderTarget2D* RenderTarget = nullptr;
+		UTexture2D* CompressedTexture = nullptr;
+		UTextureRenderTarget2D* DistanceFieldTarget = nullptr;
+		UTextureRenderTarget2D* NormalTarget = nullptr;
+		UTexture2D* CompressedNormalTexture = nullptr;
+		UTextureRenderTarget2DArray* FrameRing = nullptr;
+
+		void Create(const FParameterRecordTargets& Targets)
+		{
+			if (Targets.Size.X > 0 && Targets.Size.Y > 0)
+			{
+				RenderTarget = NewObject<UTextureRenderTarget2D>();
+				RenderTarget->AddToRoot();
+				RenderTarget->InitCustomFormat(Targets.Size.X, Targets.Size.Y, Targets.Format != PF_Unknown ? Targets.Format : PF_A32B32G32R32F, true);
+				RenderTarget->UpdateResourceImmediate(false);
+
+				//Same conditions as AWhiteNoiseConsumer, BC4 needs whole blocks
+				if (Targets.bCompressed && Targets.Size.X % 4 == 0 && Targets.Size.Y % 4 == 0)
+				{
+					CompressedTexture = UTexture2D::CreateTransient(Targets.Size.X, Targets.Size.Y, PF_BC4);
+					CompressedTexture->AddToRoot();
+					CompressedTexture->SRGB = false;
+					CompressedTexture->UpdateResource();
+				}
+				if (Targets.bDistanceField)
+				{
+					DistanceFieldTarget = NewObject<UTextureRenderTarget2D>();
+					DistanceFieldTarget->AddToRoot();
+					DistanceFieldTarget->InitCustomFormat(Targets.Size.X, Targets.Size.Y, PF_R32_FLOAT, true);
+					DistanceFieldTarget->UpdateResourceImmediate(false);
+				}
+				if (Targets.bNormals)
+				{
+					NormalTarget = NewObject<UTextureRenderTarget2D>();
+					NormalTarget->AddToRoot();
+					NormalTarget->InitCustomFormat(Targets.Size.X, Targets.Size.Y, PF_FloatRGBA, true);
+					NormalTarget->UpdateResourceImmediate(false);
+
+					if (Targets.bCompressedNormals && Targets.Size.X % 4 == 0 && Targets.Size.Y % 4 == 0)
+					{
+						CompressedNormalTexture = UTexture2D::CreateTransient(Targets.Size.X, Targets.Size.Y, PF_BC5);
+						CompressedNormalTexture->AddToRoot();
+						CompressedNormalTexture->SRGB = false;
+						CompressedNormalTexture->CompressionSettings = TC_Normalmap;
+						CompressedNormalTexture->UpdateResource();
+					}
+				}
+			}
+			if (Targets.FrameRingSize.X > 0 && Targets.FrameRingSize.Y > 0 && Targets.FrameRingSize.Z > 0)
+			{
+				FrameRing = NewObject<UTextureRenderTarget2DArray>();
+				FrameRing->AddToRoot();
+				FrameRing->Init(Targets.FrameRingSize.X, Targets.FrameRingSize.Y, Targets.FrameRingSize.Z, PF_R32_FLOAT);
+				FrameRing->UpdateResourceImmediate(false);
+			}
+		}
+
+		//The render thread must be done with the textures
+		void Release()
+		{
+			UObject* Textures[] = { RenderTarget, CompressedTexture, DistanceFieldTarget, NormalTarget, CompressedNormalTexture, FrameRing };
+			for (UObject* Texture : Textures)
+			{
+				if (Texture)
+				{
+					Texture->RemoveFromRoot();
+				}
+			}
+			*this = FReplayTargets();
+		}
+	};
+
+	//Render thread side of the timing, written by the render commands and read once they are flushed
+	struct FRenderThreadTimes
+	{
+		double FrameStart = 0.0;
+		TArray<double> FrameSeconds;
+	};
+
+	struct FTimingSummary
+	{
+		double MeanMs = 0.0;
+		double MedianMs = 0.0;
+		double P95Ms = 0.0;
+		double MaxMs = 0.0;
+	};
+
+	FTimingSummary Summarize(TArray<double> Seconds)
+	{
+		FTimingSummary Summary;
+		if (Seconds.Num() == 0)
+		{
+			return Summary;
+		}
+		Seconds.Sort();
+		double Sum = 0.0;
+		for (const double Value : Seconds)
+		{
+			Sum += Value;
+		}
+		Summary.MeanMs = Sum * 1e3 / Seconds.Num();
+		Summary.MedianMs = Seconds[Seconds.Num() / 2] * 1e3;
+		Summary.P95Ms = Seconds[FMath::Min(Seconds.Num() * 95 / 100, Seconds.Num() - 1)] * 1e3;
+		Summary.MaxMs = Seconds.Last() * 1e3;
+		return Summary;
+	}
+
+	TSharedRef<FJsonObject> ToJson(const FTimingSummary& Summary)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetNumberField(TEXT("MeanMs"), Summary.MeanMs);
+		Object->SetNumberField(TEXT("MedianMs"), Summary.MedianMs);
+		Object->SetNumberField(TEXT("P95Ms"), Summary.P95Ms);
+		Object->SetNumberField(TEXT("MaxMs"), Summary.MaxMs);
+		return Object;
+	}
+}
+
+UParameterReplayCommandlet::UParameterReplayCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UParameterReplayCommandlet::Main(const FString& Params)
+{
+	FString LogPath;
+	if (!FParse::Value(*Params, TEXT("Log="), LogPath))
+	{
+		UE_LOG(LogParameterReplay, Error, TEXT("Usage: -run=ParameterReplay -Log=File.wnpr [-Paced] [-Loops=N] [-Output=File.json]"));
+		return 1;
+	}
+	const bool bPaced = FParse::Param(*Params, TEXT("Paced"));
+	int32 NumLoops = 1;
+	FParse::Value(*Params, TEXT("Loops="), NumLoops);
+	NumLoops = FMath::Max(NumLoops, 1);
+	FString OutputPath;
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	TArray<FParameterRecord> Records;
+	if (!FParameterRecorder::Load(LogPath, Records))
+	{
+		UE_LOG(LogParameterReplay, Error, TEXT("Could not read the parameter log %s"), *LogPath);
+		return 1;
+	}
+
+	bool bHasCompiledShaders = false;
+	bool* bHasCompiledShadersPtr = &bHasCompiledShaders;
+	ENQUEUE_RENDER_COMMAND(CheckReplayShaders)(
+		[bHasCompiledShadersPtr](FRHICommandListImmediate& RHICmdList)
+		{
+			*bHasCompiledShadersPtr = FWhiteNoiseCSManager::Get()->HasCompiledShaders();
+		});
+	FlushRenderingCommands();
+	if (!bHasCompiledShaders)
+	{
+		UE_LOG(LogParameterReplay, Warning, TEXT("The white noise shader isn't compiled, only the game thread side is replayed"));
+	}
+
+	FWhiteNoiseCSManager* Manager = FWhiteNoiseCSManager::Get();
+	TSharedRef<FRenderThreadTimes, ESPMode::ThreadSafe> RenderThreadTimes = MakeShared<FRenderThreadTimes, ESPMode::ThreadSafe>();
+	TArray<double> GameThreadSeconds;
+	FReplayTargets Targets;
+
+	const double ReplayStart = FPlatformTime::Seconds();
+	for (int32 Loop = 0; Loop < NumLoops; ++Loop)
+	{
+		const double LoopStart = FPlatformTime::Seconds();
+		double FrameStart = LoopStart;
+		bool bInFrame = false;
+		for (const FParameterRecord& Record : Records)
+		{
+			if (bPaced)
+			{
+				const double Wait = LoopStart + Record.Time - FPlatformTime::Seconds();
+				if (Wait > 0.0)
+				{
+					FPlatformProcess::Sleep(float(Wait));
+				}
+			}
+			//A frame is measured from its first event, the waits of the pacing are not part of it
+			if (!bInFrame)
+			{
+				FrameStart = FPlatformTime::Seconds();
+				bInFrame = true;
+			}
+
+			switch (Record.Type)
+			{
+			case EParameterRecordType::Targets:
+				FlushRenderingCommands();
+				Targets.Release();
+				Targets.Create(Record.Targets);
+				//Creating the textures is not part of the frame
+				FrameStart = FPlatformTime::Seconds();
+				break;
+
+			case EParameterRecordType::Parameters:
+				{
+					FWhiteNoiseCSParameters Parameters(Targets.RenderTarget);
+					Parameters.TimeStamp = Record.TimeStamp;
+					Parameters.Seed = Record.Seed;
+					Parameters.Hash = Record.Hash;
+					Parameters.CompressedTexture = Targets.CompressedTexture;
+					Parameters.DistanceFieldTarget = Targets.DistanceFieldTarget;
+					Parameters.DistanceFieldThreshold = Record.DistanceFieldThreshold;
+					Parameters.NormalTarget = Targets.NormalTarget;
+					Parameters.NormalStrength = Record.NormalStrength;
+					Parameters.CompressedNormalTexture = Targets.CompressedNormalTexture;
+					Parameters.SetFrameRing(Targets.FrameRing);
+					Manager->UpdateParameters(Parameters);
+				}
+				break;
+
+			case EParameterRecordType::BeginRendering:
+				if (bHasCompiledShaders)
+				{
+					ENQUEUE_RENDER_COMMAND(BeginReplayFrame)(
+						[RenderThreadTimes](FRHICommandListImmediate& RHICmdList)
+						{
+							RenderThreadTimes->FrameStart = FPlatformTime::Seconds();
+						});
+					Manager->BeginRendering();
+					ENQUEUE_RENDER_COMMAND(EndReplayFrame)(
+						[RenderThreadTimes](FRHICommandListImmediate& RHICmdList)
+						{
+							RenderThreadTimes->FrameSeconds.Add(FPlatformTime::Seconds() - RenderThreadTimes->FrameStart);
+						});
+				}
+				GameThreadSeconds.Add(FPlatformTime::Seconds() - FrameStart);
+				bInFrame = false;
+				break;
+
+			case EParameterRecordType::EndRendering:
+				Manager->EndRendering();
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+	FlushRenderingCommands();
+	const double WallSeconds = FPlatformTime::Seconds() - ReplayStart;
+
+	//Leave the manager without references to the replay targets
+	FWhiteNoiseCSParameters EmptyParameters(nullptr);
+	Manager->UpdateParameters(EmptyParameters);
+	FlushRenderingCommands();
+	Targets.Release();
+
+	const FTimingSummary GameThread = Summarize(GameThreadSeconds);
+	const FTimingSummary RenderThread = Summarize(RenderThreadTimes->FrameSeconds);
+	UE_LOG(LogParameterReplay, Display, TEXT("%s: %d events, %d frames in %.3f s over %d loops (%s)"), *LogPath, Records.Num() * NumLoops,
+		GameThreadSeconds.Num(), WallSeconds, NumLoops, bPaced ? TEXT("paced") : TEXT("full speed"));
+	UE_LOG(LogParameterReplay, Display, TEXT("Game thread ms: mean %.3f median %.3f p95 %.3f max %.3f"),
+		GameThread.MeanMs, GameThread.MedianMs, GameThread.P95Ms, GameThread.MaxMs);
+	UE_LOG(LogParameterReplay, Display, TEXT("Render thread ms: mean %.3f median %.3f p95 %.3f max %.3f"),
+		RenderThread.MeanMs, RenderThread.MedianMs, RenderThread.P95Ms, RenderThread.MaxMs);
+
+	if (!OutputPath.IsEmpty())
+	{
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("Log"), LogPath);
+		Root->SetBoolField(TEXT("Paced"), bPaced);
+		Root->SetNumberField(TEXT("Loops"), NumLoops);
+		Root->SetNumberField(TEXT("Events"), Records.Num() * NumLoops);
+		Root->SetNumberField(TEXT("Frames"), GameThreadSeconds.Num());
+		Root->SetNumberField(TEXT("WallSeconds"), WallSeconds);
+		Root->SetObjectField(TEXT("GameThread"), ToJson(GameThread));
+		Root->SetObjectField(TEXT("RenderThread"), ToJson(RenderThread));
+
+		FString Text;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+		if (!FJsonSerializer::Serialize(Root, Writer) || !FFileHelper::SaveStringToFile(Text, *OutputPath))
+		{
+			UE_LOG(LogParameterReplay, Error, TEXT("Could not write %s"), *OutputPath);
+			return 1;
+		}
+		UE_LOG(LogParameterReplay, Display, TEXT("Results written to %s"), *OutputPath);
+	}
+	return 0;
+}
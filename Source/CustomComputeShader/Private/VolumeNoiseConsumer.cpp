@@ -0,0 +1,61 @@
+#include "VolumeNoiseConsumer.h"
+
+#include "Engine/TextureRenderTargetVolume.h"
+#include "CustomShadersDeclarations/Private/VolumeNoise.h"
+
+// Sets default values
+AVolumeNoiseConsumer::AVolumeNoiseConsumer()
+{
+ 	// Set this pawn to call Tick() every frame.
+	PrimaryActorTick.bCanEverTick = true;
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent = Root;
+
+	static_mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Static Mesh"));
+
+	VolumeTarget = nullptr;
+	VolumeResolution = FIntVector(128, 128, 128);
+	Seed = 0;
+	bAnimate = false;
+	TimeStamp = 1;
+}
+
+// Called when the game starts or when spawned
+void AVolumeNoiseConsumer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!VolumeTarget)
+	{
+		VolumeTarget = NewObject<UTextureRenderTargetVolume>(this);
+		VolumeTarget->Init(FMath::Max(VolumeResolution.X, 1), FMath::Max(VolumeResolution.Y, 1), FMath::Max(VolumeResolution.Z, 1), PF_R16F);
+		VolumeTarget->UpdateResourceImmediate(false);
+	}
+
+	//Assuming that the static mesh is already using the material that we're targeting, we create an instance and assign it to it
+	UMaterialInstanceDynamic* MID = static_mesh->CreateAndSetMaterialInstanceDynamic(0);
+	MID->SetTextureParameterValue("Volume", (UTexture*)VolumeTarget);
+}
+
+void AVolumeNoiseConsumer::BeginDestroy()
+{
+	FVolumeNoiseCSManager::Get()->EndRendering();
+	Super::BeginDestroy();
+}
+
+// Called every frame
+void AVolumeNoiseConsumer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	//The manager skips the generation when nothing changed
+	FVolumeNoiseCSParameters parameters(VolumeTarget);
+	if (bAnimate)
+	{
+		TimeStamp++;
+	}
+	parameters.TimeStamp = TimeStamp;
+	parameters.Seed = Seed;
+	FVolumeNoiseCSManager::Get()->UpdateParameters(parameters);
+	FVolumeNoiseCSManager::Get()->BeginRendering();
+}
@@ -1,57 +1,136 @@
-#include "WhiteNoiseConsumer.h"
-
-#include "Kismet/GameplayStatics.h"
-#include "CustomShadersDeclarations/Private/ComputeShaderDeclaration.h"
-
-// Sets default values
-AWhiteNoiseConsumer::AWhiteNoiseConsumer()
-{
- 	// Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
-	RootComponent = Root;
-
-	static_mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Static Mesh"));
-
-	TimeStamp = 0;
-}
-
-// Called when the game starts or when spawned
-void AWhiteNoiseConsumer::BeginPlay()
-{
-	Super::BeginPlay();
-	FWhiteNoiseCSManager::Get()->BeginRendering();
-
-
-	//Assuming that the static mesh is already using the material that we're targeting, we create an instance and assign it to it
-	UMaterialInstanceDynamic* MID = static_mesh->CreateAndSetMaterialInstanceDynamic(0);
-	MID->SetTextureParameterValue("InputTexture", (UTexture*)RenderTarget);
-}
-
-void AWhiteNoiseConsumer::BeginDestroy()
-{
-	FWhiteNoiseCSManager::Get()->EndRendering();
-	Super::BeginDestroy();
-
-}
-
-// Called every frame
-void AWhiteNoiseConsumer::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-	//Update parameters
-	FWhiteNoiseCSParameters parameters(RenderTarget);
-	TimeStamp++;
-	parameters.TimeStamp = TimeStamp;
-	FWhiteNoiseCSManager::Get()->UpdateParameters(parameters);
-	FWhiteNoiseCSManager::Get()->BeginRendering();
-}
-
-// Called to bind functionality to input
-void AWhiteNoiseConsumer::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
-{
-	Super::SetupPlayerInputComponent(PlayerInputComponent);
-
-}
-
+#include "WhiteNoiseConsumer.h"
+
+#include "Kismet/GameplayStatics.h"
+#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2DArray.h"
+#include "CustomShadersDeclarations/Private/ComputeShaderDeclaration.h"
+
+// Sets default values
+AWhiteNoiseConsumer::AWhiteNoiseConsumer()
+{
+ 	// Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent = Root;
+
+	static_mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Static Mesh"));
+
+	TimeStamp = 0;
+	Seed = 0;
+	HashFunction = 0;
+	bCompressOutput = false;
+	CompressedTexture = nullptr;
+	CompressedNormals = nullptr;
+	bGenerateDistanceField = false;
+	DistanceFieldThreshold = 0.5f;
+	DistanceField = nullptr;
+	bGenerateNormals = false;
+	NormalStrength = 1.f;
+	Normals = nullptr;
+	bUseFrameRing = false;
+	FrameRingSlices = 16;
+	FrameRingResolution = FIntPoint(512, 512);
+	FrameRing = nullptr;
+	MaterialInstance = nullptr;
+}
+
+// Called when the game starts or when spawned
+void AWhiteNoiseConsumer::BeginPlay()
+{
+	Super::BeginPlay();
+	FWhiteNoiseCSManager::Get()->BeginRendering();
+
+
+	//Assuming that the static mesh is already using the material that we're targeting, we create an instance and assign it to it
+	UMaterialInstanceDynamic* MID = static_mesh->CreateAndSetMaterialInstanceDynamic(0);
+	MID->SetTextureParameterValue("InputTexture", (UTexture*)RenderTarget);
+	MaterialInstance = MID;
+
+	//Block compressed textures need whole blocks
+	const bool bCanCompress = RenderTarget && RenderTarget->SizeX % 4 == 0 && RenderTarget->SizeY % 4 == 0;
+	if (bCompressOutput && RenderTarget && !bCanCompress)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: the %dx%d render target is not a multiple of 4, the output is not compressed"), *GetName(), RenderTarget->SizeX, RenderTarget->SizeY);
+	}
+	if (bCompressOutput && bCanCompress)
+	{
+		CompressedTexture = UTexture2D::CreateTransient(RenderTarget->SizeX, RenderTarget->SizeY, PF_BC4);
+		CompressedTexture->SRGB = false;
+		CompressedTexture->UpdateResource();
+		MID->SetTextureParameterValue("InputTexture", (UTexture*)CompressedTexture);
+	}
+
+	if (bGenerateDistanceField && RenderTarget)
+	{
+		DistanceField = NewObject<UTextureRenderTarget2D>(this);
+		DistanceField->InitCustomFormat(RenderTarget->SizeX, RenderTarget->SizeY, PF_R32_FLOAT, true);
+		DistanceField->UpdateResourceImmediate(false);
+		MID->SetTextureParameterValue("DistanceField", (UTexture*)DistanceField);
+	}
+
+	if (bGenerateNormals && RenderTarget)
+	{
+		Normals = NewObject<UTextureRenderTarget2D>(this);
+		Normals->InitCustomFormat(RenderTarget->SizeX, RenderTarget->SizeY, PF_FloatRGBA, true);
+		Normals->UpdateResourceImmediate(false);
+		MID->SetTextureParameterValue("NormalMap", (UTexture*)Normals);
+
+		if (bCompressOutput && bCanCompress)
+		{
+			CompressedNormals = UTexture2D::CreateTransient(RenderTarget->SizeX, RenderTarget->SizeY, PF_BC5);
+			CompressedNormals->SRGB = false;
+			CompressedNormals->CompressionSettings = TC_Normalmap;
+			CompressedNormals->UpdateResource();
+			MID->SetTextureParameterValue("CompressedNormalMap", (UTexture*)CompressedNormals);
+		}
+	}
+
+	if (bUseFrameRing)
+	{
+		FrameRing = NewObject<UTextureRenderTarget2DArray>(this);
+		FrameRing->Init(FMath::Max(FrameRingResolution.X, 1), FMath::Max(FrameRingResolution.Y, 1), FMath::Max(FrameRingSlices, 1), PF_R32_FLOAT);
+		FrameRing->UpdateResourceImmediate(false);
+		MID->SetTextureParameterValue("FrameRing", (UTexture*)FrameRing);
+	}
+}
+
+void AWhiteNoiseConsumer::BeginDestroy()
+{
+	FWhiteNoiseCSManager::Get()->EndRendering();
+	Super::BeginDestroy();
+
+}
+
+// Called every frame
+void AWhiteNoiseConsumer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	//Update parameters
+	FWhiteNoiseCSParameters parameters(RenderTarget);
+	TimeStamp++;
+	parameters.TimeStamp = TimeStamp;
+	parameters.Seed = Seed;
+	parameters.Hash = (ENoiseHash)FMath::Clamp(HashFunction, 0, (int32)ENoiseHash::Count - 1);
+	parameters.CompressedTexture = CompressedTexture;
+	parameters.DistanceFieldTarget = DistanceField;
+	parameters.DistanceFieldThreshold = DistanceFieldThreshold;
+	parameters.NormalTarget = Normals;
+	parameters.NormalStrength = NormalStrength;
+	parameters.CompressedNormalTexture = CompressedNormals;
+	parameters.SetFrameRing(FrameRing);
+	if (FrameRing && MaterialInstance)
+	{
+		MaterialInstance->SetScalarParameterValue("SliceIndex", (float)FWhiteNoiseCSManager::GetFrameRingSlice(TimeStamp, FrameRing->Slices));
+	}
+	FWhiteNoiseCSManager::Get()->UpdateParameters(parameters);
+	FWhiteNoiseCSManager::Get()->BeginRendering();
+}
+
+// Called to bind functionality to input
+void AWhiteNoiseConsumer::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
+{
+	Super::SetupPlayerInputComponent(PlayerInputComponent);
+
+}
+
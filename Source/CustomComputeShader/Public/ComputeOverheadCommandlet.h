@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ComputeOverheadCommandlet.generated.h"
+
+/// <summary>
+/// Measures the CPU cost of the white noise compute path at several consumer counts, meant to run with -nullrhi so only the CPU side is timed
+/// Usage: UE4Editor-Cmd.exe CustomComputeShader.uproject -run=ComputeOverhead -nullrhi [-Consumers=1,100,1000,10000] [-Frames=N]
+///        [-Output=Overhead.json] [-Baseline=Config/ComputeOverheadBaseline.json] [-MaxRegression=Percent] [-UpdateBaseline] [-AllowSteadyStateAllocations]
+/// Metrics are the mean microseconds per frame of: ticking every AWhiteNoiseConsumer, one UpdateParameters and one BeginRendering per consumer
+/// on the game thread, one UpdateResults and one render target pool lookup per consumer on the render thread, plus the heap allocations
+/// and bytes of the UpdateResults calls per frame.
+/// The run fails when a metric is more than MaxRegression percent above the baseline, or when UpdateResults allocates once its output is cached
+/// unless -AllowSteadyStateAllocations is given.
+/// The exit code is 2 when something wasn't measured: the white noise shader isn't compiled so UpdateResults and its allocations
+/// couldn't be timed, or there is no readable baseline so the timings had nothing to be gated against.
+/// -UpdateBaseline writes the results as the new baseline, with the CPU, OS and date they were measured on
+/// </summary>
+UCLASS()
+class CUSTOMCOMPUTESHADER_API UComputeOverheadCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UComputeOverheadCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Pawn.h"
+#include "FluidConsumer.generated.h"
+
+UCLASS()
+class CUSTOMCOMPUTESHADER_API AFluidConsumer : public APawn
+{
+	GENERATED_BODY()
+
+//Properties
+public:
+	UPROPERTY()
+		USceneComponent* Root;
+
+	UPROPERTY(EditAnywhere)
+		UStaticMeshComponent* static_mesh;
+
+	//Receives the dye, its size is the simulation resolution
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo)
+		class UTextureRenderTarget2D* RenderTarget;
+
+	//Jacobi iterations of the pressure solve
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo, meta = (ClampMin = "0"))
+		int32 PressureIterations;
+
+	//Solves the pressure with multigrid V-cycles, converges with far fewer passes than Jacobi on large grids
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo)
+		bool bUseMultigrid;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo, meta = (ClampMin = "1", EditCondition = "bUseMultigrid"))
+		int32 MultigridCycles;
+
+	//Only simulates the tiles around the emitter and the moving fluid, the cost follows the active area instead of the grid size
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo)
+		bool bUseSparseTiles;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo, meta = (ClampMin = "0", ClampMax = "1"))
+		float VelocityDissipation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo, meta = (ClampMin = "0", ClampMax = "1"))
+		float DyeDissipation;
+
+	//Emitter position in UV space of the render target
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo)
+		FVector2D EmitterUV;
+
+	//Emitter force in cells per second squared
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo)
+		FVector2D EmitterForce;
+
+	//Emitter radius in cells, 0 disables the emitter
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo, meta = (ClampMin = "0"))
+		float EmitterRadius;
+
+	//Dye injected per second at the emitter center
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = FluidDemo)
+		float EmitterDye;
+
+public:
+	// Sets default values for this pawn's properties
+	AFluidConsumer();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void BeginDestroy() override;
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NoiseBakeCommandlet.generated.h"
+
+/// <summary>
+/// Bakes procedural textures to disk without a GPU using the CPU implementation of the compute shaders
+/// Usage: UE4Editor-Cmd.exe CustomComputeShader.uproject -run=NoiseBake -Manifest=Jobs.txt [-OutDir=Dir] [-Format=png|exr|raw|bc4] [-MaxPendingWrites=N] [-BenchmarkCompression]
+/// Each non-empty manifest line that doesn't start with '#' describes a job: Type Width Height Seed Frame [Format]
+/// -Volume=N|X,Y,Z [-Seed=N] [-Frame=N] bakes a single 3D white noise volume as raw floats instead
+/// -Ocean=N [-JONSWAP] [-Seed=N] [-Time=S] bakes an ocean heightfield with the CPU FFT, -ValidateFFT checks the CPU FFT against the direct DFT
+/// -BenchmarkPrimitives [-Elements=N] times the CPU reduce, scan, compaction and histogram
+/// -BenchmarkSummedAreaTable [-Size=N] times the CPU summed-area table box filter against a separable blur
+/// -BenchmarkFluid [-Size=N] [-Steps=N] [-Multigrid] [-Sparse] times the CPU fluid step with 1 worker up to every task graph thread
+/// </summary>
+UCLASS()
+class CUSTOMCOMPUTESHADER_API UNoiseBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UNoiseBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Pawn.h"
+#include "OceanConsumer.generated.h"
+
+UCLASS()
+class CUSTOMCOMPUTESHADER_API AOceanConsumer : public APawn
+{
+	GENERATED_BODY()
+
+//Properties
+public:
+	UPROPERTY()
+		USceneComponent* Root;
+
+	UPROPERTY(EditAnywhere)
+		UStaticMeshComponent* static_mesh;
+
+	//Receives the displacement (XY choppy offset, Z height). Created at begin play with Resolution when not set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo)
+		class UTextureRenderTarget2D* DisplacementTarget;
+
+	//Receives the normal in XYZ and the folding Jacobian in W. Created at begin play with Resolution when not set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo)
+		class UTextureRenderTarget2D* NormalTarget;
+
+	//Texels per side, a power of two between 128 and 1024
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "128", ClampMax = "1024"))
+		int32 Resolution;
+
+	//Uses the fetch limited JONSWAP spectrum instead of the Phillips spectrum
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo)
+		bool bUseJONSWAP;
+
+	//World size of the tiling patch in meters
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "1"))
+		float PatchSize;
+
+	//Meters per second
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "0.1"))
+		float WindSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo)
+		FVector2D WindDirection;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "0", EditCondition = "!bUseJONSWAP"))
+		float PhillipsAmplitude;
+
+	//Distance over which the wind blows in meters
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "1", EditCondition = "bUseJONSWAP"))
+		float Fetch;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "1", EditCondition = "bUseJONSWAP"))
+		float PeakEnhancement;
+
+	//Waves shorter than this in meters are damped
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "0"))
+		float SmallWaveLength;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo)
+		int32 Seed;
+
+	//Scales the horizontal displacement, too much makes the waves fold over
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = OceanDemo, meta = (ClampMin = "0"))
+		float Choppiness;
+
+	UPROPERTY(Transient)
+		float Time;
+
+public:
+	// Sets default values for this pawn's properties
+	AOceanConsumer();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void BeginDestroy() override;
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+};
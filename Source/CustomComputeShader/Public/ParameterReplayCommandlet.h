@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ParameterReplayCommandlet.generated.h"
+
+/// <summary>
+/// Plays a parameter stream recorded with CustomShaders.Record.Start back through FWhiteNoiseCSManager, to reproduce a performance problem without the level
+/// Usage: UE4Editor-Cmd.exe CustomComputeShader.uproject -run=ParameterReplay -Log=File.wnpr [-Paced] [-Loops=N] [-Output=Replay.json]
+/// The render targets are recreated whenever the recorded targets change. Events are replayed as fast as possible, or at their recorded times with -Paced.
+/// Logs the wall time and the mean, median, 95th percentile and maximum milliseconds of each frame (the events up to a BeginRendering) on the
+/// game thread and of its UpdateResults on the render thread. Without compiled shaders, as with -nullrhi, only the game thread is replayed
+/// </summary>
+UCLASS()
+class CUSTOMCOMPUTESHADER_API UParameterReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UParameterReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Pawn.h"
+#include "VolumeNoiseConsumer.generated.h"
+
+UCLASS()
+class CUSTOMCOMPUTESHADER_API AVolumeNoiseConsumer : public APawn
+{
+	GENERATED_BODY()
+
+//Properties
+public:
+	UPROPERTY()
+		USceneComponent* Root;
+
+	UPROPERTY(EditAnywhere)
+		UStaticMeshComponent* static_mesh;
+
+	//Receives the noise. Created at begin play with VolumeResolution when not set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = VolumeDemo)
+		class UTextureRenderTargetVolume* VolumeTarget;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = VolumeDemo, meta = (ClampMin = "1"))
+		FIntVector VolumeResolution;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = VolumeDemo)
+		int32 Seed;
+
+	//Regenerates the volume every frame with a new time stamp, otherwise it is generated once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = VolumeDemo)
+		bool bAnimate;
+
+	UPROPERTY(Transient)
+		int32 TimeStamp;
+
+public:
+	// Sets default values for this pawn's properties
+	AVolumeNoiseConsumer();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void BeginDestroy() override;
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+};
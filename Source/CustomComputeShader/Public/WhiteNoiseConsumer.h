@@ -1,41 +1,101 @@
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/Pawn.h"
-#include "WhiteNoiseConsumer.generated.h"
-
-UCLASS()
-class CUSTOMCOMPUTESHADER_API AWhiteNoiseConsumer : public APawn
-{
-	GENERATED_BODY()
-
-//Properties
-public:
-	UPROPERTY()
-		USceneComponent* Root;
-
-	UPROPERTY(EditAnywhere)
-		UStaticMeshComponent* static_mesh;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo)
-		class UTextureRenderTarget2D* RenderTarget;
-private:
-	uint32 TimeStamp;
-public:
-	// Sets default values for this pawn's properties
-	AWhiteNoiseConsumer();
-
-protected:
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
-
-	virtual void BeginDestroy() override;
-
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
-	// Called to bind functionality to input
-	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
-
-};
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Pawn.h"
+#include "WhiteNoiseConsumer.generated.h"
+
+UCLASS()
+class CUSTOMCOMPUTESHADER_API AWhiteNoiseConsumer : public APawn
+{
+	GENERATED_BODY()
+
+//Properties
+public:
+	UPROPERTY()
+		USceneComponent* Root;
+
+	UPROPERTY(EditAnywhere)
+		UStaticMeshComponent* static_mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo)
+		class UTextureRenderTarget2D* RenderTarget;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo)
+		int32 Seed;
+
+	//Hash family of the kernel: 0 = hash12 (default), 1 = PCG2D, 2 = xxHash32, 3 = Wang, 4 = IQ integer hash. The integer families are cheaper,
+	//see the NoiseQuality tool for how they compare. Not used by the frame ring
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo, meta = (ClampMin = "0", ClampMax = "4"))
+		int32 HashFunction;
+
+	//Samples a BC4 compressed copy of the output instead of the float render target. With bGenerateNormals, the normals are also compressed
+	//into a BC5 normal map the material samples through the "CompressedNormalMap" texture parameter.
+	//The render target size must be a multiple of 4, the output stays uncompressed otherwise
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo)
+		bool bCompressOutput;
+
+	UPROPERTY(Transient)
+		class UTexture2D* CompressedTexture;
+
+	UPROPERTY(Transient)
+		class UTexture2D* CompressedNormals;
+
+	//Also generates the signed distance field of the output thresholded at DistanceFieldThreshold.
+	//The material samples it through the "DistanceField" texture parameter, in texels and negative above the threshold
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo)
+		bool bGenerateDistanceField;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo, meta = (EditCondition = "bGenerateDistanceField"))
+		float DistanceFieldThreshold;
+
+	UPROPERTY(Transient)
+		class UTextureRenderTarget2D* DistanceField;
+
+	//Also writes the normals of the output seen as a height field, from the same dispatch as the noise.
+	//The material samples them through the "NormalMap" texture parameter: the normal in xyz and the height in w, one sample instead of a Sobel in the material
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo)
+		bool bGenerateNormals;
+
+	//Height of a noise value of 1, in texels
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo, meta = (EditCondition = "bGenerateNormals"))
+		float NormalStrength;
+
+	UPROPERTY(Transient)
+		class UTextureRenderTarget2D* Normals;
+
+	//Generates FrameRingSlices frames once into a texture array and only rotates the sampled slice every frame.
+	//The material samples the "FrameRing" texture array parameter at the "SliceIndex" scalar parameter
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo)
+		bool bUseFrameRing;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo, meta = (ClampMin = "1", EditCondition = "bUseFrameRing"))
+		int32 FrameRingSlices;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ShaderDemo, meta = (EditCondition = "bUseFrameRing"))
+		FIntPoint FrameRingResolution;
+
+	UPROPERTY(Transient)
+		class UTextureRenderTarget2DArray* FrameRing;
+
+	UPROPERTY(Transient)
+		class UMaterialInstanceDynamic* MaterialInstance;
+private:
+	uint32 TimeStamp;
+public:
+	// Sets default values for this pawn's properties
+	AWhiteNoiseConsumer();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void BeginDestroy() override;
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Called to bind functionality to input
+	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+};
@@ -1,23 +1,24 @@
-// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
-
-using UnrealBuildTool;
-
-public class CustomShadersDeclarations : ModuleRules
-{
-	public CustomShadersDeclarations(ReadOnlyTargetRules Target) : base(Target)
-	{
-		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
-
-		PublicDependencyModuleNames.AddRange(new string[] { });
-		PrivateDependencyModuleNames.AddRange(new string[]
-		{
-				"Core",
-				"CoreUObject",
-				"Engine",
-				"Renderer",
-				"RenderCore",
-				"RHI",
-				"Projects"
-		});
-	}
-}
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class CustomShadersDeclarations : ModuleRules
+{
+	public CustomShadersDeclarations(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[]
+		{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"Renderer",
+				"RenderCore",
+				"RHI",
+				"Projects",
+				"ImageWrapper"
+		});
+	}
+}
@@ -0,0 +1,113 @@
+#include "AllocationTracker.h"
+
+#include "HAL/MemoryBase.h"
+
+namespace
+{
+	//Count of the innermost FScopedAllocationCount of this thread
+	thread_local FAllocationCount* ThreadAllocationCount = nullptr;
+
+	void CountAllocation(SIZE_T Size)
+	{
+		if (FAllocationCount* Count = ThreadAllocationCount)
+		{
+			++Count->NumAllocations;
+			Count->NumBytes += Size;
+		}
+	}
+
+	class FMallocCountingProxy final : public FMalloc
+	{
+	public:
+		explicit FMallocCountingProxy(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation(Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation(Count);
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		//Shrinking or growing, a realloc is churn all the same
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation(Count);
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation(Count);
+			}
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		FMalloc* Inner;
+	};
+
+	FMallocCountingProxy* CountingProxy = nullptr;
+}
+
+void FAllocationTracker::Install()
+{
+	check(IsInGameThread());
+	if (CountingProxy)
+	{
+		return;
+	}
+
+	//Every block keeps going through the allocator that made it, the proxy only adds the counting. It is never deleted since threads
+	//may still be inside it
+	CountingProxy = new FMallocCountingProxy(GMalloc);
+	FPlatformMisc::MemoryBarrier();
+	GMalloc = CountingProxy;
+}
+
+bool FAllocationTracker::IsInstalled()
+{
+	return CountingProxy != nullptr;
+}
+
+FScopedAllocationCount::FScopedAllocationCount()
+	: PreviousCount(ThreadAllocationCount)
+{
+	ThreadAllocationCount = &Count;
+}
+
+FScopedAllocationCount::~FScopedAllocationCount()
+{
+	ThreadAllocationCount = PreviousCount;
+	if (PreviousCount)
+	{
+		PreviousCount->NumAllocations += Count.NumAllocations;
+		PreviousCount->NumBytes += Count.NumBytes;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Heap allocations counted by an FScopedAllocationCount
+struct FAllocationCount
+{
+	uint64 NumAllocations = 0;
+	uint64 NumBytes = 0;
+};
+
+/// <summary>
+/// Counts the heap allocations of a scope, to keep per frame allocations out of the compute hot paths.
+/// Install() wraps GMalloc in a proxy that forwards everything to the real allocator and, on threads inside an FScopedAllocationCount,
+/// counts every Malloc and Realloc. The proxy stays installed once added, it only costs a thread local read per allocation
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FAllocationTracker
+{
+public:
+	//Game thread. Does nothing if the proxy is already installed
+	static void Install();
+	static bool IsInstalled();
+};
+
+//Counts the allocations of the current thread while it is alive. Nested scopes add their count to the enclosing one when they end
+class CUSTOMSHADERSDECLARATIONS_API FScopedAllocationCount
+{
+public:
+	FScopedAllocationCount();
+	~FScopedAllocationCount();
+
+	const FAllocationCount& Get() const { return Count; }
+
+private:
+	FAllocationCount Count;
+	FAllocationCount* PreviousCount;
+};
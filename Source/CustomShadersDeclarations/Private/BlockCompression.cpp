@@ -0,0 +1,355 @@
+#include "BlockCompression.h"
+
+#include "Async/ParallelFor.h"
+#include "GlobalShader.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ShaderParameterStruct.h"
+#include "ComputeBenchmark.h"
+#include "WhiteNoiseCPU.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 8
+
+static FAutoConsoleCommand BlockCompressBenchmarkCommand(
+	TEXT("CustomShaders.BlockCompress.Benchmark"),
+	TEXT("Times the BC4 and BC5 compute encoders and checks their blocks against the CPU encoder. Arguments: [Size] [NumIterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4096;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10;
+		ENQUEUE_RENDER_COMMAND(BlockCompressBenchmarkCommand)(
+			[Size, NumIterations](FRHICommandListImmediate& RHICmdList)
+			{
+				RunBlockCompressBenchmark(RHICmdList, Size, NumIterations);
+			});
+	}));
+
+/// <summary>
+/// Internal class that connects BlockCompressCS.usf to the engine
+/// </summary>
+class FBlockCompressCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FBlockCompressCS);
+	SHADER_USE_PARAMETER_STRUCT(FBlockCompressCS, FGlobalShader);
+
+	//BC5 encodes the green channel into a second BC4 block
+	class FBC5Dim : SHADER_PERMUTATION_BOOL("BLOCK_COMPRESS_BC5");
+	using FPermutationDomain = TShaderPermutationDomain<FBC5Dim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, SourceTexture)
+		SHADER_PARAMETER(FIntPoint, SourceSize)
+		SHADER_PARAMETER(FVector2D, SourceScale)
+		SHADER_PARAMETER(FVector2D, SourceBias)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<uint2>, OutputBlocks)
+	END_SHADER_PARAMETER_STRUCT()
+
+public:
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FBlockCompressCS, "/CustomShaders/BlockCompressCS.usf", "MainComputeShader", SF_Compute);
+
+
+FRDGTextureRef AddBlockCompressPass(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source, FIntPoint SourceSize, bool bTwoChannels,
+									FVector2D SourceScale, FVector2D SourceBias)
+{
+	const FIntPoint NumBlocks = FBlockCompressionCPU::GetNumBlocks(SourceSize);
+	FRDGTextureDesc BlocksDesc = FRDGTextureDesc::Create2DDesc(NumBlocks, bTwoChannels ? PF_R32G32B32A32_UINT : PF_R32G32_UINT,
+															   FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+	FRDGTextureRef Blocks = GraphBuilder.CreateTexture(BlocksDesc, bTwoChannels ? TEXT("BC5Blocks") : TEXT("BC4Blocks"));
+
+	FBlockCompressCS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FBlockCompressCS::FBC5Dim>(bTwoChannels);
+	TShaderMapRef<FBlockCompressCS> BlockCompressCS(ShaderMap, PermutationVector);
+
+	FBlockCompressCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FBlockCompressCS::FParameters>();
+	PassParameters->SourceTexture = Source;
+	PassParameters->SourceSize = SourceSize;
+	PassParameters->SourceScale = SourceScale;
+	PassParameters->SourceBias = SourceBias;
+	PassParameters->OutputBlocks = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Blocks));
+
+	FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("BlockCompress %s", bTwoChannels ? TEXT("BC5") : TEXT("BC4")), BlockCompressCS, PassParameters,
+								 FComputeShaderUtils::GetGroupCount(NumBlocks, NUM_THREADS_PER_GROUP_DIMENSION));
+	return Blocks;
+}
+
+void RunBlockCompressBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations)
+{
+	check(IsInRenderingThread());
+	const FIntPoint Extent(FMath::Clamp(Size, 4, 8192), FMath::Clamp(Size, 4, 8192));
+	const int32 NumTexels = Extent.X * Extent.Y;
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+
+	//BC4 compresses the noise itself, BC5 the xy of its normals the way the white noise manager builds a BC5 normal map
+	TArray<float> Noise;
+	FWhiteNoiseCPU::Generate(ENoiseType::White, Extent, 1, 1, Noise);
+	TArray<FVector4> Normals;
+	FWhiteNoiseCPU::GenerateNormals(Extent, 1, 1, ENoiseHash::Hash12, 1.f, Normals);
+	TArray<FVector2D> NormalsXY;
+	TArray<float> Planes[2];
+	NormalsXY.SetNumUninitialized(NumTexels);
+	Planes[0].SetNumUninitialized(NumTexels);
+	Planes[1].SetNumUninitialized(NumTexels);
+	for (int32 Index = 0; Index < NumTexels; ++Index)
+	{
+		NormalsXY[Index] = FVector2D(Normals[Index].X, Normals[Index].Y);
+		Planes[0][Index] = Normals[Index].X * 0.5f + 0.5f;
+		Planes[1][Index] = Normals[Index].Y * 0.5f + 0.5f;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Block compression benchmark: %dx%d, %d iterations"), Extent.X, Extent.Y, NumIterations);
+	auto RunCase = [&](const TCHAR* Name, const TRefCountPtr<IPooledRenderTarget>& Source, bool bTwoChannels, FVector2D SourceScale, FVector2D SourceBias,
+					   TArrayView<const TArray<float>* const> Channels)
+	{
+		TRefCountPtr<IPooledRenderTarget> Result;
+		const double GPUMilliseconds = FComputeBenchmark::TimeGraphs(RHICmdList, NumIterations, [&](FRDGBuilder& GraphBuilder)
+		{
+			FRDGTextureRef SourceTexture = GraphBuilder.RegisterExternalTexture(Source, TEXT("BlockCompressBenchmarkSource"));
+			GraphBuilder.QueueTextureExtraction(AddBlockCompressPass(GraphBuilder, ShaderMap, SourceTexture, Extent, bTwoChannels, SourceScale, SourceBias), &Result);
+		});
+		TArray<uint8> GPUBlocks;
+		FComputeBenchmark::ReadbackTexture(RHICmdList, Result, GPUBlocks);
+
+		TArray<uint8> CPUBlocks;
+		const double CPUStart = FPlatformTime::Seconds();
+		if (bTwoChannels)
+		{
+			FBlockCompressionCPU::EncodeBC5(*Channels[0], *Channels[1], Extent, CPUBlocks);
+		}
+		else
+		{
+			FBlockCompressionCPU::EncodeBC4(*Channels[0], Extent, CPUBlocks);
+		}
+		const double CPUMilliseconds = (FPlatformTime::Seconds() - CPUStart) * 1000.0;
+		check(GPUBlocks.Num() == CPUBlocks.Num());
+
+		//Every BC4 block on its own, a BC5 block is two of them
+		const uint64* GPUData = (const uint64*)GPUBlocks.GetData();
+		const uint64* CPUData = (const uint64*)CPUBlocks.GetData();
+		const int32 NumBC4Blocks = CPUBlocks.Num() / sizeof(uint64);
+		int32 NumDifferentBlocks = 0;
+		for (int32 Block = 0; Block < NumBC4Blocks; ++Block)
+		{
+			NumDifferentBlocks += GPUData[Block] != CPUData[Block] ? 1 : 0;
+		}
+
+		TArray<float> GPUDecoded[2];
+		TArray<float> CPUDecoded[2];
+		if (bTwoChannels)
+		{
+			FBlockCompressionCPU::DecodeBC5(GPUBlocks, Extent, GPUDecoded[0], GPUDecoded[1]);
+			FBlockCompressionCPU::DecodeBC5(CPUBlocks, Extent, CPUDecoded[0], CPUDecoded[1]);
+		}
+		else
+		{
+			FBlockCompressionCPU::DecodeBC4(GPUBlocks, Extent, GPUDecoded[0]);
+			FBlockCompressionCPU::DecodeBC4(CPUBlocks, Extent, CPUDecoded[0]);
+		}
+		float MaxDifference = 0.f;
+		double MinGPUPSNR = TNumericLimits<double>::Max();
+		double MinCPUPSNR = TNumericLimits<double>::Max();
+		for (int32 Channel = 0; Channel < Channels.Num(); ++Channel)
+		{
+			for (int32 Index = 0; Index < NumTexels; ++Index)
+			{
+				MaxDifference = FMath::Max(MaxDifference, FMath::Abs(GPUDecoded[Channel][Index] - CPUDecoded[Channel][Index]));
+			}
+			MinGPUPSNR = FMath::Min(MinGPUPSNR, FBlockCompressionCPU::ComputePSNR(*Channels[Channel], GPUDecoded[Channel]));
+			MinCPUPSNR = FMath::Min(MinCPUPSNR, FBlockCompressionCPU::ComputePSNR(*Channels[Channel], CPUDecoded[Channel]));
+		}
+
+		const double Megapixels = NumTexels / 1.0e6;
+		UE_LOG(LogTemp, Log, TEXT("  %s GPU %8.3f ms (%8.1f Mpixels/s)  CPU %8.3f ms (%8.1f Mpixels/s)  %d of %d blocks differ from the CPU, max decoded difference %g, PSNR GPU %.2f dB CPU %.2f dB"),
+			Name, GPUMilliseconds, GPUMilliseconds > 0.0 ? Megapixels / (GPUMilliseconds / 1000.0) : 0.0, CPUMilliseconds, CPUMilliseconds > 0.0 ? Megapixels / (CPUMilliseconds / 1000.0) : 0.0,
+			NumDifferentBlocks, NumBC4Blocks, MaxDifference, MinGPUPSNR, MinCPUPSNR);
+	};
+
+	const TArray<float>* NoiseChannels[] = { &Noise };
+	RunCase(TEXT("BC4"), FComputeBenchmark::UploadFloatTexture(RHICmdList, Extent, Noise, TEXT("BlockCompressBenchmarkNoise")), false,
+		FVector2D(1.f, 1.f), FVector2D::ZeroVector, NoiseChannels);
+	const TArray<float>* NormalChannels[] = { &Planes[0], &Planes[1] };
+	RunCase(TEXT("BC5"), FComputeBenchmark::UploadTexture(RHICmdList, Extent, PF_G32R32F, NormalsXY.GetData(), TEXT("BlockCompressBenchmarkNormals")), true,
+		FVector2D(0.5f, 0.5f), FVector2D(0.5f, 0.5f), NormalChannels);
+}
+
+
+uint64 FBlockCompressionCPU::EncodeBC4Block(const float Texels[16])
+{
+	float MinValue = Texels[0];
+	float MaxValue = Texels[0];
+	for (int32 Index = 1; Index < 16; ++Index)
+	{
+		MinValue = FMath::Min(MinValue, Texels[Index]);
+		MaxValue = FMath::Max(MaxValue, Texels[Index]);
+	}
+
+	//Red0 > Red1 selects the 8 value interpolation mode
+	const uint32 Red0 = (uint32)FMath::RoundToInt(FMath::Clamp(MaxValue, 0.f, 1.f) * 255.f);
+	const uint32 Red1 = (uint32)FMath::RoundToInt(FMath::Clamp(MinValue, 0.f, 1.f) * 255.f);
+
+	uint64 Block = Red0 | (Red1 << 8);
+	if (Red0 == Red1)
+	{
+		return Block;
+	}
+
+	const float Low = Red1 / 255.f;
+	const float Scale = 7.f * 255.f / (float)(Red0 - Red1);
+	for (int32 Index = 0; Index < 16; ++Index)
+	{
+		const uint32 Step = (uint32)FMath::Clamp((float)FMath::RoundToInt((Texels[Index] - Low) * Scale), 0.f, 7.f);
+		const uint64 BlockIndex = Step == 7 ? 0 : (Step == 0 ? 1 : 8 - Step);
+		Block |= BlockIndex << (16 + 3 * Index);
+	}
+	return Block;
+}
+
+namespace
+{
+	//Gathers the 4x4 block at (BlockX, BlockY), repeating the last texel on partial blocks like the shader does
+	void GatherBlock(const float* Values, FIntPoint Size, int32 BlockX, int32 BlockY, float OutTexels[16])
+	{
+		for (int32 Y = 0; Y < 4; ++Y)
+		{
+			const int32 SourceY = FMath::Min(BlockY * 4 + Y, Size.Y - 1);
+			for (int32 X = 0; X < 4; ++X)
+			{
+				const int32 SourceX = FMath::Min(BlockX * 4 + X, Size.X - 1);
+				OutTexels[Y * 4 + X] = Values[SourceY * Size.X + SourceX];
+			}
+		}
+	}
+}
+
+void FBlockCompressionCPU::EncodeBC4(const TArray<float>& Values, FIntPoint Size, TArray<uint8>& OutBlocks)
+{
+	check(Values.Num() == Size.X * Size.Y);
+	const FIntPoint NumBlocks = GetNumBlocks(Size);
+	OutBlocks.SetNumUninitialized(NumBlocks.X * NumBlocks.Y * sizeof(uint64));
+	uint64* Blocks = (uint64*)OutBlocks.GetData();
+
+	ParallelFor(NumBlocks.Y, [&Values, Size, NumBlocks, Blocks](int32 BlockY)
+	{
+		float Texels[16];
+		for (int32 BlockX = 0; BlockX < NumBlocks.X; ++BlockX)
+		{
+			GatherBlock(Values.GetData(), Size, BlockX, BlockY, Texels);
+			Blocks[BlockY * NumBlocks.X + BlockX] = EncodeBC4Block(Texels);
+		}
+	});
+}
+
+void FBlockCompressionCPU::EncodeBC5(const TArray<float>& Red, const TArray<float>& Green, FIntPoint Size, TArray<uint8>& OutBlocks)
+{
+	check(Red.Num() == Size.X * Size.Y && Green.Num() == Red.Num());
+	const FIntPoint NumBlocks = GetNumBlocks(Size);
+	OutBlocks.SetNumUninitialized(NumBlocks.X * NumBlocks.Y * 2 * sizeof(uint64));
+	uint64* Blocks = (uint64*)OutBlocks.GetData();
+
+	ParallelFor(NumBlocks.Y, [&Red, &Green, Size, NumBlocks, Blocks](int32 BlockY)
+	{
+		float Texels[16];
+		for (int32 BlockX = 0; BlockX < NumBlocks.X; ++BlockX)
+		{
+			uint64* Block = Blocks + (BlockY * NumBlocks.X + BlockX) * 2;
+			GatherBlock(Red.GetData(), Size, BlockX, BlockY, Texels);
+			Block[0] = EncodeBC4Block(Texels);
+			GatherBlock(Green.GetData(), Size, BlockX, BlockY, Texels);
+			Block[1] = EncodeBC4Block(Texels);
+		}
+	});
+}
+
+void FBlockCompressionCPU::DecodeBC4(const TArray<uint8>& Blocks, FIntPoint Size, TArray<float>& OutValues)
+{
+	const FIntPoint NumBlocks = GetNumBlocks(Size);
+	check(Blocks.Num() == NumBlocks.X * NumBlocks.Y * sizeof(uint64));
+	OutValues.SetNumUninitialized(Size.X * Size.Y);
+
+	const uint64* BlockData = (const uint64*)Blocks.GetData();
+	for (int32 BlockY = 0; BlockY < NumBlocks.Y; ++BlockY)
+	{
+		for (int32 BlockX = 0; BlockX < NumBlocks.X; ++BlockX)
+		{
+			const uint64 Block = BlockData[BlockY * NumBlocks.X + BlockX];
+			const float Red0 = (float)(Block & 0xFF);
+			const float Red1 = (float)((Block >> 8) & 0xFF);
+
+			float Palette[8] = { Red0, Red1 };
+			for (int32 Step = 1; Step < 7; ++Step)
+			{
+				if (Red0 > Red1)
+				{
+					Palette[Step + 1] = ((7 - Step) * Red0 + Step * Red1) / 7.f;
+				}
+				else
+				{
+					//6 value mode, never produced by our encoder but part of the format
+					Palette[Step + 1] = Step < 5 ? ((5 - Step) * Red0 + Step * Red1) / 5.f : (Step == 5 ? 0.f : 255.f);
+				}
+			}
+
+			for (int32 Y = 0; Y < 4; ++Y)
+			{
+				for (int32 X = 0; X < 4; ++X)
+				{
+					const int32 DestX = BlockX * 4 + X;
+					const int32 DestY = BlockY * 4 + Y;
+					if (DestX < Size.X && DestY < Size.Y)
+					{
+						const uint32 Index = (Block >> (16 + 3 * (Y * 4 + X))) & 7;
+						OutValues[DestY * Size.X + DestX] = Palette[Index] / 255.f;
+					}
+				}
+			}
+		}
+	}
+}
+
+void FBlockCompressionCPU::DecodeBC5(const TArray<uint8>& Blocks, FIntPoint Size, TArray<float>& OutRed, TArray<float>& OutGreen)
+{
+	const FIntPoint NumBlocks = GetNumBlocks(Size);
+	check(Blocks.Num() == NumBlocks.X * NumBlocks.Y * 2 * sizeof(uint64));
+
+	//A BC5 block is the BC4 block of the red channel followed by the one of the green channel
+	TArray<uint8> Channels[2];
+	for (int32 Channel = 0; Channel < 2; ++Channel)
+	{
+		Channels[Channel].SetNumUninitialized(NumBlocks.X * NumBlocks.Y * sizeof(uint64));
+		const uint64* Source = (const uint64*)Blocks.GetData() + Channel;
+		uint64* Dest = (uint64*)Channels[Channel].GetData();
+		for (int32 Block = 0; Block < NumBlocks.X * NumBlocks.Y; ++Block)
+		{
+			Dest[Block] = Source[Block * 2];
+		}
+	}
+	DecodeBC4(Channels[0], Size, OutRed);
+	DecodeBC4(Channels[1], Size, OutGreen);
+}
+
+double FBlockCompressionCPU::ComputePSNR(const TArray<float>& Reference, const TArray<float>& Decoded)
+{
+	check(Reference.Num() == Decoded.Num() && Reference.Num() > 0);
+	double SquaredError = 0.0;
+	for (int32 Index = 0; Index < Reference.Num(); ++Index)
+	{
+		const double Error = (double)Reference[Index] - Decoded[Index];
+		SquaredError += Error * Error;
+	}
+
+	const double MeanSquaredError = SquaredError / Reference.Num();
+	return MeanSquaredError > 0.0 ? 10.0 * FMath::LogX(10.0, 1.0 / MeanSquaredError) : TNumericLimits<double>::Max();
+}
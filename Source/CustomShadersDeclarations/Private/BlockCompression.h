@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphUtils.h"
+
+/// <summary>
+/// Adds a compute pass that block compresses Source into BC4 (red) or BC5 (red and green) blocks
+/// The returned texture is PF_R32G32_UINT (BC4) or PF_R32G32B32A32_UINT (BC5) with one texel per 4x4 block, ready to be copied into a texture with the matching BC format
+/// The source is remapped to Texel * SourceScale + SourceBias first, e.g. a scale and a bias of 0.5 turn the xy of a normal map into a BC5 normal map
+/// </summary>
+CUSTOMSHADERSDECLARATIONS_API FRDGTextureRef AddBlockCompressPass(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source, FIntPoint SourceSize, bool bTwoChannels,
+																  FVector2D SourceScale = FVector2D(1.f, 1.f), FVector2D SourceBias = FVector2D::ZeroVector);
+
+/// <summary>
+/// Times AddBlockCompressPass in BC4 on white noise and in BC5 on the xy of its normals, then compares the blocks read back with FBlockCompressionCPU
+/// and logs both throughputs, the blocks that differ, the largest difference of the decoded texels and the PSNR. Stalls the GPU, render thread only
+/// </summary>
+CUSTOMSHADERSDECLARATIONS_API void RunBlockCompressBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations);
+
+/// <summary>
+/// CPU reference implementation of BlockCompressCS.usf, matches the GPU encoder except for texels that land exactly halfway between two steps.
+/// RunBlockCompressBenchmark counts the blocks where they differ
+/// Blocks are stored row-major, 8 bytes per BC4 block and 16 bytes per BC5 block
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FBlockCompressionCPU
+{
+	static FIntPoint GetNumBlocks(FIntPoint Size) { return FIntPoint(FMath::DivideAndRoundUp(Size.X, 4), FMath::DivideAndRoundUp(Size.Y, 4)); }
+
+	//Encodes a single channel image. Block rows are spread across all the worker threads
+	static void EncodeBC4(const TArray<float>& Values, FIntPoint Size, TArray<uint8>& OutBlocks);
+
+	//Encodes a two channel image given as two planes
+	static void EncodeBC5(const TArray<float>& Red, const TArray<float>& Green, FIntPoint Size, TArray<uint8>& OutBlocks);
+
+	//Decodes BC4 blocks back to a single channel image of the given size
+	static void DecodeBC4(const TArray<uint8>& Blocks, FIntPoint Size, TArray<float>& OutValues);
+
+	//Decodes BC5 blocks back to two planes of the given size
+	static void DecodeBC5(const TArray<uint8>& Blocks, FIntPoint Size, TArray<float>& OutRed, TArray<float>& OutGreen);
+
+	//Peak signal to noise ratio in dB of Decoded against Reference, for values in [0, 1]. Identical images return TNumericLimits<double>::Max()
+	static double ComputePSNR(const TArray<float>& Reference, const TArray<float>& Decoded);
+
+	//Encodes the 16 texels of a block, mirrors EncodeBC4Block in BlockCompressCS.usf
+	static uint64 EncodeBC4Block(const float Texels[16]);
+};
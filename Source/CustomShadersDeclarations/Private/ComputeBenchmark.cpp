@@ -0,0 +1,81 @@
+#include "ComputeBenchmark.h"
+
+#include "RHIGPUReadback.h"
+
+TRefCountPtr<IPooledRenderTarget> FComputeBenchmark::UploadFloatTexture(FRHICommandListImmediate& RHICmdList, FIntPoint Size, TArrayView<const float> Values, const TCHAR* Name)
+{
+	check(Values.Num() == Size.X * Size.Y);
+	return UploadTexture(RHICmdList, Size, PF_R32_FLOAT, Values.GetData(), Name);
+}
+
+TRefCountPtr<IPooledRenderTarget> FComputeBenchmark::UploadTexture(FRHICommandListImmediate& RHICmdList, FIntPoint Size, EPixelFormat Format, const void* Texels, const TCHAR* Name)
+{
+	check(GPixelFormats[Format].BlockSizeX == 1 && GPixelFormats[Format].BlockSizeY == 1);
+	TRefCountPtr<IPooledRenderTarget> Texture;
+	const FPooledRenderTargetDesc Desc = FPooledRenderTargetDesc::Create2DDesc(Size, Format, FClearValueBinding::None,
+																			   TexCreate_None, TexCreate_ShaderResource, false);
+	GRenderTargetPool.FindFreeElement(RHICmdList, Desc, Texture, Name);
+	RHIUpdateTexture2D(Texture->GetRenderTargetItem().ShaderResourceTexture->GetTexture2D(), 0, FUpdateTextureRegion2D(0, 0, 0, 0, Size.X, Size.Y),
+					   Size.X * GPixelFormats[Format].BlockBytes, (const uint8*)Texels);
+	return Texture;
+}
+
+void FComputeBenchmark::ReadbackFloatTexture(FRHICommandListImmediate& RHICmdList, const TRefCountPtr<IPooledRenderTarget>& Texture, TArray<float>& OutValues)
+{
+	check(Texture->GetDesc().Format == PF_R32_FLOAT);
+	TArray<uint8> Texels;
+	ReadbackTexture(RHICmdList, Texture, Texels);
+	OutValues.SetNumUninitialized(Texels.Num() / sizeof(float));
+	FMemory::Memcpy(OutValues.GetData(), Texels.GetData(), Texels.Num());
+}
+
+void FComputeBenchmark::ReadbackTexture(FRHICommandListImmediate& RHICmdList, const TRefCountPtr<IPooledRenderTarget>& Texture, TArray<uint8>& OutTexels)
+{
+	const FIntPoint Size = Texture->GetDesc().Extent;
+	const int32 BytesPerTexel = GPixelFormats[Texture->GetDesc().Format].BlockBytes;
+	FRHIGPUTextureReadback Readback(TEXT("ComputeBenchmarkReadback"));
+	Readback.EnqueueCopy(RHICmdList, Texture->GetRenderTargetItem().ShaderResourceTexture);
+	RHICmdList.BlockUntilGPUIdle();
+
+	void* Data = nullptr;
+	int32 RowPitchInPixels = 0;
+	Readback.LockTexture(RHICmdList, Data, RowPitchInPixels);
+	OutTexels.SetNumUninitialized(Size.X * Size.Y * BytesPerTexel);
+	for (int32 Y = 0; Y < Size.Y; ++Y)
+	{
+		FMemory::Memcpy(&OutTexels[Y * Size.X * BytesPerTexel], (const uint8*)Data + Y * RowPitchInPixels * BytesPerTexel, Size.X * BytesPerTexel);
+	}
+	Readback.Unlock();
+}
+
+double FComputeBenchmark::TimeGraphs(FRHICommandListImmediate& RHICmdList, int32 NumIterations, TFunctionRef<void(FRDGBuilder&)> BuildGraph)
+{
+	check(IsInRenderingThread());
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	//Timing each graph on its own leaves out the GPU idling while the next one is built
+	TArray<FRenderQueryRHIRef> Queries;
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		FRDGBuilder GraphBuilder(RHICmdList);
+		BuildGraph(GraphBuilder);
+
+		Queries.Add(RHICreateRenderQuery(RQT_AbsoluteTime));
+		RHICmdList.EndRenderQuery(Queries.Last());
+		GraphBuilder.Execute();
+		Queries.Add(RHICreateRenderQuery(RQT_AbsoluteTime));
+		RHICmdList.EndRenderQuery(Queries.Last());
+	}
+	RHICmdList.BlockUntilGPUIdle();
+
+	uint64 TotalMicroseconds = 0;
+	for (int32 Query = 0; Query < Queries.Num(); Query += 2)
+	{
+		uint64 StartMicroseconds = 0;
+		uint64 EndMicroseconds = 0;
+		RHIGetRenderQueryResult(Queries[Query], StartMicroseconds, true);
+		RHIGetRenderQueryResult(Queries[Query + 1], EndMicroseconds, true);
+		TotalMicroseconds += EndMicroseconds - StartMicroseconds;
+	}
+	return TotalMicroseconds / 1000.0 / NumIterations;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+
+/// <summary>
+/// Helpers shared by the console benchmarks of the compute passes. They all stall the GPU and must run on the render thread
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FComputeBenchmark
+{
+	//PF_R32_FLOAT texture holding Values, rows packed
+	static TRefCountPtr<IPooledRenderTarget> UploadFloatTexture(FRHICommandListImmediate& RHICmdList, FIntPoint Size, TArrayView<const float> Values, const TCHAR* Name);
+
+	//Texture of an uncompressed Format holding Size.X * Size.Y texels, rows packed
+	static TRefCountPtr<IPooledRenderTarget> UploadTexture(FRHICommandListImmediate& RHICmdList, FIntPoint Size, EPixelFormat Format, const void* Texels, const TCHAR* Name);
+
+	//Copies a PF_R32_FLOAT texture to OutValues, rows packed
+	static void ReadbackFloatTexture(FRHICommandListImmediate& RHICmdList, const TRefCountPtr<IPooledRenderTarget>& Texture, TArray<float>& OutValues);
+
+	//Copies the texels of an uncompressed texture of any format to OutTexels, rows packed
+	static void ReadbackTexture(FRHICommandListImmediate& RHICmdList, const TRefCountPtr<IPooledRenderTarget>& Texture, TArray<uint8>& OutTexels);
+
+	//Builds and executes NumIterations graphs with BuildGraph, each between two timestamps, and returns the average GPU milliseconds of one.
+	//BuildGraph must extract what it produces, the graph culls the passes nothing reads
+	static double TimeGraphs(FRHICommandListImmediate& RHICmdList, int32 NumIterations, TFunctionRef<void(FRDGBuilder&)> BuildGraph);
+};
@@ -1,240 +1,1171 @@
-#include "ComputeShaderDeclaration.h"
-
-#include "Modules/ModuleManager.h"
-
-#define NUM_THREADS_PER_GROUP_DIMENSION 32
-
-/// <summary>
-/// Internal class thet holds the parameters and connects the HLSL Shader to the engine
-/// </summary>
-class FWhiteNoiseCS : public FGlobalShader
-{
-public:
-	//Declare this class as a global shader
-	DECLARE_GLOBAL_SHADER(FWhiteNoiseCS);
-	//Tells the engine that this shader uses a structure for its parameters
-	SHADER_USE_PARAMETER_STRUCT(FWhiteNoiseCS, FGlobalShader);
-	/// <summary>
-	/// DECLARATION OF THE PARAMETER STRUCTURE
-	/// The parameters must match the parameters in the HLSL code
-	/// For each parameter, provide the C++ type, and the name (Same name used in HLSL code)
-	/// </summary>
-	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
-		SHADER_PARAMETER_UAV(RWTexture2D<float>, OutputTexture)
-		SHADER_PARAMETER(FVector2D, Dimensions)
-		SHADER_PARAMETER(UINT, TimeStamp)
-	END_SHADER_PARAMETER_STRUCT()
-
-public:
-	//Called by the engine to determine which permutations to compile for this shader
-	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
-	{
-		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
-	}
-
-	//Modifies the compilations environment of the shader
-	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
-	{
-		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
-
-		//We're using it here to add some preprocessor defines. That way we don't have to change both C++ and HLSL code when we change the value for NUM_THREADS_PER_GROUP_DIMENSION
-		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
-		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
-		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Z"), 1);
-	}
-
-};
-
-// This will tell the engine to create the shader and where the shader entry point is.
-//                        ShaderType              ShaderPath             Shader function name    Type
-IMPLEMENT_GLOBAL_SHADER(FWhiteNoiseCS, "/CustomShaders/WhiteNoiseCS.usf", "MainComputeShader", SF_Compute);
-
-
-//Static members
-FWhiteNoiseCSManager* FWhiteNoiseCSManager::instance = nullptr;
-
-//Begin the execution of the compute shader each frame
-void FWhiteNoiseCSManager::BeginRendering()
-{
-	// //If the handle is already initalized and valid, no need to do anything
-	// if (OnPostResolvedSceneColorHandle.IsValid())
-	// {
-	// 	return;
-	// }
-	// bCachedParamsAreValid = false;
-	// // Get the Renderer Module and add our entry to the callbacks so it can be executed each frame after the scene rendering is done
-	// const FName RendererModuleName("Renderer");
-	// IRendererModule* RendererModule = FModuleManager::GetModulePtr<IRendererModule>(RendererModuleName);
-	// if (RendererModule)
-	// {
-	// 	OnPostResolvedSceneColorHandle = RendererModule->GetResolvedSceneColorCallbacks().AddRaw(this, &FWhiteNoiseCSManager::Execute_Graph);
-	// }
-	// check(IsInGameThread());
-	ENQUEUE_RENDER_COMMAND(CaptureCommand)
-		(
-			[](FRHICommandListImmediate& RHICmdList)
-			{
-				FWhiteNoiseCSManager::Get()->UpdateResults(RHICmdList);
-			}
-		);
-	
-}
-
-//Stop the compute shader execution
-void FWhiteNoiseCSManager::EndRendering()
-{
-	// // If the handle is not valid then there's no cleanup to do
-	// if (!OnPostResolvedSceneColorHandle.IsValid())
-	// {
-	// 	return;
-	// }
-
-	// //Get the Renderer Module and remove our entry from the ResolvedSceneColorCallbacks
-	// const FName RendererModuleName("Renderer");
-	// IRendererModule* RendererModule = FModuleManager::GetModulePtr<IRendererModule>(RendererModuleName);
-	// if (RendererModule)
-	// {
-	// 	RendererModule->GetResolvedSceneColorCallbacks().Remove(OnPostResolvedSceneColorHandle);
-	// }
-
-	// OnPostResolvedSceneColorHandle.Reset();
-}
-
-//Update the parameters by a providing an instance of the Parameters structure used by the shader manager
-void FWhiteNoiseCSManager::UpdateParameters(FWhiteNoiseCSParameters& params)
-{
-	cachedParams = params;
-	bCachedParamsAreValid = true;
-}
-
-
-void FWhiteNoiseCSManager::AddWhiteNoisePass(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap,
-											 TRefCountPtr<IPooledRenderTarget> OutputUAV, FRDGTextureUAVRef DstTexture)
-{
-    TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(ShaderMap);
-    FWhiteNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseCS::FParameters>();
-
-	PassParameters->OutputTexture = OutputUAV->GetRenderTargetItem().UAV;
-	PassParameters->Dimensions = FVector2D(cachedParams.GetRenderTargetSize().X, cachedParams.GetRenderTargetSize().Y);
-	PassParameters->TimeStamp = cachedParams.TimeStamp;
-
-    FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("ComputeWhiteNoise"), WhiteNoiseCS, PassParameters,
-                                 FIntVector(FMath::DivideAndRoundUp(cachedParams.GetRenderTargetSize().X, NUM_THREADS_PER_GROUP_DIMENSION),
-                                            FMath::DivideAndRoundUp(cachedParams.GetRenderTargetSize().Y, NUM_THREADS_PER_GROUP_DIMENSION), 1));
-}
-
-
-void FWhiteNoiseCSManager::UpdateResults(FRHICommandListImmediate& RHICmdList)
-{
-	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
-	{
-		return;
-	}
-
-	//Render Thread Assertion
-	check(IsInRenderingThread());
-	const ERHIFeatureLevel::Type FeatureLevel = GMaxRHIFeatureLevel;
-	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(FeatureLevel);
-    FTexture2DRHIRef OutTexture = cachedParams.RenderTarget->GetRenderTargetResource()->GetRenderTargetTexture();
-	FPooledRenderTargetDesc TexDesc = FPooledRenderTargetDesc::Create2DDesc(cachedParams.GetRenderTargetSize(),
-															cachedParams.RenderTarget->GetRenderTargetResource()->TextureRHI->GetFormat(),
-															FClearValueBinding::None, TexCreate_None,
-															TexCreate_ShaderResource | TexCreate_UAV, false);
-    // FRDGTextureDesc TexDesc = FRDGTextureDesc::Create2DDesc(FluidSurfaceSize, PF_G32R32F, FClearValueBinding(FLinearColor::Black), TexCreate_None, TexCreate_UAV | TexCreate_ShaderResource, false);
-    TRefCountPtr<IPooledRenderTarget> PooledDivergenceField;
-    GRenderTargetPool.FindFreeElement(RHICmdList, TexDesc, PooledDivergenceField, TEXT("DivergenceField"));
-    FRDGBuilder GraphBuilder(RHICmdList);
-	FRDGTextureRef DivergenceField = GraphBuilder.RegisterExternalTexture(PooledDivergenceField, TEXT("DivergenceField"),
-																		  ERenderTargetTexture::ShaderResource, ERDGTextureFlags::MultiFrame);
-	FRDGTextureUAVRef DivergenceFieldUAV = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(DivergenceField));
-
-    TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(ShaderMap);
-    FWhiteNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseCS::FParameters>();
-
-	PassParameters->OutputTexture = PooledDivergenceField->GetRenderTargetItem().UAV;
-	PassParameters->Dimensions = FVector2D(cachedParams.GetRenderTargetSize().X, cachedParams.GetRenderTargetSize().Y);
-	PassParameters->TimeStamp = cachedParams.TimeStamp;
-
-	FIntVector ThreadGroupCount(FMath::DivideAndRoundUp(cachedParams.GetRenderTargetSize().X, NUM_THREADS_PER_GROUP_DIMENSION),
-								FMath::DivideAndRoundUp(cachedParams.GetRenderTargetSize().Y, NUM_THREADS_PER_GROUP_DIMENSION), 1);
-
-	GraphBuilder.AddPass(RDG_EVENT_NAME("ComputeWhiteNoise"),
-			PassParameters,
-			ERDGPassFlags::Compute,
-			[PassParameters, WhiteNoiseCS, ThreadGroupCount](FRHICommandList &RHICmdList) {
-				FComputeShaderUtils::Dispatch(RHICmdList, WhiteNoiseCS, *PassParameters, ThreadGroupCount);
-			});
-
-	// AddWhiteNoisePass(GraphBuilder, ShaderMap, PooledDivergenceField, DivergenceFieldUAV);
-	GraphBuilder.QueueTextureExtraction(DivergenceField, &PooledDivergenceField);
-    GraphBuilder.Execute();
-	RHICmdList.CopyTexture(PooledDivergenceField->GetRenderTargetItem().ShaderResourceTexture,  OutTexture->GetTexture2D(), FRHICopyTextureInfo());
-}
-
-void FWhiteNoiseCSManager::Execute_Graph(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext)
-{
-	//If there's no cached parameters to use, skip
-	//If no Render Target is supplied in the cachedParams, skip
-	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
-	{
-		return;
-	}
-
-	//Render Thread Assertion
-	check(IsInRenderingThread());
-	FWhiteNoiseCSManager::Get()->UpdateResults(RHICmdList);
-}
-
-
-/// <summary>
-/// Creates an instance of the shader type parameters structure and fills it using the cached shader manager parameter structure
-/// Gets a reference to the shader type from the global shaders map
-/// Dispatches the shader using the parameter structure instance
-/// </summary>
-void FWhiteNoiseCSManager::Execute_RenderThread(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext)
-{
-	//If there's no cached parameters to use, skip
-	//If no Render Target is supplied in the cachedParams, skip
-	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
-	{
-		return;
-	}
-
-	//Render Thread Assertion
-	check(IsInRenderingThread());
-
-
-	//If the render target is not valid, get an element from the render target pool by supplying a Descriptor
-	if (!ComputeShaderOutput.IsValid())
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Not Valid"));
-		FPooledRenderTargetDesc ComputeShaderOutputDesc(FPooledRenderTargetDesc::Create2DDesc(cachedParams.GetRenderTargetSize(), cachedParams.RenderTarget->GetRenderTargetResource()->TextureRHI->GetFormat(), FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false));
-		ComputeShaderOutputDesc.DebugName = TEXT("WhiteNoiseCS_Output_RenderTarget");
-		GRenderTargetPool.FindFreeElement(RHICmdList, ComputeShaderOutputDesc, ComputeShaderOutput, TEXT("WhiteNoiseCS_Output_RenderTarget"));
-	}
-	
-	//Unbind the previously bound render targets
-	// UnbindRenderTargets(RHICmdList);
-
-	//Specify the resource transition, we're executing this in post scene rendering so we set it to Graphics to Compute
-	RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, ComputeShaderOutput->GetRenderTargetItem().UAV);
-
-
-	//Fill the shader parameters structure with tha cached data supplied by the client
-	FWhiteNoiseCS::FParameters PassParameters;
-	PassParameters.OutputTexture = ComputeShaderOutput->GetRenderTargetItem().UAV;
-	PassParameters.Dimensions = FVector2D(cachedParams.GetRenderTargetSize().X, cachedParams.GetRenderTargetSize().Y);
-	PassParameters.TimeStamp = cachedParams.TimeStamp;
-
-	//Get a reference to our shader type from global shader map
-	TShaderMapRef<FWhiteNoiseCS> whiteNoiseCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
-
-	//Dispatch the compute shader
-	FComputeShaderUtils::Dispatch(RHICmdList, whiteNoiseCS, PassParameters,
-		FIntVector(FMath::DivideAndRoundUp(cachedParams.GetRenderTargetSize().X, NUM_THREADS_PER_GROUP_DIMENSION),
-			FMath::DivideAndRoundUp(cachedParams.GetRenderTargetSize().Y, NUM_THREADS_PER_GROUP_DIMENSION), 1));
-
-	//Copy shader's output to the render target provided by the client
-	RHICmdList.CopyTexture(ComputeShaderOutput->GetRenderTargetItem().ShaderResourceTexture, cachedParams.RenderTarget->GetRenderTargetResource()->TextureRHI, FRHICopyTextureInfo());
-
-}
+#include "ComputeShaderDeclaration.h"
+
+#include "Modules/ModuleManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "NoiseFrameCapture.h"
+#include "BlockCompression.h"
+#include "ComputeBenchmark.h"
+#include "JumpFlood.h"
+#include "Primitives.h"
+#include "WhiteNoiseCPU.h"
+#include "Core/DispatchSizing.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 32
+
+static TAutoConsoleVariable<int32> CVarWhiteNoiseInstrumentationPermutations(
+	TEXT("CustomShaders.WhiteNoise.InstrumentationPermutations"),
+	1,
+	TEXT("Project setting: compiles the STAMP_SUBMISSION, CHECKSUM_OUTPUT and WAVE_OPS permutations of the white noise shader, 120 permutations\n")
+	TEXT("instead of 20. Without them MeasureLatency, ChecksumInterval and ChecksumBenchmark do nothing. Set it to 0 in the [SystemSettings]\n")
+	TEXT("of the config a shipping build is cooked with. Shipping builds never use them"),
+	ECVF_ReadOnly);
+
+//Whether the instrumentation permutations of FWhiteNoiseCS are compiled and may be dispatched
+static bool AreWhiteNoiseInstrumentationPermutationsEnabled()
+{
+#if UE_BUILD_SHIPPING
+	return false;
+#else
+	return CVarWhiteNoiseInstrumentationPermutations.GetValueOnAnyThread() != 0;
+#endif
+}
+
+/// <summary>
+/// Internal class thet holds the parameters and connects the HLSL Shader to the engine
+/// </summary>
+class FWhiteNoiseCS : public FGlobalShader
+{
+public:
+	//Declare this class as a global shader
+	DECLARE_GLOBAL_SHADER(FWhiteNoiseCS);
+	//Tells the engine that this shader uses a structure for its parameters
+	SHADER_USE_PARAMETER_STRUCT(FWhiteNoiseCS, FGlobalShader);
+	//Thread coarsening, the number of pixels computed by each thread: 0 = 1x1, 1 = 2x2, 2 = 4x1
+	class FCoarseningDim : SHADER_PERMUTATION_INT("COARSENING", 3);
+	//Writes the submission id for CustomShaders.WhiteNoise.MeasureLatency
+	class FStampSubmissionDim : SHADER_PERMUTATION_BOOL("STAMP_SUBMISSION");
+	//Accumulates the output checksum for CustomShaders.WhiteNoise.ChecksumInterval
+	class FChecksumDim : SHADER_PERMUTATION_BOOL("CHECKSUM_OUTPUT");
+	//Hash family, ENoiseHash. Chosen by each consumer through FWhiteNoiseCSParameters::Hash
+	class FHashFunctionDim : SHADER_PERMUTATION_INT("HASH_FUNCTION", (int32)ENoiseHash::Count);
+	//Writes the Sobel normal of the output to OutputNormal in the same dispatch, see FWhiteNoiseCSParameters::NormalTarget. COARSENING 0 only
+	class FFusedNormalDim : SHADER_PERMUTATION_BOOL("FUSED_NORMAL");
+	//Reduces the checksum with wave intrinsics instead of a groupshared tree, CHECKSUM_OUTPUT only
+	class FWaveOpsDim : SHADER_PERMUTATION_BOOL("WAVE_OPS");
+	using FPermutationDomain = TShaderPermutationDomain<FCoarseningDim, FStampSubmissionDim, FChecksumDim, FHashFunctionDim, FFusedNormalDim, FWaveOpsDim>;
+	/// <summary>
+	/// DECLARATION OF THE PARAMETER STRUCTURE
+	/// The parameters must match the parameters in the HLSL code
+	/// For each parameter, provide the C++ type, and the name (Same name used in HLSL code)
+	/// </summary>
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_UAV(RWTexture2D<float>, OutputTexture)
+		SHADER_PARAMETER(FVector2D, Dimensions)
+		SHADER_PARAMETER(UINT, TimeStamp)
+		SHADER_PARAMETER(UINT, Seed)
+		SHADER_PARAMETER_UAV(RWBuffer<uint>, SubmissionStamp)
+		SHADER_PARAMETER(UINT, SubmissionId)
+		SHADER_PARAMETER_UAV(RWBuffer<uint>, OutputChecksum)
+		SHADER_PARAMETER_UAV(RWTexture2D<float4>, OutputNormal)
+		SHADER_PARAMETER(float, NormalStrength)
+	END_SHADER_PARAMETER_STRUCT()
+
+public:
+	//Called by the engine to determine which permutations to compile for this shader
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		//The normals need the tile of one pixel per thread
+		const FPermutationDomain PermutationVector(Parameters.PermutationId);
+		if (PermutationVector.Get<FFusedNormalDim>() && PermutationVector.Get<FCoarseningDim>() != 0)
+		{
+			return false;
+		}
+		if (PermutationVector.Get<FWaveOpsDim>() && (!PermutationVector.Get<FChecksumDim>() || !RHISupportsWaveOperations(Parameters.Platform)))
+		{
+			return false;
+		}
+		//Debug instrumentation, left out of the cooks that disable it
+		if ((PermutationVector.Get<FStampSubmissionDim>() || PermutationVector.Get<FChecksumDim>()) && !AreWhiteNoiseInstrumentationPermutationsEnabled())
+		{
+			return false;
+		}
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	//Modifies the compilations environment of the shader
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+
+		//We're using it here to add some preprocessor defines. That way we don't have to change both C++ and HLSL code when we change the value for NUM_THREADS_PER_GROUP_DIMENSION
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Z"), 1);
+		if (FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>())
+		{
+			OutEnvironment.CompilerFlags.Add(CFLAG_WaveOperations);
+		}
+	}
+
+};
+
+// This will tell the engine to create the shader and where the shader entry point is.
+//                        ShaderType              ShaderPath             Shader function name    Type
+IMPLEMENT_GLOBAL_SHADER(FWhiteNoiseCS, "/CustomShaders/WhiteNoiseCS.usf", "MainComputeShader", SF_Compute);
+
+/// <summary>
+/// Generates several consecutive frames of white noise into the slices of a texture array in one dispatch
+/// </summary>
+class FWhiteNoiseFrameRingCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FWhiteNoiseFrameRingCS);
+	SHADER_USE_PARAMETER_STRUCT(FWhiteNoiseFrameRingCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2DArray<float>, OutputFrames)
+		SHADER_PARAMETER(UINT, FirstTimeStamp)
+		SHADER_PARAMETER(UINT, Seed)
+	END_SHADER_PARAMETER_STRUCT()
+
+public:
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Z"), 1);
+		OutEnvironment.SetDefine(TEXT("COARSENING"), 0);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FWhiteNoiseFrameRingCS, "/CustomShaders/WhiteNoiseCS.usf", "FrameRingComputeShader", SF_Compute);
+
+
+static TAutoConsoleVariable<int32> CVarWhiteNoiseCoarsening(
+	TEXT("CustomShaders.WhiteNoise.Coarsening"),
+	0,
+	TEXT("Number of pixels computed by each thread of the white noise shader. Experimental: 1 and 2 haven't been measured against 0 on a GPU yet,\n")
+	TEXT("compare them with CustomShaders.WhiteNoise.CoarseningBenchmark or ShaderHarness before changing the default.\n")
+	TEXT(" 0: one pixel per thread (default)\n")
+	TEXT(" 1: 2x2 block per thread\n")
+	TEXT(" 2: 4x1 block per thread, meant to reduce the scheduling overhead on large (4K+) targets"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarWhiteNoiseTrackAllocations(
+	TEXT("CustomShaders.WhiteNoise.TrackAllocations"),
+	0,
+	TEXT("Counts the heap allocations of every white noise UpdateResults and logs whenever the count changes.\n")
+	TEXT("The steady state of the plain output is expected to allocate nothing"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarWhiteNoiseMeasureLatency(
+	TEXT("CustomShaders.WhiteNoise.MeasureLatency"),
+	0,
+	TEXT("Measures the latency from UpdateParameters to the white noise output being complete on the GPU.\n")
+	TEXT("The kernel stamps the submission id into a buffer read back asynchronously, CustomShaders.WhiteNoise.LatencyReport logs the histograms"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarWhiteNoiseChecksumInterval(
+	TEXT("CustomShaders.WhiteNoise.ChecksumInterval"),
+	0,
+	TEXT("Checks one white noise frame out of N against the CPU reference: the kernel hashes its output into 8 bytes that are read back asynchronously.\n")
+	TEXT("Mismatches are logged, CustomShaders.WhiteNoise.ChecksumReport logs the counters. 0 disables the checks (default)"),
+	ECVF_RenderThreadSafe);
+
+//Buffers the instrumentation permutations of the white noise kernel write to, nullptr when the instrumentation is off
+struct FWhiteNoiseInstrumentation
+{
+	FRHIUnorderedAccessView* SubmissionStampUAV = nullptr;
+	uint32 SubmissionId = 0;
+	FRHIUnorderedAccessView* OutputChecksumUAV = nullptr;
+};
+
+//Returns the shader permutation to use for the next dispatch
+static FWhiteNoiseCS::FPermutationDomain GetWhiteNoisePermutation(ENoiseHash Hash, bool bFusedNormal,
+																   const FWhiteNoiseInstrumentation& Instrumentation = FWhiteNoiseInstrumentation())
+{
+	FWhiteNoiseCS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FWhiteNoiseCS::FHashFunctionDim>(FMath::Clamp((int32)Hash, 0, (int32)ENoiseHash::Count - 1));
+	PermutationVector.Set<FWhiteNoiseCS::FCoarseningDim>(bFusedNormal ? 0 : FMath::Clamp(CVarWhiteNoiseCoarsening.GetValueOnRenderThread(), 0, 2));
+	PermutationVector.Set<FWhiteNoiseCS::FFusedNormalDim>(bFusedNormal);
+	PermutationVector.Set<FWhiteNoiseCS::FStampSubmissionDim>(Instrumentation.SubmissionStampUAV != nullptr);
+	PermutationVector.Set<FWhiteNoiseCS::FChecksumDim>(Instrumentation.OutputChecksumUAV != nullptr);
+	PermutationVector.Set<FWhiteNoiseCS::FWaveOpsDim>(Instrumentation.OutputChecksumUAV != nullptr && FComputePrimitives::UseWaveOperations());
+	return PermutationVector;
+}
+
+//Number of thread groups needed to cover Size, each thread covering a block of pixels that depends on the coarsening permutation
+static FIntVector GetWhiteNoiseGroupCount(FIntPoint Size, const FWhiteNoiseCS::FPermutationDomain& PermutationVector)
+{
+	int32 BlockX, BlockY;
+	FDispatchSizing::GetWhiteNoiseBlockSize(PermutationVector.Get<FWhiteNoiseCS::FCoarseningDim>(), BlockX, BlockY);
+	const FGroupCount GroupCount = FDispatchSizing::GetGroupCount2D(Size.X, Size.Y, NUM_THREADS_PER_GROUP_DIMENSION, BlockX, BlockY);
+	return FIntVector(GroupCount.X, GroupCount.Y, GroupCount.Z);
+}
+
+//Times the white noise dispatch of every hash with and without the output checksum, and checks one GPU checksum per hash
+//against FWhiteNoiseCPU::Checksum. Render thread only, stalls the GPU
+static void RunChecksumBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations, int32 Interval)
+{
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	const FIntPoint Extent(Size, Size);
+	const uint32 Seed = 1;
+	const uint32 TimeStamp = 1;
+
+	TRefCountPtr<IPooledRenderTarget> Output;
+	GRenderTargetPool.FindFreeElement(RHICmdList, FPooledRenderTargetDesc::Create2DDesc(Extent, PF_R32_FLOAT, FClearValueBinding::None, TexCreate_None,
+									  TexCreate_ShaderResource | TexCreate_UAV, false), Output, TEXT("WhiteNoiseChecksumBenchmarkOutput"));
+	FRWBuffer ChecksumBuffer;
+	ChecksumBuffer.Initialize(sizeof(uint32), 2, PF_R32_UINT, BUF_SourceCopy, TEXT("WhiteNoiseChecksumBenchmarkChecksum"));
+	FRHIGPUBufferReadback ChecksumReadback(TEXT("WhiteNoiseChecksumBenchmarkReadback"));
+
+	//The checked dispatch clears the buffer first, as FOutputChecksumMonitor::BeginDispatch does
+	auto TimeDispatch = [&](ENoiseHash Hash, bool bChecksum, int32 Iterations)
+	{
+		FWhiteNoiseInstrumentation Instrumentation;
+		Instrumentation.OutputChecksumUAV = bChecksum ? ChecksumBuffer.UAV.GetReference() : nullptr;
+		const FWhiteNoiseCS::FPermutationDomain PermutationVector = GetWhiteNoisePermutation(Hash, false, Instrumentation);
+		TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(ShaderMap, PermutationVector);
+		const FIntVector GroupCount = GetWhiteNoiseGroupCount(Extent, PermutationVector);
+		return FComputeBenchmark::TimeGraphs(RHICmdList, Iterations, [&](FRDGBuilder& GraphBuilder)
+		{
+			FWhiteNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseCS::FParameters>();
+			PassParameters->OutputTexture = Output->GetRenderTargetItem().UAV;
+			PassParameters->Dimensions = FVector2D(Extent.X, Extent.Y);
+			PassParameters->TimeStamp = TimeStamp;
+			PassParameters->Seed = Seed;
+			PassParameters->OutputChecksum = Instrumentation.OutputChecksumUAV;
+			FRHIUnorderedAccessView* ChecksumUAV = Instrumentation.OutputChecksumUAV;
+			GraphBuilder.AddPass(RDG_EVENT_NAME("WhiteNoiseChecksumBenchmark"), PassParameters, ERDGPassFlags::Compute,
+				[PassParameters, WhiteNoiseCS, GroupCount, ChecksumUAV](FRHICommandList& RHICmdList)
+				{
+					if (ChecksumUAV)
+					{
+						RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, ChecksumUAV);
+						RHICmdList.ClearUAVUint(ChecksumUAV, FUintVector4(0, 0, 0, 0));
+						RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EComputeToCompute, ChecksumUAV);
+					}
+					FComputeShaderUtils::Dispatch(RHICmdList, WhiteNoiseCS, *PassParameters, GroupCount);
+				});
+		});
+	};
+
+	UE_LOG(LogTemp, Log, TEXT("White noise checksum benchmark: %dx%d, %d iterations, %s reduction, one checked frame in %d"),
+		   Size, Size, NumIterations, FComputePrimitives::UseWaveOperations() ? TEXT("wave") : TEXT("groupshared"), Interval);
+	for (int32 HashIndex = 0; HashIndex < (int32)ENoiseHash::Count; ++HashIndex)
+	{
+		const ENoiseHash Hash = (ENoiseHash)HashIndex;
+
+		//Warm up both permutations, then alternate so clock changes hit both alike
+		TimeDispatch(Hash, false, 1);
+		TimeDispatch(Hash, true, 1);
+		double PlainMilliseconds = 0.0;
+		double CheckedMilliseconds = 0.0;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			PlainMilliseconds += TimeDispatch(Hash, false, 1);
+			CheckedMilliseconds += TimeDispatch(Hash, true, 1);
+		}
+		PlainMilliseconds /= NumIterations;
+		CheckedMilliseconds /= NumIterations;
+
+		//The last checked dispatch left the checksum of one frame in the buffer
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, EResourceTransitionPipeline::EComputeToGfx, ChecksumBuffer.UAV);
+		ChecksumReadback.EnqueueCopy(RHICmdList, ChecksumBuffer.Buffer, 2 * sizeof(uint32));
+		RHICmdList.SubmitCommandsAndFlushGPU();
+		RHICmdList.BlockUntilGPUIdle();
+		const uint32* Halves = (const uint32*)ChecksumReadback.Lock(2 * sizeof(uint32));
+		const uint64 GPUChecksum = ((uint64)Halves[1] << 32) | Halves[0];
+		ChecksumReadback.Unlock();
+		const uint64 CPUChecksum = FWhiteNoiseCPU::Checksum(Extent, Seed, TimeStamp, Hash);
+
+		const double OverheadPercent = PlainMilliseconds > 0.0 ? (CheckedMilliseconds - PlainMilliseconds) / PlainMilliseconds * 100.0 : 0.0;
+		UE_LOG(LogTemp, Log, TEXT("  %-8s plain %.4f ms, checked %.4f ms: %+.2f%% on a checked frame, %+.3f%% on average, checksum %s"),
+			   ANSI_TO_TCHAR(FNoiseMath::GetHashName(Hash)), PlainMilliseconds, CheckedMilliseconds, OverheadPercent, OverheadPercent / Interval,
+			   GPUChecksum == CPUChecksum ? TEXT("matches") : TEXT("MISMATCH"));
+	}
+	ChecksumBuffer.Release();
+}
+
+//Times the white noise dispatch of Hash at every coarsening and checks each output against FWhiteNoiseCPU. Render thread only, stalls the GPU
+static void RunCoarseningBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations, ENoiseHash Hash)
+{
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	const FIntPoint Extent(Size, Size);
+	const uint32 Seed = 1;
+	const uint32 TimeStamp = 1;
+
+	TRefCountPtr<IPooledRenderTarget> Output;
+	GRenderTargetPool.FindFreeElement(RHICmdList, FPooledRenderTargetDesc::Create2DDesc(Extent, PF_R32_FLOAT, FClearValueBinding::None, TexCreate_None,
+									  TexCreate_ShaderResource | TexCreate_UAV, false), Output, TEXT("WhiteNoiseCoarseningBenchmarkOutput"));
+	TArray<float> Reference;
+	FWhiteNoiseCPU::Generate(ENoiseType::White, Extent, Seed, TimeStamp, Reference, Hash);
+
+	auto TimeDispatch = [&](int32 Coarsening, int32 Iterations)
+	{
+		FWhiteNoiseCS::FPermutationDomain PermutationVector = GetWhiteNoisePermutation(Hash, false);
+		PermutationVector.Set<FWhiteNoiseCS::FCoarseningDim>(Coarsening);
+		TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(ShaderMap, PermutationVector);
+		const FIntVector GroupCount = GetWhiteNoiseGroupCount(Extent, PermutationVector);
+		return FComputeBenchmark::TimeGraphs(RHICmdList, Iterations, [&](FRDGBuilder& GraphBuilder)
+		{
+			FWhiteNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseCS::FParameters>();
+			PassParameters->OutputTexture = Output->GetRenderTargetItem().UAV;
+			PassParameters->Dimensions = FVector2D(Extent.X, Extent.Y);
+			PassParameters->TimeStamp = TimeStamp;
+			PassParameters->Seed = Seed;
+			FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("WhiteNoiseCoarseningBenchmark"), WhiteNoiseCS, PassParameters, GroupCount);
+		});
+	};
+
+	UE_LOG(LogTemp, Log, TEXT("White noise coarsening benchmark: %dx%d, %s, %d iterations"), Size, Size, ANSI_TO_TCHAR(FNoiseMath::GetHashName(Hash)), NumIterations);
+	double Milliseconds[3] = {};
+	//Warm up every permutation, then interleave them so clock changes hit all alike
+	for (int32 Coarsening = 0; Coarsening < 3; ++Coarsening)
+	{
+		TimeDispatch(Coarsening, 1);
+	}
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		for (int32 Coarsening = 0; Coarsening < 3; ++Coarsening)
+		{
+			Milliseconds[Coarsening] += TimeDispatch(Coarsening, 1);
+		}
+	}
+
+	for (int32 Coarsening = 0; Coarsening < 3; ++Coarsening)
+	{
+		//The output of the last dispatch of this coarsening
+		TimeDispatch(Coarsening, 1);
+		TArray<float> Texels;
+		FComputeBenchmark::ReadbackFloatTexture(RHICmdList, Output, Texels);
+		int32 NumMismatches = 0;
+		for (int32 Index = 0; Index < Reference.Num() && Index < Texels.Num(); ++Index)
+		{
+			NumMismatches += Texels[Index] != Reference[Index] ? 1 : 0;
+		}
+
+		int32 BlockX, BlockY;
+		FDispatchSizing::GetWhiteNoiseBlockSize(Coarsening, BlockX, BlockY);
+		const double Average = Milliseconds[Coarsening] / NumIterations;
+		UE_LOG(LogTemp, Log, TEXT("  COARSENING %d (%dx%d per thread): %.4f ms, %.2f Gtexels/s, %+.1f%% against 0, %d texels differ from the CPU"),
+			   Coarsening, BlockX, BlockY, Average, Average > 0.0 ? (double)Size * Size / (Average * 1e6) : 0.0,
+			   Milliseconds[0] > 0.0 ? (Milliseconds[Coarsening] / Milliseconds[0] - 1.0) * 100.0 : 0.0, NumMismatches);
+	}
+}
+
+//Largest difference per component between the fused normals and FWhiteNoiseCPU::GenerateNormals. The heights of every hash are exact, hash12
+//included since it is precise, so they are compared bit for bit. What remains is the float rounding of the Sobel slopes and of the normalize
+static const float FusedNormalTolerance = 1e-5f;
+
+//Dispatches the FUSED_NORMAL permutation once and checks the normals and heights it writes against FWhiteNoiseCPU::GenerateNormals.
+//Render thread only, stalls the GPU
+static void RunNormalValidation(FRHICommandListImmediate& RHICmdList, int32 Size, ENoiseHash Hash, float Strength)
+{
+	const FIntPoint Extent(Size, Size);
+	const uint32 Seed = 1;
+	const uint32 TimeStamp = 1;
+	TRefCountPtr<IPooledRenderTarget> Output;
+	TRefCountPtr<IPooledRenderTarget> Normals;
+	GRenderTargetPool.FindFreeElement(RHICmdList, FPooledRenderTargetDesc::Create2DDesc(Extent, PF_R32_FLOAT, FClearValueBinding::None, TexCreate_None,
+									  TexCreate_ShaderResource | TexCreate_UAV, false), Output, TEXT("WhiteNoiseNormalValidationOutput"));
+	GRenderTargetPool.FindFreeElement(RHICmdList, FPooledRenderTargetDesc::Create2DDesc(Extent, PF_A32B32G32R32F, FClearValueBinding::None, TexCreate_None,
+									  TexCreate_ShaderResource | TexCreate_UAV, false), Normals, TEXT("WhiteNoiseNormalValidationNormals"));
+
+	const FWhiteNoiseCS::FPermutationDomain PermutationVector = GetWhiteNoisePermutation(Hash, true);
+	TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+	const FIntVector GroupCount = GetWhiteNoiseGroupCount(Extent, PermutationVector);
+	const double GPUMilliseconds = FComputeBenchmark::TimeGraphs(RHICmdList, 1, [&](FRDGBuilder& GraphBuilder)
+	{
+		FWhiteNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseCS::FParameters>();
+		PassParameters->OutputTexture = Output->GetRenderTargetItem().UAV;
+		PassParameters->Dimensions = FVector2D(Extent.X, Extent.Y);
+		PassParameters->TimeStamp = TimeStamp;
+		PassParameters->Seed = Seed;
+		PassParameters->OutputNormal = Normals->GetRenderTargetItem().UAV;
+		PassParameters->NormalStrength = Strength;
+		FRHIUnorderedAccessView* NormalUAV = PassParameters->OutputNormal;
+		GraphBuilder.AddPass(RDG_EVENT_NAME("WhiteNoiseNormalValidation"), PassParameters, ERDGPassFlags::Compute,
+			[PassParameters, WhiteNoiseCS, GroupCount, NormalUAV](FRHICommandList& RHICmdList)
+			{
+				RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, NormalUAV);
+				FComputeShaderUtils::Dispatch(RHICmdList, WhiteNoiseCS, *PassParameters, GroupCount);
+				RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, EResourceTransitionPipeline::EComputeToGfx, NormalUAV);
+			});
+	});
+
+	TArray<uint8> Texels;
+	FComputeBenchmark::ReadbackTexture(RHICmdList, Normals, Texels);
+	const FVector4* GPUNormals = (const FVector4*)Texels.GetData();
+	TArray<FVector4> CPUNormals;
+	FWhiteNoiseCPU::GenerateNormals(Extent, Seed, TimeStamp, Hash, Strength, CPUNormals);
+	check(Texels.Num() == CPUNormals.Num() * sizeof(FVector4));
+
+	float MaxNormalError = 0.f;
+	float MaxHeightError = 0.f;
+	int32 NumMismatches = 0;
+	int32 NumHeightMismatches = 0;
+	FIntPoint WorstTexel = FIntPoint::ZeroValue;
+	for (int32 Index = 0; Index < CPUNormals.Num(); ++Index)
+	{
+		const FVector4& GPU = GPUNormals[Index];
+		const FVector4& CPU = CPUNormals[Index];
+		const float NormalError = FMath::Max3(FMath::Abs(GPU.X - CPU.X), FMath::Abs(GPU.Y - CPU.Y), FMath::Abs(GPU.Z - CPU.Z));
+		const float HeightError = FMath::Abs(GPU.W - CPU.W);
+		if (NormalError > MaxNormalError)
+		{
+			MaxNormalError = NormalError;
+			WorstTexel = FIntPoint(Index % Size, Index / Size);
+		}
+		MaxHeightError = FMath::Max(MaxHeightError, HeightError);
+		NumMismatches += NormalError > FusedNormalTolerance ? 1 : 0;
+		NumHeightMismatches += GPU.W != CPU.W ? 1 : 0;
+	}
+	UE_LOG(LogTemp, Log, TEXT("Fused normals %dx%d, %s, strength %.2f in %.3f ms: largest normal difference %g at (%d, %d), %d normals above %g, ")
+		   TEXT("largest height difference %g, %d heights not bit exact"),
+		   Size, Size, ANSI_TO_TCHAR(FNoiseMath::GetHashName(Hash)), Strength, GPUMilliseconds, MaxNormalError, WorstTexel.X, WorstTexel.Y,
+		   NumMismatches, FusedNormalTolerance, MaxHeightError, NumHeightMismatches);
+}
+
+static FAutoConsoleCommand ValidateNormalsCommand(
+	TEXT("CustomShaders.WhiteNoise.ValidateNormals"),
+	TEXT("Checks the fused normals of the white noise kernel against FWhiteNoiseCPU::GenerateNormals. Arguments: [Size] [Hash, all by default] [Strength]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1024, 1);
+		const FString HashName = Args.Num() > 1 ? Args[1] : TEXT("all");
+		const float Strength = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 1.f;
+		TArray<ENoiseHash> Hashes;
+		for (int32 HashIndex = 0; HashIndex < (int32)ENoiseHash::Count; ++HashIndex)
+		{
+			if (HashName == TEXT("all") || HashName.Equals(ANSI_TO_TCHAR(FNoiseMath::GetHashName((ENoiseHash)HashIndex)), ESearchCase::IgnoreCase))
+			{
+				Hashes.Add((ENoiseHash)HashIndex);
+			}
+		}
+		if (Hashes.Num() == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Unknown hash %s"), *HashName);
+			return;
+		}
+		ENQUEUE_RENDER_COMMAND(WhiteNoiseValidateNormals)(
+			[Size, Hashes, Strength](FRHICommandListImmediate& RHICmdList)
+			{
+				for (const ENoiseHash Hash : Hashes)
+				{
+					RunNormalValidation(RHICmdList, Size, Hash, Strength);
+				}
+			});
+	}));
+
+static FAutoConsoleCommand ChecksumBenchmarkCommand(
+	TEXT("CustomShaders.WhiteNoise.ChecksumBenchmark"),
+	TEXT("Measures the GPU cost of the output checksum on each hash family. Arguments: [Size] [NumIterations] [Interval, defaults to CustomShaders.WhiteNoise.ChecksumInterval]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2048;
+		const int32 NumIterations = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100, 1);
+		const int32 Interval = FMath::Max(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : CVarWhiteNoiseChecksumInterval.GetValueOnGameThread(), 1);
+		if (!AreWhiteNoiseInstrumentationPermutationsEnabled())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("The checksum permutations aren't compiled, see CustomShaders.WhiteNoise.InstrumentationPermutations"));
+			return;
+		}
+		ENQUEUE_RENDER_COMMAND(WhiteNoiseChecksumBenchmark)(
+			[Size, NumIterations, Interval](FRHICommandListImmediate& RHICmdList)
+			{
+				RunChecksumBenchmark(RHICmdList, Size, NumIterations, Interval);
+			});
+	}));
+
+static FAutoConsoleCommand CoarseningBenchmarkCommand(
+	TEXT("CustomShaders.WhiteNoise.CoarseningBenchmark"),
+	TEXT("Times the white noise dispatch with each CustomShaders.WhiteNoise.Coarsening permutation. Arguments: [Size] [NumIterations] [Hash, hash12 by default]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4096, 1);
+		const int32 NumIterations = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100, 1);
+		const FString HashName = Args.Num() > 2 ? Args[2] : ANSI_TO_TCHAR(FNoiseMath::GetHashName(ENoiseHash::Hash12));
+		int32 HashIndex = 0;
+		while (HashIndex < (int32)ENoiseHash::Count && !HashName.Equals(ANSI_TO_TCHAR(FNoiseMath::GetHashName((ENoiseHash)HashIndex)), ESearchCase::IgnoreCase))
+		{
+			++HashIndex;
+		}
+		if (HashIndex == (int32)ENoiseHash::Count)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Unknown hash %s"), *HashName);
+			return;
+		}
+		const ENoiseHash Hash = (ENoiseHash)HashIndex;
+		ENQUEUE_RENDER_COMMAND(WhiteNoiseCoarseningBenchmark)(
+			[Size, NumIterations, Hash](FRHICommandListImmediate& RHICmdList)
+			{
+				RunCoarseningBenchmark(RHICmdList, Size, NumIterations, Hash);
+			});
+	}));
+
+//Static members
+FWhiteNoiseCSManager* FWhiteNoiseCSManager::instance = nullptr;
+
+static FAutoConsoleCommand CaptureStartCommand(
+	TEXT("CustomShaders.Capture.Start"),
+	TEXT("Writes every generated white noise frame to disk. Arguments: [Directory] [png|exr|raw] [MaxQueuedFrames]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Directory = Args.Num() > 0 ? Args[0] : FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("NoiseCapture"));
+		ENoiseImageFormat Format = ENoiseImageFormat::PNG;
+		if (Args.Num() > 1 && !FNoiseImageWriteQueue::ParseFormat(Args[1], Format))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Unknown capture format %s"), *Args[1]);
+			return;
+		}
+		const int32 MaxQueuedFrames = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 8;
+		FWhiteNoiseCSManager::Get()->BeginCapture(Directory, Format, MaxQueuedFrames);
+	}));
+
+static FAutoConsoleCommand RecordStartCommand(
+	TEXT("CustomShaders.Record.Start"),
+	TEXT("Records the white noise parameter stream for the ParameterReplay commandlet. Arguments: [File]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Path = Args.Num() > 0 ? Args[0] : FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("WhiteNoiseParameters.wnpr"));
+		FWhiteNoiseCSManager::Get()->BeginParameterRecording(Path);
+	}));
+
+static FAutoConsoleCommand RecordStopCommand(
+	TEXT("CustomShaders.Record.Stop"),
+	TEXT("Stops the parameter recording and writes the log"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FWhiteNoiseCSManager::Get()->EndParameterRecording();
+	}));
+
+static FAutoConsoleCommand LatencyReportCommand(
+	TEXT("CustomShaders.WhiteNoise.LatencyReport"),
+	TEXT("Logs the submit to GPU complete latencies measured with CustomShaders.WhiteNoise.MeasureLatency since the last report"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		ENQUEUE_RENDER_COMMAND(WhiteNoiseLatencyReport)
+			(
+				[](FRHICommandListImmediate& RHICmdList)
+				{
+					FWhiteNoiseCSManager::Get()->ReportSubmissionLatency();
+				}
+			);
+	}));
+
+static FAutoConsoleCommand ChecksumReportCommand(
+	TEXT("CustomShaders.WhiteNoise.ChecksumReport"),
+	TEXT("Logs the white noise output checksum matches and mismatches since the last report"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		ENQUEUE_RENDER_COMMAND(WhiteNoiseChecksumReport)
+			(
+				[](FRHICommandListImmediate& RHICmdList)
+				{
+					FWhiteNoiseCSManager::Get()->ReportOutputChecksums();
+				}
+			);
+	}));
+
+static FAutoConsoleCommand CaptureStopCommand(
+	TEXT("CustomShaders.Capture.Stop"),
+	TEXT("Stops the white noise frame capture"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FWhiteNoiseCSManager::Get()->EndCapture();
+	}));
+
+//Begin the execution of the compute shader each frame
+void FWhiteNoiseCSManager::BeginRendering()
+{
+	// //If the handle is already initalized and valid, no need to do anything
+	// if (OnPostResolvedSceneColorHandle.IsValid())
+	// {
+	// 	return;
+	// }
+	// bCachedParamsAreValid = false;
+	// // Get the Renderer Module and add our entry to the callbacks so it can be executed each frame after the scene rendering is done
+	// const FName RendererModuleName("Renderer");
+	// IRendererModule* RendererModule = FModuleManager::GetModulePtr<IRendererModule>(RendererModuleName);
+	// if (RendererModule)
+	// {
+	// 	OnPostResolvedSceneColorHandle = RendererModule->GetResolvedSceneColorCallbacks().AddRaw(this, &FWhiteNoiseCSManager::Execute_Graph);
+	// }
+	// check(IsInGameThread());
+	if (ParameterRecorder.IsValid())
+	{
+		ParameterRecorder->RecordEvent(EParameterRecordType::BeginRendering);
+	}
+	if (CVarWhiteNoiseTrackAllocations.GetValueOnGameThread() != 0)
+	{
+		FAllocationTracker::Install();
+	}
+	ENQUEUE_RENDER_COMMAND(CaptureCommand)
+		(
+			[](FRHICommandListImmediate& RHICmdList)
+			{
+				FWhiteNoiseCSManager::Get()->UpdateResults(RHICmdList);
+			}
+		);
+	
+}
+
+//Stop the compute shader execution
+void FWhiteNoiseCSManager::EndRendering()
+{
+	if (ParameterRecorder.IsValid())
+	{
+		ParameterRecorder->RecordEvent(EParameterRecordType::EndRendering);
+	}
+
+	// // If the handle is not valid then there's no cleanup to do
+	// if (!OnPostResolvedSceneColorHandle.IsValid())
+	// {
+	// 	return;
+	// }
+
+	// //Get the Renderer Module and remove our entry from the ResolvedSceneColorCallbacks
+	// const FName RendererModuleName("Renderer");
+	// IRendererModule* RendererModule = FModuleManager::GetModulePtr<IRendererModule>(RendererModuleName);
+	// if (RendererModule)
+	// {
+	// 	RendererModule->GetResolvedSceneColorCallbacks().Remove(OnPostResolvedSceneColorHandle);
+	// }
+
+	// OnPostResolvedSceneColorHandle.Reset();
+}
+
+//Update the parameters by a providing an instance of the Parameters structure used by the shader manager
+void FWhiteNoiseCSManager::UpdateParameters(FWhiteNoiseCSParameters& params)
+{
+	if (ParameterRecorder.IsValid())
+	{
+		ParameterRecorder->RecordParameters(params);
+	}
+	if (AreWhiteNoiseInstrumentationPermutationsEnabled() && CVarWhiteNoiseMeasureLatency.GetValueOnGameThread() != 0)
+	{
+		cachedSubmission.Id = ++NumSubmissions;
+		cachedSubmission.Frame = GFrameNumber;
+		cachedSubmission.Cycles = FPlatformTime::Cycles64();
+	}
+	cachedParams = params;
+	bCachedParamsAreValid = true;
+}
+
+
+void FWhiteNoiseCSManager::AddWhiteNoisePass(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap,
+											 TRefCountPtr<IPooledRenderTarget> OutputUAV, FRDGTextureUAVRef DstTexture)
+{
+	const FWhiteNoiseCS::FPermutationDomain PermutationVector = GetWhiteNoisePermutation(cachedParams.Hash, false);
+    TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(ShaderMap, PermutationVector);
+    FWhiteNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseCS::FParameters>();
+
+	PassParameters->OutputTexture = OutputUAV->GetRenderTargetItem().UAV;
+	PassParameters->Dimensions = FVector2D(cachedParams.GetRenderTargetSize().X, cachedParams.GetRenderTargetSize().Y);
+	PassParameters->TimeStamp = cachedParams.TimeStamp;
+	PassParameters->Seed = cachedParams.Seed;
+
+    FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("ComputeWhiteNoise"), WhiteNoiseCS, PassParameters,
+                                 GetWhiteNoiseGroupCount(cachedParams.GetRenderTargetSize(), PermutationVector));
+}
+
+
+void FWhiteNoiseCSManager::UpdateResults(FRHICommandListImmediate& RHICmdList)
+{
+	if (bCachedParamsAreValid && cachedParams.GetFrameRing())
+	{
+		UpdateFrameRing(RHICmdList);
+		return;
+	}
+
+	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
+	{
+		return;
+	}
+
+	//Render Thread Assertion
+	check(IsInRenderingThread());
+	const bool bTrackAllocations = CVarWhiteNoiseTrackAllocations.GetValueOnRenderThread() != 0 && FAllocationTracker::IsInstalled();
+	TOptional<FScopedAllocationCount> AllocationCount;
+	if (bTrackAllocations)
+	{
+		AllocationCount.Emplace();
+	}
+
+	//The graph is only needed for the passes that read the output back on the GPU or the CPU
+	FTextureResource* CompressedResource = cachedParams.CompressedTexture ? cachedParams.CompressedTexture->Resource : nullptr;
+	FTextureRenderTargetResource* DistanceFieldResource = cachedParams.DistanceFieldTarget ? cachedParams.DistanceFieldTarget->GetRenderTargetResource() : nullptr;
+	//Latency instrumentation, the dispatch stamps the submission into a buffer that is read back once the GPU is done with it
+	FWhiteNoiseInstrumentation Instrumentation;
+	const bool bInstrumentationPermutations = AreWhiteNoiseInstrumentationPermutationsEnabled();
+	if (bInstrumentationPermutations && CVarWhiteNoiseMeasureLatency.GetValueOnRenderThread() != 0)
+	{
+		if (!SubmissionLatency.IsValid())
+		{
+			SubmissionLatency = MakeUnique<FSubmissionLatencyMonitor>();
+		}
+		Instrumentation.SubmissionStampUAV = SubmissionLatency->BeginDispatch(RHICmdList);
+		Instrumentation.SubmissionId = cachedSubmission.Id;
+	}
+
+	//Integrity checks, one frame out of ChecksumInterval hashes its output for the comparison with the CPU
+	const int32 ChecksumInterval = CVarWhiteNoiseChecksumInterval.GetValueOnRenderThread();
+	if (bInstrumentationPermutations && ChecksumInterval > 0 && ++NumFramesSinceChecksum >= uint32(ChecksumInterval))
+	{
+		if (!OutputChecksum.IsValid())
+		{
+			OutputChecksum = MakeUnique<FOutputChecksumMonitor>();
+		}
+		Instrumentation.OutputChecksumUAV = OutputChecksum->BeginDispatch(RHICmdList);
+		NumFramesSinceChecksum = 0;
+	}
+
+	//Normals are written by the same dispatch, either path. Compressing them needs the graph
+	FRHIUnorderedAccessView* NormalUAV = BeginNormalOutput(RHICmdList);
+	const bool bCompressNormals = NormalUAV && cachedParams.CompressedNormalTexture && cachedParams.CompressedNormalTexture->Resource;
+	if (CompressedResource || DistanceFieldResource || bCompressNormals || RenderThreadCapture.IsValid())
+	{
+		UpdateResults_Graph(RHICmdList, Instrumentation, NormalUAV);
+	}
+	else
+	{
+		UpdateResults_Direct(RHICmdList, Instrumentation, NormalUAV);
+	}
+	if (NormalUAV)
+	{
+		EndNormalOutput(RHICmdList);
+	}
+
+	if (Instrumentation.SubmissionStampUAV)
+	{
+		SubmissionLatency->EndDispatch(RHICmdList, cachedSubmission);
+	}
+	if (Instrumentation.OutputChecksumUAV)
+	{
+		OutputChecksum->EndDispatch(RHICmdList, cachedParams.GetRenderTargetSize(), cachedParams.Seed, cachedParams.TimeStamp, cachedParams.Hash);
+	}
+
+	if (AllocationCount.IsSet())
+	{
+		const FAllocationCount FrameAllocations = AllocationCount->Get();
+		AllocationCount.Reset();
+		if (FrameAllocations.NumAllocations != LastFrameAllocations.NumAllocations || FrameAllocations.NumBytes != LastFrameAllocations.NumBytes)
+		{
+			UE_LOG(LogTemp, Log, TEXT("White noise UpdateResults: %llu allocations, %llu bytes (frame %u)"),
+				   FrameAllocations.NumAllocations, FrameAllocations.NumBytes, cachedParams.TimeStamp);
+		}
+		LastFrameAllocations = FrameAllocations;
+	}
+}
+
+void FWhiteNoiseCSManager::UpdateResults_Direct(FRHICommandListImmediate& RHICmdList, const FWhiteNoiseInstrumentation& Instrumentation, FRHIUnorderedAccessView* NormalUAV)
+{
+	FTextureRenderTargetResource* RenderTargetResource = cachedParams.RenderTarget->GetRenderTargetResource();
+	if (!RenderTargetResource || !RenderTargetResource->TextureRHI.IsValid())
+	{
+		return;
+	}
+
+	//Only look the output up again when the client changed the target, the pool would otherwise be searched every frame
+	const FIntPoint Size = cachedParams.GetRenderTargetSize();
+	const EPixelFormat Format = RenderTargetResource->TextureRHI->GetFormat();
+	if (!ComputeShaderOutput.IsValid() || ComputeShaderOutput->GetDesc().Extent != Size || ComputeShaderOutput->GetDesc().Format != Format)
+	{
+		FPooledRenderTargetDesc ComputeShaderOutputDesc(FPooledRenderTargetDesc::Create2DDesc(Size, Format, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false));
+		ComputeShaderOutputDesc.DebugName = TEXT("WhiteNoiseCS_Output_RenderTarget");
+		ComputeShaderOutput.SafeRelease();
+		GRenderTargetPool.FindFreeElement(RHICmdList, ComputeShaderOutputDesc, ComputeShaderOutput, TEXT("WhiteNoiseCS_Output_RenderTarget"));
+	}
+
+	const FSceneRenderTargetItem& Output = ComputeShaderOutput->GetRenderTargetItem();
+	RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, Output.UAV);
+
+	//The parameters live on the stack, a graph would allocate them and its passes every frame
+	FWhiteNoiseCS::FParameters PassParameters;
+	PassParameters.OutputTexture = Output.UAV;
+	PassParameters.Dimensions = FVector2D(Size.X, Size.Y);
+	PassParameters.TimeStamp = cachedParams.TimeStamp;
+	PassParameters.Seed = cachedParams.Seed;
+	PassParameters.SubmissionStamp = Instrumentation.SubmissionStampUAV;
+	PassParameters.SubmissionId = Instrumentation.SubmissionId;
+	PassParameters.OutputChecksum = Instrumentation.OutputChecksumUAV;
+	PassParameters.OutputNormal = NormalUAV;
+	PassParameters.NormalStrength = cachedParams.NormalStrength;
+
+	const FWhiteNoiseCS::FPermutationDomain PermutationVector = GetWhiteNoisePermutation(cachedParams.Hash, NormalUAV != nullptr, Instrumentation);
+	TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+	FComputeShaderUtils::Dispatch(RHICmdList, WhiteNoiseCS, PassParameters, GetWhiteNoiseGroupCount(Size, PermutationVector));
+
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, EResourceTransitionPipeline::EComputeToGfx, Output.UAV);
+	RHICmdList.CopyTexture(Output.ShaderResourceTexture, RenderTargetResource->TextureRHI, FRHICopyTextureInfo());
+}
+
+void FWhiteNoiseCSManager::UpdateResults_Graph(FRHICommandListImmediate& RHICmdList, const FWhiteNoiseInstrumentation& Instrumentation, FRHIUnorderedAccessView* NormalUAV)
+{
+	const ERHIFeatureLevel::Type FeatureLevel = GMaxRHIFeatureLevel;
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(FeatureLevel);
+    FTexture2DRHIRef OutTexture = cachedParams.RenderTarget->GetRenderTargetResource()->GetRenderTargetTexture();
+	FPooledRenderTargetDesc TexDesc = FPooledRenderTargetDesc::Create2DDesc(cachedParams.GetRenderTargetSize(),
+															cachedParams.RenderTarget->GetRenderTargetResource()->TextureRHI->GetFormat(),
+															FClearValueBinding::None, TexCreate_None,
+															TexCreate_ShaderResource | TexCreate_UAV, false);
+    // FRDGTextureDesc TexDesc = FRDGTextureDesc::Create2DDesc(FluidSurfaceSize, PF_G32R32F, FClearValueBinding(FLinearColor::Black), TexCreate_None, TexCreate_UAV | TexCreate_ShaderResource, false);
+    TRefCountPtr<IPooledRenderTarget> PooledDivergenceField;
+    GRenderTargetPool.FindFreeElement(RHICmdList, TexDesc, PooledDivergenceField, TEXT("DivergenceField"));
+    FRDGBuilder GraphBuilder(RHICmdList);
+	FRDGTextureRef DivergenceField = GraphBuilder.RegisterExternalTexture(PooledDivergenceField, TEXT("DivergenceField"),
+																		  ERenderTargetTexture::ShaderResource, ERDGTextureFlags::MultiFrame);
+	FRDGTextureUAVRef DivergenceFieldUAV = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(DivergenceField));
+
+	const FWhiteNoiseCS::FPermutationDomain PermutationVector = GetWhiteNoisePermutation(cachedParams.Hash, NormalUAV != nullptr, Instrumentation);
+    TShaderMapRef<FWhiteNoiseCS> WhiteNoiseCS(ShaderMap, PermutationVector);
+    FWhiteNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseCS::FParameters>();
+
+	PassParameters->OutputTexture = PooledDivergenceField->GetRenderTargetItem().UAV;
+	PassParameters->Dimensions = FVector2D(cachedParams.GetRenderTargetSize().X, cachedParams.GetRenderTargetSize().Y);
+	PassParameters->TimeStamp = cachedParams.TimeStamp;
+	PassParameters->Seed = cachedParams.Seed;
+	PassParameters->SubmissionStamp = Instrumentation.SubmissionStampUAV;
+	PassParameters->SubmissionId = Instrumentation.SubmissionId;
+	PassParameters->OutputChecksum = Instrumentation.OutputChecksumUAV;
+	PassParameters->OutputNormal = NormalUAV;
+	PassParameters->NormalStrength = cachedParams.NormalStrength;
+
+	FIntVector ThreadGroupCount = GetWhiteNoiseGroupCount(cachedParams.GetRenderTargetSize(), PermutationVector);
+
+	GraphBuilder.AddPass(RDG_EVENT_NAME("ComputeWhiteNoise"),
+			PassParameters,
+			ERDGPassFlags::Compute,
+			[PassParameters, WhiteNoiseCS, ThreadGroupCount](FRHICommandList &RHICmdList) {
+				FComputeShaderUtils::Dispatch(RHICmdList, WhiteNoiseCS, *PassParameters, ThreadGroupCount);
+			});
+
+	// AddWhiteNoisePass(GraphBuilder, ShaderMap, PooledDivergenceField, DivergenceFieldUAV);
+
+	//Block compress the output for consumers that sample the BC4 copy instead of the float render target
+	TRefCountPtr<IPooledRenderTarget> PooledCompressedBlocks;
+	FTextureResource* CompressedResource = cachedParams.CompressedTexture ? cachedParams.CompressedTexture->Resource : nullptr;
+	if (CompressedResource && CompressedResource->TextureRHI.IsValid())
+	{
+		FRDGTextureRef CompressedBlocks = AddBlockCompressPass(GraphBuilder, ShaderMap, DivergenceField, cachedParams.GetRenderTargetSize(), false);
+		GraphBuilder.QueueTextureExtraction(CompressedBlocks, &PooledCompressedBlocks);
+	}
+
+	//BC5 normal map of the normals the noise pass wrote
+	TRefCountPtr<IPooledRenderTarget> PooledCompressedNormals;
+	FTextureResource* CompressedNormalResource = cachedParams.CompressedNormalTexture ? cachedParams.CompressedNormalTexture->Resource : nullptr;
+	if (NormalUAV && CompressedNormalResource && CompressedNormalResource->TextureRHI.IsValid())
+	{
+		FRDGTextureRef Normals = GraphBuilder.RegisterExternalTexture(NormalOutput, TEXT("WhiteNoiseNormals"));
+		FRDGTextureRef CompressedNormals = AddBlockCompressPass(GraphBuilder, ShaderMap, Normals, cachedParams.GetRenderTargetSize(), true,
+																FVector2D(0.5f, 0.5f), FVector2D(0.5f, 0.5f));
+		GraphBuilder.QueueTextureExtraction(CompressedNormals, &PooledCompressedNormals);
+	}
+
+	//Distance field of the thresholded output, flooded in the same graph as the noise
+	TRefCountPtr<IPooledRenderTarget> PooledDistanceField;
+	FTextureRenderTargetResource* DistanceFieldResource = cachedParams.DistanceFieldTarget ? cachedParams.DistanceFieldTarget->GetRenderTargetResource() : nullptr;
+	if (DistanceFieldResource && DistanceFieldResource->TextureRHI.IsValid())
+	{
+		FRDGTextureRef DistanceField = FJumpFloodCompute::AddSignedDistanceField(GraphBuilder, ShaderMap, DivergenceField, cachedParams.DistanceFieldThreshold);
+		GraphBuilder.QueueTextureExtraction(DistanceField, &PooledDistanceField);
+	}
+
+	GraphBuilder.QueueTextureExtraction(DivergenceField, &PooledDivergenceField);
+    GraphBuilder.Execute();
+	RHICmdList.CopyTexture(PooledDivergenceField->GetRenderTargetItem().ShaderResourceTexture,  OutTexture->GetTexture2D(), FRHICopyTextureInfo());
+
+	if (PooledCompressedBlocks.IsValid())
+	{
+		//Each uint2 texel of the blocks texture is bit compatible with one BC4 block
+		FRHICopyTextureInfo CopyInfo;
+		CopyInfo.Size = FIntVector(PooledCompressedBlocks->GetDesc().Extent.X, PooledCompressedBlocks->GetDesc().Extent.Y, 1);
+		RHICmdList.CopyTexture(PooledCompressedBlocks->GetRenderTargetItem().ShaderResourceTexture, CompressedResource->TextureRHI, CopyInfo);
+	}
+
+	if (PooledCompressedNormals.IsValid())
+	{
+		//Each uint4 texel is bit compatible with one BC5 block
+		FRHICopyTextureInfo CopyInfo;
+		CopyInfo.Size = FIntVector(PooledCompressedNormals->GetDesc().Extent.X, PooledCompressedNormals->GetDesc().Extent.Y, 1);
+		RHICmdList.CopyTexture(PooledCompressedNormals->GetRenderTargetItem().ShaderResourceTexture, CompressedNormalResource->TextureRHI, CopyInfo);
+	}
+
+	if (PooledDistanceField.IsValid())
+	{
+		RHICmdList.CopyTexture(PooledDistanceField->GetRenderTargetItem().ShaderResourceTexture, DistanceFieldResource->GetRenderTargetTexture(), FRHICopyTextureInfo());
+	}
+
+	if (RenderThreadCapture.IsValid())
+	{
+		RenderThreadCapture->CaptureFrame(RHICmdList, PooledDivergenceField->GetRenderTargetItem().ShaderResourceTexture, cachedParams.GetRenderTargetSize(), cachedParams.TimeStamp);
+	}
+}
+
+bool FWhiteNoiseCSManager::WritesNormals() const
+{
+	FTextureRenderTargetResource* NormalResource = cachedParams.NormalTarget ? cachedParams.NormalTarget->GetRenderTargetResource() : nullptr;
+	return NormalResource && NormalResource->TextureRHI.IsValid() && NormalResource->GetSizeXY() == cachedParams.GetRenderTargetSize();
+}
+
+FRHIUnorderedAccessView* FWhiteNoiseCSManager::BeginNormalOutput(FRHICommandListImmediate& RHICmdList)
+{
+	if (!WritesNormals())
+	{
+		return nullptr;
+	}
+
+	const FIntPoint Size = cachedParams.GetRenderTargetSize();
+	const EPixelFormat Format = cachedParams.NormalTarget->GetRenderTargetResource()->TextureRHI->GetFormat();
+	if (!NormalOutput.IsValid() || NormalOutput->GetDesc().Extent != Size || NormalOutput->GetDesc().Format != Format)
+	{
+		FPooledRenderTargetDesc NormalOutputDesc(FPooledRenderTargetDesc::Create2DDesc(Size, Format, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false));
+		NormalOutputDesc.DebugName = TEXT("WhiteNoiseCS_Normal_RenderTarget");
+		NormalOutput.SafeRelease();
+		GRenderTargetPool.FindFreeElement(RHICmdList, NormalOutputDesc, NormalOutput, TEXT("WhiteNoiseCS_Normal_RenderTarget"));
+	}
+
+	FRHIUnorderedAccessView* NormalUAV = NormalOutput->GetRenderTargetItem().UAV;
+	RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, NormalUAV);
+	return NormalUAV;
+}
+
+void FWhiteNoiseCSManager::EndNormalOutput(FRHICommandListImmediate& RHICmdList)
+{
+	const FSceneRenderTargetItem& Normals = NormalOutput->GetRenderTargetItem();
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, EResourceTransitionPipeline::EComputeToGfx, Normals.UAV);
+	RHICmdList.CopyTexture(Normals.ShaderResourceTexture, cachedParams.NormalTarget->GetRenderTargetResource()->TextureRHI, FRHICopyTextureInfo());
+}
+
+void FWhiteNoiseCSManager::UpdateFrameRing(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+	FTextureResource* FrameRingResource = cachedParams.GetFrameRing()->Resource;
+	if (!FrameRingResource || !FrameRingResource->TextureRHI.IsValid())
+	{
+		return;
+	}
+
+	//Steady state: the ring is up to date, consumers only rotate the slice they sample
+	const FIntVector RingSize = cachedParams.GetFrameRingSize();
+	if (FrameRingTexture == FrameRingResource->TextureRHI && FrameRingGeneratedSize == RingSize && FrameRingGeneratedSeed == cachedParams.Seed)
+	{
+		return;
+	}
+
+	FRDGBuilder GraphBuilder(RHICmdList);
+	FRDGTextureDesc FramesDesc = FRDGTextureDesc::Create2DDesc(FIntPoint(RingSize.X, RingSize.Y), FrameRingResource->TextureRHI->GetFormat(),
+															   FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+	FramesDesc.ArraySize = RingSize.Z;
+	FramesDesc.bIsArray = true;
+	FRDGTextureRef Frames = GraphBuilder.CreateTexture(FramesDesc, TEXT("WhiteNoiseFrameRing"));
+
+	TShaderMapRef<FWhiteNoiseFrameRingCS> FrameRingCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+	FWhiteNoiseFrameRingCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FWhiteNoiseFrameRingCS::FParameters>();
+	PassParameters->OutputFrames = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Frames));
+	PassParameters->FirstTimeStamp = FParameterPacking::FrameRingFirstTimeStamp;
+	PassParameters->Seed = cachedParams.Seed;
+
+	FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("ComputeWhiteNoiseFrameRing %d frames", RingSize.Z), FrameRingCS, PassParameters,
+								 FIntVector(FMath::DivideAndRoundUp(RingSize.X, NUM_THREADS_PER_GROUP_DIMENSION),
+											FMath::DivideAndRoundUp(RingSize.Y, NUM_THREADS_PER_GROUP_DIMENSION), RingSize.Z));
+
+	TRefCountPtr<IPooledRenderTarget> PooledFrames;
+	GraphBuilder.QueueTextureExtraction(Frames, &PooledFrames);
+	GraphBuilder.Execute();
+
+	FRHICopyTextureInfo CopyInfo;
+	CopyInfo.NumSlices = RingSize.Z;
+	RHICmdList.CopyTexture(PooledFrames->GetRenderTargetItem().ShaderResourceTexture, FrameRingResource->TextureRHI, CopyInfo);
+
+	FrameRingTexture = FrameRingResource->TextureRHI;
+	FrameRingGeneratedSize = RingSize;
+	FrameRingGeneratedSeed = cachedParams.Seed;
+}
+
+void FWhiteNoiseCSManager::BeginCapture(const FString& Directory, ENoiseImageFormat Format, int32 MaxQueuedFrames)
+{
+	check(IsInGameThread());
+	EndCapture();
+
+	GameThreadCapture = MakeShared<FNoiseFrameCapture, ESPMode::ThreadSafe>(Directory, Format, MaxQueuedFrames);
+	ENQUEUE_RENDER_COMMAND(BeginNoiseCapture)
+		(
+			[Capture = GameThreadCapture](FRHICommandListImmediate& RHICmdList)
+			{
+				FWhiteNoiseCSManager::Get()->RenderThreadCapture = Capture;
+			}
+		);
+}
+
+void FWhiteNoiseCSManager::EndCapture()
+{
+	check(IsInGameThread());
+	if (!GameThreadCapture.IsValid())
+	{
+		return;
+	}
+
+	//The render thread drops the last reference, the capture then finishes its writes on the thread pool
+	GameThreadCapture.Reset();
+	ENQUEUE_RENDER_COMMAND(EndNoiseCapture)
+		(
+			[](FRHICommandListImmediate& RHICmdList)
+			{
+				FWhiteNoiseCSManager* Manager = FWhiteNoiseCSManager::Get();
+				if (Manager->RenderThreadCapture.IsValid())
+				{
+					Manager->RenderThreadCapture->ReleaseReadbacks();
+					Manager->RenderThreadCapture.Reset();
+				}
+			}
+		);
+}
+
+void FWhiteNoiseCSManager::BeginParameterRecording(const FString& Path)
+{
+	check(IsInGameThread());
+	EndParameterRecording();
+	ParameterRecorder = MakeUnique<FParameterRecorder>(Path);
+}
+
+void FWhiteNoiseCSManager::EndParameterRecording()
+{
+	check(IsInGameThread());
+	if (!ParameterRecorder.IsValid())
+	{
+		return;
+	}
+
+	if (ParameterRecorder->Save())
+	{
+		UE_LOG(LogTemp, Log, TEXT("Parameter recording written to %s: %d events"), *ParameterRecorder->GetPath(), ParameterRecorder->GetNumRecords());
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not write the parameter recording %s"), *ParameterRecorder->GetPath());
+	}
+	ParameterRecorder.Reset();
+}
+
+int32 FWhiteNoiseCSManager::GetNumCapturedFrames() const
+{
+	return GameThreadCapture.IsValid() ? GameThreadCapture->GetNumCapturedFrames() : 0;
+}
+
+int32 FWhiteNoiseCSManager::GetNumDroppedFrames() const
+{
+	return GameThreadCapture.IsValid() ? GameThreadCapture->GetNumDroppedFrames() : 0;
+}
+
+double FWhiteNoiseCSManager::MeasureUpdateResults(FRHICommandListImmediate& RHICmdList, int32 NumCalls, FAllocationCount* OutAllocations)
+{
+	check(IsInRenderingThread());
+	FScopedAllocationCount AllocationCount;
+	const double Start = FPlatformTime::Seconds();
+	for (int32 Call = 0; Call < NumCalls; ++Call)
+	{
+		UpdateResults(RHICmdList);
+	}
+	const double Seconds = FPlatformTime::Seconds() - Start;
+	if (OutAllocations)
+	{
+		*OutAllocations = AllocationCount.Get();
+	}
+	return Seconds;
+}
+
+double FWhiteNoiseCSManager::MeasurePoolLookups(FRHICommandListImmediate& RHICmdList, int32 NumCalls)
+{
+	check(IsInRenderingThread());
+	//Same description as the UpdateResults output, every lookup after the first one finds the element the previous one released
+	const FPooledRenderTargetDesc TexDesc = FPooledRenderTargetDesc::Create2DDesc(FIntPoint::ComponentMax(cachedParams.GetRenderTargetSize(), FIntPoint(1, 1)),
+																				  PF_A32B32G32R32F, FClearValueBinding::None, TexCreate_None,
+																				  TexCreate_ShaderResource | TexCreate_UAV, false);
+	const double Start = FPlatformTime::Seconds();
+	for (int32 Call = 0; Call < NumCalls; ++Call)
+	{
+		TRefCountPtr<IPooledRenderTarget> PooledOutput;
+		GRenderTargetPool.FindFreeElement(RHICmdList, TexDesc, PooledOutput, TEXT("WhiteNoiseOverhead"));
+	}
+	return FPlatformTime::Seconds() - Start;
+}
+
+void FWhiteNoiseCSManager::ReportSubmissionLatency()
+{
+	check(IsInRenderingThread());
+	if (!SubmissionLatency.IsValid())
+	{
+		UE_LOG(LogTemp, Log, TEXT("No white noise latency measured, set CustomShaders.WhiteNoise.MeasureLatency 1 first"));
+		return;
+	}
+	SubmissionLatency->Report();
+}
+
+void FWhiteNoiseCSManager::ReportOutputChecksums()
+{
+	check(IsInRenderingThread());
+	if (!OutputChecksum.IsValid())
+	{
+		UE_LOG(LogTemp, Log, TEXT("No white noise checksum computed, set CustomShaders.WhiteNoise.ChecksumInterval first"));
+		return;
+	}
+	OutputChecksum->Report();
+}
+
+bool FWhiteNoiseCSManager::HasCompiledShaders() const
+{
+	check(IsInRenderingThread());
+	const FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	return ShaderMap && ShaderMap->HasShader(&FWhiteNoiseCS::StaticType, GetWhiteNoisePermutation(cachedParams.Hash, WritesNormals()).ToDimensionValueId());
+}
+
+void FWhiteNoiseCSManager::Execute_Graph(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext)
+{
+	//If there's no cached parameters to use, skip
+	//If no Render Target is supplied in the cachedParams, skip
+	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
+	{
+		return;
+	}
+
+	//Render Thread Assertion
+	check(IsInRenderingThread());
+	FWhiteNoiseCSManager::Get()->UpdateResults(RHICmdList);
+}
+
+
+/// <summary>
+/// Creates an instance of the shader type parameters structure and fills it using the cached shader manager parameter structure
+/// Gets a reference to the shader type from the global shaders map
+/// Dispatches the shader using the parameter structure instance
+/// </summary>
+void FWhiteNoiseCSManager::Execute_RenderThread(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext)
+{
+	//If there's no cached parameters to use, skip
+	//If no Render Target is supplied in the cachedParams, skip
+	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
+	{
+		return;
+	}
+
+	//Render Thread Assertion
+	check(IsInRenderingThread());
+
+	//Same dispatch as the steady state of UpdateResults, the output is only taken from the render target pool when the target changes
+	FRHIUnorderedAccessView* NormalUAV = BeginNormalOutput(RHICmdList);
+	UpdateResults_Direct(RHICmdList, FWhiteNoiseInstrumentation(), NormalUAV);
+	if (NormalUAV)
+	{
+		EndNormalOutput(RHICmdList);
+	}
+}
@@ -1,84 +1,206 @@
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GlobalShader.h"
-#include "ShaderParameterStruct.h"
-#include "RenderGraphUtils.h"
-#include "RenderTargetPool.h"
-#include "Runtime/Engine/Classes/Engine/TextureRenderTarget2D.h"
-
-//This struct act as a container for all the parameters that the client needs to pass to the Compute Shader Manager.
-struct  FWhiteNoiseCSParameters
-{
-	UTextureRenderTarget2D* RenderTarget;
-
-
-	FIntPoint GetRenderTargetSize() const
-	{
-		return CachedRenderTargetSize;
-	}
-
-	FWhiteNoiseCSParameters() { }
-	FWhiteNoiseCSParameters(UTextureRenderTarget2D* IORenderTarget)
-		: RenderTarget(IORenderTarget)
-	{
-		CachedRenderTargetSize = RenderTarget ? FIntPoint(RenderTarget->SizeX, RenderTarget->SizeY) : FIntPoint::ZeroValue;
-	}
-
-private:
-	FIntPoint CachedRenderTargetSize;
-public:
-	uint32 TimeStamp;
-};
-
-
-/// <summary>
-/// A singleton Shader Manager for our Shader Type
-/// </summary>
-class CUSTOMSHADERSDECLARATIONS_API FWhiteNoiseCSManager
-{
-public:
-	//Get the instance
-	static FWhiteNoiseCSManager* Get()
-	{
-		if (!instance)
-			instance = new FWhiteNoiseCSManager();
-		return instance;
-	};
-
-	// Call this when you want to hook onto the renderer and start executing the compute shader. The shader will be dispatched once per frame.
-	void BeginRendering();
-
-	// Stops compute shader execution
-	void EndRendering();
-
-	// Call this whenever you have new parameters to share.
-	void UpdateParameters(FWhiteNoiseCSParameters& DrawParameters);
-
-	void UpdateResults(FRHICommandListImmediate& RHICmdList);
-	
-	void AddWhiteNoisePass(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap,
-						   TRefCountPtr<IPooledRenderTarget> OutputUAV, FRDGTextureUAVRef DstTexture);
-	
-private:
-	//Private constructor to prevent client from instanciating
-	FWhiteNoiseCSManager() = default;
-
-	//The singleton instance
-	static FWhiteNoiseCSManager* instance;
-
-	//The delegate handle to our function that will be executed each frame by the renderer
-	FDelegateHandle OnPostResolvedSceneColorHandle;
-
-	//Cached Shader Manager Parameters
-	FWhiteNoiseCSParameters cachedParams;
-
-	//Whether we have cached parameters to pass to the shader or not
-	volatile bool bCachedParamsAreValid;
-
-	//Reference to a pooled render target where the shader will write its output
-	TRefCountPtr<IPooledRenderTarget> ComputeShaderOutput;
-public:
-	void Execute_RenderThread(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext);
-	void Execute_Graph(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext);
-};
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+#include "Runtime/Engine/Classes/Engine/TextureRenderTarget2D.h"
+#include "Runtime/Engine/Classes/Engine/TextureRenderTarget2DArray.h"
+#include "NoiseImageWriter.h"
+#include "AllocationTracker.h"
+#include "ParameterRecording.h"
+#include "SubmissionLatency.h"
+#include "OutputChecksum.h"
+#include "Core/ParameterPacking.h"
+#include "Core/NoiseMath.h"
+
+class FNoiseFrameCapture;
+struct FWhiteNoiseInstrumentation;
+
+//This struct act as a container for all the parameters that the client needs to pass to the Compute Shader Manager.
+struct  FWhiteNoiseCSParameters
+{
+	UTextureRenderTarget2D* RenderTarget;
+
+
+	FIntPoint GetRenderTargetSize() const
+	{
+		return CachedRenderTargetSize;
+	}
+
+	FWhiteNoiseCSParameters() { }
+	FWhiteNoiseCSParameters(UTextureRenderTarget2D* IORenderTarget)
+		: RenderTarget(IORenderTarget)
+	{
+		CachedRenderTargetSize = RenderTarget ? FIntPoint(RenderTarget->SizeX, RenderTarget->SizeY) : FIntPoint::ZeroValue;
+	}
+
+private:
+	FIntPoint CachedRenderTargetSize;
+public:
+	uint32 TimeStamp;
+	//Offsets the noise lattice, outputs for different seeds are uncorrelated
+	uint32 Seed = 0;
+	//Hash family of the kernel, the cheapest one that meets the consumer's quality bar (see the NoiseQuality tool). The frame ring always uses hash12
+	ENoiseHash Hash = ENoiseHash::Hash12;
+	//Optional PF_BC4 texture of the same size as RenderTarget. When set, the output is also block compressed into it every frame
+	UTexture2D* CompressedTexture = nullptr;
+	//Optional PF_R32_FLOAT render target of the same size as RenderTarget. When set, the output is thresholded at DistanceFieldThreshold
+	//and its signed distance field (in texels, negative above the threshold) is written to it every frame, see FJumpFloodCompute
+	UTextureRenderTarget2D* DistanceFieldTarget = nullptr;
+	float DistanceFieldThreshold = 0.5f;
+	//Optional float RGBA render target (PF_FloatRGBA, PF_A32B32G32R32F) of the same size as RenderTarget. When set, the kernel sees its output as
+	//a height field and writes the Sobel normal in xyz and the height in w, in the same dispatch. The thread coarsening is ignored meanwhile
+	UTextureRenderTarget2D* NormalTarget = nullptr;
+	//Height of a noise value of 1, in texels
+	float NormalStrength = 1.f;
+	//Optional PF_BC5 texture of the same size as NormalTarget. When set along with NormalTarget, the xy of the normals are also block compressed
+	//into it every frame, remapped to [0, 1] like any BC5 normal map
+	UTexture2D* CompressedNormalTexture = nullptr;
+
+	//Optional ring of precomputed frames. Slice z holds the output for TimeStamp z + 1, all slices are generated at once and only regenerated when the seed or the size changes.
+	//Nothing is dispatched in the steady state, consumers sample the slice returned by FWhiteNoiseCSManager::GetFrameRingSlice instead
+	void SetFrameRing(UTextureRenderTarget2DArray* InFrameRing)
+	{
+		FrameRing = InFrameRing;
+		FrameRingSize = FrameRing ? FIntVector(FrameRing->SizeX, FrameRing->SizeY, FrameRing->Slices) : FIntVector::ZeroValue;
+	}
+
+	UTextureRenderTarget2DArray* GetFrameRing() const { return FrameRing; }
+	FIntVector GetFrameRingSize() const { return FrameRingSize; }
+
+private:
+	UTextureRenderTarget2DArray* FrameRing = nullptr;
+	FIntVector FrameRingSize = FIntVector::ZeroValue;
+};
+
+
+/// <summary>
+/// A singleton Shader Manager for our Shader Type
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FWhiteNoiseCSManager
+{
+public:
+	//Get the instance
+	static FWhiteNoiseCSManager* Get()
+	{
+		if (!instance)
+			instance = new FWhiteNoiseCSManager();
+		return instance;
+	};
+
+	// Call this when you want to hook onto the renderer and start executing the compute shader. The shader will be dispatched once per frame.
+	void BeginRendering();
+
+	// Stops compute shader execution
+	void EndRendering();
+
+	// Call this whenever you have new parameters to share.
+	void UpdateParameters(FWhiteNoiseCSParameters& DrawParameters);
+
+	void UpdateResults(FRHICommandListImmediate& RHICmdList);
+	
+	void AddWhiteNoisePass(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap,
+						   TRefCountPtr<IPooledRenderTarget> OutputUAV, FRDGTextureUAVRef DstTexture);
+
+	// Starts writing every generated frame to Directory. Frames are dropped and counted instead of blocking when the GPU or the disk can't keep up
+	void BeginCapture(const FString& Directory, ENoiseImageFormat Format, int32 MaxQueuedFrames = 8);
+
+	// Stops the capture, the pending writes finish in the background
+	void EndCapture();
+
+	int32 GetNumCapturedFrames() const;
+	int32 GetNumDroppedFrames() const;
+
+	// Starts recording every UpdateParameters, BeginRendering and EndRendering call to a log the ParameterReplay commandlet plays back. Game thread only
+	void BeginParameterRecording(const FString& Path);
+
+	// Stops the recording and writes the log
+	void EndParameterRecording();
+
+	// Logs the histograms of the latencies measured by CustomShaders.WhiteNoise.MeasureLatency since the last report. Render thread only
+	void ReportSubmissionLatency();
+
+	// Logs the output checksum counters of CustomShaders.WhiteNoise.ChecksumInterval since the last report. Render thread only
+	void ReportOutputChecksums();
+
+	// CPU cost of the render thread side, for the ComputeOverhead commandlet. Seconds spent in NumCalls UpdateResults with the cached
+	// parameters, and in NumCalls render target pool lookups of the output description. Render thread only.
+	// OutAllocations receives the heap allocations of the UpdateResults calls when FAllocationTracker is installed
+	double MeasureUpdateResults(FRHICommandListImmediate& RHICmdList, int32 NumCalls, FAllocationCount* OutAllocations = nullptr);
+	double MeasurePoolLookups(FRHICommandListImmediate& RHICmdList, int32 NumCalls);
+	// Whether the shader UpdateResults dispatches is compiled. Commandlets running with -nullrhi may not have the global shaders. Render thread only
+	bool HasCompiledShaders() const;
+
+	// Slice of the frame ring holding the output for TimeStamp, see FWhiteNoiseCSParameters::SetFrameRing
+	static uint32 GetFrameRingSlice(uint32 TimeStamp, uint32 NumSlices)
+	{
+		return FParameterPacking::GetFrameRingSlice(TimeStamp, NumSlices);
+	}
+	
+private:
+	//Private constructor to prevent client from instanciating
+	FWhiteNoiseCSManager() = default;
+
+	//The singleton instance
+	static FWhiteNoiseCSManager* instance;
+
+	//The delegate handle to our function that will be executed each frame by the renderer
+	FDelegateHandle OnPostResolvedSceneColorHandle;
+
+	//Cached Shader Manager Parameters
+	FWhiteNoiseCSParameters cachedParams;
+
+	//Whether we have cached parameters to pass to the shader or not
+	volatile bool bCachedParamsAreValid;
+
+	//Reference to a pooled render target where the shader will write its output. Kept across frames by the direct path
+	TRefCountPtr<IPooledRenderTarget> ComputeShaderOutput;
+
+	//Output of the plain noise without a graph: the dispatch goes straight to ComputeShaderOutput, which is only looked up again when the
+	//size or the format changes, so the steady state allocates nothing. Used when no compression, distance field or capture needs the graph
+	void UpdateResults_Direct(FRHICommandListImmediate& RHICmdList, const FWhiteNoiseInstrumentation& Instrumentation, FRHIUnorderedAccessView* NormalUAV);
+	//Everything else, built as a render graph every frame
+	void UpdateResults_Graph(FRHICommandListImmediate& RHICmdList, const FWhiteNoiseInstrumentation& Instrumentation, FRHIUnorderedAccessView* NormalUAV);
+
+	//Whether the cached parameters have a normal target of the output size, the only case the fused normals are written in
+	bool WritesNormals() const;
+	//Returns the UAV the fused normals are written to, nullptr unless WritesNormals. Looked up again like ComputeShaderOutput
+	FRHIUnorderedAccessView* BeginNormalOutput(FRHICommandListImmediate& RHICmdList);
+	//Copies the normals of the dispatch to the normal target
+	void EndNormalOutput(FRHICommandListImmediate& RHICmdList);
+	TRefCountPtr<IPooledRenderTarget> NormalOutput;
+
+	//When the cached parameters were submitted, only stamped while CustomShaders.WhiteNoise.MeasureLatency is set
+	FSubmissionStamp cachedSubmission;
+	uint32 NumSubmissions = 0;
+
+	//Created on the render thread the first time the latency is measured
+	TUniquePtr<FSubmissionLatencyMonitor> SubmissionLatency;
+
+	//Created on the render thread the first time CustomShaders.WhiteNoise.ChecksumInterval is set
+	TUniquePtr<FOutputChecksumMonitor> OutputChecksum;
+	uint32 NumFramesSinceChecksum = 0;
+
+	//Allocations of the last UpdateResults when CustomShaders.WhiteNoise.TrackAllocations is set, render thread only
+	FAllocationCount LastFrameAllocations;
+
+	//The active parameter recording, game thread only
+	TUniquePtr<FParameterRecorder> ParameterRecorder;
+
+	//The active frame capture. The game thread copy is used for the statistics, the render thread copy for the readbacks
+	TSharedPtr<FNoiseFrameCapture, ESPMode::ThreadSafe> GameThreadCapture;
+	TSharedPtr<FNoiseFrameCapture, ESPMode::ThreadSafe> RenderThreadCapture;
+
+	//Generates every slice of the frame ring if its contents are out of date
+	void UpdateFrameRing(FRHICommandListImmediate& RHICmdList);
+
+	//What the frame ring was last generated with, render thread only
+	FTextureRHIRef FrameRingTexture;
+	FIntVector FrameRingGeneratedSize = FIntVector::ZeroValue;
+	uint32 FrameRingGeneratedSeed = 0;
+public:
+	void Execute_RenderThread(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext);
+	void Execute_Graph(FRHICommandListImmediate& RHICmdList, class FSceneRenderTargets& SceneContext);
+};
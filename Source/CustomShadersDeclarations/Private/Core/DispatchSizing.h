@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+struct FGroupCount
+{
+	int32_t X = 1;
+	int32_t Y = 1;
+	int32_t Z = 1;
+};
+
+/// <summary>
+/// Engine-free thread group arithmetic, the FMath::DivideAndRoundUp / FComputeShaderUtils::GetGroupCount logic the managers size their
+/// dispatches with
+/// </summary>
+struct FDispatchSizing
+{
+	//Same as FMath::DivideAndRoundUp for positive values
+	static constexpr int32_t DivideAndRoundUp(int32_t Dividend, int32_t Divisor) { return (Dividend + Divisor - 1) / Divisor; }
+
+	//Groups of ThreadsPerGroup x ThreadsPerGroup threads needed to cover Width x Height when every thread covers a BlockX x BlockY block
+	static constexpr FGroupCount GetGroupCount2D(int32_t Width, int32_t Height, int32_t ThreadsPerGroup, int32_t BlockX = 1, int32_t BlockY = 1)
+	{
+		return FGroupCount{ DivideAndRoundUp(Width, ThreadsPerGroup * BlockX), DivideAndRoundUp(Height, ThreadsPerGroup * BlockY), 1 };
+	}
+
+	//Texels a thread of each COARSENING permutation of MainComputeShader writes: 1x1, 2x2 and 4x1. Out of range values are clamped
+	static void GetWhiteNoiseBlockSize(int32_t Coarsening, int32_t& OutX, int32_t& OutY)
+	{
+		static const int32_t BlockSizes[3][2] = { { 1, 1 }, { 2, 2 }, { 4, 1 } };
+		const int32_t Index = Coarsening < 0 ? 0 : (Coarsening > 2 ? 2 : Coarsening);
+		OutX = BlockSizes[Index][0];
+		OutY = BlockSizes[Index][1];
+	}
+};
@@ -0,0 +1,81 @@
+#include "NoiseMath.h"
+
+namespace
+{
+	//Calls Texel(X, Value) for the Width texels of row Y. The family is picked once per row, so every loop keeps its hash inlined
+	template <typename TexelFunc>
+	void ForEachWhiteNoiseTexel(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t TimeStamp, ENoiseHash Hash, TexelFunc Texel)
+	{
+		const uint32_t LatticeY = Y * TimeStamp + Seed * FNoiseMath::SeedStrideY;
+		uint32_t LatticeX = Seed * FNoiseMath::SeedStrideX;
+		switch (Hash)
+		{
+		case ENoiseHash::PCG2D:
+			for (int32_t X = 0; X < Width; ++X, LatticeX += TimeStamp)
+			{
+				Texel(X, FNoiseMath::HashToUnorm(FNoiseMath::PCG2D(LatticeX, LatticeY)));
+			}
+			break;
+		case ENoiseHash::XXHash32:
+			for (int32_t X = 0; X < Width; ++X, LatticeX += TimeStamp)
+			{
+				Texel(X, FNoiseMath::HashToUnorm(FNoiseMath::XXHash32(LatticeX, LatticeY)));
+			}
+			break;
+		case ENoiseHash::Wang:
+		{
+			const uint32_t HashY = FNoiseMath::WangHash(LatticeY);
+			for (int32_t X = 0; X < Width; ++X, LatticeX += TimeStamp)
+			{
+				Texel(X, FNoiseMath::HashToUnorm(FNoiseMath::WangHash(LatticeX + HashY)));
+			}
+			break;
+		}
+		case ENoiseHash::IQInt:
+			for (int32_t X = 0; X < Width; ++X, LatticeX += TimeStamp)
+			{
+				Texel(X, FNoiseMath::HashToUnorm(FNoiseMath::IQIntHash(LatticeX, LatticeY)));
+			}
+			break;
+		default:
+		{
+			const float AxisY = FNoiseMath::HashAxis(LatticeY);
+			for (int32_t X = 0; X < Width; ++X, LatticeX += TimeStamp)
+			{
+				Texel(X, FNoiseMath::Hash12Axes(FNoiseMath::HashAxis(LatticeX), AxisY));
+			}
+			break;
+		}
+		}
+	}
+}
+
+void FNoiseMath::GenerateWhiteNoiseRow(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t TimeStamp, float* OutRow, ENoiseHash Hash)
+{
+	ForEachWhiteNoiseTexel(Y, Width, Seed, TimeStamp, Hash, [OutRow](int32_t X, float Value)
+	{
+		OutRow[X] = Value;
+	});
+}
+
+void FNoiseMath::GenerateVolumeRow(uint32_t Y, uint32_t Z, int32_t Width, uint32_t Seed, uint32_t TimeStamp, float* OutRow)
+{
+	const float AxisY = HashAxis(Y * TimeStamp + Seed * SeedStrideY);
+	const float AxisZ = HashAxis(Z * TimeStamp + Seed * SeedStrideZ);
+	uint32_t LatticeX = Seed * SeedStrideX;
+	for (int32_t X = 0; X < Width; ++X, LatticeX += TimeStamp)
+	{
+		OutRow[X] = Hash13Axes(HashAxis(LatticeX), AxisY, AxisZ);
+	}
+}
+
+uint64_t FNoiseMath::ChecksumWhiteNoiseRow(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t TimeStamp, ENoiseHash Hash)
+{
+	const uint32_t FirstIndex = Y * (uint32_t)Width;
+	uint64_t Checksum = 0;
+	ForEachWhiteNoiseTexel(Y, Width, Seed, TimeStamp, Hash, [FirstIndex, &Checksum](int32_t X, float Value)
+	{
+		Checksum ^= ChecksumTexel(FirstIndex + (uint32_t)X, Value);
+	});
+	return Checksum;
+}
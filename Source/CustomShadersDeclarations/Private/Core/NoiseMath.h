@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+//Hash families of MainComputeShader, the values of its HASH_FUNCTION permutation. The integer families hash the lattice coordinates
+//directly and keep the top 24 bits of the hash, hash12 is precise float math. The CPU and the GPU agree bit for bit on all of them
+enum class ENoiseHash : uint8_t
+{
+	//The float hash of the original shader, hash12
+	Hash12,
+	//PCG2D of Jarzynski and Olano, the y component: it takes one more multiply than x and is the better mixed of the two
+	PCG2D,
+	//The 2D xxHash32 of Jarzynski and Olano
+	XXHash32,
+	//Wang's integer hash, nested: wang(x + wang(y))
+	Wang,
+	//Inigo Quilez' integer hash III
+	IQInt,
+
+	Count,
+};
+
+/// <summary>
+/// Engine-free copy of the hash functions in WhiteNoiseCS.usf. FWhiteNoiseCPU and the ShaderHarness reference are built on it, and
+/// Tools/ComputeCore builds it without the engine to benchmark it. The per texel functions are inline so the row loops keep them inlined
+/// </summary>
+struct FNoiseMath
+{
+	//Lattice offset of one unit of Seed along each axis, see MainComputeShader and VolumeComputeShader
+	static constexpr uint32_t SeedStrideX = 1973u;
+	static constexpr uint32_t SeedStrideY = 9277u;
+	static constexpr uint32_t SeedStrideZ = 26699u;
+
+	//HLSL frac, same as FMath::Frac
+	static float Frac(float Value) { return Value - std::floor(Value); }
+
+	//Mirrors HashAxis
+	static float HashAxis(uint32_t LatticeCoord) { return Frac((float)LatticeCoord * .1031f); }
+
+	//Mirrors hash12_axes. One multiply or add per statement like the precise shader: a fused dot product would move the frac of the last
+	//product. Clang only fuses within an expression, MSVC not without /arch:AVX2, GCC needs -ffp-contract=off (Tools/ComputeCore sets it)
+	static float Hash12Axes(float AxisX, float AxisY)
+	{
+		float P3X = AxisX;
+		float P3Y = AxisY;
+		float P3Z = AxisX;
+
+		//p3 += dot(p3, p3.yzx + 33.33);
+		float Dot = P3X * (P3Y + 33.33f);
+		const float DotY = P3Y * (P3Z + 33.33f);
+		Dot += DotY;
+		const float DotZ = P3Z * (P3X + 33.33f);
+		Dot += DotZ;
+		P3X += Dot;
+		P3Y += Dot;
+		P3Z += Dot;
+
+		//return frac((p3.x + p3.y) * p3.z);
+		return Frac((P3X + P3Y) * P3Z);
+	}
+
+	//Mirrors hash12
+	static float Hash12(float X, float Y)
+	{
+		//float3 p3 = frac(float3(p.xyx) * .1031);
+		return Hash12Axes(Frac(X * .1031f), Frac(Y * .1031f));
+	}
+
+	//Mirrors hash13_axes
+	static float Hash13Axes(float AxisX, float AxisY, float AxisZ)
+	{
+		float P3X = AxisX;
+		float P3Y = AxisY;
+		float P3Z = AxisZ;
+
+		//p3 += dot(p3, p3.zyx + 31.32);
+		const float Dot = P3X * (P3Z + 31.32f) + P3Y * (P3Y + 31.32f) + P3Z * (P3X + 31.32f);
+		P3X += Dot;
+		P3Y += Dot;
+		P3Z += Dot;
+
+		//return frac((p3.x + p3.y) * p3.z);
+		return Frac((P3X + P3Y) * P3Z);
+	}
+
+	//Mirrors UintToUnorm: the top 24 bits of an integer hash in [0, 1), exact in a float
+	static float HashToUnorm(uint32_t Hash) { return (float)(Hash >> 8) * (1.f / 16777216.f); }
+
+	//Mirrors pcg2d
+	static uint32_t PCG2D(uint32_t X, uint32_t Y)
+	{
+		X = X * 1664525u + 1013904223u;
+		Y = Y * 1664525u + 1013904223u;
+		X += Y * 1664525u;
+		Y += X * 1664525u;
+		X ^= X >> 16;
+		Y ^= Y >> 16;
+		X += Y * 1664525u;
+		Y += X * 1664525u;
+		return Y ^ (Y >> 16);
+	}
+
+	//Mirrors xxhash32
+	static uint32_t XXHash32(uint32_t X, uint32_t Y)
+	{
+		uint32_t Hash = Y + 374761393u + X * 3266489917u;
+		Hash = 668265263u * ((Hash << 17) | (Hash >> 15));
+		Hash = 2246822519u * (Hash ^ (Hash >> 15));
+		Hash = 3266489917u * (Hash ^ (Hash >> 13));
+		return Hash ^ (Hash >> 16);
+	}
+
+	//Mirrors wang
+	static uint32_t WangHash(uint32_t Value)
+	{
+		Value = (Value ^ 61u) ^ (Value >> 16);
+		Value *= 9u;
+		Value ^= Value >> 4;
+		Value *= 0x27D4EB2Du;
+		Value ^= Value >> 15;
+		return Value;
+	}
+
+	//Mirrors iqint
+	static uint32_t IQIntHash(uint32_t X, uint32_t Y)
+	{
+		const uint32_t QX = 1103515245u * ((X >> 1) ^ Y);
+		const uint32_t QY = 1103515245u * ((Y >> 1) ^ X);
+		return 1103515245u * (QX ^ (QY >> 3));
+	}
+
+	//Mirrors HashLattice for the integer families
+	static uint32_t HashLattice(ENoiseHash Hash, uint32_t X, uint32_t Y)
+	{
+		switch (Hash)
+		{
+		case ENoiseHash::PCG2D: return PCG2D(X, Y);
+		case ENoiseHash::XXHash32: return XXHash32(X, Y);
+		case ENoiseHash::Wang: return WangHash(X + WangHash(Y));
+		case ENoiseHash::IQInt: return IQIntHash(X, Y);
+		default: return 0;
+		}
+	}
+
+	//Mirrors MainComputeShader for the texel at (X, Y). Unsigned arithmetic wraps exactly like the uint math in the shader
+	static float EvaluateWhiteNoise(uint32_t X, uint32_t Y, uint32_t Seed, uint32_t TimeStamp, ENoiseHash Hash = ENoiseHash::Hash12)
+	{
+		const uint32_t LatticeX = X * TimeStamp + Seed * SeedStrideX;
+		const uint32_t LatticeY = Y * TimeStamp + Seed * SeedStrideY;
+		return Hash == ENoiseHash::Hash12 ? Hash12((float)LatticeX, (float)LatticeY) : HashToUnorm(HashLattice(Hash, LatticeX, LatticeY));
+	}
+
+	//Name of a hash family in the logs, the console variables and the tools ("hash12", "pcg2d", ...)
+	static const char* GetHashName(ENoiseHash Hash)
+	{
+		static const char* const Names[] = { "hash12", "pcg2d", "xxhash32", "wang", "iqint" };
+		return (uint32_t)Hash < (uint32_t)ENoiseHash::Count ? Names[(uint32_t)Hash] : "unknown";
+	}
+
+	//Mirrors VolumeComputeShader for the voxel at (X, Y, Z)
+	static float EvaluateWhiteNoise3D(uint32_t X, uint32_t Y, uint32_t Z, uint32_t Seed, uint32_t TimeStamp)
+	{
+		return Hash13Axes(HashAxis(X * TimeStamp + Seed * SeedStrideX), HashAxis(Y * TimeStamp + Seed * SeedStrideY), HashAxis(Z * TimeStamp + Seed * SeedStrideZ));
+	}
+
+	//fmix32 of MurmurHash3, mirrors MixChecksum in WhiteNoiseCS.usf
+	static uint32_t MixChecksum(uint32_t Hash)
+	{
+		Hash ^= Hash >> 16;
+		Hash *= 0x85EBCA6Bu;
+		Hash ^= Hash >> 13;
+		Hash *= 0xC2B2AE35u;
+		Hash ^= Hash >> 16;
+		return Hash;
+	}
+
+	//Mirrors ChecksumTexel: 64 bit hash of the bits of the texel at Index (Y * Width + X), the shader's second half in the upper 32 bits.
+	//The checksum of an output is the XOR of the hashes of its texels, so the GPU can combine them in any order
+	static uint64_t ChecksumTexel(uint32_t Index, float Value)
+	{
+		uint32_t Bits;
+		std::memcpy(&Bits, &Value, sizeof(Bits));
+		const uint32_t Low = MixChecksum(Bits ^ MixChecksum(Index * 0x9E3779B9u));
+		const uint32_t High = MixChecksum((Bits * 0x85EBCA6Bu) ^ MixChecksum(Index + 0x7F4A7C15u));
+		return ((uint64_t)High << 32) | Low;
+	}
+
+	//Fills the Width texels of row Y. Same sharing as the coarsened shader permutations: the Y axis setup is done once per row
+	static void GenerateWhiteNoiseRow(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t TimeStamp, float* OutRow, ENoiseHash Hash = ENoiseHash::Hash12);
+
+	//Fills the Width voxels of row Y of slice Z, the Y and Z axis setups are shared by the row
+	static void GenerateVolumeRow(uint32_t Y, uint32_t Z, int32_t Width, uint32_t Seed, uint32_t TimeStamp, float* OutRow);
+
+	//XOR of the texel checksums of row Y of a Width wide white noise output, without storing the row
+	static uint64_t ChecksumWhiteNoiseRow(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t TimeStamp, ENoiseHash Hash = ENoiseHash::Hash12);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//The loose parameters of MainComputeShader, laid out like the $Globals constant buffer the shader compiler puts them in
+struct FWhiteNoiseGlobals
+{
+	float Dimensions[2];
+	uint32_t TimeStamp;
+	uint32_t Seed;
+};
+
+/// <summary>
+/// Engine-free packing of shader parameters: HLSL constant buffer offsets, the x | y << 16 texel indices of the compaction and jump flood
+/// shaders, and the frame ring slice a timestamp maps to
+/// </summary>
+struct FParameterPacking
+{
+	//Offset of a Size byte member placed after Offset in a constant buffer: 4 byte aligned, moved to the next 16 byte register if it
+	//would straddle one
+	static constexpr uint32_t GetConstantOffset(uint32_t Offset, uint32_t Size)
+	{
+		const uint32_t Aligned = (Offset + 3u) & ~3u;
+		return Aligned / 16u != (Aligned + Size - 1u) / 16u ? (Aligned + 15u) & ~15u : Aligned;
+	}
+
+	static FWhiteNoiseGlobals PackWhiteNoise(int32_t Width, int32_t Height, uint32_t TimeStamp, uint32_t Seed)
+	{
+		return FWhiteNoiseGlobals{ { (float)Width, (float)Height }, TimeStamp, Seed };
+	}
+
+	//Texel indices of textures up to 65536 texels wide
+	static uint32_t PackTexelIndex(uint32_t X, uint32_t Y) { return X | (Y << 16); }
+	static void UnpackTexelIndex(uint32_t Packed, uint32_t& OutX, uint32_t& OutY)
+	{
+		OutX = Packed & 0xFFFFu;
+		OutY = Packed >> 16;
+	}
+
+	//TimeStamp of slice 0 of the frame ring. TimeStamp 0 would be a constant image, the lattice is multiplied by it
+	static constexpr uint32_t FrameRingFirstTimeStamp = 1;
+
+	//Slice of a NumSlices frame ring holding the output for TimeStamp: slice z holds FrameRingFirstTimeStamp + z, and the ring repeats every
+	//NumSlices timestamps. Unsigned arithmetic keeps the earlier timestamps on the same cycle
+	static uint32_t GetFrameRingSlice(uint32_t TimeStamp, uint32_t NumSlices)
+	{
+		if (NumSlices == 0)
+		{
+			return 0;
+		}
+		const uint32_t FirstSlice = FrameRingFirstTimeStamp % NumSlices;
+		const uint32_t Slice = TimeStamp % NumSlices;
+		return Slice >= FirstSlice ? Slice - FirstSlice : Slice + NumSlices - FirstSlice;
+	}
+};
+
+static_assert(offsetof(FWhiteNoiseGlobals, TimeStamp) == FParameterPacking::GetConstantOffset(sizeof(float[2]), sizeof(uint32_t)), "TimeStamp offset");
+static_assert(offsetof(FWhiteNoiseGlobals, Seed) == FParameterPacking::GetConstantOffset(offsetof(FWhiteNoiseGlobals, TimeStamp) + 4, sizeof(uint32_t)), "Seed offset");
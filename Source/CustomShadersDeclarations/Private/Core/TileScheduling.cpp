@@ -0,0 +1,28 @@
+#include "TileScheduling.h"
+
+bool FTileScheduling::IsTileDispatched(const uint8_t* Active, int32_t GridX, int32_t GridY, int32_t TileX, int32_t TileY)
+{
+	for (int32_t NeighbourY = TileY - 1; NeighbourY <= TileY + 1; ++NeighbourY)
+	{
+		for (int32_t NeighbourX = TileX - 1; NeighbourX <= TileX + 1; ++NeighbourX)
+		{
+			if (NeighbourX >= 0 && NeighbourY >= 0 && NeighbourX < GridX && NeighbourY < GridY && Active[NeighbourY * GridX + NeighbourX] != 0)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+int32_t FTileScheduling::GetBrickDepth(int32_t SizeX, int32_t SizeY, int32_t SizeZ, int32_t BytesPerVoxel, int64_t BudgetBytes, int32_t Alignment)
+{
+	const int64_t SliceBytes = (int64_t)SizeX * SizeY * BytesPerVoxel;
+	int64_t Depth = SliceBytes > 0 ? BudgetBytes / SliceBytes : SizeZ;
+	Depth = Depth < 1 ? 1 : (Depth > SizeZ ? SizeZ : Depth);
+	if (Depth < SizeZ && Depth > Alignment)
+	{
+		Depth -= Depth % Alignment;
+	}
+	return (int32_t)Depth;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+//Half-open rectangle of texels, [MinX, MaxX) x [MinY, MaxY)
+struct FTileRect
+{
+	int32_t MinX;
+	int32_t MinY;
+	int32_t MaxX;
+	int32_t MaxY;
+};
+
+/// <summary>
+/// Engine-free work splitting: the tile lists the CPU fluid solver walks (mirroring ClassifyTilesCS/BuildTileListsCS) and the bricks the volume
+/// noise is generated in. The tile walkers hand every rectangle to a callback so callers keep their own containers
+/// </summary>
+struct FTileScheduling
+{
+	//Calls Emit for every TileSize x TileSize tile of Width x Height, row after row, clipped to the size
+	template <typename EmitFunc>
+	static void ForEachDenseTile(int32_t Width, int32_t Height, int32_t TileSize, EmitFunc&& Emit)
+	{
+		for (int32_t MinY = 0; MinY < Height; MinY += TileSize)
+		{
+			for (int32_t MinX = 0; MinX < Width; MinX += TileSize)
+			{
+				Emit(FTileRect{ MinX, MinY, Min(MinX + TileSize, Width), Min(MinY + TileSize, Height) });
+			}
+		}
+	}
+
+	//Whether the tile at (TileX, TileY) of a GridX x GridY grid has to be dispatched: it or one of its 8 neighbours is active. Mirrors BuildTileListsCS
+	static bool IsTileDispatched(const uint8_t* Active, int32_t GridX, int32_t GridY, int32_t TileX, int32_t TileY);
+
+	//Calls Emit for every run of consecutive dispatched tiles of a row, runs are cut after MaxRunLength tiles so the tasks stay balanced.
+	//Tiles are TileSize texels wide, the rectangles are clipped to Width x Height
+	template <typename EmitFunc>
+	static void ForEachTileRun(const uint8_t* Dispatched, int32_t GridX, int32_t GridY, int32_t TileSize, int32_t MaxRunLength, int32_t Width, int32_t Height,
+							   EmitFunc&& Emit)
+	{
+		for (int32_t TileY = 0; TileY < GridY; ++TileY)
+		{
+			int32_t RunStart = -1;
+			for (int32_t TileX = 0; TileX <= GridX; ++TileX)
+			{
+				const bool bDispatch = TileX < GridX && Dispatched[TileY * GridX + TileX] != 0;
+				if (RunStart != -1 && (!bDispatch || TileX - RunStart == MaxRunLength))
+				{
+					Emit(FTileRect{ RunStart * TileSize, TileY * TileSize, Min(TileX * TileSize, Width), Min((TileY + 1) * TileSize, Height) });
+					RunStart = -1;
+				}
+				if (bDispatch && RunStart == -1)
+				{
+					RunStart = TileX;
+				}
+			}
+		}
+	}
+
+	//Slices of a SizeX x SizeY x SizeZ volume that fit in BudgetBytes, at least one. Partial bricks are rounded down to a multiple of
+	//Alignment (the thread group depth) when that leaves more than one group
+	static int32_t GetBrickDepth(int32_t SizeX, int32_t SizeY, int32_t SizeZ, int32_t BytesPerVoxel, int64_t BudgetBytes, int32_t Alignment);
+
+private:
+	static int32_t Min(int32_t A, int32_t B) { return A < B ? A : B; }
+};
@@ -0,0 +1,130 @@
+#include "DistanceFieldCPU.h"
+
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	//Squared distance of the texels that aren't features, large enough to never win but small enough to keep the parabola intersections finite
+	constexpr double Infinity = 1e20;
+
+	//Lower envelope of the parabolas rooted at every element of Line, in place
+	void DistanceTransform1D(TArray<double>& Line, TArray<double>& Scratch, TArray<int32>& Roots, TArray<double>& Boundaries)
+	{
+		const int32 Num = Line.Num();
+		Scratch = Line;
+		Roots.SetNumUninitialized(Num);
+		Boundaries.SetNumUninitialized(Num + 1);
+
+		int32 NumParabolas = 0;
+		Roots[0] = 0;
+		Boundaries[0] = -Infinity;
+		Boundaries[1] = Infinity;
+		for (int32 Q = 1; Q < Num; ++Q)
+		{
+			auto Intersect = [&Scratch, Q](int32 Root)
+			{
+				return ((Scratch[Q] + (double)Q * Q) - (Scratch[Root] + (double)Root * Root)) / (2.0 * (Q - Root));
+			};
+			//Boundaries[0] is -Infinity, so this stops at the first parabola at the latest
+			double Intersection = Intersect(Roots[NumParabolas]);
+			while (Intersection <= Boundaries[NumParabolas])
+			{
+				--NumParabolas;
+				Intersection = Intersect(Roots[NumParabolas]);
+			}
+			++NumParabolas;
+			Roots[NumParabolas] = Q;
+			Boundaries[NumParabolas] = Intersection;
+			Boundaries[NumParabolas + 1] = Infinity;
+		}
+
+		int32 Parabola = 0;
+		for (int32 Q = 0; Q < Num; ++Q)
+		{
+			while (Boundaries[Parabola + 1] < Q)
+			{
+				++Parabola;
+			}
+			const double Delta = Q - Roots[Parabola];
+			Line[Q] = Delta * Delta + Scratch[Roots[Parabola]];
+		}
+	}
+
+	//Squared distance from every texel to the nearest texel where Grid is 0, in place
+	void SquaredDistanceTransform(TArray<double>& Grid, int32 Width, int32 Height)
+	{
+		ParallelFor(Width, [&Grid, Width, Height](int32 X)
+		{
+			TArray<double> Line, Scratch, Boundaries;
+			TArray<int32> Roots;
+			Line.SetNumUninitialized(Height);
+			for (int32 Y = 0; Y < Height; ++Y)
+			{
+				Line[Y] = Grid[Y * Width + X];
+			}
+			DistanceTransform1D(Line, Scratch, Roots, Boundaries);
+			for (int32 Y = 0; Y < Height; ++Y)
+			{
+				Grid[Y * Width + X] = Line[Y];
+			}
+		});
+
+		ParallelFor(Height, [&Grid, Width](int32 Y)
+		{
+			TArray<double> Line, Scratch, Boundaries;
+			TArray<int32> Roots;
+			Line.SetNumUninitialized(Width);
+			FMemory::Memcpy(Line.GetData(), &Grid[Y * Width], Width * sizeof(double));
+			DistanceTransform1D(Line, Scratch, Roots, Boundaries);
+			FMemory::Memcpy(&Grid[Y * Width], Line.GetData(), Width * sizeof(double));
+		});
+	}
+}
+
+void FDistanceFieldCPU::ComputeSignedDistanceField(TArrayView<const float> Values, int32 Width, int32 Height, float Threshold, TArray<float>& OutDistances)
+{
+	check(Values.Num() == Width * Height);
+	TArray<double> ToInside;
+	TArray<double> ToOutside;
+	ToInside.SetNumUninitialized(Values.Num());
+	ToOutside.SetNumUninitialized(Values.Num());
+	for (int32 Index = 0; Index < Values.Num(); ++Index)
+	{
+		const bool bInside = Values[Index] > Threshold;
+		ToInside[Index] = bInside ? 0.0 : Infinity;
+		ToOutside[Index] = bInside ? Infinity : 0.0;
+	}
+	SquaredDistanceTransform(ToInside, Width, Height);
+	SquaredDistanceTransform(ToOutside, Width, Height);
+
+	OutDistances.SetNumUninitialized(Values.Num());
+	const float NoSeedDistance = (float)(Width + Height);
+	ParallelFor(Height, [&](int32 Y)
+	{
+		for (int32 Index = Y * Width; Index < (Y + 1) * Width; ++Index)
+		{
+			const bool bInside = Values[Index] > Threshold;
+			const double DistanceSquared = bInside ? ToOutside[Index] : ToInside[Index];
+			const float Distance = DistanceSquared >= Infinity * 0.5 ? NoSeedDistance : (float)FMath::Sqrt(DistanceSquared);
+			OutDistances[Index] = bInside ? -Distance : Distance;
+		}
+	});
+}
+
+FDistanceFieldError FDistanceFieldCPU::MeasureError(TArrayView<const float> Distances, TArrayView<const float> Reference)
+{
+	check(Distances.Num() == Reference.Num());
+	FDistanceFieldError Error;
+	double SumError = 0.0;
+	int32 NumWrong = 0;
+	for (int32 Index = 0; Index < Distances.Num(); ++Index)
+	{
+		const float TexelError = FMath::Abs(Distances[Index] - Reference[Index]);
+		Error.MaxError = FMath::Max(Error.MaxError, TexelError);
+		SumError += TexelError;
+		NumWrong += TexelError > 0.01f ? 1 : 0;
+	}
+	Error.MeanError = Distances.Num() > 0 ? (float)(SumError / Distances.Num()) : 0.f;
+	Error.WrongFraction = Distances.Num() > 0 ? (float)NumWrong / Distances.Num() : 0.f;
+	return Error;
+}
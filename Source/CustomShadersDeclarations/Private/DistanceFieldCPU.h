@@ -0,0 +1,25 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//How far a distance field is from a reference, in texels
+struct FDistanceFieldError
+{
+	float MaxError = 0.f;
+	float MeanError = 0.f;
+	//Share of the texels off by more than a hundredth of a texel
+	float WrongFraction = 0.f;
+};
+
+/// <summary>
+/// Exact signed Euclidean distance transform (Felzenszwalb and Huttenlocher), the reference JumpFloodCS.usf is checked against.
+/// The squared distances are computed one column at a time then one row at a time, each line on its own worker thread
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FDistanceFieldCPU
+{
+	//Distance between the center of every texel and the nearest texel center on the other side of the mask (Values > Threshold), negative
+	//inside the mask. Without any texel on the other side, the distance is Width + Height
+	static void ComputeSignedDistanceField(TArrayView<const float> Values, int32 Width, int32 Height, float Threshold, TArray<float>& OutDistances);
+
+	static FDistanceFieldError MeasureError(TArrayView<const float> Distances, TArrayView<const float> Reference);
+};
@@ -0,0 +1,75 @@
+#include "FFT.h"
+
+#include "ShaderParameterStruct.h"
+
+class FFFTCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFFTCS);
+	SHADER_USE_PARAMETER_STRUCT(FFFTCS, FGlobalShader);
+
+	//Points per line, a thread group handles one line with a quarter as many threads
+	class FSizeDim : SHADER_PERMUTATION_SPARSE_INT("FFT_SIZE", 128, 256, 512, 1024);
+	class FVerticalDim : SHADER_PERMUTATION_BOOL("FFT_VERTICAL");
+	using FPermutationDomain = TShaderPermutationDomain<FSizeDim, FVerticalDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, Input)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, Output)
+		SHADER_PARAMETER(float, TwiddleSign)
+		SHADER_PARAMETER(float, Scale)
+	END_SHADER_PARAMETER_STRUCT()
+
+public:
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+
+		const FPermutationDomain PermutationVector(Parameters.PermutationId);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), PermutationVector.Get<FSizeDim>() / 4);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FFFTCS, "/CustomShaders/FFTCS.usf", "FFTCS", SF_Compute);
+
+
+void FFFTCompute::AddTransform1D(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Input, FRDGTextureRef Output,
+								 bool bVertical, EFFTDirection Direction, float Scale)
+{
+	const FIntPoint Size = Input->Desc.Extent;
+	check(Output->Desc.Extent == Size);
+	const int32 LineSize = bVertical ? Size.Y : Size.X;
+	const int32 NumLines = bVertical ? Size.X : Size.Y;
+	check(IsSupportedSize(LineSize));
+
+	FFFTCS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FFFTCS::FSizeDim>(LineSize);
+	PermutationVector.Set<FFFTCS::FVerticalDim>(bVertical);
+	TShaderMapRef<FFFTCS> ComputeShader(ShaderMap, PermutationVector);
+
+	FFFTCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFFTCS::FParameters>();
+	PassParameters->Input = Input;
+	PassParameters->Output = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Output));
+	PassParameters->TwiddleSign = Direction == EFFTDirection::Forward ? -1.f : 1.f;
+	PassParameters->Scale = Scale;
+
+	FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("FFT %s %d", bVertical ? TEXT("Columns") : TEXT("Rows"), LineSize),
+								 ComputeShader, PassParameters, FIntVector(NumLines, 1, 1));
+}
+
+void FFFTCompute::AddTransform2D(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Data, EFFTDirection Direction, float Scale)
+{
+	FRDGTextureRef Scratch = GraphBuilder.CreateTexture(CreateTextureDesc(Data->Desc.Extent), TEXT("FFTScratch"));
+	AddTransform1D(GraphBuilder, ShaderMap, Data, Scratch, false, Direction);
+	AddTransform1D(GraphBuilder, ShaderMap, Scratch, Data, true, Direction, Scale);
+}
+
+FRDGTextureDesc FFFTCompute::CreateTextureDesc(FIntPoint Size)
+{
+	return FRDGTextureDesc::Create2DDesc(Size, PF_A32B32G32R32F, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+}
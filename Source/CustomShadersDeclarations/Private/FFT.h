@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "FFTCPU.h"
+
+/// <summary>
+/// GPU FFT of the two complex values packed in every texel (xy and zw) of a PF_A32B32G32R32F texture, see FFTCS.usf
+/// A line is transformed by one thread group in groupshared memory, so lines of 128 to 1024 points are supported. Every pass reads one texture
+/// and writes another, a 2D transform is two passes that end in the texture they started from
+/// FFFTCPU is the CPU counterpart
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FFFTCompute
+{
+public:
+	static constexpr int32 MinSize = 128;
+	static constexpr int32 MaxSize = 1024;
+
+	//Whether lines of Size points can be transformed
+	static bool IsSupportedSize(int32 Size)
+	{
+		return FMath::IsPowerOfTwo(Size) && Size >= MinSize && Size <= MaxSize;
+	}
+
+	//Transforms the rows (or the columns when bVertical) of Input into Output. Both have the same size
+	static void AddTransform1D(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Input, FRDGTextureRef Output,
+							   bool bVertical, EFFTDirection Direction, float Scale = 1.f);
+
+	//Transforms Data in place through a transient texture of the same size. Scale is applied once
+	static void AddTransform2D(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Data, EFFTDirection Direction, float Scale = 1.f);
+
+	//Description of a texture the transforms accept
+	static FRDGTextureDesc CreateTextureDesc(FIntPoint Size);
+};
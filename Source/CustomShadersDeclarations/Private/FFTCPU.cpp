@@ -0,0 +1,175 @@
+#include "FFTCPU.h"
+
+#include "Async/ParallelFor.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+	FVector2D ComplexMul(const FVector2D& A, const FVector2D& B)
+	{
+		return FVector2D(A.X * B.X - A.Y * B.Y, A.X * B.Y + A.Y * B.X);
+	}
+
+	FVector2D TimesI(const FVector2D& A)
+	{
+		return FVector2D(-A.Y, A.X);
+	}
+
+	FVector2D Twiddle(float TwiddleSign, uint32 K, uint32 Span)
+	{
+		float Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, TwiddleSign * 2.f * PI * (float)K / (float)Span);
+		return FVector2D(Cos, Sin);
+	}
+
+	//Radix2Stage and Radix4Stage of FFTCS.usf, one loop iteration per butterfly. Reads Source and writes Destination
+	void Radix2Stage(const FVector2D* Source, FVector2D* Destination, uint32 Size, uint32 Ns, float TwiddleSign)
+	{
+		const uint32 HalfSize = Size / 2;
+		for (uint32 J = 0; J < HalfSize; ++J)
+		{
+			const uint32 K = J & (Ns - 1);
+			const FVector2D V0 = Source[J];
+			const FVector2D V1 = ComplexMul(Source[J + HalfSize], Twiddle(TwiddleSign, K, Ns * 2));
+			const uint32 Out = (J - K) * 2 + K;
+			Destination[Out] = V0 + V1;
+			Destination[Out + Ns] = V0 - V1;
+		}
+	}
+
+	void Radix4Stage(const FVector2D* Source, FVector2D* Destination, uint32 Size, uint32 Ns, float TwiddleSign)
+	{
+		const uint32 QuarterSize = Size / 4;
+		for (uint32 J = 0; J < QuarterSize; ++J)
+		{
+			const uint32 K = J & (Ns - 1);
+			const FVector2D W = Twiddle(TwiddleSign, K, Ns * 4);
+			const FVector2D W2 = ComplexMul(W, W);
+			const FVector2D V0 = Source[J];
+			const FVector2D V1 = ComplexMul(Source[J + QuarterSize], W);
+			const FVector2D V2 = ComplexMul(Source[J + 2 * QuarterSize], W2);
+			const FVector2D V3 = ComplexMul(Source[J + 3 * QuarterSize], ComplexMul(W2, W));
+
+			const FVector2D A = V0 + V2;
+			const FVector2D B = V0 - V2;
+			const FVector2D C = V1 + V3;
+			const FVector2D D = TimesI(V1 - V3) * TwiddleSign;
+			const uint32 Out = (J - K) * 4 + K;
+			Destination[Out] = A + C;
+			Destination[Out + Ns] = B + D;
+			Destination[Out + 2 * Ns] = A - C;
+			Destination[Out + 3 * Ns] = B - D;
+		}
+	}
+
+	float GetTwiddleSign(EFFTDirection Direction)
+	{
+		return Direction == EFFTDirection::Forward ? -1.f : 1.f;
+	}
+}
+
+void FFFTCPU::Transform(TArrayView<FVector2D> Data, EFFTDirection Direction, float Scale)
+{
+	const uint32 Size = (uint32)Data.Num();
+	check(FMath::IsPowerOfTwo(Size));
+	if (Size < 2)
+	{
+		return;
+	}
+
+	const float TwiddleSign = GetTwiddleSign(Direction);
+	TArray<FVector2D, TInlineAllocator<1024>> Scratch;
+	Scratch.SetNumUninitialized(Size);
+	FVector2D* Source = Data.GetData();
+	FVector2D* Destination = Scratch.GetData();
+
+	uint32 Ns = 1;
+	if (FMath::FloorLog2(Size) % 2 == 1)
+	{
+		Radix2Stage(Source, Destination, Size, Ns, TwiddleSign);
+		Swap(Source, Destination);
+		Ns = 2;
+	}
+	for (; Ns < Size; Ns *= 4)
+	{
+		Radix4Stage(Source, Destination, Size, Ns, TwiddleSign);
+		Swap(Source, Destination);
+	}
+
+	for (uint32 Index = 0; Index < Size; ++Index)
+	{
+		Data[Index] = Source[Index] * Scale;
+	}
+}
+
+void FFFTCPU::Transform2D(TArray<FVector2D>& Data, FIntPoint Size, EFFTDirection Direction, float Scale)
+{
+	check(Data.Num() == Size.X * Size.Y);
+	FVector2D* Values = Data.GetData();
+
+	ParallelFor(Size.Y, [Values, Size, Direction](int32 Y)
+	{
+		Transform(TArrayView<FVector2D>(Values + (int64)Y * Size.X, Size.X), Direction);
+	});
+
+	//Columns are gathered into a contiguous line, transformed and scattered back
+	ParallelFor(Size.X, [Values, Size, Direction, Scale](int32 X)
+	{
+		TArray<FVector2D, TInlineAllocator<1024>> Column;
+		Column.SetNumUninitialized(Size.Y);
+		for (int32 Y = 0; Y < Size.Y; ++Y)
+		{
+			Column[Y] = Values[(int64)Y * Size.X + X];
+		}
+		Transform(Column, Direction, Scale);
+		for (int32 Y = 0; Y < Size.Y; ++Y)
+		{
+			Values[(int64)Y * Size.X + X] = Column[Y];
+		}
+	});
+}
+
+void FFFTCPU::TransformDirect(TArrayView<const FVector2D> Input, TArray<FVector2D>& Output, EFFTDirection Direction, float Scale)
+{
+	const int32 Size = Input.Num();
+	const double TwiddleSign = GetTwiddleSign(Direction);
+	Output.SetNumUninitialized(Size);
+	for (int32 K = 0; K < Size; ++K)
+	{
+		double SumReal = 0.0;
+		double SumImaginary = 0.0;
+		for (int32 N = 0; N < Size; ++N)
+		{
+			//K * N can overflow int32 for large sizes, it is only needed modulo Size
+			const double Angle = TwiddleSign * 2.0 * PI * (double)(((int64)K * N) % Size) / Size;
+			const double Cos = FMath::Cos(Angle);
+			const double Sin = FMath::Sin(Angle);
+			SumReal += Input[N].X * Cos - Input[N].Y * Sin;
+			SumImaginary += Input[N].X * Sin + Input[N].Y * Cos;
+		}
+		Output[K] = FVector2D((float)(SumReal * Scale), (float)(SumImaginary * Scale));
+	}
+}
+
+float FFFTCPU::MeasureMaxError(int32 Size, EFFTDirection Direction, int32 Seed)
+{
+	FRandomStream Random(Seed);
+	TArray<FVector2D> Input;
+	Input.SetNumUninitialized(Size);
+	for (FVector2D& Value : Input)
+	{
+		Value = FVector2D(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f));
+	}
+
+	TArray<FVector2D> Expected;
+	TransformDirect(Input, Expected, Direction);
+	TArray<FVector2D> Actual = Input;
+	Transform(Actual, Direction);
+
+	float MaxError = 0.f;
+	for (int32 Index = 0; Index < Size; ++Index)
+	{
+		MaxError = FMath::Max(MaxError, (Actual[Index] - Expected[Index]).GetAbsMax());
+	}
+	return MaxError;
+}
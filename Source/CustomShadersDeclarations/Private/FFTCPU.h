@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EFFTDirection : uint8
+{
+	//exp(-2 pi i k n / N)
+	Forward,
+	//exp(2 pi i k n / N), not normalized
+	Inverse,
+};
+
+/// <summary>
+/// CPU implementation of FFTCS.usf, complex values are stored as FVector2D (X real, Y imaginary)
+/// Transform runs the same Stockham radix-2/4 stages as the shader so its output can be used to validate the GPU transforms,
+/// TransformDirect is the O(N^2) DFT both are checked against
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FFFTCPU
+{
+	//Mirrors FFTCS. Data.Num() must be a power of two
+	static void Transform(TArrayView<FVector2D> Data, EFFTDirection Direction, float Scale = 1.f);
+
+	//Transforms the rows then the columns of a Size.X x Size.Y row-major grid, lines are spread across all the worker threads
+	static void Transform2D(TArray<FVector2D>& Data, FIntPoint Size, EFFTDirection Direction, float Scale = 1.f);
+
+	//Direct evaluation of the DFT in double precision
+	static void TransformDirect(TArrayView<const FVector2D> Input, TArray<FVector2D>& Output, EFFTDirection Direction, float Scale = 1.f);
+
+	//Largest absolute difference between Transform and TransformDirect on random data of Size points
+	static float MeasureMaxError(int32 Size, EFFTDirection Direction, int32 Seed = 0);
+};
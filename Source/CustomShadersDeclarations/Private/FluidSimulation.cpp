@@ -0,0 +1,772 @@
+#include "FluidSimulation.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ShaderParameterStruct.h"
+#include "ComputeBenchmark.h"
+#include "FluidSimulationCPU.h"
+#include "PrimitivesCPU.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 8
+
+static TAutoConsoleVariable<int32> CVarFluidReportResidual(
+	TEXT("CustomShaders.Fluid.ReportResidual"),
+	0,
+	TEXT("Logs the residual of the fluid pressure solve and the number of passes it took, to compare the Jacobi and multigrid solvers."),
+	ECVF_RenderThreadSafe);
+
+static FAutoConsoleCommand FluidSolverBenchmarkCommand(
+	TEXT("CustomShaders.Fluid.SolverBenchmark"),
+	TEXT("Solves the same pressure problem with Jacobi and with multigrid down to the same residual and logs the passes, GPU time and final residual of each. Arguments: [Size] [RelativeResidual] [MaxJacobiIterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1024;
+		const float RelativeResidual = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 1e-2f;
+		const int32 MaxJacobiIterations = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 20000;
+		ENQUEUE_RENDER_COMMAND(FluidSolverBenchmarkCommand)(
+			[Size, RelativeResidual, MaxJacobiIterations](FRHICommandListImmediate& RHICmdList)
+			{
+				FFluidSimulation::RunSolverBenchmark(RHICmdList, Size, RelativeResidual, MaxJacobiIterations);
+			});
+	}));
+
+static FAutoConsoleCommand FluidValidateCommand(
+	TEXT("CustomShaders.Fluid.Validate"),
+	TEXT("Steps an emitter on the GPU and on the CPU reference and logs the largest difference of every field after each step. Arguments: [Size] [NumSteps] [Multigrid 0|1] [Sparse 0|1]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 256;
+		const int32 NumSteps = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10;
+		const bool bUseMultigrid = Args.Num() > 2 && FCString::Atoi(*Args[2]) != 0;
+		const bool bUseSparseTiles = Args.Num() > 3 && FCString::Atoi(*Args[3]) != 0;
+		ENQUEUE_RENDER_COMMAND(FluidValidateCommand)(
+			[Size, NumSteps, bUseMultigrid, bUseSparseTiles](FRHICommandListImmediate& RHICmdList)
+			{
+				FFluidSimulation::RunValidation(RHICmdList, Size, NumSteps, bUseMultigrid, bUseSparseTiles);
+			});
+	}));
+
+BEGIN_SHADER_PARAMETER_STRUCT(FFluidCommonParameters, )
+	SHADER_PARAMETER(FIntPoint, SimulationSize)
+	SHADER_PARAMETER(float, DeltaTime)
+	SHADER_PARAMETER(float, VelocityDissipation)
+	SHADER_PARAMETER(float, DyeDissipation)
+	SHADER_PARAMETER(FVector2D, EmitterPosition)
+	SHADER_PARAMETER(FVector2D, EmitterForce)
+	SHADER_PARAMETER(float, EmitterRadius)
+	SHADER_PARAMETER(float, EmitterDye)
+END_SHADER_PARAMETER_STRUCT()
+
+//Active tile list of the sparse mode and the dispatch arguments that go with it
+BEGIN_SHADER_PARAMETER_STRUCT(FFluidTileParameters, )
+	SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, TileList)
+	SHADER_PARAMETER_RDG_BUFFER(Buffer<uint>, IndirectArgsBuffer)
+END_SHADER_PARAMETER_STRUCT()
+
+/// <summary>
+/// Base class of the fluid passes, they all live in FluidCS.usf and share the same compilation environment
+/// </summary>
+class FFluidCS : public FGlobalShader
+{
+public:
+	//Runs the pass over the tiles of TileList instead of the whole grid
+	class FSparseTilesDim : SHADER_PERMUTATION_BOOL("SPARSE_TILES");
+	using FPermutationDomain = TShaderPermutationDomain<FSparseTilesDim>;
+
+	FFluidCS() { }
+	FFluidCS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{ }
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+	}
+};
+
+class FFluidAdvectVelocityCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidAdvectVelocityCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidAdvectVelocityCS, FFluidCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidCommonParameters, Common)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidTileParameters, Tiles)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, VelocityTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, OutputVelocity)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidDivergenceCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidDivergenceCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidDivergenceCS, FFluidCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidCommonParameters, Common)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidTileParameters, Tiles)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, VelocityTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputDivergence)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidJacobiPressureCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidJacobiPressureCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidJacobiPressureCS, FFluidCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidCommonParameters, Common)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidTileParameters, Tiles)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, PressureTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, DivergenceTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputPressure)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidProjectCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidProjectCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidProjectCS, FFluidCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidCommonParameters, Common)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidTileParameters, Tiles)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, VelocityTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, PressureTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, OutputVelocity)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidAdvectDyeCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidAdvectDyeCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidAdvectDyeCS, FFluidCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidCommonParameters, Common)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidTileParameters, Tiles)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, VelocityTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, DyeTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutputDye)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidClassifyTilesCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidClassifyTilesCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidClassifyTilesCS, FFluidCS);
+	using FPermutationDomain = FShaderPermutationNone;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidCommonParameters, Common)
+		SHADER_PARAMETER(float, ActivityThreshold)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, VelocityTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, DyeTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<uint>, OutputTileActivity)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidInitTileArgsCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidInitTileArgsCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidInitTileArgsCS, FFluidCS);
+	using FPermutationDomain = FShaderPermutationNone;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputIndirectArgs)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidBuildTileListsCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidBuildTileListsCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidBuildTileListsCS, FFluidCS);
+	using FPermutationDomain = FShaderPermutationNone;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, TileGridSize)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<uint>, TileActivityTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<uint>, TileDispatched)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputIndirectArgs)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputTileList)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputRetiredTileList)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FFluidClearTilesCS : public FFluidCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FFluidClearTilesCS);
+	SHADER_USE_PARAMETER_STRUCT(FFluidClearTilesCS, FFluidCS);
+	using FPermutationDomain = FShaderPermutationNone;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidCommonParameters, Common)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FFluidTileParameters, Tiles)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, RetiredVelocity0)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, RetiredVelocity1)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RetiredPressure0)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RetiredPressure1)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, RetiredDye0)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, RetiredDye1)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FFluidAdvectVelocityCS, "/CustomShaders/FluidCS.usf", "AdvectVelocityCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidDivergenceCS, "/CustomShaders/FluidCS.usf", "DivergenceCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidJacobiPressureCS, "/CustomShaders/FluidCS.usf", "JacobiPressureCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidProjectCS, "/CustomShaders/FluidCS.usf", "ProjectCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidAdvectDyeCS, "/CustomShaders/FluidCS.usf", "AdvectDyeCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidClassifyTilesCS, "/CustomShaders/FluidCS.usf", "ClassifyTilesCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidInitTileArgsCS, "/CustomShaders/FluidCS.usf", "InitTileArgsCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidBuildTileListsCS, "/CustomShaders/FluidCS.usf", "BuildTileListsCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FFluidClearTilesCS, "/CustomShaders/FluidCS.usf", "ClearTilesCS", SF_Compute);
+
+//Adds a fluid pass over the whole grid, or over the active tiles when Tiles is set
+template<typename ShaderType>
+static void AddFluidPass(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGEventName&& PassName, typename ShaderType::FParameters* PassParameters,
+						 const FFluidTileParameters* Tiles, FIntPoint Size)
+{
+	typename ShaderType::FPermutationDomain PermutationVector;
+	PermutationVector.template Set<FFluidCS::FSparseTilesDim>(Tiles != nullptr);
+	TShaderMapRef<ShaderType> ComputeShader(ShaderMap, PermutationVector);
+	if (Tiles)
+	{
+		PassParameters->Tiles = *Tiles;
+		FComputeShaderUtils::AddPass(GraphBuilder, MoveTemp(PassName), ComputeShader, PassParameters, Tiles->IndirectArgsBuffer, 0);
+	}
+	else
+	{
+		FComputeShaderUtils::AddPass(GraphBuilder, MoveTemp(PassName), ComputeShader, PassParameters, FComputeShaderUtils::GetGroupCount(Size, NUM_THREADS_PER_GROUP_DIMENSION));
+	}
+}
+
+
+bool FFluidSimulation::AllocateTargets(FRHICommandListImmediate& RHICmdList, FIntPoint Size, EPixelFormat DyeFormat)
+{
+	auto MakeDesc = [Size](EPixelFormat Format)
+	{
+		return FPooledRenderTargetDesc::Create2DDesc(Size, Format, FClearValueBinding::Black, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+	};
+
+	//Not short-circuited, every field has to be allocated
+	bool bReallocated = Velocity.Allocate(RHICmdList, MakeDesc(PF_G32R32F), TEXT("FluidVelocity"));
+	bReallocated |= Pressure.Allocate(RHICmdList, MakeDesc(PF_R32_FLOAT), TEXT("FluidPressure"));
+	bReallocated |= Dye.Allocate(RHICmdList, MakeDesc(DyeFormat), TEXT("FluidDye"));
+
+	if (bReallocated || !TileDispatched.IsValid())
+	{
+		const FPooledRenderTargetDesc TileDesc = FPooledRenderTargetDesc::Create2DDesc(GetTileGridSize(Size), PF_R32_UINT, FClearValueBinding::Black,
+																				   TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+		GRenderTargetPool.FindFreeElement(RHICmdList, TileDesc, TileDispatched, TEXT("FluidTileDispatched"));
+	}
+	return bReallocated;
+}
+
+FIntPoint FFluidSimulation::GetTileGridSize(FIntPoint Size)
+{
+	return FIntPoint(FMath::DivideAndRoundUp(Size.X, NUM_THREADS_PER_GROUP_DIMENSION), FMath::DivideAndRoundUp(Size.Y, NUM_THREADS_PER_GROUP_DIMENSION));
+}
+
+FFluidTileParameters FFluidSimulation::AddTileClassification(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FFluidSimulationParameters& Parameters,
+															 const FFluidCommonParameters& Common, bool bReallocated)
+{
+	RDG_EVENT_SCOPE(GraphBuilder, "FluidTiles");
+	const FIntPoint Size = Parameters.SimulationSize;
+	const FIntPoint TileGridSize = GetTileGridSize(Size);
+	const int32 NumTiles = TileGridSize.X * TileGridSize.Y;
+
+	FRDGTextureRef TileDispatchedTexture = GraphBuilder.RegisterExternalTexture(TileDispatched, TEXT("FluidTileDispatched"), ERenderTargetTexture::ShaderResource, ERDGTextureFlags::MultiFrame);
+	FRDGTextureUAVRef TileDispatchedUAV = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(TileDispatchedTexture));
+	//A new simulation has nothing to retire. Coming from the dense mode, every tile counts as dispatched so the idle ones get retired on this step
+	if (bReallocated || !bLastStepSparse)
+	{
+		const uint32 ClearValues[4] = { bReallocated ? 0u : 1u, 0u, 0u, 0u };
+		AddClearUAVPass(GraphBuilder, TileDispatchedUAV, ClearValues);
+	}
+
+	FRDGTextureRef TileActivity = GraphBuilder.CreateTexture(
+		FRDGTextureDesc::Create2DDesc(TileGridSize, PF_R32_UINT, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false),
+		TEXT("FluidTileActivity"));
+	FRDGBufferRef IndirectArgs = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateIndirectDesc(6), TEXT("FluidTileIndirectArgs"));
+	FRDGBufferRef TileList = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), NumTiles), TEXT("FluidTileList"));
+	FRDGBufferRef RetiredTileList = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), NumTiles), TEXT("FluidRetiredTileList"));
+	FRDGBufferUAVRef IndirectArgsUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(IndirectArgs, PF_R32_UINT));
+
+	{
+		TShaderMapRef<FFluidClassifyTilesCS> ComputeShader(ShaderMap);
+		FFluidClassifyTilesCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidClassifyTilesCS::FParameters>();
+		PassParameters->Common = Common;
+		PassParameters->ActivityThreshold = Parameters.ActivityThreshold;
+		PassParameters->VelocityTexture = Velocity.GetCurrent();
+		PassParameters->DyeTexture = Dye.GetCurrent();
+		PassParameters->OutputTileActivity = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(TileActivity));
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("FluidClassifyTiles"), ComputeShader, PassParameters, FIntVector(TileGridSize.X, TileGridSize.Y, 1));
+	}
+
+	{
+		TShaderMapRef<FFluidInitTileArgsCS> ComputeShader(ShaderMap);
+		FFluidInitTileArgsCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidInitTileArgsCS::FParameters>();
+		PassParameters->OutputIndirectArgs = IndirectArgsUAV;
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("FluidInitTileArgs"), ComputeShader, PassParameters, FIntVector(1, 1, 1));
+	}
+
+	{
+		TShaderMapRef<FFluidBuildTileListsCS> ComputeShader(ShaderMap);
+		FFluidBuildTileListsCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidBuildTileListsCS::FParameters>();
+		PassParameters->TileGridSize = TileGridSize;
+		PassParameters->TileActivityTexture = TileActivity;
+		PassParameters->TileDispatched = TileDispatchedUAV;
+		PassParameters->OutputIndirectArgs = IndirectArgsUAV;
+		PassParameters->OutputTileList = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(TileList, PF_R32_UINT));
+		PassParameters->OutputRetiredTileList = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(RetiredTileList, PF_R32_UINT));
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("FluidBuildTileLists"), ComputeShader, PassParameters,
+									 FComputeShaderUtils::GetGroupCount(TileGridSize, NUM_THREADS_PER_GROUP_DIMENSION));
+	}
+
+	//The retired tiles go back to rest in both buffers, the passes won't touch them until they are active again
+	{
+		TShaderMapRef<FFluidClearTilesCS> ComputeShader(ShaderMap);
+		FFluidClearTilesCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidClearTilesCS::FParameters>();
+		PassParameters->Common = Common;
+		PassParameters->Tiles.TileList = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(RetiredTileList, PF_R32_UINT));
+		PassParameters->Tiles.IndirectArgsBuffer = IndirectArgs;
+		PassParameters->RetiredVelocity0 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Velocity.GetBuffer(0)));
+		PassParameters->RetiredVelocity1 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Velocity.GetBuffer(1)));
+		PassParameters->RetiredPressure0 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Pressure.GetBuffer(0)));
+		PassParameters->RetiredPressure1 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Pressure.GetBuffer(1)));
+		PassParameters->RetiredDye0 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Dye.GetBuffer(0)));
+		PassParameters->RetiredDye1 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Dye.GetBuffer(1)));
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("FluidClearRetiredTiles"), ComputeShader, PassParameters, IndirectArgs, 3 * sizeof(uint32));
+	}
+
+	FFluidTileParameters Tiles;
+	Tiles.TileList = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(TileList, PF_R32_UINT));
+	Tiles.IndirectArgsBuffer = IndirectArgs;
+	return Tiles;
+}
+
+FRDGTextureRef FFluidSimulation::AddStep(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FFluidSimulationParameters& Parameters, EPixelFormat DyeFormat)
+{
+	check(IsInRenderingThread());
+	const FIntPoint Size = Parameters.SimulationSize;
+	check(Size.X > 0 && Size.Y > 0);
+
+	const bool bReallocate = AllocateTargets(GraphBuilder.RHICmdList, Size, DyeFormat);
+	Velocity.Register(GraphBuilder);
+	Pressure.Register(GraphBuilder);
+	Dye.Register(GraphBuilder);
+
+	//A new simulation starts at rest
+	if (bReallocate)
+	{
+		Velocity.AddClearPass(GraphBuilder);
+		Pressure.AddClearPass(GraphBuilder);
+		Dye.AddClearPass(GraphBuilder);
+	}
+
+	FRDGTextureRef Divergence = GraphBuilder.CreateTexture(
+		FRDGTextureDesc::Create2DDesc(Size, PF_R32_FLOAT, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false),
+		TEXT("FluidDivergence"));
+
+	FFluidCommonParameters Common;
+	Common.SimulationSize = Size;
+	Common.DeltaTime = Parameters.DeltaTime;
+	Common.VelocityDissipation = Parameters.VelocityDissipation;
+	Common.DyeDissipation = Parameters.DyeDissipation;
+	Common.EmitterPosition = Parameters.EmitterPosition;
+	Common.EmitterForce = Parameters.EmitterForce;
+	Common.EmitterRadius = Parameters.EmitterRadius;
+	Common.EmitterDye = Parameters.EmitterDye;
+
+	//Sparse mode: the passes below only run over the active tiles and their neighbours, the other tiles are at rest
+	FFluidTileParameters TileParameters;
+	const FFluidTileParameters* Tiles = nullptr;
+	if (Parameters.bUseSparseTiles)
+	{
+		TileParameters = AddTileClassification(GraphBuilder, ShaderMap, Parameters, Common, bReallocate);
+		Tiles = &TileParameters;
+	}
+	bLastStepSparse = Parameters.bUseSparseTiles;
+
+	//Advect the velocity into the other buffer of the pair
+	{
+		FFluidAdvectVelocityCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidAdvectVelocityCS::FParameters>();
+		PassParameters->Common = Common;
+		PassParameters->VelocityTexture = Velocity.GetCurrent();
+		PassParameters->OutputVelocity = Velocity.Advance(GraphBuilder);
+		AddFluidPass<FFluidAdvectVelocityCS>(GraphBuilder, ShaderMap, RDG_EVENT_NAME("FluidAdvectVelocity"), PassParameters, Tiles, Size);
+	}
+
+	{
+		FFluidDivergenceCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidDivergenceCS::FParameters>();
+		PassParameters->Common = Common;
+		PassParameters->VelocityTexture = Velocity.GetCurrent();
+		PassParameters->OutputDivergence = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Divergence));
+		AddFluidPass<FFluidDivergenceCS>(GraphBuilder, ShaderMap, RDG_EVENT_NAME("FluidDivergence"), PassParameters, Tiles, Size);
+	}
+
+	//The multigrid solver and the residual measurement run over the whole grid, the idle tiles have no divergence
+	const bool bReportResidual = CVarFluidReportResidual.GetValueOnRenderThread() != 0;
+	if (Tiles && (Parameters.bUseMultigrid || bReportResidual))
+	{
+		AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Divergence)), FLinearColor::Black);
+	}
+	if (bReportResidual)
+	{
+		ResidualMonitor.BeginFrame(GraphBuilder, Size, Parameters.bUseMultigrid ? Parameters.Multigrid.NumCycles + 1 : 2,
+								   Parameters.bUseMultigrid ? FString::Printf(TEXT("Fluid multigrid %d cycles"), Parameters.Multigrid.NumCycles)
+															: FString::Printf(TEXT("Fluid Jacobi %d iterations"), Parameters.PressureIterations));
+	}
+
+	//The previous frame pressure is the initial guess
+	if (Parameters.bUseMultigrid)
+	{
+		FMultigridPoissonSolver::AddSolve(GraphBuilder, ShaderMap, Pressure.GetCurrent(), Divergence, Size, Parameters.Multigrid,
+										  bReportResidual ? &ResidualMonitor : nullptr);
+	}
+	else
+	{
+		if (bReportResidual)
+		{
+			ResidualMonitor.AddMeasurement(GraphBuilder, ShaderMap, Pressure.GetCurrent(), Divergence);
+		}
+
+		for (int32 Iteration = 0; Iteration < Parameters.PressureIterations; ++Iteration)
+		{
+			FFluidJacobiPressureCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidJacobiPressureCS::FParameters>();
+			PassParameters->Common = Common;
+			PassParameters->PressureTexture = Pressure.GetCurrent();
+			PassParameters->DivergenceTexture = Divergence;
+			PassParameters->OutputPressure = Pressure.Advance(GraphBuilder);
+			AddFluidPass<FFluidJacobiPressureCS>(GraphBuilder, ShaderMap, RDG_EVENT_NAME("FluidJacobiPressure %d", Iteration), PassParameters, Tiles, Size);
+		}
+
+		if (bReportResidual)
+		{
+			ResidualMonitor.AddMeasurement(GraphBuilder, ShaderMap, Pressure.GetCurrent(), Divergence);
+			ResidualMonitor.AddSolverPasses(Parameters.PressureIterations);
+		}
+	}
+
+	{
+		FFluidProjectCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidProjectCS::FParameters>();
+		PassParameters->Common = Common;
+		PassParameters->VelocityTexture = Velocity.GetCurrent();
+		PassParameters->PressureTexture = Pressure.GetCurrent();
+		PassParameters->OutputVelocity = Velocity.Advance(GraphBuilder);
+		AddFluidPass<FFluidProjectCS>(GraphBuilder, ShaderMap, RDG_EVENT_NAME("FluidProject"), PassParameters, Tiles, Size);
+	}
+
+	{
+		FFluidAdvectDyeCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidAdvectDyeCS::FParameters>();
+		PassParameters->Common = Common;
+		PassParameters->VelocityTexture = Velocity.GetCurrent();
+		PassParameters->DyeTexture = Dye.GetCurrent();
+		PassParameters->OutputDye = Dye.Advance(GraphBuilder);
+		AddFluidPass<FFluidAdvectDyeCS>(GraphBuilder, ShaderMap, RDG_EVENT_NAME("FluidAdvectDye"), PassParameters, Tiles, Size);
+	}
+
+	return Dye.GetCurrent();
+}
+
+void FFluidSimulation::OnGraphExecuted(FRHICommandListImmediate& RHICmdList)
+{
+	ResidualMonitor.EndFrame(RHICmdList);
+}
+
+void FFluidSimulation::Release()
+{
+	check(IsInRenderingThread());
+	Velocity.Release();
+	Pressure.Release();
+	Dye.Release();
+	TileDispatched.SafeRelease();
+	bLastStepSparse = false;
+}
+
+void FFluidSimulation::RunSolverBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, float RelativeResidual, int32 MaxJacobiIterations)
+{
+	check(IsInRenderingThread());
+	Size = FMath::Clamp(Size, 16, 4096);
+	RelativeResidual = FMath::Clamp(RelativeResidual, 1e-6f, 1.f);
+	const FIntPoint GridSize(Size, Size);
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+
+	//A source and a sink the size of an emitter over some noise. The low frequencies are what Jacobi is slow on.
+	//With the closed border there is only a solution when the right hand side sums to zero, so the mean is removed
+	TArray<float> RightHandSide;
+	TArray<uint32> Unused;
+	FPrimitivesCPU::FillRandom(1, Size * Size, RightHandSide, Unused);
+	const float RadiusSquared = FMath::Square(Size / 16.f);
+	double Sum = 0.0;
+	for (int32 Y = 0; Y < Size; ++Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			const float Source = FMath::Exp(-FVector2D(X - Size * 0.3f, Y - Size * 0.3f).SizeSquared() / RadiusSquared);
+			const float Sink = FMath::Exp(-FVector2D(X - Size * 0.7f, Y - Size * 0.7f).SizeSquared() / RadiusSquared);
+			float& Value = RightHandSide[Y * Size + X];
+			Value = (Value - 0.5f) * 0.1f + Source - Sink;
+			Sum += Value;
+		}
+	}
+	const float Mean = (float)(Sum / RightHandSide.Num());
+	for (float& Value : RightHandSide)
+	{
+		Value -= Mean;
+	}
+
+	TArray<float> Solution;
+	Solution.Init(0.f, RightHandSide.Num());
+	const double InitialResidual = FFluidSimulationCPU::ComputeResidualNorm(Solution, RightHandSide, GridSize);
+	const double TargetResidual = InitialResidual * RelativeResidual;
+	TRefCountPtr<IPooledRenderTarget> RightHandSideTarget = FComputeBenchmark::UploadFloatTexture(RHICmdList, GridSize, RightHandSide, TEXT("FluidBenchmarkRightHandSide"));
+
+	//Both solvers start from zero and run batch after batch, the residual is measured on the CPU between two batches so it isn't in the GPU time
+	struct FSolverResult
+	{
+		int32 NumBatches = 0;
+		int32 NumPasses = 0;
+		double GPUMilliseconds = 0.0;
+		double Residual = 0.0;
+	};
+	auto Solve = [&](int32 MaxBatches, TFunctionRef<int32(FRDGBuilder&, TRefCountPtr<IPooledRenderTarget>&)> AddBatch, TRefCountPtr<IPooledRenderTarget>& Result)
+	{
+		FSolverResult SolverResult;
+		SolverResult.Residual = InitialResidual;
+		for (; SolverResult.Residual > TargetResidual && SolverResult.NumBatches < MaxBatches; ++SolverResult.NumBatches)
+		{
+			int32 NumBatchPasses = 0;
+			SolverResult.GPUMilliseconds += FComputeBenchmark::TimeGraphs(RHICmdList, 1, [&](FRDGBuilder& GraphBuilder)
+			{
+				NumBatchPasses = AddBatch(GraphBuilder, Result);
+			});
+			SolverResult.NumPasses += NumBatchPasses;
+			FComputeBenchmark::ReadbackFloatTexture(RHICmdList, Result, Solution);
+			SolverResult.Residual = FFluidSimulationCPU::ComputeResidualNorm(Solution, RightHandSide, GridSize);
+		}
+		return SolverResult;
+	};
+
+	//Jacobi ping-pongs between two textures, an even batch leaves the solution where it started. Its residual is checked every batch,
+	//so its pass count is rounded up to JacobiBatchSize. The Jacobi pass only reads the simulation size of the common parameters
+	const int32 JacobiBatchSize = 50;
+	FFluidCommonParameters Common;
+	Common.SimulationSize = GridSize;
+	Solution.Init(0.f, RightHandSide.Num());
+	TRefCountPtr<IPooledRenderTarget> JacobiSolution = FComputeBenchmark::UploadFloatTexture(RHICmdList, GridSize, Solution, TEXT("FluidBenchmarkJacobi"));
+	TRefCountPtr<IPooledRenderTarget> JacobiScratch = FComputeBenchmark::UploadFloatTexture(RHICmdList, GridSize, Solution, TEXT("FluidBenchmarkJacobiScratch"));
+	const FSolverResult Jacobi = Solve(FMath::DivideAndRoundUp(FMath::Max(MaxJacobiIterations, 1), JacobiBatchSize), [&](FRDGBuilder& GraphBuilder, TRefCountPtr<IPooledRenderTarget>& Result)
+	{
+		FRDGTextureRef Buffers[2] = {
+			GraphBuilder.RegisterExternalTexture(JacobiSolution, TEXT("FluidBenchmarkJacobi")),
+			GraphBuilder.RegisterExternalTexture(JacobiScratch, TEXT("FluidBenchmarkJacobiScratch")) };
+		FRDGTextureRef RightHandSideTexture = GraphBuilder.RegisterExternalTexture(RightHandSideTarget, TEXT("FluidBenchmarkRightHandSide"));
+		for (int32 Iteration = 0; Iteration < JacobiBatchSize; ++Iteration)
+		{
+			FFluidJacobiPressureCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FFluidJacobiPressureCS::FParameters>();
+			PassParameters->Common = Common;
+			PassParameters->PressureTexture = Buffers[Iteration & 1];
+			PassParameters->DivergenceTexture = RightHandSideTexture;
+			PassParameters->OutputPressure = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Buffers[(Iteration + 1) & 1]));
+			AddFluidPass<FFluidJacobiPressureCS>(GraphBuilder, ShaderMap, RDG_EVENT_NAME("FluidJacobiPressure %d", Iteration), PassParameters, nullptr, GridSize);
+		}
+		GraphBuilder.QueueTextureExtraction(Buffers[0], &Result);
+		return JacobiBatchSize;
+	}, JacobiSolution);
+
+	//One V-cycle per batch, solved in place
+	FMultigridSettings Settings;
+	Settings.NumCycles = 1;
+	const int32 MaxCycles = 100;
+	Solution.Init(0.f, RightHandSide.Num());
+	TRefCountPtr<IPooledRenderTarget> MultigridSolution = FComputeBenchmark::UploadFloatTexture(RHICmdList, GridSize, Solution, TEXT("FluidBenchmarkMultigrid"));
+	const FSolverResult Multigrid = Solve(MaxCycles, [&](FRDGBuilder& GraphBuilder, TRefCountPtr<IPooledRenderTarget>& Result)
+	{
+		FRDGTextureRef SolutionTexture = GraphBuilder.RegisterExternalTexture(MultigridSolution, TEXT("FluidBenchmarkMultigrid"));
+		FRDGTextureRef RightHandSideTexture = GraphBuilder.RegisterExternalTexture(RightHandSideTarget, TEXT("FluidBenchmarkRightHandSide"));
+		const int32 NumPasses = FMultigridPoissonSolver::AddSolve(GraphBuilder, ShaderMap, SolutionTexture, RightHandSideTexture, GridSize, Settings);
+		GraphBuilder.QueueTextureExtraction(SolutionTexture, &Result);
+		return NumPasses;
+	}, MultigridSolution);
+
+	UE_LOG(LogTemp, Log, TEXT("Pressure solve %dx%d, initial residual %.3e, target %.3e (x%g)"), Size, Size, InitialResidual, TargetResidual, RelativeResidual);
+	UE_LOG(LogTemp, Log, TEXT("Jacobi:    %6d passes, GPU %8.3f ms, residual %.3e%s"), Jacobi.NumPasses, Jacobi.GPUMilliseconds, Jacobi.Residual,
+		Jacobi.Residual > TargetResidual ? TEXT(", target not reached") : TEXT(""));
+	UE_LOG(LogTemp, Log, TEXT("Multigrid: %6d passes, GPU %8.3f ms, residual %.3e after %d V-cycles%s"), Multigrid.NumPasses, Multigrid.GPUMilliseconds,
+		Multigrid.Residual, Multigrid.NumBatches, Multigrid.Residual > TargetResidual ? TEXT(", target not reached") : TEXT(""));
+}
+
+void FFluidSimulation::RunValidation(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumSteps, bool bUseMultigrid, bool bUseSparseTiles)
+{
+	check(IsInRenderingThread());
+	Size = FMath::Clamp(Size, 16, 2048);
+	NumSteps = FMath::Max(NumSteps, 1);
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+
+	//An emitter below the center pushing dye up, slow enough for the tile dilation of the sparse mode
+	FFluidSimulationParameters Parameters;
+	Parameters.SimulationSize = FIntPoint(Size, Size);
+	Parameters.bUseMultigrid = bUseMultigrid;
+	Parameters.bUseSparseTiles = bUseSparseTiles;
+	Parameters.EmitterPosition = FVector2D(Size * 0.5f, Size * 0.25f);
+	Parameters.EmitterForce = FVector2D(0.f, 120.f);
+	Parameters.EmitterRadius = Size / 32.f;
+
+	//The CPU only simulates the first dye channel, a single channel dye is read back as is
+	FFluidSimulation Simulation;
+	FFluidSimulationCPU Reference;
+	const int32 NumCells = Size * Size;
+	double CPUSeconds = 0.0;
+	float MaxDifference = 0.f;
+	int32 NumTileMismatches = 0;
+	for (int32 StepIndex = 0; StepIndex < NumSteps; ++StepIndex)
+	{
+		TRefCountPtr<IPooledRenderTarget> GPUVelocity;
+		TRefCountPtr<IPooledRenderTarget> GPUPressure;
+		TRefCountPtr<IPooledRenderTarget> GPUDye;
+		{
+			FRDGBuilder GraphBuilder(RHICmdList);
+			GraphBuilder.QueueTextureExtraction(Simulation.AddStep(GraphBuilder, ShaderMap, Parameters, PF_R32_FLOAT), &GPUDye);
+			GraphBuilder.QueueTextureExtraction(Simulation.Velocity.GetCurrent(), &GPUVelocity);
+			GraphBuilder.QueueTextureExtraction(Simulation.Pressure.GetCurrent(), &GPUPressure);
+			GraphBuilder.Execute();
+			Simulation.OnGraphExecuted(RHICmdList);
+		}
+
+		const double CPUStart = FPlatformTime::Seconds();
+		Reference.Step(Parameters);
+		CPUSeconds += FPlatformTime::Seconds() - CPUStart;
+
+		//PF_G32R32F, two floats per cell
+		TArray<uint8> VelocityTexels;
+		TArray<float> Pressure;
+		TArray<float> Dye;
+		FComputeBenchmark::ReadbackTexture(RHICmdList, GPUVelocity, VelocityTexels);
+		FComputeBenchmark::ReadbackFloatTexture(RHICmdList, GPUPressure, Pressure);
+		FComputeBenchmark::ReadbackFloatTexture(RHICmdList, GPUDye, Dye);
+		const float* Velocities = reinterpret_cast<const float*>(VelocityTexels.GetData());
+
+		float VelocityDifference = 0.f;
+		float PressureDifference = 0.f;
+		float DyeDifference = 0.f;
+		for (int32 Index = 0; Index < NumCells; ++Index)
+		{
+			VelocityDifference = FMath::Max3(VelocityDifference, FMath::Abs(Velocities[Index * 2] - Reference.GetVelocityX()[Index]),
+											 FMath::Abs(Velocities[Index * 2 + 1] - Reference.GetVelocityY()[Index]));
+			PressureDifference = FMath::Max(PressureDifference, FMath::Abs(Pressure[Index] - Reference.GetPressure()[Index]));
+			DyeDifference = FMath::Max(DyeDifference, FMath::Abs(Dye[Index] - Reference.GetDye()[Index]));
+		}
+
+		//The tiles BuildTileListsCS flagged as dispatched have to be the ones the CPU walked
+		FString TileReport;
+		if (bUseSparseTiles)
+		{
+			TArray<uint8> TileTexels;
+			FComputeBenchmark::ReadbackTexture(RHICmdList, Simulation.TileDispatched, TileTexels);
+			const uint32* GPUTiles = reinterpret_cast<const uint32*>(TileTexels.GetData());
+			const TArray<uint8>& CPUTiles = Reference.GetDispatchedTiles();
+			int32 NumDispatched = 0;
+			int32 NumStepMismatches = 0;
+			for (int32 TileIndex = 0; TileIndex < CPUTiles.Num(); ++TileIndex)
+			{
+				NumDispatched += CPUTiles[TileIndex];
+				NumStepMismatches += (GPUTiles[TileIndex] != 0) != (CPUTiles[TileIndex] != 0) ? 1 : 0;
+			}
+			NumTileMismatches += NumStepMismatches;
+			TileReport = FString::Printf(TEXT(", %d/%d tiles dispatched, %d differ"), NumDispatched, CPUTiles.Num(), NumStepMismatches);
+		}
+
+		const float StepDifference = FMath::Max3(VelocityDifference, PressureDifference, DyeDifference);
+		MaxDifference = FMath::Max(MaxDifference, StepDifference);
+		UE_LOG(LogTemp, Log, TEXT("Step %3d: max difference velocity %.3e, pressure %.3e, dye %.3e%s%s"), StepIndex + 1, VelocityDifference, PressureDifference,
+			DyeDifference, *TileReport, StepDifference > FFluidSimulationCPU::GPUTolerance ? TEXT(" over the tolerance") : TEXT(""));
+	}
+	Simulation.Release();
+
+	UE_LOG(LogTemp, Log, TEXT("Fluid %dx%d %s%s, %d steps: max difference %.3e, %s the tolerance %g. CPU reference %.3f ms per step"), Size, Size,
+		bUseMultigrid ? TEXT("multigrid") : TEXT("Jacobi"), bUseSparseTiles ? TEXT(" sparse") : TEXT(""), NumSteps, MaxDifference,
+		MaxDifference <= FFluidSimulationCPU::GPUTolerance ? TEXT("within") : TEXT("OVER"), FFluidSimulationCPU::GPUTolerance, CPUSeconds * 1000.0 / NumSteps);
+	if (bUseSparseTiles)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Sparse tiles: %d dispatched tiles differ from the CPU over the %d steps"), NumTileMismatches, NumSteps);
+	}
+}
+
+
+//Static members
+FFluidCSManager* FFluidCSManager::instance = nullptr;
+
+void FFluidCSManager::BeginRendering()
+{
+	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
+	{
+		return;
+	}
+
+	ENQUEUE_RENDER_COMMAND(FluidStepCommand)
+		(
+			[Parameters = cachedParams](FRHICommandListImmediate& RHICmdList)
+			{
+				FFluidCSManager::Get()->UpdateResults(RHICmdList, Parameters);
+			}
+		);
+}
+
+void FFluidCSManager::EndRendering()
+{
+	bCachedParamsAreValid = false;
+	ENQUEUE_RENDER_COMMAND(FluidReleaseCommand)
+		(
+			[](FRHICommandListImmediate& RHICmdList)
+			{
+				FFluidCSManager::Get()->Simulation.Release();
+			}
+		);
+}
+
+void FFluidCSManager::UpdateParameters(const FFluidCSParameters& Parameters)
+{
+	cachedParams = Parameters;
+	bCachedParamsAreValid = true;
+}
+
+void FFluidCSManager::UpdateResults(FRHICommandListImmediate& RHICmdList, const FFluidCSParameters& Parameters)
+{
+	check(IsInRenderingThread());
+	FTextureRenderTargetResource* RenderTargetResource = Parameters.RenderTarget->GetRenderTargetResource();
+	if (!RenderTargetResource || Parameters.Simulation.SimulationSize.X <= 0 || Parameters.Simulation.SimulationSize.Y <= 0)
+	{
+		return;
+	}
+
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	FTexture2DRHIRef OutTexture = RenderTargetResource->GetRenderTargetTexture();
+
+	FRDGBuilder GraphBuilder(RHICmdList);
+	FRDGTextureRef DyeTexture = Simulation.AddStep(GraphBuilder, ShaderMap, Parameters.Simulation, OutTexture->GetFormat());
+
+	TRefCountPtr<IPooledRenderTarget> PooledDye;
+	GraphBuilder.QueueTextureExtraction(DyeTexture, &PooledDye);
+	GraphBuilder.Execute();
+	Simulation.OnGraphExecuted(RHICmdList);
+
+	RHICmdList.CopyTexture(PooledDye->GetRenderTargetItem().ShaderResourceTexture, OutTexture, FRHICopyTextureInfo());
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+#include "Runtime/Engine/Classes/Engine/TextureRenderTarget2D.h"
+#include "MultigridSolver.h"
+#include "PingPongTexture.h"
+
+struct FFluidCommonParameters;
+struct FFluidTileParameters;
+
+//Everything that drives one step of the fluid simulation. Positions are in cells, velocities in cells per second
+struct FFluidSimulationParameters
+{
+	FIntPoint SimulationSize = FIntPoint::ZeroValue;
+	float DeltaTime = 1.f / 60.f;
+	//Jacobi iterations, used when bUseMultigrid is false
+	int32 PressureIterations = 40;
+	//Solves the pressure with multigrid V-cycles instead of Jacobi iterations
+	bool bUseMultigrid = false;
+	FMultigridSettings Multigrid;
+	//Only simulates the tiles where something happens and their neighbours, the rest of the grid stays at rest. See FFluidSimulation
+	bool bUseSparseTiles = false;
+	//A tile is active when a velocity component or the dye of one of its cells, or the emitter weight, is above this
+	float ActivityThreshold = 1e-3f;
+	//Fraction of the velocity and the dye kept every step
+	float VelocityDissipation = 0.999f;
+	float DyeDissipation = 0.995f;
+	//Gaussian emitter, disabled when EmitterRadius is 0
+	FVector2D EmitterPosition = FVector2D::ZeroVector;
+	FVector2D EmitterForce = FVector2D::ZeroVector;
+	float EmitterRadius = 0.f;
+	float EmitterDye = 1.f;
+};
+
+/// <summary>
+/// GPU Eulerian fluid solver: advection, divergence, Jacobi pressure solve, projection and dye advection
+/// Velocity, pressure and dye are ping-pong textures that persist across frames, the pressure is warm started from the previous frame
+/// All the calls happen on the render thread
+///
+/// In sparse mode the grid is split in 8x8 tiles, one per thread group. A classification pass flags the active tiles, they are dilated by one tile
+/// and compacted into a list the passes are dispatched over indirectly, so the cost follows the active area. The tiles that leave the list are cleared
+/// in both buffers of every field. Only the multigrid solver, when used, still runs over the whole grid.
+/// The dilation assumes the flow moves less than a tile per step
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FFluidSimulation
+{
+public:
+	//Adds the passes of one simulation step to the graph and returns the dye after the step. The textures are (re)allocated when the size or the dye format change
+	FRDGTextureRef AddStep(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FFluidSimulationParameters& Parameters, EPixelFormat DyeFormat);
+
+	//Call once the graph AddStep was called with has been executed
+	void OnGraphExecuted(FRHICommandListImmediate& RHICmdList);
+
+	//Returns the pooled targets to the pool
+	void Release();
+
+	//Solves the same Size x Size pressure problem with Jacobi iterations and with multigrid V-cycles until the residual is RelativeResidual times the
+	//initial one, and logs the passes, the GPU time and the final residual of each. Stalls the GPU, render thread only
+	static void RunSolverBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, float RelativeResidual, int32 MaxJacobiIterations);
+
+	//Runs NumSteps steps of an emitter on the GPU and on FFluidSimulationCPU and logs the largest difference of velocity, pressure and dye of each step
+	//against FFluidSimulationCPU::GPUTolerance, and in sparse mode the tiles TileDispatched disagrees on. Stalls the GPU, render thread only
+	static void RunValidation(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumSteps, bool bUseMultigrid, bool bUseSparseTiles);
+
+private:
+	//Returns true when the fields were (re)allocated and have to be reset
+	bool AllocateTargets(FRHICommandListImmediate& RHICmdList, FIntPoint Size, EPixelFormat DyeFormat);
+
+	//Builds the active tile list of this step and retires the tiles that went idle
+	FFluidTileParameters AddTileClassification(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FFluidSimulationParameters& Parameters,
+											   const FFluidCommonParameters& Common, bool bReallocated);
+
+	static FIntPoint GetTileGridSize(FIntPoint Size);
+
+	FPingPongTexture Velocity;
+	FPingPongTexture Pressure;
+	FPingPongTexture Dye;
+
+	//1 for the tiles the last sparse step was dispatched over
+	TRefCountPtr<IPooledRenderTarget> TileDispatched;
+	bool bLastStepSparse = false;
+
+	//Reports the pressure solver convergence when CustomShaders.Fluid.ReportResidual is set
+	FPoissonResidualMonitor ResidualMonitor;
+};
+
+
+//This struct act as a container for all the parameters that the client needs to pass to the Fluid Manager.
+struct FFluidCSParameters
+{
+	//Receives the dye every frame, its size is the simulation size
+	UTextureRenderTarget2D* RenderTarget = nullptr;
+	FFluidSimulationParameters Simulation;
+
+	FFluidCSParameters() { }
+	FFluidCSParameters(UTextureRenderTarget2D* IORenderTarget)
+		: RenderTarget(IORenderTarget)
+	{
+		Simulation.SimulationSize = RenderTarget ? FIntPoint(RenderTarget->SizeX, RenderTarget->SizeY) : FIntPoint::ZeroValue;
+	}
+};
+
+
+/// <summary>
+/// A singleton manager that steps the fluid simulation once per frame and copies the dye into the client render target
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FFluidCSManager
+{
+public:
+	//Get the instance
+	static FFluidCSManager* Get()
+	{
+		if (!instance)
+			instance = new FFluidCSManager();
+		return instance;
+	};
+
+	// Steps the simulation once on the render thread with the last parameters
+	void BeginRendering();
+
+	// Releases the simulation state
+	void EndRendering();
+
+	// Call this whenever you have new parameters to share.
+	void UpdateParameters(const FFluidCSParameters& Parameters);
+
+	void UpdateResults(FRHICommandListImmediate& RHICmdList, const FFluidCSParameters& Parameters);
+
+private:
+	//Private constructor to prevent client from instanciating
+	FFluidCSManager() = default;
+
+	//The singleton instance
+	static FFluidCSManager* instance;
+
+	//Cached parameters, written on the game thread and copied to the render thread by BeginRendering
+	FFluidCSParameters cachedParams;
+	bool bCachedParamsAreValid = false;
+
+	//Render thread state
+	FFluidSimulation Simulation;
+};
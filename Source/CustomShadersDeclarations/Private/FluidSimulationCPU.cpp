@@ -0,0 +1,507 @@
+#include "FluidSimulationCPU.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Core/TileScheduling.h"
+
+namespace
+{
+	//ParallelFor that keeps at most MaxWorkers threads busy, every worker when MaxWorkers is 0
+	template<typename FunctionType>
+	void ParallelForWorkers(int32 Num, int32 MaxWorkers, FunctionType Function)
+	{
+		if (MaxWorkers <= 0)
+		{
+			ParallelFor(Num, Function);
+			return;
+		}
+
+		//MaxWorkers tasks that pull the items until there are none left
+		FThreadSafeCounter NextIndex;
+		ParallelFor(FMath::Min(MaxWorkers, Num), [&NextIndex, &Function, Num](int32)
+		{
+			for (int32 Index = NextIndex.Increment() - 1; Index < Num; Index = NextIndex.Increment() - 1)
+			{
+				Function(Index);
+			}
+		}, MaxWorkers == 1);
+	}
+
+	//Runs Function(MinX, MinY, MaxX, MaxY) on every tile in parallel, max bounds are exclusive
+	template<typename FunctionType>
+	void ForEachTile(const TArray<FIntRect>& Tiles, int32 MaxWorkers, FunctionType Function)
+	{
+		ParallelForWorkers(Tiles.Num(), MaxWorkers, [&Function, &Tiles](int32 TileIndex)
+		{
+			const FIntRect& Tile = Tiles[TileIndex];
+			Function(Tile.Min.X, Tile.Min.Y, Tile.Max.X, Tile.Max.Y);
+		});
+	}
+
+	//Walks [MinX, MaxX) of row Y. Interior cells go to VectorOp 4 at a time, the border cells and the leftovers to ScalarOp,
+	//which has to handle any cell
+	template<typename ScalarOpType, typename VectorOpType>
+	FORCEINLINE void ForEachCellInRow(FIntPoint Size, int32 Y, int32 MinX, int32 MaxX, ScalarOpType ScalarOp, VectorOpType VectorOp)
+	{
+		int32 X = MinX;
+		if (Y > 0 && Y < Size.Y - 1)
+		{
+			if (X == 0)
+			{
+				ScalarOp(X++);
+			}
+			const int32 InteriorEnd = FMath::Min(MaxX, Size.X - 1);
+			for (; X + 4 <= InteriorEnd; X += 4)
+			{
+				VectorOp(X);
+			}
+		}
+		for (; X < MaxX; ++X)
+		{
+			ScalarOp(X);
+		}
+	}
+
+	FORCEINLINE float LoadClamped(const float* Field, FIntPoint Size, int32 X, int32 Y)
+	{
+		return Field[FMath::Clamp(Y, 0, Size.Y - 1) * Size.X + FMath::Clamp(X, 0, Size.X - 1)];
+	}
+
+	//Mirrors the manual bilinear filter of FluidCS.usf
+	FORCEINLINE float SampleBilinear(const float* Field, FIntPoint Size, float PositionX, float PositionY)
+	{
+		const float BaseX = FMath::FloorToFloat(PositionX);
+		const float BaseY = FMath::FloorToFloat(PositionY);
+		const float FractionX = PositionX - BaseX;
+		const float FractionY = PositionY - BaseY;
+		const int32 X = (int32)BaseX;
+		const int32 Y = (int32)BaseY;
+		const float Bottom = FMath::Lerp(LoadClamped(Field, Size, X, Y), LoadClamped(Field, Size, X + 1, Y), FractionX);
+		const float Top = FMath::Lerp(LoadClamped(Field, Size, X, Y + 1), LoadClamped(Field, Size, X + 1, Y + 1), FractionX);
+		return FMath::Lerp(Bottom, Top, FractionY);
+	}
+
+	FORCEINLINE float EmitterWeight(const FFluidSimulationParameters& Parameters, int32 X, int32 Y)
+	{
+		if (Parameters.EmitterRadius <= 0.f)
+		{
+			return 0.f;
+		}
+		const FVector2D Offset = FVector2D((float)X, (float)Y) - Parameters.EmitterPosition;
+		return FMath::Exp(-(Offset | Offset) / (Parameters.EmitterRadius * Parameters.EmitterRadius));
+	}
+
+	FORCEINLINE float SumNeighboursClamped(const float* Field, FIntPoint Size, int32 X, int32 Y)
+	{
+		return LoadClamped(Field, Size, X - 1, Y) + LoadClamped(Field, Size, X + 1, Y)
+			 + LoadClamped(Field, Size, X, Y - 1) + LoadClamped(Field, Size, X, Y + 1);
+	}
+
+	//Mirrors SmoothCS: one color of a red-black Gauss-Seidel sweep, in place
+	void MultigridSmooth(float* Solution, const float* RightHandSide, FIntPoint Size, float GridSpacingSquared, int32 Parity, int32 MaxWorkers)
+	{
+		ParallelForWorkers(Size.Y, MaxWorkers, [=](int32 Y)
+		{
+			for (int32 X = (Y + Parity) & 1; X < Size.X; X += 2)
+			{
+				Solution[Y * Size.X + X] = (SumNeighboursClamped(Solution, Size, X, Y) - GridSpacingSquared * RightHandSide[Y * Size.X + X]) * 0.25f;
+			}
+		});
+	}
+
+	//Mirrors RestrictResidualCS
+	void MultigridRestrictResidual(const float* FineSolution, const float* FineRightHandSide, FIntPoint FineSize, float FineGridSpacingSquared,
+								   float* CoarseRightHandSide, FIntPoint CoarseSize, int32 MaxWorkers)
+	{
+		ParallelForWorkers(CoarseSize.Y, MaxWorkers, [=](int32 Y)
+		{
+			for (int32 X = 0; X < CoarseSize.X; ++X)
+			{
+				float Sum = 0.f;
+				for (int32 ChildY = 0; ChildY < 2; ++ChildY)
+				{
+					for (int32 ChildX = 0; ChildX < 2; ++ChildX)
+					{
+						const int32 FineX = FMath::Min(X * 2 + ChildX, FineSize.X - 1);
+						const int32 FineY = FMath::Min(Y * 2 + ChildY, FineSize.Y - 1);
+						const int32 FineIndex = FineY * FineSize.X + FineX;
+						const float Laplacian = (SumNeighboursClamped(FineSolution, FineSize, FineX, FineY) - 4.f * FineSolution[FineIndex]) / FineGridSpacingSquared;
+						Sum += FineRightHandSide[FineIndex] - Laplacian;
+					}
+				}
+				CoarseRightHandSide[Y * CoarseSize.X + X] = Sum * 0.25f;
+			}
+		});
+	}
+
+	//Mirrors ProlongateCS
+	void MultigridProlongate(float* Solution, FIntPoint Size, const float* CoarseSolution, FIntPoint CoarseSize, int32 MaxWorkers)
+	{
+		ParallelForWorkers(Size.Y, MaxWorkers, [=](int32 Y)
+		{
+			for (int32 X = 0; X < Size.X; ++X)
+			{
+				const float PositionX = ((float)X + 0.5f) * 0.5f - 0.5f;
+				const float PositionY = ((float)Y + 0.5f) * 0.5f - 0.5f;
+				Solution[Y * Size.X + X] += SampleBilinear(CoarseSolution, CoarseSize, PositionX, PositionY);
+			}
+		});
+	}
+}
+
+void FFluidSimulationCPU::Step(const FFluidSimulationParameters& Parameters)
+{
+	check(Parameters.SimulationSize.X > 0 && Parameters.SimulationSize.Y > 0);
+	if (Size != Parameters.SimulationSize)
+	{
+		Size = Parameters.SimulationSize;
+		const int32 NumCells = Size.X * Size.Y;
+		for (TArray<float>* Field : { &VelocityX, &VelocityY, &Pressure, &Divergence, &Dye, &ScratchX, &ScratchY })
+		{
+			Field->Init(0.f, NumCells);
+		}
+		MultigridLevels.Reset();
+
+		TileGridSize = FIntPoint(FMath::DivideAndRoundUp(Size.X, ActivityTileSize), FMath::DivideAndRoundUp(Size.Y, ActivityTileSize));
+		TileActive.Init(0, TileGridSize.X * TileGridSize.Y);
+		TileDispatched.Init(0, TileGridSize.X * TileGridSize.Y);
+		//A new simulation has nothing to retire
+		bLastStepSparse = true;
+	}
+
+	if (Parameters.bUseSparseTiles)
+	{
+		//Coming from the dense mode, every tile counts as dispatched so the idle ones get retired on this step
+		if (!bLastStepSparse)
+		{
+			FMemory::Memset(TileDispatched.GetData(), 1, TileDispatched.Num());
+		}
+		BuildSparseWorkTiles(Parameters);
+	}
+	else
+	{
+		BuildDenseWorkTiles();
+	}
+	bLastStepSparse = Parameters.bUseSparseTiles;
+
+	AdvectVelocity(Parameters);
+	ComputeDivergence();
+	if (Parameters.bUseMultigrid)
+	{
+		SolvePressureMultigrid(Parameters.Multigrid);
+	}
+	else
+	{
+		SolvePressureJacobi(Parameters.PressureIterations);
+	}
+	Project();
+	AdvectDye(Parameters);
+}
+
+void FFluidSimulationCPU::BuildDenseWorkTiles()
+{
+	WorkTiles.Reset();
+	FTileScheduling::ForEachDenseTile(Size.X, Size.Y, TileSize, [this](const FTileRect& Tile)
+	{
+		WorkTiles.Add(FIntRect(Tile.MinX, Tile.MinY, Tile.MaxX, Tile.MaxY));
+	});
+}
+
+void FFluidSimulationCPU::BuildSparseWorkTiles(const FFluidSimulationParameters& Parameters)
+{
+	//Mirrors ClassifyTilesCS
+	ParallelForWorkers(TileGridSize.Y, MaxWorkers, [this, &Parameters](int32 TileY)
+	{
+		for (int32 TileX = 0; TileX < TileGridSize.X; ++TileX)
+		{
+			bool bActive = false;
+			const int32 MaxX = FMath::Min((TileX + 1) * ActivityTileSize, Size.X);
+			const int32 MaxY = FMath::Min((TileY + 1) * ActivityTileSize, Size.Y);
+			for (int32 Y = TileY * ActivityTileSize; Y < MaxY && !bActive; ++Y)
+			{
+				for (int32 X = TileX * ActivityTileSize; X < MaxX && !bActive; ++X)
+				{
+					const int32 Index = Y * Size.X + X;
+					bActive = FMath::Max(FMath::Abs(VelocityX[Index]), FMath::Abs(VelocityY[Index])) > Parameters.ActivityThreshold
+						|| Dye[Index] > Parameters.ActivityThreshold
+						|| EmitterWeight(Parameters, X, Y) > Parameters.ActivityThreshold;
+				}
+			}
+			TileActive[TileY * TileGridSize.X + TileX] = bActive ? 1 : 0;
+		}
+	});
+
+	//Mirrors BuildTileListsCS. The tiles that stop being dispatched are cleared
+	for (int32 TileY = 0; TileY < TileGridSize.Y; ++TileY)
+	{
+		for (int32 TileX = 0; TileX < TileGridSize.X; ++TileX)
+		{
+			const bool bDispatch = FTileScheduling::IsTileDispatched(TileActive.GetData(), TileGridSize.X, TileGridSize.Y, TileX, TileY);
+			uint8& bWasDispatched = TileDispatched[TileY * TileGridSize.X + TileX];
+			if (!bDispatch && bWasDispatched)
+			{
+				RetireTile(TileX, TileY);
+			}
+			bWasDispatched = bDispatch ? 1 : 0;
+		}
+	}
+
+	//Merges the dispatched tiles of a row into runs up to TileSize wide so the parallel tasks aren't too small
+	WorkTiles.Reset();
+	FTileScheduling::ForEachTileRun(TileDispatched.GetData(), TileGridSize.X, TileGridSize.Y, ActivityTileSize, TileSize / ActivityTileSize, Size.X, Size.Y,
+									[this](const FTileRect& Tile)
+	{
+		WorkTiles.Add(FIntRect(Tile.MinX, Tile.MinY, Tile.MaxX, Tile.MaxY));
+	});
+}
+
+void FFluidSimulationCPU::RetireTile(int32 TileX, int32 TileY)
+{
+	//Mirrors ClearTilesCS. Every buffer is cleared since the passes swap them
+	const int32 MinX = TileX * ActivityTileSize;
+	const int32 Width = FMath::Min(MinX + ActivityTileSize, Size.X) - MinX;
+	const int32 MaxY = FMath::Min((TileY + 1) * ActivityTileSize, Size.Y);
+	for (TArray<float>* Field : { &VelocityX, &VelocityY, &Pressure, &Divergence, &Dye, &ScratchX, &ScratchY })
+	{
+		for (int32 Y = TileY * ActivityTileSize; Y < MaxY; ++Y)
+		{
+			FMemory::Memzero(Field->GetData() + Y * Size.X + MinX, Width * sizeof(float));
+		}
+	}
+}
+
+void FFluidSimulationCPU::AdvectVelocity(const FFluidSimulationParameters& Parameters)
+{
+	const float* InX = VelocityX.GetData();
+	const float* InY = VelocityY.GetData();
+	float* OutX = ScratchX.GetData();
+	float* OutY = ScratchY.GetData();
+	const FIntPoint GridSize = Size;
+
+	ForEachTile(WorkTiles, MaxWorkers, [&Parameters, InX, InY, OutX, OutY, GridSize](int32 MinX, int32 MinY, int32 MaxX, int32 MaxY)
+	{
+		for (int32 Y = MinY; Y < MaxY; ++Y)
+		{
+			for (int32 X = MinX; X < MaxX; ++X)
+			{
+				const int32 Index = Y * GridSize.X + X;
+				const float SourceX = (float)X - Parameters.DeltaTime * InX[Index];
+				const float SourceY = (float)Y - Parameters.DeltaTime * InY[Index];
+				const float Force = Parameters.DeltaTime * EmitterWeight(Parameters, X, Y);
+				OutX[Index] = SampleBilinear(InX, GridSize, SourceX, SourceY) * Parameters.VelocityDissipation + Parameters.EmitterForce.X * Force;
+				OutY[Index] = SampleBilinear(InY, GridSize, SourceX, SourceY) * Parameters.VelocityDissipation + Parameters.EmitterForce.Y * Force;
+			}
+		}
+	});
+	Swap(VelocityX, ScratchX);
+	Swap(VelocityY, ScratchY);
+}
+
+void FFluidSimulationCPU::ComputeDivergence()
+{
+	const float* InX = VelocityX.GetData();
+	const float* InY = VelocityY.GetData();
+	float* Out = Divergence.GetData();
+	const FIntPoint GridSize = Size;
+
+	ForEachTile(WorkTiles, MaxWorkers, [InX, InY, Out, GridSize](int32 MinX, int32 MinY, int32 MaxX, int32 MaxY)
+	{
+		const VectorRegister Half = VectorSetFloat1(0.5f);
+		for (int32 Y = MinY; Y < MaxY; ++Y)
+		{
+			const int32 Row = Y * GridSize.X;
+			ForEachCellInRow(GridSize, Y, MinX, MaxX,
+				[=](int32 X)
+				{
+					//The domain border is a solid wall, the normal velocity is mirrored outside of it
+					const int32 Index = Row + X;
+					const float Left = X == 0 ? -InX[Index] : InX[Index - 1];
+					const float Right = X == GridSize.X - 1 ? -InX[Index] : InX[Index + 1];
+					const float Bottom = Y == 0 ? -InY[Index] : InY[Index - GridSize.X];
+					const float Top = Y == GridSize.Y - 1 ? -InY[Index] : InY[Index + GridSize.X];
+					Out[Index] = 0.5f * ((Right - Left) + (Top - Bottom));
+				},
+				[=](int32 X)
+				{
+					const int32 Index = Row + X;
+					const VectorRegister DeltaX = VectorSubtract(VectorLoad(InX + Index + 1), VectorLoad(InX + Index - 1));
+					const VectorRegister DeltaY = VectorSubtract(VectorLoad(InY + Index + GridSize.X), VectorLoad(InY + Index - GridSize.X));
+					VectorStore(VectorMultiply(Half, VectorAdd(DeltaX, DeltaY)), Out + Index);
+				});
+		}
+	});
+}
+
+void FFluidSimulationCPU::SolvePressureJacobi(int32 Iterations)
+{
+	const float* Rhs = Divergence.GetData();
+	const FIntPoint GridSize = Size;
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const float* In = Pressure.GetData();
+		float* Out = ScratchX.GetData();
+		ForEachTile(WorkTiles, MaxWorkers, [In, Out, Rhs, GridSize](int32 MinX, int32 MinY, int32 MaxX, int32 MaxY)
+		{
+			const VectorRegister Quarter = VectorSetFloat1(0.25f);
+			for (int32 Y = MinY; Y < MaxY; ++Y)
+			{
+				const int32 Row = Y * GridSize.X;
+				ForEachCellInRow(GridSize, Y, MinX, MaxX,
+					[=](int32 X)
+					{
+						Out[Row + X] = (SumNeighboursClamped(In, GridSize, X, Y) - Rhs[Row + X]) * 0.25f;
+					},
+					[=](int32 X)
+					{
+						//Same association as the shader: ((Left + Right) + Bottom) + Top
+						const int32 Index = Row + X;
+						VectorRegister Neighbours = VectorAdd(VectorLoad(In + Index - 1), VectorLoad(In + Index + 1));
+						Neighbours = VectorAdd(Neighbours, VectorLoad(In + Index - GridSize.X));
+						Neighbours = VectorAdd(Neighbours, VectorLoad(In + Index + GridSize.X));
+						VectorStore(VectorMultiply(VectorSubtract(Neighbours, VectorLoad(Rhs + Index)), Quarter), Out + Index);
+					});
+			}
+		});
+		Swap(Pressure, ScratchX);
+	}
+}
+
+void FFluidSimulationCPU::SolvePressureMultigrid(const FMultigridSettings& Settings)
+{
+	//Same level layout as FMultigridPoissonSolver::AddSolve
+	const int32 NumLevels = FMultigridPoissonSolver::GetNumLevels(Size, FMath::Max(Settings.MinLevelSize, 1));
+	if (MultigridLevels.Num() != NumLevels - 1)
+	{
+		MultigridLevels.SetNum(NumLevels - 1);
+		FIntPoint LevelSize = Size;
+		float GridSpacingSquared = 1.f;
+		for (FMultigridLevel& Level : MultigridLevels)
+		{
+			LevelSize = FIntPoint(FMath::DivideAndRoundUp(LevelSize.X, 2), FMath::DivideAndRoundUp(LevelSize.Y, 2));
+			GridSpacingSquared *= 4.f;
+			Level.Size = LevelSize;
+			Level.GridSpacingSquared = GridSpacingSquared;
+			Level.Solution.Init(0.f, LevelSize.X * LevelSize.Y);
+			Level.RightHandSide.Init(0.f, LevelSize.X * LevelSize.Y);
+		}
+	}
+
+	struct FLevelView
+	{
+		FIntPoint Size;
+		float GridSpacingSquared;
+		float* Solution;
+		float* RightHandSide;
+	};
+	TArray<FLevelView, TInlineAllocator<16>> Levels;
+	Levels.Add({ Size, 1.f, Pressure.GetData(), Divergence.GetData() });
+	for (FMultigridLevel& Level : MultigridLevels)
+	{
+		Levels.Add({ Level.Size, Level.GridSpacingSquared, Level.Solution.GetData(), Level.RightHandSide.GetData() });
+	}
+
+	auto Smooth = [this](const FLevelView& Level, int32 NumSweeps)
+	{
+		for (int32 Sweep = 0; Sweep < NumSweeps; ++Sweep)
+		{
+			MultigridSmooth(Level.Solution, Level.RightHandSide, Level.Size, Level.GridSpacingSquared, 0, MaxWorkers);
+			MultigridSmooth(Level.Solution, Level.RightHandSide, Level.Size, Level.GridSpacingSquared, 1, MaxWorkers);
+		}
+	};
+
+	for (int32 Cycle = 0; Cycle < Settings.NumCycles; ++Cycle)
+	{
+		for (int32 LevelIndex = 0; LevelIndex < NumLevels - 1; ++LevelIndex)
+		{
+			const FLevelView& Level = Levels[LevelIndex];
+			const FLevelView& Coarse = Levels[LevelIndex + 1];
+			Smooth(Level, Settings.PreSmoothingSweeps);
+			MultigridRestrictResidual(Level.Solution, Level.RightHandSide, Level.Size, Level.GridSpacingSquared, Coarse.RightHandSide, Coarse.Size, MaxWorkers);
+			FMemory::Memzero(Coarse.Solution, Coarse.Size.X * Coarse.Size.Y * sizeof(float));
+		}
+
+		Smooth(Levels.Last(), Settings.CoarsestSweeps);
+
+		for (int32 LevelIndex = NumLevels - 2; LevelIndex >= 0; --LevelIndex)
+		{
+			const FLevelView& Level = Levels[LevelIndex];
+			const FLevelView& Coarse = Levels[LevelIndex + 1];
+			MultigridProlongate(Level.Solution, Level.Size, Coarse.Solution, Coarse.Size, MaxWorkers);
+			Smooth(Level, Settings.PostSmoothingSweeps);
+		}
+	}
+}
+
+void FFluidSimulationCPU::Project()
+{
+	const float* In = Pressure.GetData();
+	float* OutX = VelocityX.GetData();
+	float* OutY = VelocityY.GetData();
+	const FIntPoint GridSize = Size;
+
+	//Each cell only reads the pressure and its own velocity, so the velocity is updated in place
+	ForEachTile(WorkTiles, MaxWorkers, [In, OutX, OutY, GridSize](int32 MinX, int32 MinY, int32 MaxX, int32 MaxY)
+	{
+		const VectorRegister Half = VectorSetFloat1(0.5f);
+		for (int32 Y = MinY; Y < MaxY; ++Y)
+		{
+			const int32 Row = Y * GridSize.X;
+			ForEachCellInRow(GridSize, Y, MinX, MaxX,
+				[=](int32 X)
+				{
+					OutX[Row + X] -= 0.5f * (LoadClamped(In, GridSize, X + 1, Y) - LoadClamped(In, GridSize, X - 1, Y));
+					OutY[Row + X] -= 0.5f * (LoadClamped(In, GridSize, X, Y + 1) - LoadClamped(In, GridSize, X, Y - 1));
+				},
+				[=](int32 X)
+				{
+					const int32 Index = Row + X;
+					const VectorRegister GradientX = VectorMultiply(Half, VectorSubtract(VectorLoad(In + Index + 1), VectorLoad(In + Index - 1)));
+					const VectorRegister GradientY = VectorMultiply(Half, VectorSubtract(VectorLoad(In + Index + GridSize.X), VectorLoad(In + Index - GridSize.X)));
+					VectorStore(VectorSubtract(VectorLoad(OutX + Index), GradientX), OutX + Index);
+					VectorStore(VectorSubtract(VectorLoad(OutY + Index), GradientY), OutY + Index);
+				});
+		}
+	});
+}
+
+void FFluidSimulationCPU::AdvectDye(const FFluidSimulationParameters& Parameters)
+{
+	const float* InX = VelocityX.GetData();
+	const float* InY = VelocityY.GetData();
+	const float* In = Dye.GetData();
+	float* Out = ScratchX.GetData();
+	const FIntPoint GridSize = Size;
+
+	ForEachTile(WorkTiles, MaxWorkers, [&Parameters, InX, InY, In, Out, GridSize](int32 MinX, int32 MinY, int32 MaxX, int32 MaxY)
+	{
+		for (int32 Y = MinY; Y < MaxY; ++Y)
+		{
+			for (int32 X = MinX; X < MaxX; ++X)
+			{
+				const int32 Index = Y * GridSize.X + X;
+				const float SourceX = (float)X - Parameters.DeltaTime * InX[Index];
+				const float SourceY = (float)Y - Parameters.DeltaTime * InY[Index];
+				const float Injected = Parameters.EmitterDye * Parameters.DeltaTime * EmitterWeight(Parameters, X, Y);
+				Out[Index] = SampleBilinear(In, GridSize, SourceX, SourceY) * Parameters.DyeDissipation + Injected;
+			}
+		}
+	});
+	Swap(Dye, ScratchX);
+}
+
+double FFluidSimulationCPU::ComputeResidualNorm(const TArray<float>& Solution, const TArray<float>& RightHandSide, FIntPoint Size)
+{
+	check(Solution.Num() == Size.X * Size.Y && RightHandSide.Num() == Solution.Num());
+	double SumOfSquares = 0.0;
+	for (int32 Y = 0; Y < Size.Y; ++Y)
+	{
+		for (int32 X = 0; X < Size.X; ++X)
+		{
+			const int32 Index = Y * Size.X + X;
+			const double Laplacian = (double)SumNeighboursClamped(Solution.GetData(), Size, X, Y) - 4.0 * Solution[Index];
+			SumOfSquares += FMath::Square(RightHandSide[Index] - Laplacian);
+		}
+	}
+	return FMath::Sqrt(SumOfSquares);
+}
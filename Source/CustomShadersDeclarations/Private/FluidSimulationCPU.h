@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FluidSimulation.h"
+
+/// <summary>
+/// CPU reference of FFluidSimulation, every pass mirrors its counterpart in FluidCS.usf and MultigridCS.usf
+/// Used as the ground truth of the GPU tests and to run the simulation on servers without a GPU. Only the first dye channel is simulated
+///
+/// Fields are stored as structure of arrays and every pass walks the grid in TileSize x TileSize tiles spread across the task graph workers,
+/// so a tile of every field a pass touches stays in L2 and the throughput scales with the number of cores.
+/// The stencil loops (divergence, Jacobi, projection) use 4 wide SIMD on interior cells and keep the shader's order of operations.
+///
+/// In sparse mode the same 8x8 activity tiles as the GPU are classified, dilated and retired, and the passes only walk the dispatched tiles,
+/// so GetDispatchedTiles() can be compared with the GPU tile set.
+///
+/// Expected difference with the GPU: GPUTolerance absolute per cell on velocity, pressure and dye for the first 10 steps of a 256x256 simulation.
+/// It comes from fused multiply-adds and the precision of exp() on the GPU and grows slowly with the number of steps.
+/// CustomShaders.Fluid.Validate measures it, NoiseBake -BenchmarkFluid times the CPU passes at every worker count
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FFluidSimulationCPU
+{
+public:
+	//Edge of the square tiles the passes are split into. 64x64 floats is 16KB per field
+	static constexpr int32 TileSize = 64;
+	//Edge of the sparse mode tiles, the thread group size of FluidCS.usf
+	static constexpr int32 ActivityTileSize = 8;
+	//Largest absolute difference per cell with FFluidSimulation CustomShaders.Fluid.Validate accepts
+	static constexpr float GPUTolerance = 1e-4f;
+
+	//Runs one step. The state is reset to rest when the simulation size changes
+	void Step(const FFluidSimulationParameters& Parameters);
+
+	//Most task graph threads a pass may use, to measure how the passes scale with the number of cores. 0 uses them all
+	void SetMaxWorkers(int32 InMaxWorkers) { MaxWorkers = FMath::Max(InMaxWorkers, 0); }
+
+	FIntPoint GetSize() const { return Size; }
+	const TArray<float>& GetVelocityX() const { return VelocityX; }
+	const TArray<float>& GetVelocityY() const { return VelocityY; }
+	const TArray<float>& GetPressure() const { return Pressure; }
+	const TArray<float>& GetDye() const { return Dye; }
+	//1 for the activity tiles the last sparse step ran over, row major over GetTileGridSize()
+	const TArray<uint8>& GetDispatchedTiles() const { return TileDispatched; }
+	FIntPoint GetTileGridSize() const { return TileGridSize; }
+
+	//L2 norm of RightHandSide - Laplacian(Solution) with the clamped border of the pressure solvers, what FPoissonResidualMonitor measures on the GPU
+	static double ComputeResidualNorm(const TArray<float>& Solution, const TArray<float>& RightHandSide, FIntPoint Size);
+
+private:
+	//Fills WorkTiles with the rectangles the passes walk
+	void BuildDenseWorkTiles();
+	void BuildSparseWorkTiles(const FFluidSimulationParameters& Parameters);
+	void RetireTile(int32 TileX, int32 TileY);
+
+	void AdvectVelocity(const FFluidSimulationParameters& Parameters);
+	void ComputeDivergence();
+	void SolvePressureJacobi(int32 Iterations);
+	void SolvePressureMultigrid(const FMultigridSettings& Settings);
+	void Project();
+	void AdvectDye(const FFluidSimulationParameters& Parameters);
+
+	FIntPoint Size = FIntPoint::ZeroValue;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> Pressure;
+	TArray<float> Divergence;
+	TArray<float> Dye;
+
+	//Destination of the passes that can't run in place
+	TArray<float> ScratchX;
+	TArray<float> ScratchY;
+
+	TArray<FIntRect> WorkTiles;
+	FIntPoint TileGridSize = FIntPoint::ZeroValue;
+	TArray<uint8> TileActive;
+	TArray<uint8> TileDispatched;
+	bool bLastStepSparse = false;
+
+	//Coarse multigrid levels, level 0 is Pressure/Divergence
+	struct FMultigridLevel
+	{
+		FIntPoint Size;
+		float GridSpacingSquared;
+		TArray<float> Solution;
+		TArray<float> RightHandSide;
+	};
+	TArray<FMultigridLevel> MultigridLevels;
+
+	int32 MaxWorkers = 0;
+};
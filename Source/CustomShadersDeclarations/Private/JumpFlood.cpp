@@ -0,0 +1,196 @@
+#include "JumpFlood.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ShaderParameterStruct.h"
+#include "ComputeBenchmark.h"
+#include "PrimitivesCPU.h"
+#include "SummedAreaTable.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 8
+
+static FAutoConsoleCommand JumpFloodBenchmarkCommand(
+	TEXT("CustomShaders.DistanceField.Benchmark"),
+	TEXT("Times the jump flooding distance field of a thresholded noise texture and checks it against the exact CPU transform. Arguments: [Size] [NumIterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4096;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10;
+		ENQUEUE_RENDER_COMMAND(JumpFloodBenchmarkCommand)(
+			[Size, NumIterations](FRHICommandListImmediate& RHICmdList)
+			{
+				FJumpFloodCompute::RunBenchmark(RHICmdList, Size, NumIterations);
+			});
+	}));
+
+/// <summary>
+/// Base class of the passes in JumpFloodCS.usf
+/// </summary>
+class FJumpFloodCS : public FGlobalShader
+{
+public:
+	FJumpFloodCS() { }
+	FJumpFloodCS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{ }
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+	}
+};
+
+class FJumpFloodSeedCS : public FJumpFloodCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FJumpFloodSeedCS);
+	SHADER_USE_PARAMETER_STRUCT(FJumpFloodSeedCS, FJumpFloodCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, Size)
+		SHADER_PARAMETER(float, Threshold)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, InputTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<uint2>, OutputSeeds)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FJumpFloodFloodCS : public FJumpFloodCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FJumpFloodFloodCS);
+	SHADER_USE_PARAMETER_STRUCT(FJumpFloodFloodCS, FJumpFloodCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, Size)
+		SHADER_PARAMETER(int32, Step)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<uint2>, InputSeeds)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<uint2>, OutputSeeds)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FJumpFloodResolveCS : public FJumpFloodCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FJumpFloodResolveCS);
+	SHADER_USE_PARAMETER_STRUCT(FJumpFloodResolveCS, FJumpFloodCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, Size)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<uint2>, InputSeeds)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputTexture)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FJumpFloodSeedCS, "/CustomShaders/JumpFloodCS.usf", "SeedCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FJumpFloodFloodCS, "/CustomShaders/JumpFloodCS.usf", "FloodCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FJumpFloodResolveCS, "/CustomShaders/JumpFloodCS.usf", "ResolveCS", SF_Compute);
+
+
+FRDGTextureRef FJumpFloodCompute::AddSignedDistanceField(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source, float Threshold)
+{
+	const FIntPoint Size = Source->Desc.Extent;
+	check(Size.X <= MaxSize && Size.Y <= MaxSize);
+	const FIntVector GroupCount = FComputeShaderUtils::GetGroupCount(Size, NUM_THREADS_PER_GROUP_DIMENSION);
+
+	//The flood passes ping-pong between two seed textures
+	const FRDGTextureDesc SeedsDesc = FRDGTextureDesc::Create2DDesc(Size, PF_R32G32_UINT, FClearValueBinding::None, TexCreate_None,
+																	TexCreate_ShaderResource | TexCreate_UAV, false);
+	FRDGTextureRef Seeds[2] = {
+		GraphBuilder.CreateTexture(SeedsDesc, TEXT("JumpFloodSeedsA")),
+		GraphBuilder.CreateTexture(SeedsDesc, TEXT("JumpFloodSeedsB"))
+	};
+	{
+		TShaderMapRef<FJumpFloodSeedCS> ComputeShader(ShaderMap);
+		FJumpFloodSeedCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FJumpFloodSeedCS::FParameters>();
+		PassParameters->Size = Size;
+		PassParameters->Threshold = Threshold;
+		PassParameters->InputTexture = Source;
+		PassParameters->OutputSeeds = GraphBuilder.CreateUAV(Seeds[0]);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("JumpFloodSeed"), ComputeShader, PassParameters, GroupCount);
+	}
+
+	//Steps from half the padded size down to 1, then 1 again
+	TArray<int32, TInlineAllocator<18>> Steps;
+	for (int32 Step = FMath::RoundUpToPowerOfTwo(FMath::Max(Size.X, Size.Y)) / 2; Step >= 1; Step /= 2)
+	{
+		Steps.Add(Step);
+	}
+	Steps.Add(1);
+
+	int32 Current = 0;
+	TShaderMapRef<FJumpFloodFloodCS> FloodShader(ShaderMap);
+	for (int32 Step : Steps)
+	{
+		FJumpFloodFloodCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FJumpFloodFloodCS::FParameters>();
+		PassParameters->Size = Size;
+		PassParameters->Step = Step;
+		PassParameters->InputSeeds = Seeds[Current];
+		PassParameters->OutputSeeds = GraphBuilder.CreateUAV(Seeds[1 - Current]);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("JumpFlood Step %d", Step), FloodShader, PassParameters, GroupCount);
+		Current = 1 - Current;
+	}
+
+	FRDGTextureRef Output = GraphBuilder.CreateTexture(
+		FRDGTextureDesc::Create2DDesc(Size, PF_R32_FLOAT, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false),
+		TEXT("SignedDistanceField"));
+	{
+		TShaderMapRef<FJumpFloodResolveCS> ComputeShader(ShaderMap);
+		FJumpFloodResolveCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FJumpFloodResolveCS::FParameters>();
+		PassParameters->Size = Size;
+		PassParameters->InputSeeds = Seeds[Current];
+		PassParameters->OutputTexture = GraphBuilder.CreateUAV(Output);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("JumpFloodResolve"), ComputeShader, PassParameters, GroupCount);
+	}
+	return Output;
+}
+
+void FJumpFloodCompute::RunBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations)
+{
+	check(IsInRenderingThread());
+	Size = FMath::Clamp(Size, 16, 8192);
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	const float Threshold = 0.5f;
+
+	//Thresholded white noise is mostly single texel islands, blurring it first gives the blobs a gameplay mask looks like
+	TArray<float> Values;
+	TArray<uint32> Unused;
+	FPrimitivesCPU::FillRandom(1, Size * Size, Values, Unused);
+	TRefCountPtr<IPooledRenderTarget> Noise = FComputeBenchmark::UploadFloatTexture(RHICmdList, FIntPoint(Size, Size), Values, TEXT("JumpFloodBenchmarkNoise"));
+	TRefCountPtr<IPooledRenderTarget> Source;
+	{
+		FRDGBuilder GraphBuilder(RHICmdList);
+		FRDGTextureRef NoiseTexture = GraphBuilder.RegisterExternalTexture(Noise, TEXT("JumpFloodBenchmarkNoise"));
+		FRDGTextureRef Blurred = FSummedAreaTableCompute::AddBoxFilter(GraphBuilder, ShaderMap, FSummedAreaTableCompute::AddBuild(GraphBuilder, ShaderMap, NoiseTexture), 8);
+		GraphBuilder.QueueTextureExtraction(Blurred, &Source);
+		GraphBuilder.Execute();
+	}
+
+	TRefCountPtr<IPooledRenderTarget> Result;
+	const double GPUMilliseconds = FComputeBenchmark::TimeGraphs(RHICmdList, NumIterations, [&](FRDGBuilder& GraphBuilder)
+	{
+		FRDGTextureRef SourceTexture = GraphBuilder.RegisterExternalTexture(Source, TEXT("JumpFloodBenchmarkSource"));
+		GraphBuilder.QueueTextureExtraction(AddSignedDistanceField(GraphBuilder, ShaderMap, SourceTexture, Threshold), &Result);
+	});
+
+	//The reference thresholds the very values the GPU saw
+	TArray<float> SourceValues;
+	TArray<float> GPUDistances;
+	FComputeBenchmark::ReadbackFloatTexture(RHICmdList, Source, SourceValues);
+	FComputeBenchmark::ReadbackFloatTexture(RHICmdList, Result, GPUDistances);
+
+	TArray<float> Reference;
+	const double CPUStart = FPlatformTime::Seconds();
+	FDistanceFieldCPU::ComputeSignedDistanceField(SourceValues, Size, Size, Threshold, Reference);
+	const double CPUMilliseconds = (FPlatformTime::Seconds() - CPUStart) * 1000.0;
+
+	const FDistanceFieldError Error = FDistanceFieldCPU::MeasureError(GPUDistances, Reference);
+	UE_LOG(LogTemp, Log, TEXT("Jump flooding %dx%d: GPU %.3f ms, exact CPU transform %.3f ms. Max error %g texels, mean error %g, %.4f%% of the texels off"),
+		Size, Size, GPUMilliseconds, CPUMilliseconds, Error.MaxError, Error.MeanError, Error.WrongFraction * 100.f);
+}
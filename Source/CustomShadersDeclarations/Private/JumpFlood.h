@@ -0,0 +1,25 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "DistanceFieldCPU.h"
+
+/// <summary>
+/// Signed distance fields of thresholded compute outputs with the jump flooding algorithm, see JumpFloodCS.usf
+/// One seed pass, log2 of the size flood passes plus a last pass at step 1 that fixes most of the texels plain jump flooding gets wrong, then a resolve pass.
+/// The result is approximate, FDistanceFieldCPU computes the exact distances it is checked against
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FJumpFloodCompute
+{
+public:
+	//Seeds are packed on 16 bits per coordinate
+	static constexpr int32 MaxSize = 65535;
+
+	//Returns a PF_R32_FLOAT texture of the size of Source holding the distance in texels from every texel to the other side of the mask
+	//(first channel of Source > Threshold), negative inside the mask
+	static FRDGTextureRef AddSignedDistanceField(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source, float Threshold);
+
+	//Times AddSignedDistanceField on a Size x Size mask of blurred random noise and checks it against FDistanceFieldCPU. Stalls the GPU, render thread only
+	static void RunBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations);
+};
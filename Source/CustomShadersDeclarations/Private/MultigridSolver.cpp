@@ -0,0 +1,333 @@
+#include "MultigridSolver.h"
+
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 8
+
+/// <summary>
+/// Base class of the multigrid passes, they all live in MultigridCS.usf and share the same compilation environment
+/// </summary>
+class FMultigridCS : public FGlobalShader
+{
+public:
+	FMultigridCS() { }
+	FMultigridCS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{ }
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+	}
+};
+
+class FMultigridSmoothCS : public FMultigridCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FMultigridSmoothCS);
+	SHADER_USE_PARAMETER_STRUCT(FMultigridSmoothCS, FMultigridCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, LevelSize)
+		SHADER_PARAMETER(float, GridSpacingSquared)
+		SHADER_PARAMETER(uint32, RedBlackParity)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, RightHandSide)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, Solution)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FMultigridRestrictResidualCS : public FMultigridCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FMultigridRestrictResidualCS);
+	SHADER_USE_PARAMETER_STRUCT(FMultigridRestrictResidualCS, FMultigridCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, LevelSize)
+		SHADER_PARAMETER(FIntPoint, FineSize)
+		SHADER_PARAMETER(float, FineGridSpacingSquared)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, FineSolution)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, FineRightHandSide)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputRightHandSide)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FMultigridProlongateCS : public FMultigridCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FMultigridProlongateCS);
+	SHADER_USE_PARAMETER_STRUCT(FMultigridProlongateCS, FMultigridCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, LevelSize)
+		SHADER_PARAMETER(FIntPoint, CoarseSize)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, CoarseSolution)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, Solution)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FMultigridResidualNormCS : public FMultigridCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FMultigridResidualNormCS);
+	SHADER_USE_PARAMETER_STRUCT(FMultigridResidualNormCS, FMultigridCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, FineSize)
+		SHADER_PARAMETER(float, FineGridSpacingSquared)
+		SHADER_PARAMETER(uint32, PartialSumOffset)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, FineSolution)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, FineRightHandSide)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<float>, OutputPartialSums)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FMultigridSmoothCS, "/CustomShaders/MultigridCS.usf", "SmoothCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FMultigridRestrictResidualCS, "/CustomShaders/MultigridCS.usf", "RestrictResidualCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FMultigridProlongateCS, "/CustomShaders/MultigridCS.usf", "ProlongateCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FMultigridResidualNormCS, "/CustomShaders/MultigridCS.usf", "ResidualNormCS", SF_Compute);
+
+
+namespace
+{
+	struct FMultigridLevel
+	{
+		FIntPoint Size;
+		float GridSpacingSquared;
+		FRDGTextureRef Solution;
+		FRDGTextureRef RightHandSide;
+		FRDGTextureUAVRef SolutionUAV;
+	};
+
+	//Adds red-black Gauss-Seidel sweeps, two passes per sweep
+	int32 AddSmoothingPasses(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FMultigridLevel& Level, int32 LevelIndex, int32 NumSweeps)
+	{
+		TShaderMapRef<FMultigridSmoothCS> ComputeShader(ShaderMap);
+		const FIntVector GroupCount = FComputeShaderUtils::GetGroupCount(FIntPoint(FMath::DivideAndRoundUp(Level.Size.X, 2), Level.Size.Y), NUM_THREADS_PER_GROUP_DIMENSION);
+		for (int32 Sweep = 0; Sweep < NumSweeps; ++Sweep)
+		{
+			for (uint32 Parity = 0; Parity < 2; ++Parity)
+			{
+				FMultigridSmoothCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FMultigridSmoothCS::FParameters>();
+				PassParameters->LevelSize = Level.Size;
+				PassParameters->GridSpacingSquared = Level.GridSpacingSquared;
+				PassParameters->RedBlackParity = Parity;
+				PassParameters->RightHandSide = Level.RightHandSide;
+				PassParameters->Solution = Level.SolutionUAV;
+				FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("MultigridSmooth L%d %s", LevelIndex, Parity ? TEXT("Black") : TEXT("Red")), ComputeShader, PassParameters, GroupCount);
+			}
+		}
+		return NumSweeps * 2;
+	}
+}
+
+int32 FMultigridPoissonSolver::GetNumLevels(FIntPoint Size, int32 MinLevelSize)
+{
+	int32 NumLevels = 1;
+	while (FMath::DivideAndRoundUp(Size.X, 2) >= MinLevelSize && FMath::DivideAndRoundUp(Size.Y, 2) >= MinLevelSize)
+	{
+		Size = FIntPoint(FMath::DivideAndRoundUp(Size.X, 2), FMath::DivideAndRoundUp(Size.Y, 2));
+		++NumLevels;
+	}
+	return NumLevels;
+}
+
+int32 FMultigridPoissonSolver::AddSolve(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Solution, FRDGTextureRef RightHandSide, FIntPoint Size,
+										const FMultigridSettings& Settings, FPoissonResidualMonitor* Monitor)
+{
+	RDG_EVENT_SCOPE(GraphBuilder, "MultigridSolve %dx%d", Size.X, Size.Y);
+
+	const int32 NumLevels = GetNumLevels(Size, FMath::Max(Settings.MinLevelSize, 1));
+	TArray<FMultigridLevel, TInlineAllocator<16>> Levels;
+	Levels.SetNum(NumLevels);
+
+	Levels[0].Size = Size;
+	Levels[0].GridSpacingSquared = 1.f;
+	Levels[0].Solution = Solution;
+	Levels[0].RightHandSide = RightHandSide;
+	for (int32 LevelIndex = 1; LevelIndex < NumLevels; ++LevelIndex)
+	{
+		const FMultigridLevel& Fine = Levels[LevelIndex - 1];
+		FMultigridLevel& Level = Levels[LevelIndex];
+		Level.Size = FIntPoint(FMath::DivideAndRoundUp(Fine.Size.X, 2), FMath::DivideAndRoundUp(Fine.Size.Y, 2));
+		Level.GridSpacingSquared = Fine.GridSpacingSquared * 4.f;
+
+		const FRDGTextureDesc Desc = FRDGTextureDesc::Create2DDesc(Level.Size, PF_R32_FLOAT, FClearValueBinding::Black, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+		Level.Solution = GraphBuilder.CreateTexture(Desc, TEXT("MultigridSolution"));
+		Level.RightHandSide = GraphBuilder.CreateTexture(Desc, TEXT("MultigridRightHandSide"));
+	}
+	for (FMultigridLevel& Level : Levels)
+	{
+		Level.SolutionUAV = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Level.Solution));
+	}
+
+	if (Monitor)
+	{
+		Monitor->AddMeasurement(GraphBuilder, ShaderMap, Solution, RightHandSide);
+	}
+
+	int32 NumPasses = 0;
+	for (int32 Cycle = 0; Cycle < Settings.NumCycles; ++Cycle)
+	{
+		//Down: smooth, then restrict the residual to the next level where the error equation is solved from a zero guess
+		for (int32 LevelIndex = 0; LevelIndex < NumLevels - 1; ++LevelIndex)
+		{
+			const FMultigridLevel& Level = Levels[LevelIndex];
+			const FMultigridLevel& Coarse = Levels[LevelIndex + 1];
+			NumPasses += AddSmoothingPasses(GraphBuilder, ShaderMap, Level, LevelIndex, Settings.PreSmoothingSweeps);
+
+			TShaderMapRef<FMultigridRestrictResidualCS> ComputeShader(ShaderMap);
+			FMultigridRestrictResidualCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FMultigridRestrictResidualCS::FParameters>();
+			PassParameters->LevelSize = Coarse.Size;
+			PassParameters->FineSize = Level.Size;
+			PassParameters->FineGridSpacingSquared = Level.GridSpacingSquared;
+			PassParameters->FineSolution = Level.Solution;
+			PassParameters->FineRightHandSide = Level.RightHandSide;
+			PassParameters->OutputRightHandSide = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Coarse.RightHandSide));
+			FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("MultigridRestrict L%d", LevelIndex), ComputeShader, PassParameters,
+										 FComputeShaderUtils::GetGroupCount(Coarse.Size, NUM_THREADS_PER_GROUP_DIMENSION));
+
+			AddClearUAVPass(GraphBuilder, Coarse.SolutionUAV, FLinearColor::Black);
+			NumPasses += 2;
+		}
+
+		NumPasses += AddSmoothingPasses(GraphBuilder, ShaderMap, Levels.Last(), NumLevels - 1, Settings.CoarsestSweeps);
+
+		//Up: add the coarse correction, then smooth
+		for (int32 LevelIndex = NumLevels - 2; LevelIndex >= 0; --LevelIndex)
+		{
+			const FMultigridLevel& Level = Levels[LevelIndex];
+			const FMultigridLevel& Coarse = Levels[LevelIndex + 1];
+
+			TShaderMapRef<FMultigridProlongateCS> ComputeShader(ShaderMap);
+			FMultigridProlongateCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FMultigridProlongateCS::FParameters>();
+			PassParameters->LevelSize = Level.Size;
+			PassParameters->CoarseSize = Coarse.Size;
+			PassParameters->CoarseSolution = Coarse.Solution;
+			PassParameters->Solution = Level.SolutionUAV;
+			FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("MultigridProlongate L%d", LevelIndex), ComputeShader, PassParameters,
+										 FComputeShaderUtils::GetGroupCount(Level.Size, NUM_THREADS_PER_GROUP_DIMENSION));
+			NumPasses += 1;
+
+			NumPasses += AddSmoothingPasses(GraphBuilder, ShaderMap, Level, LevelIndex, Settings.PostSmoothingSweeps);
+		}
+
+		if (Monitor)
+		{
+			Monitor->AddMeasurement(GraphBuilder, ShaderMap, Solution, RightHandSide);
+		}
+	}
+
+	if (Monitor)
+	{
+		Monitor->AddSolverPasses(NumPasses);
+	}
+	return NumPasses;
+}
+
+
+void FPoissonResidualMonitor::BeginFrame(FRDGBuilder& GraphBuilder, FIntPoint Size, int32 InMaxMeasurements, const FString& Label)
+{
+	check(IsInRenderingThread());
+	MeasuredSize = Size;
+	NumGroups = FMath::DivideAndRoundUp(Size.X, NUM_THREADS_PER_GROUP_DIMENSION) * FMath::DivideAndRoundUp(Size.Y, NUM_THREADS_PER_GROUP_DIMENSION);
+	MaxMeasurements = FMath::Max(InMaxMeasurements, 1);
+	NumMeasurements = 0;
+	NumSolverPasses = 0;
+	FrameLabel = Label;
+	PartialSums = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(float), NumGroups * MaxMeasurements), TEXT("PoissonResidualPartialSums"));
+}
+
+void FPoissonResidualMonitor::AddMeasurement(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Solution, FRDGTextureRef RightHandSide)
+{
+	if (!PartialSums || NumMeasurements >= MaxMeasurements)
+	{
+		return;
+	}
+
+	TShaderMapRef<FMultigridResidualNormCS> ComputeShader(ShaderMap);
+	FMultigridResidualNormCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FMultigridResidualNormCS::FParameters>();
+	PassParameters->FineSize = MeasuredSize;
+	PassParameters->FineGridSpacingSquared = 1.f;
+	PassParameters->PartialSumOffset = NumMeasurements * NumGroups;
+	PassParameters->FineSolution = Solution;
+	PassParameters->FineRightHandSide = RightHandSide;
+	PassParameters->OutputPartialSums = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(PartialSums, PF_R32_FLOAT));
+	FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PoissonResidualNorm %d", NumMeasurements), ComputeShader, PassParameters,
+								 FComputeShaderUtils::GetGroupCount(MeasuredSize, NUM_THREADS_PER_GROUP_DIMENSION));
+	++NumMeasurements;
+
+	if (NumMeasurements == 1)
+	{
+		GraphBuilder.QueueBufferExtraction(PartialSums, &ExtractedPartialSums);
+	}
+}
+
+void FPoissonResidualMonitor::EndFrame(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+
+	//Report the frames the GPU has finished, oldest first
+	while (PendingReadbacks.Num() > 0 && PendingReadbacks[0].Readback->IsReady())
+	{
+		Report(PendingReadbacks[0]);
+		PendingReadbacks.RemoveAt(0);
+	}
+
+	if (ExtractedPartialSums.IsValid() && NumMeasurements > 0 && PendingReadbacks.Num() < MaxPendingReadbacks)
+	{
+		FPendingReadback& Pending = PendingReadbacks.AddDefaulted_GetRef();
+		Pending.Readback = MakeUnique<FRHIGPUBufferReadback>(TEXT("PoissonResidualReadback"));
+		Pending.Readback->EnqueueCopy(RHICmdList, ExtractedPartialSums->VertexBuffer, NumGroups * NumMeasurements * sizeof(float));
+		Pending.NumGroups = NumGroups;
+		Pending.NumMeasurements = NumMeasurements;
+		Pending.NumSolverPasses = NumSolverPasses;
+		Pending.Label = FrameLabel;
+	}
+
+	PartialSums = nullptr;
+	ExtractedPartialSums.SafeRelease();
+	NumMeasurements = 0;
+}
+
+void FPoissonResidualMonitor::Report(FPendingReadback& Pending)
+{
+	const float* Sums = (const float*)Pending.Readback->Lock(Pending.NumGroups * Pending.NumMeasurements * sizeof(float));
+	if (!Sums)
+	{
+		return;
+	}
+
+	FString Line = FString::Printf(TEXT("%s (%d passes): residual"), *Pending.Label, Pending.NumSolverPasses);
+	double PreviousNorm = 0.0;
+	for (int32 Measurement = 0; Measurement < Pending.NumMeasurements; ++Measurement)
+	{
+		double SumOfSquares = 0.0;
+		for (int32 Group = 0; Group < Pending.NumGroups; ++Group)
+		{
+			SumOfSquares += Sums[Measurement * Pending.NumGroups + Group];
+		}
+
+		const double Norm = FMath::Sqrt(SumOfSquares);
+		if (Measurement == 0)
+		{
+			Line += FString::Printf(TEXT(" %.3e"), Norm);
+		}
+		else
+		{
+			Line += FString::Printf(TEXT(" -> %.3e (x%.3f)"), Norm, PreviousNorm > 0.0 ? Norm / PreviousNorm : 0.0);
+		}
+		PreviousNorm = Norm;
+	}
+	Pending.Readback->Unlock();
+
+	UE_LOG(LogTemp, Log, TEXT("%s"), *Line);
+}
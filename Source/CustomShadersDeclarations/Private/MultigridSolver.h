@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphUtils.h"
+#include "RHIGPUReadback.h"
+
+struct FMultigridSettings
+{
+	//Number of V-cycles per solve
+	int32 NumCycles = 2;
+	//Red-black Gauss-Seidel sweeps before restriction and after prolongation on every level
+	int32 PreSmoothingSweeps = 2;
+	int32 PostSmoothingSweeps = 2;
+	//Sweeps on the coarsest level, which is small enough for them to converge
+	int32 CoarsestSweeps = 16;
+	//Levels stop being added once the next one would be smaller than this in either dimension
+	int32 MinLevelSize = 4;
+};
+
+class FPoissonResidualMonitor;
+
+/// <summary>
+/// Geometric multigrid V-cycle solver for Laplacian(Solution) = RightHandSide on a cell centered grid with a Neumann border
+/// Restriction, prolongation and red-black Gauss-Seidel smoothing are all added to the caller's graph, the coarse levels are transient RDG textures
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FMultigridPoissonSolver
+{
+public:
+	//Solution is the initial guess and is updated in place. When a monitor is given, the residual is measured before the first and after every cycle.
+	//Returns the number of passes that were added
+	static int32 AddSolve(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Solution, FRDGTextureRef RightHandSide, FIntPoint Size,
+						  const FMultigridSettings& Settings, FPoissonResidualMonitor* Monitor = nullptr);
+
+	//Number of levels AddSolve uses for a grid of Size, including the finest
+	static int32 GetNumLevels(FIntPoint Size, int32 MinLevelSize);
+};
+
+/// <summary>
+/// Measures the L2 norm of RightHandSide - Laplacian(Solution) on the GPU and reads it back asynchronously
+/// Used to report the convergence of the pressure solvers, one line per frame once the GPU is done with it
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FPoissonResidualMonitor
+{
+public:
+	//Starts the measurements of this frame. Label names the solver in the report
+	void BeginFrame(FRDGBuilder& GraphBuilder, FIntPoint Size, int32 MaxMeasurements, const FString& Label);
+
+	//Adds a pass measuring the residual. Ignored once MaxMeasurements have been added
+	void AddMeasurement(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Solution, FRDGTextureRef RightHandSide);
+
+	//Adds to the number of solver passes reported for this frame
+	void AddSolverPasses(int32 NumPasses) { NumSolverPasses += NumPasses; }
+
+	//Call after GraphBuilder.Execute(). Queues the readback of this frame and reports the ones that completed
+	void EndFrame(FRHICommandListImmediate& RHICmdList);
+
+	bool IsMeasuring() const { return PartialSums != nullptr; }
+
+private:
+	struct FPendingReadback
+	{
+		TUniquePtr<FRHIGPUBufferReadback> Readback;
+		int32 NumGroups = 0;
+		int32 NumMeasurements = 0;
+		int32 NumSolverPasses = 0;
+		FString Label;
+	};
+
+	void Report(FPendingReadback& Pending);
+
+	//Frames the GPU can be behind before measurements are skipped
+	static constexpr int32 MaxPendingReadbacks = 4;
+
+	FRDGBufferRef PartialSums = nullptr;
+	TRefCountPtr<FPooledRDGBuffer> ExtractedPartialSums;
+	FIntPoint MeasuredSize = FIntPoint::ZeroValue;
+	int32 NumGroups = 0;
+	int32 MaxMeasurements = 0;
+	int32 NumMeasurements = 0;
+	int32 NumSolverPasses = 0;
+	FString FrameLabel;
+
+	TArray<FPendingReadback> PendingReadbacks;
+};
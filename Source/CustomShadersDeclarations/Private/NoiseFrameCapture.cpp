@@ -0,0 +1,118 @@
+#include "NoiseFrameCapture.h"
+
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+FNoiseFrameCapture::FNoiseFrameCapture(const FString& InDirectory, ENoiseImageFormat InFormat, int32 MaxQueuedFrames)
+	: Directory(InDirectory)
+	, Format(InFormat)
+	, WriteQueue(MakeShared<FNoiseImageWriteQueue, ESPMode::ThreadSafe>(MaxQueuedFrames))
+{
+	check(IsInGameThread());
+	IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+FNoiseFrameCapture::~FNoiseFrameCapture()
+{
+	UE_LOG(LogTemp, Log, TEXT("Frame capture to %s finished: %d frames captured, %d dropped"), *Directory, GetNumCapturedFrames(), GetNumDroppedFrames());
+
+	//Let a pool thread wait for the pending writes
+	Async(EAsyncExecution::ThreadPool, [WriteQueue = MoveTemp(WriteQueue)]() mutable
+	{
+		WriteQueue.Reset();
+	});
+}
+
+void FNoiseFrameCapture::ReleaseReadbacks()
+{
+	check(IsInRenderingThread());
+	for (FReadbackSlot& Slot : Slots)
+	{
+		if (Slot.bInFlight)
+		{
+			NumDroppedFrames.Increment();
+		}
+		Slot.Readback.Reset();
+		Slot.bInFlight = false;
+	}
+}
+
+void FNoiseFrameCapture::CaptureFrame(FRHICommandListImmediate& RHICmdList, FRHITexture* Texture, FIntPoint Size, uint32 TimeStamp)
+{
+	check(IsInRenderingThread());
+	CollectReadbacks(RHICmdList);
+
+	FReadbackSlot* FreeSlot = nullptr;
+	for (FReadbackSlot& Slot : Slots)
+	{
+		if (!Slot.bInFlight)
+		{
+			FreeSlot = &Slot;
+			break;
+		}
+	}
+
+	//The GPU is too far behind, drop the frame rather than waiting on it
+	if (!FreeSlot)
+	{
+		NumDroppedFrames.Increment();
+		return;
+	}
+
+	//The readbacks own GPU fences, so they are created here rather than on the game thread
+	if (!FreeSlot->Readback.IsValid())
+	{
+		FreeSlot->Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("WhiteNoiseCS_Capture"));
+	}
+
+	FreeSlot->Readback->EnqueueCopy(RHICmdList, Texture);
+	FreeSlot->Size = Size;
+	FreeSlot->Format = Texture->GetFormat();
+	FreeSlot->TimeStamp = TimeStamp;
+	FreeSlot->bInFlight = true;
+}
+
+void FNoiseFrameCapture::CollectReadbacks(FRHICommandListImmediate& RHICmdList)
+{
+	for (FReadbackSlot& Slot : Slots)
+	{
+		if (!Slot.bInFlight || !Slot.Readback->IsReady())
+		{
+			continue;
+		}
+
+		FNoiseImage Image;
+		Image.Size = Slot.Size;
+		Image.Format = Format;
+		Image.RawFormat = Slot.Format;
+		Image.Filename = FPaths::Combine(Directory, FString::Printf(TEXT("WhiteNoise_%08u.%s"), Slot.TimeStamp, FNoiseImageWriteQueue::GetExtension(Format)));
+
+		//Only a tight copy of the rows happens here, decoding and encoding are left to the writer threads
+		const int32 BytesPerTexel = GPixelFormats[Slot.Format].BlockBytes;
+		const int32 RowBytes = Slot.Size.X * BytesPerTexel;
+		Image.RawTexels.SetNumUninitialized(RowBytes * Slot.Size.Y);
+
+		void* Data = nullptr;
+		int32 RowPitchInPixels = 0;
+		Slot.Readback->LockTexture(RHICmdList, Data, RowPitchInPixels);
+		if (Data)
+		{
+			for (int32 Row = 0; Row < Slot.Size.Y; ++Row)
+			{
+				FMemory::Memcpy(Image.RawTexels.GetData() + Row * RowBytes, (const uint8*)Data + Row * RowPitchInPixels * BytesPerTexel, RowBytes);
+			}
+		}
+		Slot.Readback->Unlock();
+		Slot.bInFlight = false;
+
+		if (Data && WriteQueue->TryEnqueue(MoveTemp(Image)))
+		{
+			NumCapturedFrames.Increment();
+		}
+		else
+		{
+			NumDroppedFrames.Increment();
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHIGPUReadback.h"
+#include "NoiseImageWriter.h"
+
+/// <summary>
+/// Dumps every generated frame to disk without stalling the game or render threads
+/// Frames are copied into GPU readback buffers and only mapped once the GPU is done with them, the encoding and the disk writes happen on the thread pool
+/// When the GPU or the disk can't keep up, frames are dropped and counted instead of waiting
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FNoiseFrameCapture
+{
+public:
+	//Created on the game thread, every other call happens on the render thread
+	FNoiseFrameCapture(const FString& InDirectory, ENoiseImageFormat InFormat, int32 MaxQueuedFrames);
+	~FNoiseFrameCapture();
+
+	//Hands the finished readbacks to the writer and queues a readback of Texture
+	void CaptureFrame(FRHICommandListImmediate& RHICmdList, FRHITexture* Texture, FIntPoint Size, uint32 TimeStamp);
+
+	//Releases the GPU resources. Frames that are still in flight are counted as dropped
+	void ReleaseReadbacks();
+
+	int32 GetNumCapturedFrames() const { return NumCapturedFrames.GetValue(); }
+	int32 GetNumDroppedFrames() const { return NumDroppedFrames.GetValue(); }
+
+private:
+	//Number of frames the GPU can be behind before we start dropping
+	static constexpr int32 NumReadbacks = 4;
+
+	struct FReadbackSlot
+	{
+		TUniquePtr<FRHIGPUTextureReadback> Readback;
+		FIntPoint Size = FIntPoint::ZeroValue;
+		EPixelFormat Format = PF_Unknown;
+		uint32 TimeStamp = 0;
+		bool bInFlight = false;
+	};
+
+	void CollectReadbacks(FRHICommandListImmediate& RHICmdList);
+
+	const FString Directory;
+	const ENoiseImageFormat Format;
+
+	FReadbackSlot Slots[NumReadbacks];
+
+	//Written by the pool threads, the queue itself is destroyed off the render thread since flushing it waits for the disk
+	TSharedPtr<FNoiseImageWriteQueue, ESPMode::ThreadSafe> WriteQueue;
+
+	FThreadSafeCounter NumCapturedFrames;
+	FThreadSafeCounter NumDroppedFrames;
+};
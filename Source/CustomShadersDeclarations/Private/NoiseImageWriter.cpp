@@ -0,0 +1,233 @@
+#include "NoiseImageWriter.h"
+#include "BlockCompression.h"
+
+#include "Async/Async.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Math/Float16.h"
+#include "Misc/FileHelper.h"
+#include "Modules/ModuleManager.h"
+#include "RHI.h"
+
+FNoiseImageWriteQueue::FNoiseImageWriteQueue(int32 InMaxPendingWrites)
+	: MaxPendingWrites(FMath::Max(InMaxPendingWrites, 1))
+{
+	check(IsInGameThread());
+	ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	WriteCompletedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FNoiseImageWriteQueue::~FNoiseImageWriteQueue()
+{
+	Flush();
+	FPlatformProcess::ReturnSynchEventToPool(WriteCompletedEvent);
+	WriteCompletedEvent = nullptr;
+}
+
+void FNoiseImageWriteQueue::Enqueue(FNoiseImage&& Image)
+{
+	WaitForPendingWrites(MaxPendingWrites - 1);
+
+	NumPendingWrites.Increment();
+	Launch(MoveTemp(Image));
+}
+
+bool FNoiseImageWriteQueue::TryEnqueue(FNoiseImage&& Image)
+{
+	if (NumPendingWrites.Increment() > MaxPendingWrites)
+	{
+		NumPendingWrites.Decrement();
+		return false;
+	}
+
+	Launch(MoveTemp(Image));
+	return true;
+}
+
+void FNoiseImageWriteQueue::Launch(FNoiseImage&& Image)
+{
+	Async(EAsyncExecution::ThreadPool, [this, Image = MoveTemp(Image)]() mutable
+	{
+		Write(Image);
+		//Trigger before the decrement: once the count reaches zero Flush may return and the queue be destroyed, so the decrement has to be
+		//the last access to this. A waiter woken before the decrement sees the count on its next timed wait
+		WriteCompletedEvent->Trigger();
+		NumPendingWrites.Decrement();
+	});
+}
+
+void FNoiseImageWriteQueue::Flush()
+{
+	WaitForPendingWrites(0);
+}
+
+void FNoiseImageWriteQueue::WaitForPendingWrites(int32 MaxRemaining)
+{
+	while (NumPendingWrites.GetValue() > MaxRemaining)
+	{
+		//The timeout covers a trigger that happens between the check and the wait, or before the decrement it announces
+		WriteCompletedEvent->Wait(10);
+	}
+}
+
+bool FNoiseImageWriteQueue::DecodeRawTexels(FNoiseImage& Image)
+{
+	const int32 NumTexels = Image.Size.X * Image.Size.Y;
+	const int32 BytesPerTexel = GPixelFormats[Image.RawFormat].BlockBytes;
+	if (Image.RawTexels.Num() != NumTexels * BytesPerTexel)
+	{
+		return false;
+	}
+
+	Image.Values.SetNumUninitialized(NumTexels);
+	const uint8* Texel = Image.RawTexels.GetData();
+	for (int32 Index = 0; Index < NumTexels; ++Index, Texel += BytesPerTexel)
+	{
+		float Value;
+		switch (Image.RawFormat)
+		{
+		case PF_R32_FLOAT:
+		case PF_G32R32F:
+		case PF_A32B32G32R32F:
+			Value = *(const float*)Texel;
+			break;
+		case PF_R16F:
+		case PF_G16R16F:
+		case PF_FloatRGBA:
+			Value = ((const FFloat16*)Texel)->GetFloat();
+			break;
+		case PF_G8:
+		case PF_R8G8B8A8:
+			Value = Texel[0] / 255.f;
+			break;
+		case PF_B8G8R8A8:
+			Value = Texel[2] / 255.f;
+			break;
+		default:
+			return false;
+		}
+		Image.Values[Index] = Value;
+	}
+
+	Image.RawTexels.Empty();
+	return true;
+}
+
+void FNoiseImageWriteQueue::Write(FNoiseImage& Image)
+{
+	const int32 NumTexels = Image.Size.X * Image.Size.Y;
+	if (Image.Values.Num() == 0 && !DecodeRawTexels(Image))
+	{
+		NumFailedWrites.Increment();
+		UE_LOG(LogTemp, Warning, TEXT("Unsupported pixel format %s for %s"), GPixelFormats[Image.RawFormat].Name, *Image.Filename);
+		return;
+	}
+	check(Image.Values.Num() == NumTexels);
+
+	bool bSaved = false;
+	int64 NumBytes = 0;
+
+	switch (Image.Format)
+	{
+	case ENoiseImageFormat::PNG:
+	{
+		TArray<uint8> Gray;
+		Gray.SetNumUninitialized(NumTexels);
+		for (int32 Index = 0; Index < NumTexels; ++Index)
+		{
+			Gray[Index] = (uint8)FMath::Clamp(FMath::RoundToInt(Image.Values[Index] * 255.f), 0, 255);
+		}
+
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule->CreateImageWrapper(EImageFormat::PNG);
+		if (ImageWrapper.IsValid() && ImageWrapper->SetRaw(Gray.GetData(), Gray.Num(), Image.Size.X, Image.Size.Y, ERGBFormat::Gray, 8))
+		{
+			const TArray64<uint8>& Compressed = ImageWrapper->GetCompressed();
+			NumBytes = Compressed.Num();
+			bSaved = FFileHelper::SaveArrayToFile(Compressed, *Image.Filename);
+		}
+		break;
+	}
+	case ENoiseImageFormat::EXR:
+	{
+		TArray<FLinearColor> Colors;
+		Colors.SetNumUninitialized(NumTexels);
+		for (int32 Index = 0; Index < NumTexels; ++Index)
+		{
+			const float Value = Image.Values[Index];
+			Colors[Index] = FLinearColor(Value, Value, Value, 1.f);
+		}
+
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule->CreateImageWrapper(EImageFormat::EXR);
+		if (ImageWrapper.IsValid() && ImageWrapper->SetRaw(Colors.GetData(), Colors.Num() * sizeof(FLinearColor), Image.Size.X, Image.Size.Y, ERGBFormat::RGBA, 32))
+		{
+			const TArray64<uint8>& Compressed = ImageWrapper->GetCompressed();
+			NumBytes = Compressed.Num();
+			bSaved = FFileHelper::SaveArrayToFile(Compressed, *Image.Filename);
+		}
+		break;
+	}
+	case ENoiseImageFormat::Raw:
+	{
+		TArrayView<const uint8> Bytes((const uint8*)Image.Values.GetData(), NumTexels * sizeof(float));
+		NumBytes = Bytes.Num();
+		bSaved = FFileHelper::SaveArrayToFile(Bytes, *Image.Filename);
+		break;
+	}
+	case ENoiseImageFormat::BC4:
+	{
+		TArray<uint8> Blocks;
+		FBlockCompressionCPU::EncodeBC4(Image.Values, Image.Size, Blocks);
+		NumBytes = Blocks.Num();
+		bSaved = FFileHelper::SaveArrayToFile(Blocks, *Image.Filename);
+		break;
+	}
+	}
+
+	if (bSaved)
+	{
+		BytesWritten.Add(NumBytes);
+	}
+	else
+	{
+		NumFailedWrites.Increment();
+		UE_LOG(LogTemp, Warning, TEXT("Failed to write %s"), *Image.Filename);
+	}
+}
+
+bool FNoiseImageWriteQueue::ParseFormat(const FString& Name, ENoiseImageFormat& OutFormat)
+{
+	if (Name.Equals(TEXT("png"), ESearchCase::IgnoreCase))
+	{
+		OutFormat = ENoiseImageFormat::PNG;
+	}
+	else if (Name.Equals(TEXT("exr"), ESearchCase::IgnoreCase))
+	{
+		OutFormat = ENoiseImageFormat::EXR;
+	}
+	else if (Name.Equals(TEXT("raw"), ESearchCase::IgnoreCase))
+	{
+		OutFormat = ENoiseImageFormat::Raw;
+	}
+	else if (Name.Equals(TEXT("bc4"), ESearchCase::IgnoreCase))
+	{
+		OutFormat = ENoiseImageFormat::BC4;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+const TCHAR* FNoiseImageWriteQueue::GetExtension(ENoiseImageFormat Format)
+{
+	switch (Format)
+	{
+	case ENoiseImageFormat::PNG: return TEXT("png");
+	case ENoiseImageFormat::EXR: return TEXT("exr");
+	case ENoiseImageFormat::BC4: return TEXT("bc4");
+	default:                     return TEXT("raw");
+	}
+}
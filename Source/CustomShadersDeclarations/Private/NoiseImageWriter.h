@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "PixelFormat.h"
+
+class IImageWrapperModule;
+
+//File formats the write queue can encode to
+enum class ENoiseImageFormat : uint8
+{
+	//8 bit grayscale PNG
+	PNG,
+	//32 bit float RGBA EXR
+	EXR,
+	//Headerless 32 bit float, row-major
+	Raw,
+	//Headerless BC4 blocks, row-major
+	BC4,
+};
+
+//A single channel image waiting to be encoded and written to disk
+struct FNoiseImage
+{
+	FString Filename;
+	FIntPoint Size;
+	ENoiseImageFormat Format;
+	TArray<float> Values;
+
+	//Optional tightly packed texels in RawFormat. When Values is empty, the first channel is decoded on the writer thread so producers don't pay for the conversion
+	TArray<uint8> RawTexels;
+	EPixelFormat RawFormat = PF_Unknown;
+};
+
+/// <summary>
+/// Encodes and writes images on the engine thread pool so the producer never waits for the disk
+/// The number of images in flight is bounded, Enqueue blocks once the bound is reached to apply back pressure
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FNoiseImageWriteQueue
+{
+public:
+	//Must be created on the game thread since it loads the ImageWrapper module
+	explicit FNoiseImageWriteQueue(int32 InMaxPendingWrites);
+	~FNoiseImageWriteQueue();
+
+	//Hands the image over to the thread pool. Blocks while MaxPendingWrites images are still being written
+	void Enqueue(FNoiseImage&& Image);
+
+	//Never blocks. Returns false and leaves Image untouched if MaxPendingWrites images are already in flight
+	bool TryEnqueue(FNoiseImage&& Image);
+
+	//Blocks until every queued image has been written
+	void Flush();
+
+	int64 GetBytesWritten() const { return BytesWritten.GetValue(); }
+	int32 GetNumFailedWrites() const { return NumFailedWrites.GetValue(); }
+
+	static bool ParseFormat(const FString& Name, ENoiseImageFormat& OutFormat);
+	static const TCHAR* GetExtension(ENoiseImageFormat Format);
+
+private:
+	//Runs on a pool thread
+	void Write(FNoiseImage& Image);
+
+	void Launch(FNoiseImage&& Image);
+
+	//Fills Image.Values from Image.RawTexels
+	static bool DecodeRawTexels(FNoiseImage& Image);
+
+	void WaitForPendingWrites(int32 MaxRemaining);
+
+	const int32 MaxPendingWrites;
+
+	IImageWrapperModule* ImageWrapperModule;
+
+	//Signaled every time a write completes
+	FEvent* WriteCompletedEvent;
+
+	FThreadSafeCounter NumPendingWrites;
+	FThreadSafeCounter NumFailedWrites;
+	FThreadSafeCounter64 BytesWritten;
+};
@@ -0,0 +1,252 @@
+#include "Ocean.h"
+
+#include "ShaderParameterStruct.h"
+#include "FFT.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 8
+
+BEGIN_SHADER_PARAMETER_STRUCT(FOceanSpectrumParameters, )
+	SHADER_PARAMETER(uint32, Resolution)
+	SHADER_PARAMETER(float, PatchSize)
+	SHADER_PARAMETER(uint32, SpectrumType)
+	SHADER_PARAMETER(float, WindSpeed)
+	SHADER_PARAMETER(FVector2D, WindDirection)
+	SHADER_PARAMETER(float, PhillipsAmplitude)
+	SHADER_PARAMETER(float, Fetch)
+	SHADER_PARAMETER(float, PeakEnhancement)
+	SHADER_PARAMETER(float, SmallWaveLength)
+	SHADER_PARAMETER(uint32, Seed)
+END_SHADER_PARAMETER_STRUCT()
+
+/// <summary>
+/// Base class of the ocean passes, they all live in OceanCS.usf and share the same compilation environment
+/// </summary>
+class FOceanCS : public FGlobalShader
+{
+public:
+	FOceanCS() { }
+	FOceanCS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{ }
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+	}
+};
+
+class FOceanInitialSpectrumCS : public FOceanCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FOceanInitialSpectrumCS);
+	SHADER_USE_PARAMETER_STRUCT(FOceanInitialSpectrumCS, FOceanCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FOceanSpectrumParameters, Spectrum)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutputInitialSpectrum)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FOceanTimeSpectrumCS : public FOceanCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FOceanTimeSpectrumCS);
+	SHADER_USE_PARAMETER_STRUCT(FOceanTimeSpectrumCS, FOceanCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FOceanSpectrumParameters, Spectrum)
+		SHADER_PARAMETER(float, Time)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, InitialSpectrum)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutputSpectrumA)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutputSpectrumB)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FOceanAssembleCS : public FOceanCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FOceanAssembleCS);
+	SHADER_USE_PARAMETER_STRUCT(FOceanAssembleCS, FOceanCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(uint32, Resolution)
+		SHADER_PARAMETER(float, Choppiness)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, SpectrumA)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, SpectrumB)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutputDisplacement)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutputNormal)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FOceanInitialSpectrumCS, "/CustomShaders/OceanCS.usf", "InitialSpectrumCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FOceanTimeSpectrumCS, "/CustomShaders/OceanCS.usf", "TimeSpectrumCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FOceanAssembleCS, "/CustomShaders/OceanCS.usf", "AssembleCS", SF_Compute);
+
+
+namespace
+{
+	FOceanSpectrumParameters GetSpectrumParameters(const FOceanSpectrumSettings& Settings)
+	{
+		FOceanSpectrumParameters Parameters;
+		Parameters.Resolution = Settings.Resolution;
+		Parameters.PatchSize = Settings.PatchSize;
+		Parameters.SpectrumType = (uint32)Settings.Spectrum;
+		Parameters.WindSpeed = Settings.WindSpeed;
+		Parameters.WindDirection = Settings.WindDirection.GetSafeNormal();
+		Parameters.PhillipsAmplitude = Settings.PhillipsAmplitude;
+		Parameters.Fetch = Settings.Fetch;
+		Parameters.PeakEnhancement = Settings.PeakEnhancement;
+		Parameters.SmallWaveLength = Settings.SmallWaveLength;
+		Parameters.Seed = Settings.Seed;
+		return Parameters;
+	}
+}
+
+void FOceanSimulation::AddUpdate(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FOceanSpectrumSettings& Settings, float Time, float Choppiness,
+								 EPixelFormat DisplacementFormat, EPixelFormat NormalFormat, FRDGTextureRef& OutDisplacement, FRDGTextureRef& OutNormal)
+{
+	check(IsInRenderingThread());
+	check(FFFTCompute::IsSupportedSize(Settings.Resolution));
+	const FIntPoint Size(Settings.Resolution, Settings.Resolution);
+	const FIntVector GroupCount = FComputeShaderUtils::GetGroupCount(Size, NUM_THREADS_PER_GROUP_DIMENSION);
+	const FOceanSpectrumParameters SpectrumParameters = GetSpectrumParameters(Settings);
+
+	//h0 only depends on the settings, it is generated once and reused every frame after that
+	const bool bRegenerate = !InitialSpectrum.IsValid() || InitialSpectrumSettings != Settings;
+	if (bRegenerate)
+	{
+		const FPooledRenderTargetDesc Desc = FPooledRenderTargetDesc::Create2DDesc(Size, PF_A32B32G32R32F, FClearValueBinding::None,
+																				   TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+		GRenderTargetPool.FindFreeElement(GraphBuilder.RHICmdList, Desc, InitialSpectrum, TEXT("OceanInitialSpectrum"));
+		InitialSpectrumSettings = Settings;
+	}
+	FRDGTextureRef InitialSpectrumTexture = GraphBuilder.RegisterExternalTexture(InitialSpectrum, TEXT("OceanInitialSpectrum"),
+																				 ERenderTargetTexture::ShaderResource, ERDGTextureFlags::MultiFrame);
+	if (bRegenerate)
+	{
+		FOceanInitialSpectrumCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FOceanInitialSpectrumCS::FParameters>();
+		PassParameters->Spectrum = SpectrumParameters;
+		PassParameters->OutputInitialSpectrum = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(InitialSpectrumTexture));
+		TShaderMapRef<FOceanInitialSpectrumCS> ComputeShader(ShaderMap);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("OceanInitialSpectrum"), ComputeShader, PassParameters, GroupCount);
+	}
+
+	FRDGTextureRef SpectrumA = GraphBuilder.CreateTexture(FFFTCompute::CreateTextureDesc(Size), TEXT("OceanSpectrumA"));
+	FRDGTextureRef SpectrumB = GraphBuilder.CreateTexture(FFFTCompute::CreateTextureDesc(Size), TEXT("OceanSpectrumB"));
+	{
+		FOceanTimeSpectrumCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FOceanTimeSpectrumCS::FParameters>();
+		PassParameters->Spectrum = SpectrumParameters;
+		PassParameters->Time = Time;
+		PassParameters->InitialSpectrum = InitialSpectrumTexture;
+		PassParameters->OutputSpectrumA = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(SpectrumA));
+		PassParameters->OutputSpectrumB = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(SpectrumB));
+		TShaderMapRef<FOceanTimeSpectrumCS> ComputeShader(ShaderMap);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("OceanTimeSpectrum"), ComputeShader, PassParameters, GroupCount);
+	}
+
+	//The spectra are sums of amplitudes, the inverse transforms are not normalized
+	FFFTCompute::AddTransform2D(GraphBuilder, ShaderMap, SpectrumA, EFFTDirection::Inverse);
+	FFFTCompute::AddTransform2D(GraphBuilder, ShaderMap, SpectrumB, EFFTDirection::Inverse);
+
+	OutDisplacement = GraphBuilder.CreateTexture(
+		FRDGTextureDesc::Create2DDesc(Size, DisplacementFormat, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false),
+		TEXT("OceanDisplacement"));
+	OutNormal = GraphBuilder.CreateTexture(
+		FRDGTextureDesc::Create2DDesc(Size, NormalFormat, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false),
+		TEXT("OceanNormal"));
+	{
+		FOceanAssembleCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FOceanAssembleCS::FParameters>();
+		PassParameters->Resolution = Settings.Resolution;
+		PassParameters->Choppiness = Choppiness;
+		PassParameters->SpectrumA = SpectrumA;
+		PassParameters->SpectrumB = SpectrumB;
+		PassParameters->OutputDisplacement = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(OutDisplacement));
+		PassParameters->OutputNormal = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(OutNormal));
+		TShaderMapRef<FOceanAssembleCS> ComputeShader(ShaderMap);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("OceanAssemble"), ComputeShader, PassParameters, GroupCount);
+	}
+}
+
+void FOceanSimulation::Release()
+{
+	InitialSpectrum.SafeRelease();
+}
+
+
+FOceanCSManager* FOceanCSManager::instance = nullptr;
+
+void FOceanCSManager::BeginRendering()
+{
+	if (!(bCachedParamsAreValid && cachedParams.DisplacementTarget && cachedParams.NormalTarget))
+	{
+		return;
+	}
+
+	ENQUEUE_RENDER_COMMAND(OceanUpdateCommand)
+		(
+			[Parameters = cachedParams](FRHICommandListImmediate& RHICmdList)
+			{
+				FOceanCSManager::Get()->UpdateResults(RHICmdList, Parameters);
+			}
+		);
+}
+
+void FOceanCSManager::EndRendering()
+{
+	bCachedParamsAreValid = false;
+	ENQUEUE_RENDER_COMMAND(OceanReleaseCommand)
+		(
+			[](FRHICommandListImmediate& RHICmdList)
+			{
+				FOceanCSManager::Get()->Simulation.Release();
+			}
+		);
+}
+
+void FOceanCSManager::UpdateParameters(const FOceanCSParameters& Parameters)
+{
+	cachedParams = Parameters;
+	bCachedParamsAreValid = true;
+}
+
+void FOceanCSManager::UpdateResults(FRHICommandListImmediate& RHICmdList, const FOceanCSParameters& Parameters)
+{
+	check(IsInRenderingThread());
+	FTextureRenderTargetResource* DisplacementResource = Parameters.DisplacementTarget->GetRenderTargetResource();
+	FTextureRenderTargetResource* NormalResource = Parameters.NormalTarget->GetRenderTargetResource();
+	if (!DisplacementResource || !NormalResource || !FFFTCompute::IsSupportedSize(Parameters.Spectrum.Resolution))
+	{
+		return;
+	}
+
+	FTexture2DRHIRef DisplacementTexture = DisplacementResource->GetRenderTargetTexture();
+	FTexture2DRHIRef NormalTexture = NormalResource->GetRenderTargetTexture();
+	const FIntPoint Size(Parameters.Spectrum.Resolution, Parameters.Spectrum.Resolution);
+	if (DisplacementTexture->GetSizeXY() != Size || NormalTexture->GetSizeXY() != Size)
+	{
+		return;
+	}
+
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	FRDGBuilder GraphBuilder(RHICmdList);
+	FRDGTextureRef Displacement = nullptr;
+	FRDGTextureRef Normal = nullptr;
+	Simulation.AddUpdate(GraphBuilder, ShaderMap, Parameters.Spectrum, Parameters.Time, Parameters.Choppiness,
+						 DisplacementTexture->GetFormat(), NormalTexture->GetFormat(), Displacement, Normal);
+
+	TRefCountPtr<IPooledRenderTarget> PooledDisplacement;
+	TRefCountPtr<IPooledRenderTarget> PooledNormal;
+	GraphBuilder.QueueTextureExtraction(Displacement, &PooledDisplacement);
+	GraphBuilder.QueueTextureExtraction(Normal, &PooledNormal);
+	GraphBuilder.Execute();
+
+	RHICmdList.CopyTexture(PooledDisplacement->GetRenderTargetItem().ShaderResourceTexture, DisplacementTexture, FRHICopyTextureInfo());
+	RHICmdList.CopyTexture(PooledNormal->GetRenderTargetItem().ShaderResourceTexture, NormalTexture, FRHICopyTextureInfo());
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+#include "Runtime/Engine/Classes/Engine/TextureRenderTarget2D.h"
+#include "OceanSpectrum.h"
+
+/// <summary>
+/// GPU Tessendorf ocean: the initial spectrum h0 is kept in a pooled texture and only regenerated when the spectrum settings change.
+/// Every update evolves it to the current time, runs two inverse 2D FFTs (each transforming two packed complex fields, so eight real fields in total)
+/// and assembles the displacement and normal maps. All the calls happen on the render thread
+/// FOceanSpectrumCPU::GenerateDisplacement is the CPU counterpart
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FOceanSimulation
+{
+public:
+	//Adds the passes of one update to the graph. The outputs are Resolution^2 textures of the given formats, see AssembleCS in OceanCS.usf for their layout
+	void AddUpdate(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FOceanSpectrumSettings& Settings, float Time, float Choppiness,
+				   EPixelFormat DisplacementFormat, EPixelFormat NormalFormat, FRDGTextureRef& OutDisplacement, FRDGTextureRef& OutNormal);
+
+	//Returns the initial spectrum to the pool
+	void Release();
+
+private:
+	TRefCountPtr<IPooledRenderTarget> InitialSpectrum;
+	FOceanSpectrumSettings InitialSpectrumSettings;
+};
+
+
+//This struct act as a container for all the parameters that the client needs to pass to the Ocean Manager.
+struct FOceanCSParameters
+{
+	//Both are square with the spectrum resolution as their size
+	UTextureRenderTarget2D* DisplacementTarget = nullptr;
+	UTextureRenderTarget2D* NormalTarget = nullptr;
+	FOceanSpectrumSettings Spectrum;
+	//Seconds
+	float Time = 0.f;
+	//Scales the horizontal displacement, 0 gives a plain heightfield
+	float Choppiness = 1.f;
+
+	FOceanCSParameters() { }
+	FOceanCSParameters(UTextureRenderTarget2D* IODisplacementTarget, UTextureRenderTarget2D* IONormalTarget)
+		: DisplacementTarget(IODisplacementTarget)
+		, NormalTarget(IONormalTarget)
+	{
+		Spectrum.Resolution = DisplacementTarget ? DisplacementTarget->SizeX : 0;
+	}
+};
+
+
+/// <summary>
+/// A singleton manager that updates the ocean once per frame and copies the maps into the client render targets
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FOceanCSManager
+{
+public:
+	//Get the instance
+	static FOceanCSManager* Get()
+	{
+		if (!instance)
+			instance = new FOceanCSManager();
+		return instance;
+	};
+
+	// Updates the ocean once on the render thread with the last parameters
+	void BeginRendering();
+
+	// Releases the spectrum
+	void EndRendering();
+
+	// Call this whenever you have new parameters to share.
+	void UpdateParameters(const FOceanCSParameters& Parameters);
+
+	void UpdateResults(FRHICommandListImmediate& RHICmdList, const FOceanCSParameters& Parameters);
+
+private:
+	//Private constructor to prevent client from instanciating
+	FOceanCSManager() = default;
+
+	//The singleton instance
+	static FOceanCSManager* instance;
+
+	//Cached parameters, written on the game thread and copied to the render thread by BeginRendering
+	FOceanCSParameters cachedParams;
+	bool bCachedParamsAreValid = false;
+
+	//Render thread state
+	FOceanSimulation Simulation;
+};
@@ -0,0 +1,131 @@
+#include "OceanSpectrum.h"
+
+#include "Async/ParallelFor.h"
+#include "FFTCPU.h"
+
+namespace
+{
+	FVector2D ComplexMul(const FVector2D& A, const FVector2D& B)
+	{
+		return FVector2D(A.X * B.X - A.Y * B.Y, A.X * B.Y + A.Y * B.X);
+	}
+}
+
+uint32 FOceanSpectrumCPU::PcgHash(uint32 Value)
+{
+	const uint32 State = Value * 747796405u + 2891336453u;
+	const uint32 Word = ((State >> ((State >> 28u) + 4u)) ^ State) * 277803737u;
+	return (Word >> 22u) ^ Word;
+}
+
+FVector2D FOceanSpectrumCPU::GaussianPair(uint32 X, uint32 Y, uint32 Seed)
+{
+	const uint32 Hash0 = PcgHash(X + PcgHash(Y + PcgHash(Seed)));
+	const uint32 Hash1 = PcgHash(Hash0);
+	//Box-Muller, U0 in (0, 1] so that its log is finite
+	const float U0 = (float)((Hash0 >> 8) + 1) * (1.f / 16777216.f);
+	const float U1 = (float)(Hash1 >> 8) * (1.f / 16777216.f);
+	const float Radius = FMath::Sqrt(-2.f * FMath::Loge(U0));
+	float Sin, Cos;
+	FMath::SinCos(&Sin, &Cos, 2.f * PI * U1);
+	return FVector2D(Radius * Cos, Radius * Sin);
+}
+
+FVector2D FOceanSpectrumCPU::GetWaveVector(const FOceanSpectrumSettings& Settings, uint32 X, uint32 Y)
+{
+	const int32 HalfResolution = Settings.Resolution / 2;
+	const int32 WaveNumberX = (int32)X < HalfResolution ? (int32)X : (int32)X - Settings.Resolution;
+	const int32 WaveNumberY = (int32)Y < HalfResolution ? (int32)Y : (int32)Y - Settings.Resolution;
+	return FVector2D((float)WaveNumberX, (float)WaveNumberY) * (2.f * PI / Settings.PatchSize);
+}
+
+float FOceanSpectrumCPU::EvaluateSpectrum(const FOceanSpectrumSettings& Settings, FVector2D WaveVector)
+{
+	const float K = WaveVector.Size();
+	if (K < 1e-6f)
+	{
+		return 0.f;
+	}
+
+	const float CosTheta = FVector2D::DotProduct(WaveVector / K, Settings.WindDirection.GetSafeNormal());
+	const float SmallWaveDamping = FMath::Exp(-K * K * Settings.SmallWaveLength * Settings.SmallWaveLength);
+	if (Settings.Spectrum == EOceanSpectrum::Phillips)
+	{
+		const float LargestWave = Settings.WindSpeed * Settings.WindSpeed / Gravity;
+		const float KL = K * LargestWave;
+		return Settings.PhillipsAmplitude * FMath::Exp(-1.f / (KL * KL)) / (K * K * K * K) * CosTheta * CosTheta * SmallWaveDamping;
+	}
+
+	//JONSWAP frequency spectrum S(w), converted to the wave vector with dw/dk = g / 2w and the polar Jacobian 1 / k
+	const float Omega = FMath::Sqrt(Gravity * K);
+	const float Alpha = 0.076f * FMath::Pow(Settings.WindSpeed * Settings.WindSpeed / (Settings.Fetch * Gravity), 0.22f);
+	const float PeakOmega = 22.f * FMath::Pow(Gravity * Gravity / (Settings.WindSpeed * Settings.Fetch), 1.f / 3.f);
+	const float Sigma = Omega <= PeakOmega ? 0.07f : 0.09f;
+	const float PeakShape = FMath::Exp(-FMath::Square(Omega - PeakOmega) / (2.f * Sigma * Sigma * PeakOmega * PeakOmega));
+	const float OmegaSpectrum = Alpha * Gravity * Gravity / FMath::Pow(Omega, 5.f) * FMath::Exp(-1.25f * FMath::Pow(PeakOmega / Omega, 4.f))
+		* FMath::Pow(Settings.PeakEnhancement, PeakShape);
+	const float Spreading = CosTheta > 0.f ? 2.f / PI * CosTheta * CosTheta : 0.f;
+	return OmegaSpectrum * (Gravity / (2.f * Omega)) / K * Spreading * SmallWaveDamping;
+}
+
+FVector4 FOceanSpectrumCPU::EvaluateInitialSpectrum(const FOceanSpectrumSettings& Settings, uint32 X, uint32 Y)
+{
+	const float DeltaK = 2.f * PI / Settings.PatchSize;
+	auto H0 = [&Settings, DeltaK](uint32 TexelX, uint32 TexelY)
+	{
+		const float Amplitude = FMath::Sqrt(EvaluateSpectrum(Settings, GetWaveVector(Settings, TexelX, TexelY)) * DeltaK * DeltaK * 0.5f);
+		return GaussianPair(TexelX, TexelY, Settings.Seed) * Amplitude;
+	};
+
+	const uint32 Resolution = (uint32)Settings.Resolution;
+	const FVector2D H0K = H0(X, Y);
+	const FVector2D H0MinusK = H0((Resolution - X) % Resolution, (Resolution - Y) % Resolution);
+	return FVector4(H0K.X, H0K.Y, H0MinusK.X, -H0MinusK.Y);
+}
+
+void FOceanSpectrumCPU::GenerateDisplacement(const FOceanSpectrumSettings& Settings, float Time, float Choppiness, TArray<FVector>& OutDisplacement)
+{
+	const int32 Resolution = Settings.Resolution;
+	check(FMath::IsPowerOfTwo(Resolution));
+
+	//Same packing as TimeSpectrumCS: HeightAndX = h + i Dx, Y = Dy + i 0. Both halves are real after the inverse transform
+	TArray<FVector2D> HeightAndX;
+	TArray<FVector2D> DisplacementY;
+	HeightAndX.SetNumUninitialized(Resolution * Resolution);
+	DisplacementY.SetNumUninitialized(Resolution * Resolution);
+	ParallelFor(Resolution, [&Settings, &HeightAndX, &DisplacementY, Resolution, Time](int32 Y)
+	{
+		for (int32 X = 0; X < Resolution; ++X)
+		{
+			const int32 Index = Y * Resolution + X;
+			const FVector2D WaveVector = GetWaveVector(Settings, X, Y);
+			const float K = WaveVector.Size();
+			if (K < 1e-6f || X == Resolution / 2 || Y == Resolution / 2)
+			{
+				HeightAndX[Index] = FVector2D::ZeroVector;
+				DisplacementY[Index] = FVector2D::ZeroVector;
+				continue;
+			}
+
+			const FVector4 H0 = EvaluateInitialSpectrum(Settings, X, Y);
+			float Sin, Cos;
+			FMath::SinCos(&Sin, &Cos, FMath::Sqrt(Gravity * K) * Time);
+			const FVector2D Height = ComplexMul(FVector2D(H0.X, H0.Y), FVector2D(Cos, Sin)) + ComplexMul(FVector2D(H0.Z, H0.W), FVector2D(Cos, -Sin));
+			//-i k / |k| h
+			const FVector2D DisplacementXSpectrum = ComplexMul(FVector2D(0.f, -WaveVector.X / K), Height);
+			const FVector2D DisplacementYSpectrum = ComplexMul(FVector2D(0.f, -WaveVector.Y / K), Height);
+			HeightAndX[Index] = Height + FVector2D(-DisplacementXSpectrum.Y, DisplacementXSpectrum.X);
+			DisplacementY[Index] = DisplacementYSpectrum;
+		}
+	});
+
+	const FIntPoint Size(Resolution, Resolution);
+	FFFTCPU::Transform2D(HeightAndX, Size, EFFTDirection::Inverse);
+	FFFTCPU::Transform2D(DisplacementY, Size, EFFTDirection::Inverse);
+
+	OutDisplacement.SetNumUninitialized(Resolution * Resolution);
+	for (int32 Index = 0; Index < OutDisplacement.Num(); ++Index)
+	{
+		OutDisplacement[Index] = FVector(Choppiness * HeightAndX[Index].Y, Choppiness * DisplacementY[Index].X, HeightAndX[Index].X);
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EOceanSpectrum : uint8
+{
+	//Tessendorf's Phillips spectrum, PhillipsAmplitude scales it
+	Phillips,
+	//Fetch limited JONSWAP spectrum with a cos^2 spreading downwind
+	JONSWAP,
+};
+
+//What the initial spectrum of the ocean depends on. Changing any of these regenerates it, the time and the choppiness don't
+struct FOceanSpectrumSettings
+{
+	EOceanSpectrum Spectrum = EOceanSpectrum::Phillips;
+	//Texels per side of the heightfield, see FFFTCompute::IsSupportedSize
+	int32 Resolution = 512;
+	//World size of the tiling patch in meters
+	float PatchSize = 500.f;
+	//Wind speed in m/s
+	float WindSpeed = 20.f;
+	//Normalized wind direction in the patch plane
+	FVector2D WindDirection = FVector2D(1.f, 0.f);
+	float PhillipsAmplitude = 0.0081f;
+	//JONSWAP distance over which the wind blows in meters
+	float Fetch = 100000.f;
+	//JONSWAP gamma
+	float PeakEnhancement = 3.3f;
+	//Waves shorter than this in meters are damped
+	float SmallWaveLength = 0.5f;
+	uint32 Seed = 0;
+
+	bool operator==(const FOceanSpectrumSettings& Other) const
+	{
+		return Spectrum == Other.Spectrum && Resolution == Other.Resolution && PatchSize == Other.PatchSize && WindSpeed == Other.WindSpeed
+			&& WindDirection == Other.WindDirection && PhillipsAmplitude == Other.PhillipsAmplitude && Fetch == Other.Fetch
+			&& PeakEnhancement == Other.PeakEnhancement && SmallWaveLength == Other.SmallWaveLength && Seed == Other.Seed;
+	}
+
+	bool operator!=(const FOceanSpectrumSettings& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+/// <summary>
+/// CPU implementation of the ocean kernels in OceanCS.usf, every function mirrors its HLSL counterpart
+/// GenerateDisplacement runs the whole pipeline with FFFTCPU, for headless bakes and to validate FOceanSimulation
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FOceanSpectrumCPU
+{
+	static constexpr float Gravity = 9.81f;
+
+	//Mirrors PcgHash
+	static uint32 PcgHash(uint32 Value);
+
+	//Mirrors GaussianPair, two independent standard normal values for the texel
+	static FVector2D GaussianPair(uint32 X, uint32 Y, uint32 Seed);
+
+	//Mirrors GetWaveVector. Texel N holds the wave number N for N < Resolution / 2 and N - Resolution after that, so no shift is needed around the FFT
+	static FVector2D GetWaveVector(const FOceanSpectrumSettings& Settings, uint32 X, uint32 Y);
+
+	//Mirrors SpectrumDensity, the variance of the height per unit of wave vector area
+	static float EvaluateSpectrum(const FOceanSpectrumSettings& Settings, FVector2D WaveVector);
+
+	//Mirrors InitialSpectrumCS: h0(k) in XY and conj(h0(-k)) in ZW
+	static FVector4 EvaluateInitialSpectrum(const FOceanSpectrumSettings& Settings, uint32 X, uint32 Y);
+
+	//Fills OutDisplacement with Resolution^2 texels (row-major): the horizontal displacement scaled by Choppiness in XY and the height in Z
+	static void GenerateDisplacement(const FOceanSpectrumSettings& Settings, float Time, float Choppiness, TArray<FVector>& OutDisplacement);
+};
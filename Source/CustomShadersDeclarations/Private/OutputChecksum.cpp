@@ -0,0 +1,112 @@
+#include "OutputChecksum.h"
+
+#include "Async/Async.h"
+#include "WhiteNoiseCPU.h"
+
+FOutputChecksumMonitor::~FOutputChecksumMonitor()
+{
+	check(IsInRenderingThread());
+	for (FPendingCheck& Slot : Pending)
+	{
+		//The references only capture values, waiting keeps the thread pool from outliving the results
+		if (Slot.Reference.IsValid())
+		{
+			Slot.Reference.Wait();
+		}
+		Slot.Buffer.Release();
+	}
+}
+
+FRHIUnorderedAccessView* FOutputChecksumMonitor::BeginDispatch(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+	CollectChecks();
+
+	DispatchSlot = INDEX_NONE;
+	for (int32 Index = 0; Index < MaxPendingChecks; ++Index)
+	{
+		if (!Pending[Index].bInFlight)
+		{
+			DispatchSlot = Index;
+			break;
+		}
+	}
+
+	if (DispatchSlot == INDEX_NONE)
+	{
+		++NumSkipped;
+		return nullptr;
+	}
+
+	FPendingCheck& Slot = Pending[DispatchSlot];
+	if (!Slot.Buffer.Buffer.IsValid())
+	{
+		Slot.Buffer.Initialize(sizeof(uint32), 2, PF_R32_UINT, BUF_SourceCopy, TEXT("WhiteNoiseCS_OutputChecksum"));
+		Slot.Readback = MakeUnique<FRHIGPUBufferReadback>(TEXT("WhiteNoiseCS_OutputChecksumReadback"));
+	}
+	//The groups XOR into the buffer, it starts from zero
+	RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, Slot.Buffer.UAV);
+	RHICmdList.ClearUAVUint(Slot.Buffer.UAV, FUintVector4(0, 0, 0, 0));
+	RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EComputeToCompute, Slot.Buffer.UAV);
+	return Slot.Buffer.UAV;
+}
+
+void FOutputChecksumMonitor::EndDispatch(FRHICommandListImmediate& RHICmdList, FIntPoint Size, uint32 Seed, uint32 TimeStamp, ENoiseHash Hash)
+{
+	check(IsInRenderingThread());
+	if (DispatchSlot == INDEX_NONE)
+	{
+		return;
+	}
+
+	FPendingCheck& Slot = Pending[DispatchSlot];
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, EResourceTransitionPipeline::EComputeToGfx, Slot.Buffer.UAV);
+	Slot.Readback->EnqueueCopy(RHICmdList, Slot.Buffer.Buffer, 2 * sizeof(uint32));
+	Slot.Reference = Async(EAsyncExecution::ThreadPool, [Size, Seed, TimeStamp, Hash]()
+	{
+		return FWhiteNoiseCPU::Checksum(Size, Seed, TimeStamp, Hash);
+	});
+	Slot.Size = Size;
+	Slot.Seed = Seed;
+	Slot.TimeStamp = TimeStamp;
+	Slot.Hash = Hash;
+	Slot.bInFlight = true;
+	DispatchSlot = INDEX_NONE;
+}
+
+void FOutputChecksumMonitor::CollectChecks()
+{
+	for (FPendingCheck& Slot : Pending)
+	{
+		if (!Slot.bInFlight || !Slot.Readback->IsReady() || !Slot.Reference.IsReady())
+		{
+			continue;
+		}
+
+		const uint32* Halves = (const uint32*)Slot.Readback->Lock(2 * sizeof(uint32));
+		const uint64 GPUChecksum = Halves ? ((uint64)Halves[1] << 32) | Halves[0] : 0;
+		Slot.Readback->Unlock();
+		const uint64 CPUChecksum = Slot.Reference.Get();
+		Slot.Reference = TFuture<uint64>();
+		Slot.bInFlight = false;
+
+		if (Halves && GPUChecksum == CPUChecksum)
+		{
+			++NumMatches;
+			continue;
+		}
+
+		++NumMismatches;
+		UE_LOG(LogTemp, Warning, TEXT("White noise checksum mismatch for %dx%d, seed %u, frame %u, %s: GPU %016llx, CPU %016llx (%d mismatches, %d matches)"),
+			   Slot.Size.X, Slot.Size.Y, Slot.Seed, Slot.TimeStamp, ANSI_TO_TCHAR(FNoiseMath::GetHashName(Slot.Hash)), GPUChecksum, CPUChecksum, NumMismatches, NumMatches);
+	}
+}
+
+void FOutputChecksumMonitor::Report()
+{
+	check(IsInRenderingThread());
+	UE_LOG(LogTemp, Log, TEXT("White noise output checksums: %d matches, %d mismatches, %d frames skipped"), NumMatches, NumMismatches, NumSkipped);
+	NumMatches = 0;
+	NumMismatches = 0;
+	NumSkipped = 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "RHIGPUReadback.h"
+#include "RenderResource.h"
+#include "Core/NoiseMath.h"
+
+/// <summary>
+/// Checks in production that the white noise output is bit exact with FWhiteNoiseCPU, across machines and driver versions.
+/// On checked frames the kernel XORs a 64 bit hash of every texel into an 8 byte buffer, only those 8 bytes are read back. The CPU reference
+/// for the same size, seed and TimeStamp is computed on the thread pool meanwhile, and mismatches are logged and counted.
+/// Every hash family is checked: the integer ones output the top 24 bits of an integer hash, exact in a float on any GPU, and hash12 is
+/// precise in the shader so no multiply-add fusing changes its bits. A mismatch is a real bug, or an RHI that ignores precise.
+/// CustomShaders.WhiteNoise.ChecksumBenchmark measures the cost of a checked frame.
+/// Render thread only
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FOutputChecksumMonitor
+{
+public:
+	~FOutputChecksumMonitor();
+
+	//Collects the completed checks and returns the buffer the next dispatch accumulates its checksum into, nullptr when too many checks are
+	//in flight
+	FRHIUnorderedAccessView* BeginDispatch(FRHICommandListImmediate& RHICmdList);
+
+	//Call after the dispatch that received the buffer of BeginDispatch. Queues its readback and starts the CPU reference
+	void EndDispatch(FRHICommandListImmediate& RHICmdList, FIntPoint Size, uint32 Seed, uint32 TimeStamp, ENoiseHash Hash);
+
+	//Logs the counters since the last report and starts over
+	void Report();
+
+private:
+	//Checks the GPU and the CPU can be behind before frames are skipped
+	static constexpr int32 MaxPendingChecks = 4;
+
+	struct FPendingCheck
+	{
+		FRWBuffer Buffer;
+		TUniquePtr<FRHIGPUBufferReadback> Readback;
+		TFuture<uint64> Reference;
+		FIntPoint Size = FIntPoint::ZeroValue;
+		uint32 Seed = 0;
+		uint32 TimeStamp = 0;
+		ENoiseHash Hash = ENoiseHash::Hash12;
+		bool bInFlight = false;
+	};
+
+	void CollectChecks();
+
+	FPendingCheck Pending[MaxPendingChecks];
+	//Slot BeginDispatch handed out, INDEX_NONE outside a dispatch
+	int32 DispatchSlot = INDEX_NONE;
+
+	int32 NumMatches = 0;
+	int32 NumMismatches = 0;
+	int32 NumSkipped = 0;
+};
@@ -0,0 +1,164 @@
+#include "ParameterRecording.h"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "ComputeShaderDeclaration.h"
+
+namespace
+{
+	//"WNPR"
+	const uint32 ParameterLogMagic = 0x52504E57;
+	//2: the hash family of the Parameters records
+	//3: the normal targets and strength
+	const uint32 ParameterLogVersion = 3;
+
+	void SerializePacked(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = uint32(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = int32(Packed);
+	}
+
+	//Shared by the writer and the reader so both sides always agree on the layout
+	void SerializeRecord(FArchive& Ar, FParameterRecord& Record, uint32& DeltaMicroseconds)
+	{
+		uint8 Type = uint8(Record.Type);
+		Ar << Type;
+		Record.Type = EParameterRecordType(FMath::Min(Type, uint8(EParameterRecordType::Count)));
+		Ar.SerializeIntPacked(DeltaMicroseconds);
+
+		switch (Record.Type)
+		{
+		case EParameterRecordType::Parameters:
+			Ar.SerializeIntPacked(Record.TimeStamp);
+			Ar.SerializeIntPacked(Record.Seed);
+			{
+				uint8 Hash = uint8(Record.Hash);
+				Ar << Hash;
+				//An unknown family falls back to the default rather than indexing past the permutations
+				Record.Hash = Hash < uint8(ENoiseHash::Count) ? ENoiseHash(Hash) : ENoiseHash::Hash12;
+			}
+			Ar << Record.DistanceFieldThreshold;
+			Ar << Record.NormalStrength;
+			break;
+
+		case EParameterRecordType::Targets:
+			{
+				FParameterRecordTargets& Targets = Record.Targets;
+				SerializePacked(Ar, Targets.Size.X);
+				SerializePacked(Ar, Targets.Size.Y);
+				uint8 Format = uint8(Targets.Format);
+				uint8 Flags = (Targets.bCompressed ? 1 : 0) | (Targets.bDistanceField ? 2 : 0) | (Targets.bNormals ? 4 : 0) | (Targets.bCompressedNormals ? 8 : 0);
+				Ar << Format << Flags;
+				Targets.Format = EPixelFormat(Format);
+				Targets.bCompressed = (Flags & 1) != 0;
+				Targets.bDistanceField = (Flags & 2) != 0;
+				Targets.bNormals = (Flags & 4) != 0;
+				Targets.bCompressedNormals = (Flags & 8) != 0;
+				SerializePacked(Ar, Targets.FrameRingSize.X);
+				SerializePacked(Ar, Targets.FrameRingSize.Y);
+				SerializePacked(Ar, Targets.FrameRingSize.Z);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+FParameterRecorder::FParameterRecorder(const FString& InPath)
+	: Path(InPath)
+	, Writer(Data)
+	, StartTime(FPlatformTime::Seconds())
+{
+	uint32 Magic = ParameterLogMagic;
+	uint32 Version = ParameterLogVersion;
+	Writer << Magic << Version;
+}
+
+void FParameterRecorder::RecordParameters(const FWhiteNoiseCSParameters& Parameters)
+{
+	check(IsInGameThread());
+	FParameterRecord Record;
+	Record.Targets.Size = Parameters.GetRenderTargetSize();
+	Record.Targets.Format = Parameters.RenderTarget ? Parameters.RenderTarget->GetFormat() : PF_Unknown;
+	Record.Targets.bCompressed = Parameters.CompressedTexture != nullptr;
+	Record.Targets.bDistanceField = Parameters.DistanceFieldTarget != nullptr;
+	//Same condition as FWhiteNoiseCSManager::WritesNormals, a target of another size writes nothing
+	Record.Targets.bNormals = Parameters.NormalTarget && FIntPoint(Parameters.NormalTarget->SizeX, Parameters.NormalTarget->SizeY) == Record.Targets.Size;
+	Record.Targets.bCompressedNormals = Record.Targets.bNormals && Parameters.CompressedNormalTexture != nullptr;
+	Record.Targets.FrameRingSize = Parameters.GetFrameRingSize();
+	if (Record.Targets != LastTargets)
+	{
+		Record.Type = EParameterRecordType::Targets;
+		Write(Record);
+		LastTargets = Record.Targets;
+	}
+
+	Record.Type = EParameterRecordType::Parameters;
+	Record.TimeStamp = Parameters.TimeStamp;
+	Record.Seed = Parameters.Seed;
+	Record.Hash = Parameters.Hash;
+	Record.DistanceFieldThreshold = Parameters.DistanceFieldThreshold;
+	Record.NormalStrength = Parameters.NormalStrength;
+	Write(Record);
+}
+
+void FParameterRecorder::RecordEvent(EParameterRecordType Type)
+{
+	check(IsInGameThread());
+	FParameterRecord Record;
+	Record.Type = Type;
+	Write(Record);
+}
+
+void FParameterRecorder::Write(FParameterRecord& Record)
+{
+	const uint64 Microseconds = uint64((FPlatformTime::Seconds() - StartTime) * 1e6);
+	uint32 DeltaMicroseconds = uint32(FMath::Min<uint64>(Microseconds - LastMicroseconds, MAX_uint32));
+	LastMicroseconds += DeltaMicroseconds;
+	SerializeRecord(Writer, Record, DeltaMicroseconds);
+	++NumRecords;
+}
+
+bool FParameterRecorder::Save() const
+{
+	return FFileHelper::SaveArrayToFile(Data, *Path);
+}
+
+bool FParameterRecorder::Load(const FString& Path, TArray<FParameterRecord>& OutRecords)
+{
+	OutRecords.Reset();
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *Path))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(FileData);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic << Version;
+	if (Reader.IsError() || Magic != ParameterLogMagic || Version != ParameterLogVersion)
+	{
+		return false;
+	}
+
+	uint64 Microseconds = 0;
+	while (!Reader.AtEnd())
+	{
+		FParameterRecord Record;
+		uint32 DeltaMicroseconds = 0;
+		SerializeRecord(Reader, Record, DeltaMicroseconds);
+		if (Reader.IsError() || Record.Type == EParameterRecordType::Count)
+		{
+			return false;
+		}
+		Microseconds += DeltaMicroseconds;
+		Record.Time = Microseconds * 1e-6;
+		OutRecords.Add(Record);
+	}
+	return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "Serialization/MemoryWriter.h"
+#include "Core/NoiseMath.h"
+
+struct FWhiteNoiseCSParameters;
+
+//Kind of event an FParameterRecord holds
+enum class EParameterRecordType : uint8
+{
+	//An UpdateParameters call
+	Parameters,
+	//The targets of the next submissions changed size, format or presence
+	Targets,
+	//A BeginRendering call
+	BeginRendering,
+	//An EndRendering call
+	EndRendering,
+
+	Count,
+};
+
+//The textures the submissions render into, what a replay has to create to reproduce them
+struct FParameterRecordTargets
+{
+	FIntPoint Size = FIntPoint::ZeroValue;
+	EPixelFormat Format = PF_Unknown;
+	bool bCompressed = false;
+	bool bDistanceField = false;
+	//A normal target of the output size, see FWhiteNoiseCSParameters::NormalTarget
+	bool bNormals = false;
+	//A BC5 copy of the normals, see FWhiteNoiseCSParameters::CompressedNormalTexture
+	bool bCompressedNormals = false;
+	FIntVector FrameRingSize = FIntVector::ZeroValue;
+
+	bool operator==(const FParameterRecordTargets& Other) const
+	{
+		return Size == Other.Size && Format == Other.Format && bCompressed == Other.bCompressed && bDistanceField == Other.bDistanceField
+			&& bNormals == Other.bNormals && bCompressedNormals == Other.bCompressedNormals && FrameRingSize == Other.FrameRingSize;
+	}
+	bool operator!=(const FParameterRecordTargets& Other) const { return !(*this == Other); }
+};
+
+//One recorded event
+struct FParameterRecord
+{
+	EParameterRecordType Type = EParameterRecordType::Parameters;
+	//Seconds since the recording started
+	double Time = 0.0;
+
+	//Parameters only
+	uint32 TimeStamp = 0;
+	uint32 Seed = 0;
+	ENoiseHash Hash = ENoiseHash::Hash12;
+	float DistanceFieldThreshold = 0.5f;
+	float NormalStrength = 1.f;
+
+	//Targets only
+	FParameterRecordTargets Targets;
+};
+
+/// <summary>
+/// Records the parameter stream the consumers submit to FWhiteNoiseCSManager so the ParameterReplay commandlet can play it back.
+/// The log is a magic and a version followed by one entry per event: its type, the microseconds since the previous event and its payload.
+/// Integers are packed with FArchive::SerializeIntPacked and the targets are only written when they change, a steady consumer costs about
+/// ten bytes per frame. Game thread only
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FParameterRecorder
+{
+public:
+	explicit FParameterRecorder(const FString& InPath);
+
+	void RecordParameters(const FWhiteNoiseCSParameters& Parameters);
+	void RecordEvent(EParameterRecordType Type);
+
+	//Writes the log to the path given at construction
+	bool Save() const;
+
+	const FString& GetPath() const { return Path; }
+	int32 GetNumRecords() const { return NumRecords; }
+
+	//Reads a log written by Save, false if the file is missing, truncated or of another version
+	static bool Load(const FString& Path, TArray<FParameterRecord>& OutRecords);
+
+private:
+	void Write(FParameterRecord& Record);
+
+	const FString Path;
+	TArray<uint8> Data;
+	FMemoryWriter Writer;
+
+	const double StartTime;
+	uint64 LastMicroseconds = 0;
+	FParameterRecordTargets LastTargets;
+	int32 NumRecords = 0;
+};
@@ -0,0 +1,135 @@
+#include "PingPongTexture.h"
+
+#include "HAL/IConsoleManager.h"
+#include "TickableObjectRenderThread.h"
+
+static TAutoConsoleVariable<int32> CVarPingPongIdleReleaseFrames(
+	TEXT("CustomShaders.PingPong.IdleReleaseFrames"),
+	120,
+	TEXT("Frames after which the buffers of a ping-pong texture that isn't used anymore are returned to the render target pool, 0 keeps them forever."),
+	ECVF_RenderThreadSafe);
+
+/// <summary>
+/// Returns the buffers of the idle ping-pong textures to the pool, ticked on the render thread
+/// </summary>
+class FPingPongIdleReleaser : public FTickableObjectRenderThread
+{
+public:
+	//Created on the render thread the first time a texture is allocated
+	static FPingPongIdleReleaser& Get()
+	{
+		check(IsInRenderingThread());
+		static FPingPongIdleReleaser* Instance = new FPingPongIdleReleaser();
+		return *Instance;
+	}
+
+	void Add(FPingPongTexture* Texture) { Textures.AddUnique(Texture); }
+	void Remove(FPingPongTexture* Texture) { Textures.RemoveSwap(Texture); }
+
+	virtual bool IsTickable() const override { return Textures.Num() > 0; }
+
+	virtual void Tick(float DeltaTime) override
+	{
+		const int32 IdleReleaseFrames = CVarPingPongIdleReleaseFrames.GetValueOnRenderThread();
+		if (IdleReleaseFrames <= 0)
+		{
+			return;
+		}
+
+		for (int32 Index = Textures.Num() - 1; Index >= 0; --Index)
+		{
+			if (GFrameNumberRenderThread - Textures[Index]->LastUsedFrame > (uint32)IdleReleaseFrames)
+			{
+				//Release removes the texture from the list
+				Textures[Index]->Release();
+			}
+		}
+	}
+
+	virtual TStatId GetStatId() const override
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FPingPongIdleReleaser, STATGROUP_Tickables);
+	}
+
+private:
+	FPingPongIdleReleaser()
+		: FTickableObjectRenderThread(true, false)
+	{ }
+
+	TArray<FPingPongTexture*> Textures;
+};
+
+
+FPingPongTexture::~FPingPongTexture()
+{
+	if (bTrackedForIdleRelease)
+	{
+		check(IsInRenderingThread());
+		FPingPongIdleReleaser::Get().Remove(this);
+	}
+}
+
+bool FPingPongTexture::Allocate(FRHICommandListImmediate& RHICmdList, const FPooledRenderTargetDesc& InDesc, const TCHAR* InName)
+{
+	check(IsInRenderingThread());
+	LastUsedFrame = GFrameNumberRenderThread;
+	if (IsAllocated() && Desc.Compare(InDesc, true))
+	{
+		return false;
+	}
+
+	Desc = InDesc;
+	Name = InName;
+	for (int32 BufferIndex = 0; BufferIndex < 2; ++BufferIndex)
+	{
+		GRenderTargetPool.FindFreeElement(RHICmdList, Desc, Buffers[BufferIndex], Name);
+	}
+	CurrentIndex = 0;
+
+	if (!bTrackedForIdleRelease)
+	{
+		FPingPongIdleReleaser::Get().Add(this);
+		bTrackedForIdleRelease = true;
+	}
+	return true;
+}
+
+void FPingPongTexture::Register(FRDGBuilder& GraphBuilder)
+{
+	check(IsAllocated());
+	LastUsedFrame = GFrameNumberRenderThread;
+	for (int32 BufferIndex = 0; BufferIndex < 2; ++BufferIndex)
+	{
+		Textures[BufferIndex] = GraphBuilder.RegisterExternalTexture(Buffers[BufferIndex], Name, ERenderTargetTexture::ShaderResource, ERDGTextureFlags::MultiFrame);
+	}
+}
+
+FRDGTextureUAVRef FPingPongTexture::Advance(FRDGBuilder& GraphBuilder)
+{
+	check(Textures[0] && Textures[1]);
+	CurrentIndex = 1 - CurrentIndex;
+	return GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Textures[CurrentIndex]));
+}
+
+void FPingPongTexture::AddClearPass(FRDGBuilder& GraphBuilder, const FLinearColor& ClearColor)
+{
+	for (FRDGTextureRef Texture : Textures)
+	{
+		AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Texture)), ClearColor);
+	}
+}
+
+void FPingPongTexture::Release()
+{
+	check(IsInRenderingThread());
+	Buffers[0].SafeRelease();
+	Buffers[1].SafeRelease();
+	Textures[0] = Textures[1] = nullptr;
+	CurrentIndex = 0;
+	Desc = FPooledRenderTargetDesc();
+	if (bTrackedForIdleRelease)
+	{
+		FPingPongIdleReleaser::Get().Remove(this);
+		bTrackedForIdleRelease = false;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+
+/// <summary>
+/// Double-buffered texture whose content persists across frames, the state of an iterative multi-frame kernel (fluid fields, reaction-diffusion, erosion...)
+/// Both buffers are pooled render targets registered with each graph as external multi-frame textures. A pass reads GetCurrent() and writes the UAV
+/// returned by Advance(), which swaps the buffers so GetCurrent() is what the pass wrote.
+/// Allocate() only touches the pool when the description changes, so the steady state doesn't allocate. Buffers that weren't registered for
+/// CustomShaders.PingPong.IdleReleaseFrames frames are returned to the pool. Every call happens on the render thread
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FPingPongTexture
+{
+public:
+	FPingPongTexture() = default;
+	~FPingPongTexture();
+
+	FPingPongTexture(const FPingPongTexture&) = delete;
+	FPingPongTexture& operator=(const FPingPongTexture&) = delete;
+
+	//Makes sure both buffers match Desc. Returns true when they were (re)allocated, their content is then undefined
+	bool Allocate(FRHICommandListImmediate& RHICmdList, const FPooledRenderTargetDesc& Desc, const TCHAR* InName);
+
+	//Registers both buffers with the graph, call once per graph before the other graph functions
+	void Register(FRDGBuilder& GraphBuilder);
+
+	//The latest state
+	FRDGTextureRef GetCurrent() const { return Textures[CurrentIndex]; }
+
+	//Buffer by index, for passes that have to touch both of them
+	FRDGTextureRef GetBuffer(int32 BufferIndex) const { return Textures[BufferIndex]; }
+
+	//Returns a UAV of the other buffer and swaps, the pass writing to it produces the new current state
+	FRDGTextureUAVRef Advance(FRDGBuilder& GraphBuilder);
+
+	//Clears both buffers
+	void AddClearPass(FRDGBuilder& GraphBuilder, const FLinearColor& ClearColor = FLinearColor::Black);
+
+	//Returns both buffers to the pool
+	void Release();
+
+	bool IsAllocated() const { return Buffers[0].IsValid(); }
+	const FPooledRenderTargetDesc& GetDesc() const { return Desc; }
+
+private:
+	friend class FPingPongIdleReleaser;
+
+	TRefCountPtr<IPooledRenderTarget> Buffers[2];
+	FRDGTextureRef Textures[2] = { nullptr, nullptr };
+	int32 CurrentIndex = 0;
+
+	FPooledRenderTargetDesc Desc;
+	const TCHAR* Name = TEXT("PingPongTexture");
+	uint32 LastUsedFrame = 0;
+	bool bTrackedForIdleRelease = false;
+};
@@ -0,0 +1,522 @@
+#include "Primitives.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "RHIGPUReadback.h"
+#include "ShaderParameterStruct.h"
+
+#define NUM_THREADS_PER_GROUP 256
+
+static TAutoConsoleVariable<int32> CVarPrimitivesWaveOps(
+	TEXT("CustomShaders.Primitives.WaveOps"),
+	1,
+	TEXT("Uses the wave intrinsic paths of the reduce, scan and compaction primitives when the RHI supports them, 0 forces the groupshared fallback."),
+	ECVF_RenderThreadSafe);
+
+static FAutoConsoleCommand PrimitivesBenchmarkCommand(
+	TEXT("CustomShaders.Primitives.Benchmark"),
+	TEXT("Times the GPU primitives against their CPU counterparts and checks their results. Arguments: [NumElements] [NumIterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumElements = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1 << 22;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10;
+		ENQUEUE_RENDER_COMMAND(PrimitivesBenchmarkCommand)(
+			[NumElements, NumIterations](FRHICommandListImmediate& RHICmdList)
+			{
+				FComputePrimitives::RunBenchmark(RHICmdList, NumElements, NumIterations);
+			});
+	}));
+
+BEGIN_SHADER_PARAMETER_STRUCT(FPrimitivesInputParameters, )
+	SHADER_PARAMETER(uint32, NumElements)
+	SHADER_PARAMETER(uint32, InputWidth)
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, InputTexture)
+	SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float>, InputBuffer)
+END_SHADER_PARAMETER_STRUCT()
+
+/// <summary>
+/// Base class of the primitive passes, they all live in PrimitivesCS.usf. The passes with a FWaveOpsDim only compile it where the platform
+/// has wave operations
+/// </summary>
+class FPrimitivesCS : public FGlobalShader
+{
+public:
+	class FWaveOpsDim : SHADER_PERMUTATION_BOOL("WAVE_OPS");
+	class FInputTextureDim : SHADER_PERMUTATION_BOOL("INPUT_TEXTURE");
+
+	FPrimitivesCS() { }
+	FPrimitivesCS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{ }
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP);
+	}
+
+protected:
+	static bool ShouldCompileWaveOps(const FGlobalShaderPermutationParameters& Parameters, bool bWaveOps)
+	{
+		return ShouldCompilePermutation(Parameters) && (!bWaveOps || RHISupportsWaveOperations(Parameters.Platform));
+	}
+
+	static void ModifyWaveOpsEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment, bool bWaveOps)
+	{
+		ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		if (bWaveOps)
+		{
+			OutEnvironment.CompilerFlags.Add(CFLAG_WaveOperations);
+		}
+	}
+};
+
+class FPrimitivesReduceCS : public FPrimitivesCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FPrimitivesReduceCS);
+	SHADER_USE_PARAMETER_STRUCT(FPrimitivesReduceCS, FPrimitivesCS);
+
+	class FReduceOpDim : SHADER_PERMUTATION_INT("REDUCE_OP", 3);
+	using FPermutationDomain = TShaderPermutationDomain<FWaveOpsDim, FInputTextureDim, FReduceOpDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FPrimitivesInputParameters, Input)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<float>, OutputReduce)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileWaveOps(Parameters, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		ModifyWaveOpsEnvironment(Parameters, OutEnvironment, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+};
+
+class FPrimitivesScanCS : public FPrimitivesCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FPrimitivesScanCS);
+	SHADER_USE_PARAMETER_STRUCT(FPrimitivesScanCS, FPrimitivesCS);
+
+	class FInclusiveDim : SHADER_PERMUTATION_BOOL("INCLUSIVE");
+	using FPermutationDomain = TShaderPermutationDomain<FWaveOpsDim, FInclusiveDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(uint32, NumElements)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ScanInput)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputScan)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputGroupTotals)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileWaveOps(Parameters, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		ModifyWaveOpsEnvironment(Parameters, OutEnvironment, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+};
+
+class FPrimitivesAddGroupOffsetsCS : public FPrimitivesCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FPrimitivesAddGroupOffsetsCS);
+	SHADER_USE_PARAMETER_STRUCT(FPrimitivesAddGroupOffsetsCS, FPrimitivesCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(uint32, NumElements)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, GroupOffsets)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputScan)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FPrimitivesCompactCountCS : public FPrimitivesCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FPrimitivesCompactCountCS);
+	SHADER_USE_PARAMETER_STRUCT(FPrimitivesCompactCountCS, FPrimitivesCS);
+
+	using FPermutationDomain = TShaderPermutationDomain<FWaveOpsDim, FInputTextureDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FPrimitivesInputParameters, Input)
+		SHADER_PARAMETER(float, Threshold)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputGroupTotals)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileWaveOps(Parameters, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		ModifyWaveOpsEnvironment(Parameters, OutEnvironment, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+};
+
+class FPrimitivesCompactScatterCS : public FPrimitivesCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FPrimitivesCompactScatterCS);
+	SHADER_USE_PARAMETER_STRUCT(FPrimitivesCompactScatterCS, FPrimitivesCS);
+
+	using FPermutationDomain = TShaderPermutationDomain<FWaveOpsDim, FInputTextureDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FPrimitivesInputParameters, Input)
+		SHADER_PARAMETER(float, Threshold)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, GroupOffsets)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputIndices)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileWaveOps(Parameters, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		ModifyWaveOpsEnvironment(Parameters, OutEnvironment, FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>());
+	}
+};
+
+class FPrimitivesHistogramCS : public FPrimitivesCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FPrimitivesHistogramCS);
+	SHADER_USE_PARAMETER_STRUCT(FPrimitivesHistogramCS, FPrimitivesCS);
+
+	using FPermutationDomain = TShaderPermutationDomain<FInputTextureDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FPrimitivesInputParameters, Input)
+		SHADER_PARAMETER(float, HistogramMin)
+		SHADER_PARAMETER(float, HistogramScale)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputHistogram)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FPrimitivesFillRandomCS : public FPrimitivesCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FPrimitivesFillRandomCS);
+	SHADER_USE_PARAMETER_STRUCT(FPrimitivesFillRandomCS, FPrimitivesCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(uint32, NumElements)
+		SHADER_PARAMETER(uint32, Seed)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<float>, OutputRandomFloats)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, OutputRandomUints)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FPrimitivesReduceCS, "/CustomShaders/PrimitivesCS.usf", "ReduceCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FPrimitivesScanCS, "/CustomShaders/PrimitivesCS.usf", "ScanCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FPrimitivesAddGroupOffsetsCS, "/CustomShaders/PrimitivesCS.usf", "AddGroupOffsetsCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FPrimitivesCompactCountCS, "/CustomShaders/PrimitivesCS.usf", "CompactCountCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FPrimitivesCompactScatterCS, "/CustomShaders/PrimitivesCS.usf", "CompactScatterCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FPrimitivesHistogramCS, "/CustomShaders/PrimitivesCS.usf", "HistogramCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FPrimitivesFillRandomCS, "/CustomShaders/PrimitivesCS.usf", "FillRandomCS", SF_Compute);
+
+
+namespace
+{
+	uint32 GetNumGroups(uint32 NumElements)
+	{
+		check(NumElements <= FComputePrimitives::MaxElements);
+		return FMath::Max(FMath::DivideAndRoundUp(NumElements, FComputePrimitives::ItemsPerGroup), 1u);
+	}
+
+	FPrimitivesInputParameters GetInputParameters(FRDGBuilder& GraphBuilder, const FPrimitivesInput& Input)
+	{
+		check((Input.Texture != nullptr) != (Input.Buffer != nullptr));
+		FPrimitivesInputParameters Parameters;
+		Parameters.NumElements = Input.NumElements;
+		Parameters.InputWidth = Input.Texture ? Input.Texture->Desc.Extent.X : 0;
+		Parameters.InputTexture = Input.Texture;
+		Parameters.InputBuffer = Input.Buffer ? GraphBuilder.CreateSRV(FRDGBufferSRVDesc(Input.Buffer, PF_R32_FLOAT)) : nullptr;
+		return Parameters;
+	}
+
+	FRDGBufferRef CreateUintBuffer(FRDGBuilder& GraphBuilder, uint32 NumElements, const TCHAR* Name)
+	{
+		return GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), NumElements), Name);
+	}
+
+	//One scan level, the group totals are scanned by the next level until they fit in one group. Returns the buffer holding the total
+	FRDGBufferRef AddScanLevel(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGBufferRef Input, FRDGBufferRef Output,
+							   uint32 NumElements, EScanType Type, int32 Level)
+	{
+		const uint32 NumGroups = GetNumGroups(NumElements);
+		FRDGBufferRef GroupTotals = CreateUintBuffer(GraphBuilder, NumGroups, TEXT("PrimitivesScanGroupTotals"));
+		{
+			FPrimitivesScanCS::FPermutationDomain PermutationVector;
+			PermutationVector.Set<FPrimitivesCS::FWaveOpsDim>(FComputePrimitives::UseWaveOperations());
+			PermutationVector.Set<FPrimitivesScanCS::FInclusiveDim>(Type == EScanType::Inclusive);
+			TShaderMapRef<FPrimitivesScanCS> ComputeShader(ShaderMap, PermutationVector);
+
+			FPrimitivesScanCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPrimitivesScanCS::FParameters>();
+			PassParameters->NumElements = NumElements;
+			PassParameters->ScanInput = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(Input, PF_R32_UINT));
+			PassParameters->OutputScan = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Output, PF_R32_UINT));
+			PassParameters->OutputGroupTotals = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(GroupTotals, PF_R32_UINT));
+			FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrimitivesScan L%d %u", Level, NumElements), ComputeShader, PassParameters, FIntVector(NumGroups, 1, 1));
+		}
+
+		if (NumGroups == 1)
+		{
+			return GroupTotals;
+		}
+
+		FRDGBufferRef GroupOffsets = CreateUintBuffer(GraphBuilder, NumGroups, TEXT("PrimitivesScanGroupOffsets"));
+		FRDGBufferRef Total = AddScanLevel(GraphBuilder, ShaderMap, GroupTotals, GroupOffsets, NumGroups, EScanType::Exclusive, Level + 1);
+		{
+			TShaderMapRef<FPrimitivesAddGroupOffsetsCS> ComputeShader(ShaderMap);
+			FPrimitivesAddGroupOffsetsCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPrimitivesAddGroupOffsetsCS::FParameters>();
+			PassParameters->NumElements = NumElements;
+			PassParameters->GroupOffsets = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(GroupOffsets, PF_R32_UINT));
+			PassParameters->OutputScan = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Output, PF_R32_UINT));
+			FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrimitivesAddGroupOffsets L%d", Level), ComputeShader, PassParameters, FIntVector(NumGroups, 1, 1));
+		}
+		return Total;
+	}
+}
+
+bool FComputePrimitives::UseWaveOperations()
+{
+	return CVarPrimitivesWaveOps.GetValueOnRenderThread() != 0 && GRHISupportsWaveOperations && GRHIMinimumWaveSize >= 16
+		&& RHISupportsWaveOperations(GMaxRHIShaderPlatform);
+}
+
+FRDGBufferRef FComputePrimitives::AddReduce(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FPrimitivesInput& Input, EReduceOp Op)
+{
+	FPrimitivesReduceCS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FPrimitivesCS::FWaveOpsDim>(UseWaveOperations());
+	PermutationVector.Set<FPrimitivesReduceCS::FReduceOpDim>((int32)Op);
+
+	//The first level reads the input, the next ones reduce the partial results of the previous one
+	FPrimitivesInput LevelInput = Input;
+	for (int32 Level = 0;; ++Level)
+	{
+		const uint32 NumGroups = GetNumGroups(LevelInput.NumElements);
+		FRDGBufferRef Partials = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(float), NumGroups), TEXT("PrimitivesReducePartials"));
+
+		PermutationVector.Set<FPrimitivesCS::FInputTextureDim>(LevelInput.Texture != nullptr);
+		TShaderMapRef<FPrimitivesReduceCS> ComputeShader(ShaderMap, PermutationVector);
+		FPrimitivesReduceCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPrimitivesReduceCS::FParameters>();
+		PassParameters->Input = GetInputParameters(GraphBuilder, LevelInput);
+		PassParameters->OutputReduce = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Partials, PF_R32_FLOAT));
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrimitivesReduce L%d %u", Level, LevelInput.NumElements), ComputeShader, PassParameters, FIntVector(NumGroups, 1, 1));
+
+		if (NumGroups == 1)
+		{
+			return Partials;
+		}
+		LevelInput = FPrimitivesInput::FromBuffer(Partials, NumGroups);
+	}
+}
+
+FRDGBufferRef FComputePrimitives::AddScan(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGBufferRef Input, FRDGBufferRef Output, uint32 NumElements, EScanType Type)
+{
+	check(Input != Output);
+	return AddScanLevel(GraphBuilder, ShaderMap, Input, Output, NumElements, Type, 0);
+}
+
+FRDGBufferRef FComputePrimitives::AddCompact(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FPrimitivesInput& Input, float Threshold, FRDGBufferRef OutIndices)
+{
+	const uint32 NumGroups = GetNumGroups(Input.NumElements);
+	FPrimitivesCompactCountCS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FPrimitivesCS::FWaveOpsDim>(UseWaveOperations());
+	PermutationVector.Set<FPrimitivesCS::FInputTextureDim>(Input.Texture != nullptr);
+
+	FRDGBufferRef GroupCounts = CreateUintBuffer(GraphBuilder, NumGroups, TEXT("PrimitivesCompactGroupCounts"));
+	{
+		TShaderMapRef<FPrimitivesCompactCountCS> ComputeShader(ShaderMap, PermutationVector);
+		FPrimitivesCompactCountCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPrimitivesCompactCountCS::FParameters>();
+		PassParameters->Input = GetInputParameters(GraphBuilder, Input);
+		PassParameters->Threshold = Threshold;
+		PassParameters->OutputGroupTotals = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(GroupCounts, PF_R32_UINT));
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrimitivesCompactCount %u", Input.NumElements), ComputeShader, PassParameters, FIntVector(NumGroups, 1, 1));
+	}
+
+	FRDGBufferRef GroupOffsets = CreateUintBuffer(GraphBuilder, NumGroups, TEXT("PrimitivesCompactGroupOffsets"));
+	FRDGBufferRef Count = AddScan(GraphBuilder, ShaderMap, GroupCounts, GroupOffsets, NumGroups, EScanType::Exclusive);
+
+	//Same permutation dimensions as the count pass
+	{
+		TShaderMapRef<FPrimitivesCompactScatterCS> ComputeShader(ShaderMap, PermutationVector);
+		FPrimitivesCompactScatterCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPrimitivesCompactScatterCS::FParameters>();
+		PassParameters->Input = GetInputParameters(GraphBuilder, Input);
+		PassParameters->Threshold = Threshold;
+		PassParameters->GroupOffsets = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(GroupOffsets, PF_R32_UINT));
+		PassParameters->OutputIndices = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(OutIndices, PF_R32_UINT));
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrimitivesCompactScatter %u", Input.NumElements), ComputeShader, PassParameters, FIntVector(NumGroups, 1, 1));
+	}
+	return Count;
+}
+
+FRDGBufferRef FComputePrimitives::AddHistogram(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FPrimitivesInput& Input, float Min, float Max)
+{
+	static_assert(FPrimitivesCPU::NumHistogramBins == NUM_THREADS_PER_GROUP, "HistogramCS has one thread per bin");
+	FRDGBufferRef Histogram = CreateUintBuffer(GraphBuilder, FPrimitivesCPU::NumHistogramBins, TEXT("PrimitivesHistogram"));
+	FRDGBufferUAVRef HistogramUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Histogram, PF_R32_UINT));
+	AddClearUAVPass(GraphBuilder, HistogramUAV, 0u);
+
+	FPrimitivesHistogramCS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FPrimitivesCS::FInputTextureDim>(Input.Texture != nullptr);
+	TShaderMapRef<FPrimitivesHistogramCS> ComputeShader(ShaderMap, PermutationVector);
+
+	FPrimitivesHistogramCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPrimitivesHistogramCS::FParameters>();
+	PassParameters->Input = GetInputParameters(GraphBuilder, Input);
+	PassParameters->HistogramMin = Min;
+	PassParameters->HistogramScale = Max > Min ? FPrimitivesCPU::NumHistogramBins / (Max - Min) : 0.f;
+	PassParameters->OutputHistogram = HistogramUAV;
+	FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrimitivesHistogram %u", Input.NumElements), ComputeShader, PassParameters,
+								 FIntVector(GetNumGroups(Input.NumElements), 1, 1));
+	return Histogram;
+}
+
+void FComputePrimitives::RunBenchmark(FRHICommandListImmediate& RHICmdList, int32 NumElements, int32 NumIterations)
+{
+	check(IsInRenderingThread());
+	NumElements = FMath::Clamp<int32>(NumElements, 1, MaxElements);
+	NumIterations = FMath::Max(NumIterations, 1);
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	const uint32 Seed = 1;
+
+	//The input is generated on both sides instead of being uploaded
+	TRefCountPtr<FPooledRDGBuffer> PooledFloats;
+	TRefCountPtr<FPooledRDGBuffer> PooledUints;
+	{
+		FRDGBuilder GraphBuilder(RHICmdList);
+		FRDGBufferRef Floats = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(float), NumElements), TEXT("PrimitivesBenchmarkFloats"));
+		FRDGBufferRef Uints = CreateUintBuffer(GraphBuilder, NumElements, TEXT("PrimitivesBenchmarkUints"));
+
+		TShaderMapRef<FPrimitivesFillRandomCS> ComputeShader(ShaderMap);
+		FPrimitivesFillRandomCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPrimitivesFillRandomCS::FParameters>();
+		PassParameters->NumElements = NumElements;
+		PassParameters->Seed = Seed;
+		PassParameters->OutputRandomFloats = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Floats, PF_R32_FLOAT));
+		PassParameters->OutputRandomUints = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Uints, PF_R32_UINT));
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrimitivesFillRandom"), ComputeShader, PassParameters, FIntVector(GetNumGroups(NumElements), 1, 1));
+
+		GraphBuilder.QueueBufferExtraction(Floats, &PooledFloats);
+		GraphBuilder.QueueBufferExtraction(Uints, &PooledUints);
+		GraphBuilder.Execute();
+	}
+
+	TArray<float> Floats;
+	TArray<uint32> Uints;
+	FPrimitivesCPU::FillRandom(Seed, NumElements, Floats, Uints);
+
+	UE_LOG(LogTemp, Log, TEXT("Primitives benchmark: %d elements, %d iterations, %s"), NumElements, NumIterations,
+		UseWaveOperations() ? TEXT("wave operations") : TEXT("groupshared fallback"));
+
+	//Runs the passes NumIterations times between two timestamps, then checks the result of the last iteration against the CPU
+	auto RunCase = [&](const TCHAR* Name, uint32 ResultBytes, TFunctionRef<FRDGBufferRef(FRDGBuilder&, FRDGBufferRef, FRDGBufferRef)> AddPasses,
+					   TFunctionRef<void()> RunCPU, TFunctionRef<bool(const uint8*)> MatchesCPU)
+	{
+		FRenderQueryRHIRef StartQuery = RHICreateRenderQuery(RQT_AbsoluteTime);
+		FRenderQueryRHIRef EndQuery = RHICreateRenderQuery(RQT_AbsoluteTime);
+
+		//Every result is extracted, otherwise the graph would cull all the iterations but the last
+		TArray<TRefCountPtr<FPooledRDGBuffer>> Results;
+		Results.SetNum(NumIterations);
+		{
+			FRDGBuilder GraphBuilder(RHICmdList);
+			FRDGBufferRef FloatsBuffer = GraphBuilder.RegisterExternalBuffer(PooledFloats, TEXT("PrimitivesBenchmarkFloats"));
+			FRDGBufferRef UintsBuffer = GraphBuilder.RegisterExternalBuffer(PooledUints, TEXT("PrimitivesBenchmarkUints"));
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				GraphBuilder.QueueBufferExtraction(AddPasses(GraphBuilder, FloatsBuffer, UintsBuffer), &Results[Iteration]);
+			}
+			RHICmdList.EndRenderQuery(StartQuery);
+			GraphBuilder.Execute();
+			RHICmdList.EndRenderQuery(EndQuery);
+		}
+
+		FRHIGPUBufferReadback Readback(TEXT("PrimitivesBenchmarkReadback"));
+		Readback.EnqueueCopy(RHICmdList, Results.Last()->VertexBuffer, ResultBytes);
+		RHICmdList.BlockUntilGPUIdle();
+
+		uint64 StartMicroseconds = 0;
+		uint64 EndMicroseconds = 0;
+		RHIGetRenderQueryResult(StartQuery, StartMicroseconds, true);
+		RHIGetRenderQueryResult(EndQuery, EndMicroseconds, true);
+		const double GPUMilliseconds = (EndMicroseconds - StartMicroseconds) / 1000.0 / NumIterations;
+
+		const double CPUStart = FPlatformTime::Seconds();
+		RunCPU();
+		const double CPUMilliseconds = (FPlatformTime::Seconds() - CPUStart) * 1000.0;
+
+		const bool bMatches = MatchesCPU((const uint8*)Readback.Lock(ResultBytes));
+		Readback.Unlock();
+
+		UE_LOG(LogTemp, Log, TEXT("  %-16s GPU %8.3f ms (%6.2f GElements/s)  CPU %8.3f ms (%6.2f GElements/s)  %s"), Name,
+			GPUMilliseconds, GPUMilliseconds > 0.0 ? NumElements / (GPUMilliseconds * 1.0e6) : 0.0,
+			CPUMilliseconds, CPUMilliseconds > 0.0 ? NumElements / (CPUMilliseconds * 1.0e6) : 0.0,
+			bMatches ? TEXT("matches the CPU") : TEXT("DIFFERS FROM THE CPU"));
+	};
+
+	float CPUSum = 0.f;
+	RunCase(TEXT("Reduce sum"), sizeof(float),
+		[&](FRDGBuilder& GraphBuilder, FRDGBufferRef FloatsBuffer, FRDGBufferRef UintsBuffer)
+		{
+			return AddReduce(GraphBuilder, ShaderMap, FPrimitivesInput::FromBuffer(FloatsBuffer, NumElements), EReduceOp::Sum);
+		},
+		[&]() { CPUSum = FPrimitivesCPU::Reduce(Floats, EReduceOp::Sum); },
+		[&](const uint8* Result) { return FMath::IsNearlyEqual(*(const float*)Result, CPUSum, FMath::Abs(CPUSum) * 1e-4f); });
+
+	float CPUMax = 0.f;
+	RunCase(TEXT("Reduce max"), sizeof(float),
+		[&](FRDGBuilder& GraphBuilder, FRDGBufferRef FloatsBuffer, FRDGBufferRef UintsBuffer)
+		{
+			return AddReduce(GraphBuilder, ShaderMap, FPrimitivesInput::FromBuffer(FloatsBuffer, NumElements), EReduceOp::Max);
+		},
+		[&]() { CPUMax = FPrimitivesCPU::Reduce(Floats, EReduceOp::Max); },
+		[&](const uint8* Result) { return *(const float*)Result == CPUMax; });
+
+	TArray<uint32> CPUScan;
+	RunCase(TEXT("Exclusive scan"), NumElements * sizeof(uint32),
+		[&](FRDGBuilder& GraphBuilder, FRDGBufferRef FloatsBuffer, FRDGBufferRef UintsBuffer)
+		{
+			FRDGBufferRef Output = CreateUintBuffer(GraphBuilder, NumElements, TEXT("PrimitivesBenchmarkScan"));
+			AddScan(GraphBuilder, ShaderMap, UintsBuffer, Output, NumElements, EScanType::Exclusive);
+			return Output;
+		},
+		[&]() { FPrimitivesCPU::Scan(Uints, CPUScan, EScanType::Exclusive); },
+		[&](const uint8* Result) { return FMemory::Memcmp(Result, CPUScan.GetData(), CPUScan.Num() * sizeof(uint32)) == 0; });
+
+	//Keeps about half of the elements
+	TArray<uint32> CPUIndices;
+	RunCase(TEXT("Compact"), NumElements * sizeof(uint32),
+		[&](FRDGBuilder& GraphBuilder, FRDGBufferRef FloatsBuffer, FRDGBufferRef UintsBuffer)
+		{
+			FRDGBufferRef Indices = CreateUintBuffer(GraphBuilder, NumElements, TEXT("PrimitivesBenchmarkIndices"));
+			AddCompact(GraphBuilder, ShaderMap, FPrimitivesInput::FromBuffer(FloatsBuffer, NumElements), 0.5f, Indices);
+			return Indices;
+		},
+		[&]() { FPrimitivesCPU::Compact(Floats, 0.5f, CPUIndices); },
+		[&](const uint8* Result) { return FMemory::Memcmp(Result, CPUIndices.GetData(), CPUIndices.Num() * sizeof(uint32)) == 0; });
+
+	TArray<uint32> CPUBins;
+	RunCase(TEXT("Histogram"), FPrimitivesCPU::NumHistogramBins * sizeof(uint32),
+		[&](FRDGBuilder& GraphBuilder, FRDGBufferRef FloatsBuffer, FRDGBufferRef UintsBuffer)
+		{
+			return AddHistogram(GraphBuilder, ShaderMap, FPrimitivesInput::FromBuffer(FloatsBuffer, NumElements), 0.f, 1.f);
+		},
+		[&]() { FPrimitivesCPU::Histogram(Floats, 0.f, 1.f, CPUBins); },
+		[&](const uint8* Result) { return FMemory::Memcmp(Result, CPUBins.GetData(), CPUBins.Num() * sizeof(uint32)) == 0; });
+}
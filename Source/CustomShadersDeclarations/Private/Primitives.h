@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "PrimitivesCPU.h"
+
+//Values a primitive reads: the first channel of every texel of a texture in row-major order, or the elements of a PF_R32_FLOAT buffer
+struct FPrimitivesInput
+{
+	FRDGTextureRef Texture = nullptr;
+	FRDGBufferRef Buffer = nullptr;
+	uint32 NumElements = 0;
+
+	static FPrimitivesInput FromTexture(FRDGTextureRef Texture)
+	{
+		FPrimitivesInput Input;
+		Input.Texture = Texture;
+		Input.NumElements = Texture->Desc.Extent.X * Texture->Desc.Extent.Y;
+		return Input;
+	}
+
+	static FPrimitivesInput FromBuffer(FRDGBufferRef Buffer, uint32 NumElements)
+	{
+		FPrimitivesInput Input;
+		Input.Buffer = Buffer;
+		Input.NumElements = NumElements;
+		return Input;
+	}
+};
+
+/// <summary>
+/// GPU-wide reduce, scan, stream compaction and histogram added to the caller's graph, see PrimitivesCS.usf
+/// The group level steps use wave intrinsics when the RHI supports them with at least 16 lanes, unless CustomShaders.Primitives.WaveOps is 0.
+/// The results stay on the GPU, in typed buffers the following passes can read. FPrimitivesCPU is the CPU counterpart
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FComputePrimitives
+{
+public:
+	//Elements handled by one thread group
+	static constexpr uint32 ItemsPerGroup = 1024;
+	//One level of groups covers this many elements, larger inputs aren't supported
+	static constexpr uint32 MaxElements = 65535 * ItemsPerGroup;
+
+	//Returns a PF_R32_FLOAT buffer holding the result in its first element
+	static FRDGBufferRef AddReduce(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FPrimitivesInput& Input, EReduceOp Op);
+
+	//Scans the PF_R32_UINT buffer Input into Output, which must be a different buffer. Returns a PF_R32_UINT buffer holding the total in its first element
+	static FRDGBufferRef AddScan(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGBufferRef Input, FRDGBufferRef Output, uint32 NumElements, EScanType Type);
+
+	//Writes the indices of the values above Threshold, in order, to the PF_R32_UINT buffer OutIndices sized for Input.NumElements.
+	//Texture indices are packed as x | y << 16. Returns a PF_R32_UINT buffer holding the count in its first element
+	static FRDGBufferRef AddCompact(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FPrimitivesInput& Input, float Threshold, FRDGBufferRef OutIndices);
+
+	//Counts the values in FPrimitivesCPU::NumHistogramBins bins spanning [Min, Max), the values outside go to the first or the last bin.
+	//Returns a PF_R32_UINT buffer of NumHistogramBins elements
+	static FRDGBufferRef AddHistogram(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FPrimitivesInput& Input, float Min, float Max);
+
+	//Whether the wave intrinsic paths are used
+	static bool UseWaveOperations();
+
+	//Times every primitive on NumElements random values, checks the results against FPrimitivesCPU and logs both. Stalls the GPU, render thread only
+	static void RunBenchmark(FRHICommandListImmediate& RHICmdList, int32 NumElements, int32 NumIterations);
+};
@@ -0,0 +1,206 @@
+#include "PrimitivesCPU.h"
+
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	//Elements per chunk, large enough for the per chunk overhead to vanish
+	constexpr int32 ChunkSize = 1 << 16;
+
+	int32 GetNumChunks(int32 NumElements)
+	{
+		return FMath::DivideAndRoundUp(NumElements, ChunkSize);
+	}
+
+	uint32 PcgHash(uint32 Value)
+	{
+		const uint32 State = Value * 747796405u + 2891336453u;
+		const uint32 Word = ((State >> ((State >> 28u) + 4u)) ^ State) * 277803737u;
+		return (Word >> 22u) ^ Word;
+	}
+
+	float ApplyReduceOp(EReduceOp Op, float A, float B)
+	{
+		switch (Op)
+		{
+		case EReduceOp::Min:
+			return FMath::Min(A, B);
+		case EReduceOp::Max:
+			return FMath::Max(A, B);
+		default:
+			return A + B;
+		}
+	}
+
+	float GetReduceIdentity(EReduceOp Op)
+	{
+		switch (Op)
+		{
+		case EReduceOp::Min:
+			return TNumericLimits<float>::Max();
+		case EReduceOp::Max:
+			return TNumericLimits<float>::Lowest();
+		default:
+			return 0.f;
+		}
+	}
+}
+
+float FPrimitivesCPU::Reduce(TArrayView<const float> Values, EReduceOp Op)
+{
+	const int32 NumChunks = GetNumChunks(Values.Num());
+	TArray<float> Partials;
+	Partials.SetNumUninitialized(NumChunks);
+	ParallelFor(NumChunks, [&Values, &Partials, Op](int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Values.Num());
+		float Partial = GetReduceIdentity(Op);
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			Partial = ApplyReduceOp(Op, Partial, Values[Index]);
+		}
+		Partials[Chunk] = Partial;
+	});
+
+	float Result = GetReduceIdentity(Op);
+	for (float Partial : Partials)
+	{
+		Result = ApplyReduceOp(Op, Result, Partial);
+	}
+	return Result;
+}
+
+uint32 FPrimitivesCPU::Scan(TArrayView<const uint32> Values, TArray<uint32>& OutValues, EScanType Type)
+{
+	//Chunk sums, scanned serially, then every chunk is scanned from its offset
+	const int32 NumChunks = GetNumChunks(Values.Num());
+	TArray<uint32> ChunkOffsets;
+	ChunkOffsets.SetNumUninitialized(NumChunks);
+	ParallelFor(NumChunks, [&Values, &ChunkOffsets](int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Values.Num());
+		uint32 Sum = 0;
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			Sum += Values[Index];
+		}
+		ChunkOffsets[Chunk] = Sum;
+	});
+
+	uint32 Total = 0;
+	for (uint32& Offset : ChunkOffsets)
+	{
+		const uint32 Sum = Offset;
+		Offset = Total;
+		Total += Sum;
+	}
+
+	OutValues.SetNumUninitialized(Values.Num());
+	ParallelFor(NumChunks, [&Values, &OutValues, &ChunkOffsets, Type](int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Values.Num());
+		uint32 Running = ChunkOffsets[Chunk];
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			if (Type == EScanType::Inclusive)
+			{
+				Running += Values[Index];
+				OutValues[Index] = Running;
+			}
+			else
+			{
+				OutValues[Index] = Running;
+				Running += Values[Index];
+			}
+		}
+	});
+	return Total;
+}
+
+uint32 FPrimitivesCPU::Compact(TArrayView<const float> Values, float Threshold, TArray<uint32>& OutIndices)
+{
+	const int32 NumChunks = GetNumChunks(Values.Num());
+	TArray<uint32> ChunkOffsets;
+	ChunkOffsets.SetNumUninitialized(NumChunks);
+	ParallelFor(NumChunks, [&Values, &ChunkOffsets, Threshold](int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Values.Num());
+		uint32 Count = 0;
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			Count += Values[Index] > Threshold ? 1 : 0;
+		}
+		ChunkOffsets[Chunk] = Count;
+	});
+
+	uint32 Total = 0;
+	for (uint32& Offset : ChunkOffsets)
+	{
+		const uint32 Count = Offset;
+		Offset = Total;
+		Total += Count;
+	}
+
+	OutIndices.SetNumUninitialized(Total);
+	ParallelFor(NumChunks, [&Values, &OutIndices, &ChunkOffsets, Threshold](int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Values.Num());
+		uint32 Output = ChunkOffsets[Chunk];
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			if (Values[Index] > Threshold)
+			{
+				OutIndices[Output++] = Index;
+			}
+		}
+	});
+	return Total;
+}
+
+int32 FPrimitivesCPU::GetHistogramBin(float Value, float Min, float Scale)
+{
+	return (int32)FMath::Clamp((Value - Min) * Scale, 0.f, NumHistogramBins - 1.f);
+}
+
+void FPrimitivesCPU::Histogram(TArrayView<const float> Values, float Min, float Max, TArray<uint32>& OutBins)
+{
+	const float Scale = Max > Min ? NumHistogramBins / (Max - Min) : 0.f;
+	const int32 NumChunks = GetNumChunks(Values.Num());
+	TArray<uint32> ChunkBins;
+	ChunkBins.SetNumZeroed(NumChunks * NumHistogramBins);
+	ParallelFor(NumChunks, [&Values, &ChunkBins, Min, Scale](int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Values.Num());
+		uint32* Bins = ChunkBins.GetData() + Chunk * NumHistogramBins;
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			Bins[GetHistogramBin(Values[Index], Min, Scale)]++;
+		}
+	});
+
+	OutBins.SetNumZeroed(NumHistogramBins);
+	for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+	{
+		for (int32 Bin = 0; Bin < NumHistogramBins; ++Bin)
+		{
+			OutBins[Bin] += ChunkBins[Chunk * NumHistogramBins + Bin];
+		}
+	}
+}
+
+void FPrimitivesCPU::FillRandom(uint32 Seed, int32 NumElements, TArray<float>& OutFloats, TArray<uint32>& OutUints)
+{
+	OutFloats.SetNumUninitialized(NumElements);
+	OutUints.SetNumUninitialized(NumElements);
+	const uint32 SeedHash = PcgHash(Seed);
+	ParallelFor(GetNumChunks(NumElements), [&OutFloats, &OutUints, NumElements, SeedHash](int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, NumElements);
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			const uint32 Hash = PcgHash((uint32)Index + SeedHash);
+			OutFloats[Index] = (float)(Hash >> 8) * (1.f / 16777216.f);
+			OutUints[Index] = Hash & 15;
+		}
+	});
+}
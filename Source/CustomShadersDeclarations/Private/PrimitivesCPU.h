@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EReduceOp : uint8
+{
+	Sum,
+	Min,
+	Max,
+};
+
+enum class EScanType : uint8
+{
+	//Element i is the sum of the elements before i
+	Exclusive,
+	//Element i is the sum of the elements up to and including i
+	Inclusive,
+};
+
+/// <summary>
+/// CPU implementation of the kernels in PrimitivesCS.usf. The input is split in chunks that are processed on all the worker threads and combined
+/// in chunk order, so the integer results match the GPU exactly. Float sums are only equal up to the summation order
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FPrimitivesCPU
+{
+	static constexpr int32 NumHistogramBins = 256;
+
+	static float Reduce(TArrayView<const float> Values, EReduceOp Op);
+
+	//Returns the sum of all the values
+	static uint32 Scan(TArrayView<const uint32> Values, TArray<uint32>& OutValues, EScanType Type);
+
+	//Indices of the values above Threshold in order. Returns how many there are
+	static uint32 Compact(TArrayView<const float> Values, float Threshold, TArray<uint32>& OutIndices);
+
+	//Mirrors HistogramCS: NumHistogramBins bins spanning [Min, Max), the values outside go to the first or the last bin
+	static void Histogram(TArrayView<const float> Values, float Min, float Max, TArray<uint32>& OutBins);
+	static int32 GetHistogramBin(float Value, float Min, float Scale);
+
+	//Mirrors FillRandomCS, the input of the benchmarks
+	static void FillRandom(uint32 Seed, int32 NumElements, TArray<float>& OutFloats, TArray<uint32>& OutUints);
+};
@@ -0,0 +1,144 @@
+#include "SubmissionLatency.h"
+
+#include "GPUProfiler.h"
+#include "HAL/PlatformTime.h"
+
+FSubmissionLatencyMonitor::~FSubmissionLatencyMonitor()
+{
+	check(IsInRenderingThread());
+	for (FPendingStamp& Slot : Pending)
+	{
+		Slot.Buffer.Release();
+	}
+}
+
+FRHIUnorderedAccessView* FSubmissionLatencyMonitor::BeginDispatch(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+	CollectReadbacks();
+
+	DispatchSlot = INDEX_NONE;
+	for (int32 Index = 0; Index < MaxPendingReadbacks; ++Index)
+	{
+		if (!Pending[Index].bInFlight)
+		{
+			DispatchSlot = Index;
+			break;
+		}
+	}
+
+	//The GPU is too far behind, skip this submission rather than waiting on it
+	if (DispatchSlot == INDEX_NONE)
+	{
+		++NumSkipped;
+		return nullptr;
+	}
+
+	FPendingStamp& Slot = Pending[DispatchSlot];
+	if (!Slot.Buffer.Buffer.IsValid())
+	{
+		Slot.Buffer.Initialize(sizeof(uint32), 1, PF_R32_UINT, BUF_SourceCopy, TEXT("WhiteNoiseCS_SubmissionStamp"));
+		Slot.Readback = MakeUnique<FRHIGPUBufferReadback>(TEXT("WhiteNoiseCS_SubmissionStampReadback"));
+		Slot.EndQuery = RHICreateRenderQuery(RQT_AbsoluteTime);
+	}
+	RHICmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, Slot.Buffer.UAV);
+	return Slot.Buffer.UAV;
+}
+
+void FSubmissionLatencyMonitor::EndDispatch(FRHICommandListImmediate& RHICmdList, const FSubmissionStamp& Stamp)
+{
+	check(IsInRenderingThread());
+	if (DispatchSlot == INDEX_NONE)
+	{
+		return;
+	}
+
+	FPendingStamp& Slot = Pending[DispatchSlot];
+	RHICmdList.EndRenderQuery(Slot.EndQuery);
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, EResourceTransitionPipeline::EComputeToGfx, Slot.Buffer.UAV);
+	Slot.Readback->EnqueueCopy(RHICmdList, Slot.Buffer.Buffer, sizeof(uint32));
+	Slot.Stamp = Stamp;
+	Slot.bInFlight = true;
+	DispatchSlot = INDEX_NONE;
+}
+
+void FSubmissionLatencyMonitor::CollectReadbacks()
+{
+	const uint64 NowCycles = FPlatformTime::Cycles64();
+	//Zero when the RHI can't relate its timestamps to the CPU clock
+	const FGPUTimingCalibrationTimestamp Calibration = FGPUTiming::GetCalibrationTimestamp();
+	for (FPendingStamp& Slot : Pending)
+	{
+		if (!Slot.bInFlight || !Slot.Readback->IsReady())
+		{
+			continue;
+		}
+
+		const uint32* StampedId = (const uint32*)Slot.Readback->Lock(sizeof(uint32));
+		const bool bMatches = StampedId && *StampedId == Slot.Stamp.Id;
+		Slot.Readback->Unlock();
+		Slot.bInFlight = false;
+
+		if (!bMatches)
+		{
+			++NumMismatched;
+			continue;
+		}
+
+		const uint32 Frames = GFrameNumberRenderThread > Slot.Stamp.Frame ? GFrameNumberRenderThread - Slot.Stamp.Frame : 0;
+		const double SubmitMicroseconds = FPlatformTime::ToSeconds64(Slot.Stamp.Cycles) * 1e6;
+		double EndMicroseconds = FPlatformTime::ToSeconds64(NowCycles) * 1e6;
+		uint64 GPUEndMicroseconds = 0;
+		if (Calibration.GPUMicroseconds != 0 && RHIGetRenderQueryResult(Slot.EndQuery, GPUEndMicroseconds, false))
+		{
+			EndMicroseconds = (double)Calibration.CPUMicroseconds + ((double)GPUEndMicroseconds - (double)Calibration.GPUMicroseconds);
+		}
+		else
+		{
+			++NumPollQuantized;
+		}
+		const double Milliseconds = FMath::Max(EndMicroseconds - SubmitMicroseconds, 0.0) * 1e-3;
+		++FrameHistogram[FMath::Min<uint32>(Frames, NumFrameBuckets - 1)];
+		++MillisecondHistogram[FMath::Clamp(FMath::FloorToInt(FMath::Log2(FMath::Max(Milliseconds, 0.5))) + 1, 0, NumMillisecondBuckets - 1)];
+		++NumSamples;
+		SumMilliseconds += Milliseconds;
+		MaxMilliseconds = FMath::Max(MaxMilliseconds, Milliseconds);
+	}
+}
+
+void FSubmissionLatencyMonitor::Report()
+{
+	check(IsInRenderingThread());
+	FString Frames;
+	for (int32 Bucket = 0; Bucket < NumFrameBuckets; ++Bucket)
+	{
+		Frames += FString::Printf(TEXT(" %d%s:%d"), Bucket, Bucket == NumFrameBuckets - 1 ? TEXT("+") : TEXT(""), FrameHistogram[Bucket]);
+	}
+	FString Milliseconds;
+	for (int32 Bucket = 0; Bucket < NumMillisecondBuckets; ++Bucket)
+	{
+		if (Bucket == NumMillisecondBuckets - 1)
+		{
+			Milliseconds += FString::Printf(TEXT(" >=%d:%d"), 1 << (Bucket - 1), MillisecondHistogram[Bucket]);
+		}
+		else
+		{
+			Milliseconds += FString::Printf(TEXT(" <%d:%d"), 1 << Bucket, MillisecondHistogram[Bucket]);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("White noise submit to GPU complete latency, %d submissions (%d skipped, %d mismatched): mean %.2f ms, max %.2f ms"),
+		   NumSamples, NumSkipped, NumMismatched, NumSamples > 0 ? SumMilliseconds / NumSamples : 0.0, MaxMilliseconds);
+	UE_LOG(LogTemp, Log, TEXT("  Frames:%s"), *Frames);
+	UE_LOG(LogTemp, Log, TEXT("  Milliseconds to the GPU timestamp after the dispatch (%d poll-quantized, rounded up to the next UpdateResults):%s"),
+		   NumPollQuantized, *Milliseconds);
+
+	FMemory::Memzero(FrameHistogram);
+	FMemory::Memzero(MillisecondHistogram);
+	NumSamples = 0;
+	NumSkipped = 0;
+	NumMismatched = 0;
+	NumPollQuantized = 0;
+	SumMilliseconds = 0.0;
+	MaxMilliseconds = 0.0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHIGPUReadback.h"
+#include "RenderResource.h"
+
+//When and in which game frame a set of parameters was submitted
+struct FSubmissionStamp
+{
+	uint32 Id = 0;
+	//GFrameNumber on the game thread, the render thread copies it to GFrameNumberRenderThread when it starts that frame
+	uint32 Frame = 0;
+	//FPlatformTime::Cycles64(), the CPU clock the GPU timestamps are calibrated against
+	uint64 Cycles = 0;
+};
+
+/// <summary>
+/// Measures how long the white noise output takes to be complete on the GPU after its parameters were submitted on the game thread.
+/// The kernel writes the submission id into a one element buffer that is read back asynchronously, the submission is complete when the
+/// readback is ready and holds its id. Readbacks are polled once per UpdateResults, so the frame latencies are rounded up to the next frame.
+/// The millisecond latencies end at a timestamp query written right after the dispatch, converted to the CPU clock with the RHI timing
+/// calibration. When the RHI has no calibration or the query isn't ready they fall back to the poll time and are counted as poll-quantized.
+/// Render thread only
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FSubmissionLatencyMonitor
+{
+public:
+	~FSubmissionLatencyMonitor();
+
+	//Collects the completed readbacks and returns the buffer the next dispatch stamps, nullptr when too many readbacks are in flight
+	FRHIUnorderedAccessView* BeginDispatch(FRHICommandListImmediate& RHICmdList);
+
+	//Call after the dispatch that received the buffer of BeginDispatch. Queues its readback
+	void EndDispatch(FRHICommandListImmediate& RHICmdList, const FSubmissionStamp& Stamp);
+
+	//Logs the histograms of the latencies measured since the last report and starts over
+	void Report();
+
+private:
+	//Frames the GPU can be behind before submissions are skipped
+	static constexpr int32 MaxPendingReadbacks = 4;
+	//Latencies of NumFrameBuckets - 1 frames and more share the last bucket
+	static constexpr int32 NumFrameBuckets = 8;
+	//Millisecond buckets are powers of two: below 1 ms, below 2 ms, ... and the rest in the last one
+	static constexpr int32 NumMillisecondBuckets = 9;
+
+	struct FPendingStamp
+	{
+		FRWBuffer Buffer;
+		TUniquePtr<FRHIGPUBufferReadback> Readback;
+		//RQT_AbsoluteTime written after the dispatch
+		FRenderQueryRHIRef EndQuery;
+		FSubmissionStamp Stamp;
+		bool bInFlight = false;
+	};
+
+	void CollectReadbacks();
+
+	FPendingStamp Pending[MaxPendingReadbacks];
+	//Slot BeginDispatch handed out, INDEX_NONE outside a dispatch
+	int32 DispatchSlot = INDEX_NONE;
+
+	int32 FrameHistogram[NumFrameBuckets] = {};
+	int32 MillisecondHistogram[NumMillisecondBuckets] = {};
+	int32 NumSamples = 0;
+	int32 NumSkipped = 0;
+	//Readbacks that didn't hold the id of their submission
+	int32 NumMismatched = 0;
+	//Samples timed at the poll instead of the GPU timestamp
+	int32 NumPollQuantized = 0;
+	double SumMilliseconds = 0.0;
+	double MaxMilliseconds = 0.0;
+};
@@ -0,0 +1,257 @@
+#include "SummedAreaTable.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ShaderParameterStruct.h"
+#include "ComputeBenchmark.h"
+#include "Primitives.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 8
+#define NUM_THREADS_PER_SCAN_GROUP 256
+
+static FAutoConsoleCommand SummedAreaTableBenchmarkCommand(
+	TEXT("CustomShaders.SummedAreaTable.Benchmark"),
+	TEXT("Times summed-area table box filters against a separable blur at radii 4 to 64 and checks both against the CPU. Arguments: [Size] [NumIterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2048;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10;
+		ENQUEUE_RENDER_COMMAND(SummedAreaTableBenchmarkCommand)(
+			[Size, NumIterations](FRHICommandListImmediate& RHICmdList)
+			{
+				FSummedAreaTableCompute::RunBenchmark(RHICmdList, Size, NumIterations);
+			});
+	}));
+
+/// <summary>
+/// Base class of the passes in SummedAreaTableCS.usf
+/// </summary>
+class FSummedAreaTableCS : public FGlobalShader
+{
+public:
+	FSummedAreaTableCS() { }
+	FSummedAreaTableCS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{ }
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("SCAN_THREADGROUPSIZE"), NUM_THREADS_PER_SCAN_GROUP);
+	}
+};
+
+class FSummedAreaTableRowScanCS : public FSummedAreaTableCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSummedAreaTableRowScanCS);
+	SHADER_USE_PARAMETER_STRUCT(FSummedAreaTableRowScanCS, FSummedAreaTableCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, Size)
+		SHADER_PARAMETER(float, InvNumElements)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, InputTexture)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float>, InputSum)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputTable)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FSummedAreaTableColumnScanCS : public FSummedAreaTableCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSummedAreaTableColumnScanCS);
+	SHADER_USE_PARAMETER_STRUCT(FSummedAreaTableColumnScanCS, FSummedAreaTableCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, Size)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputTable)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FSummedAreaTableBoxFilterCS : public FSummedAreaTableCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSummedAreaTableBoxFilterCS);
+	SHADER_USE_PARAMETER_STRUCT(FSummedAreaTableBoxFilterCS, FSummedAreaTableCS);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, Size)
+		SHADER_PARAMETER(float, InvNumElements)
+		SHADER_PARAMETER(int32, Radius)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, Table)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float>, InputSum)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputTexture)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+class FSeparableBoxBlurCS : public FSummedAreaTableCS
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSeparableBoxBlurCS);
+	SHADER_USE_PARAMETER_STRUCT(FSeparableBoxBlurCS, FSummedAreaTableCS);
+
+	class FVerticalDim : SHADER_PERMUTATION_BOOL("BLUR_VERTICAL");
+	using FPermutationDomain = TShaderPermutationDomain<FVerticalDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, Size)
+		SHADER_PARAMETER(int32, Radius)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, InputTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, OutputTexture)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSummedAreaTableRowScanCS, "/CustomShaders/SummedAreaTableCS.usf", "RowScanCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FSummedAreaTableColumnScanCS, "/CustomShaders/SummedAreaTableCS.usf", "ColumnScanCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FSummedAreaTableBoxFilterCS, "/CustomShaders/SummedAreaTableCS.usf", "BoxFilterCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FSeparableBoxBlurCS, "/CustomShaders/SummedAreaTableCS.usf", "SeparableBlurCS", SF_Compute);
+
+
+namespace
+{
+	FRDGTextureDesc CreateFloatTextureDesc(FIntPoint Size)
+	{
+		return FRDGTextureDesc::Create2DDesc(Size, PF_R32_FLOAT, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false);
+	}
+
+	float GetInvNumElements(FRDGTextureRef Texture)
+	{
+		return 1.f / (Texture->Desc.Extent.X * Texture->Desc.Extent.Y);
+	}
+}
+
+FSummedAreaTable FSummedAreaTableCompute::AddBuild(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source)
+{
+	FSummedAreaTable Result;
+	Result.SourceSum = FComputePrimitives::AddReduce(GraphBuilder, ShaderMap, FPrimitivesInput::FromTexture(Source), EReduceOp::Sum);
+	Result.Table = GraphBuilder.CreateTexture(CreateFloatTextureDesc(Source->Desc.Extent), TEXT("SummedAreaTable"));
+	FRDGTextureUAVRef TableUAV = GraphBuilder.CreateUAV(Result.Table);
+	{
+		TShaderMapRef<FSummedAreaTableRowScanCS> ComputeShader(ShaderMap);
+		FSummedAreaTableRowScanCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FSummedAreaTableRowScanCS::FParameters>();
+		PassParameters->Size = Source->Desc.Extent;
+		PassParameters->InvNumElements = GetInvNumElements(Source);
+		PassParameters->InputTexture = Source;
+		PassParameters->InputSum = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(Result.SourceSum, PF_R32_FLOAT));
+		PassParameters->OutputTable = TableUAV;
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("SummedAreaTableRowScan"), ComputeShader, PassParameters, FIntVector(Source->Desc.Extent.Y, 1, 1));
+	}
+	{
+		TShaderMapRef<FSummedAreaTableColumnScanCS> ComputeShader(ShaderMap);
+		FSummedAreaTableColumnScanCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FSummedAreaTableColumnScanCS::FParameters>();
+		PassParameters->Size = Source->Desc.Extent;
+		PassParameters->OutputTable = TableUAV;
+		const int32 NumThreadsPerGroup = NUM_THREADS_PER_GROUP_DIMENSION * NUM_THREADS_PER_GROUP_DIMENSION;
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("SummedAreaTableColumnScan"), ComputeShader, PassParameters,
+									 FIntVector(FMath::DivideAndRoundUp(Source->Desc.Extent.X, NumThreadsPerGroup), 1, 1));
+	}
+	return Result;
+}
+
+FRDGTextureRef FSummedAreaTableCompute::AddBoxFilter(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FSummedAreaTable& Table, int32 Radius)
+{
+	FRDGTextureRef Output = GraphBuilder.CreateTexture(CreateFloatTextureDesc(Table.Table->Desc.Extent), TEXT("SummedAreaTableBoxFilter"));
+	TShaderMapRef<FSummedAreaTableBoxFilterCS> ComputeShader(ShaderMap);
+	FSummedAreaTableBoxFilterCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FSummedAreaTableBoxFilterCS::FParameters>();
+	PassParameters->Size = Table.Table->Desc.Extent;
+	PassParameters->InvNumElements = GetInvNumElements(Table.Table);
+	PassParameters->Radius = Radius;
+	PassParameters->Table = Table.Table;
+	PassParameters->InputSum = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(Table.SourceSum, PF_R32_FLOAT));
+	PassParameters->OutputTexture = GraphBuilder.CreateUAV(Output);
+	FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("SummedAreaTableBoxFilter R%d", Radius), ComputeShader, PassParameters,
+								 FComputeShaderUtils::GetGroupCount(Table.Table->Desc.Extent, NUM_THREADS_PER_GROUP_DIMENSION));
+	return Output;
+}
+
+FRDGTextureRef FSummedAreaTableCompute::AddSeparableBoxBlur(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source, int32 Radius)
+{
+	FRDGTextureRef Input = Source;
+	FRDGTextureRef Output = nullptr;
+	for (bool bVertical : { false, true })
+	{
+		Output = GraphBuilder.CreateTexture(CreateFloatTextureDesc(Source->Desc.Extent), bVertical ? TEXT("SeparableBoxBlur") : TEXT("SeparableBoxBlurHorizontal"));
+
+		FSeparableBoxBlurCS::FPermutationDomain PermutationVector;
+		PermutationVector.Set<FSeparableBoxBlurCS::FVerticalDim>(bVertical);
+		TShaderMapRef<FSeparableBoxBlurCS> ComputeShader(ShaderMap, PermutationVector);
+
+		FSeparableBoxBlurCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FSeparableBoxBlurCS::FParameters>();
+		PassParameters->Size = Source->Desc.Extent;
+		PassParameters->Radius = Radius;
+		PassParameters->InputTexture = Input;
+		PassParameters->OutputTexture = GraphBuilder.CreateUAV(Output);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("SeparableBoxBlur %s R%d", bVertical ? TEXT("Vertical") : TEXT("Horizontal"), Radius),
+									 ComputeShader, PassParameters, FComputeShaderUtils::GetGroupCount(Source->Desc.Extent, NUM_THREADS_PER_GROUP_DIMENSION));
+		Input = Output;
+	}
+	return Output;
+}
+
+void FSummedAreaTableCompute::RunBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations)
+{
+	check(IsInRenderingThread());
+	Size = FMath::Clamp(Size, 16, 8192);
+	NumIterations = FMath::Max(NumIterations, 1);
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+
+	//Random values in [0, 1), uploaded so the CPU reference sees exactly the same input
+	TArray<float> Values;
+	TArray<uint32> Unused;
+	FPrimitivesCPU::FillRandom(1, Size * Size, Values, Unused);
+
+	TRefCountPtr<IPooledRenderTarget> Input = FComputeBenchmark::UploadFloatTexture(RHICmdList, FIntPoint(Size, Size), Values, TEXT("SummedAreaTableBenchmarkInput"));
+
+	//Average GPU time of one iteration of the passes, then reads back the last result
+	auto TimeGPU = [&](TFunctionRef<FRDGTextureRef(FRDGBuilder&, FRDGTextureRef)> AddPasses, TArray<float>& OutValues)
+	{
+		TRefCountPtr<IPooledRenderTarget> Result;
+		const double Milliseconds = FComputeBenchmark::TimeGraphs(RHICmdList, NumIterations, [&](FRDGBuilder& GraphBuilder)
+		{
+			FRDGTextureRef InputTexture = GraphBuilder.RegisterExternalTexture(Input, TEXT("SummedAreaTableBenchmarkInput"));
+			GraphBuilder.QueueTextureExtraction(AddPasses(GraphBuilder, InputTexture), &Result);
+		});
+		FComputeBenchmark::ReadbackFloatTexture(RHICmdList, Result, OutValues);
+		return Milliseconds;
+	};
+
+	UE_LOG(LogTemp, Log, TEXT("Summed-area table benchmark: %dx%d, %d iterations. Errors are against the CPU separable blur"), Size, Size, NumIterations);
+	for (int32 Radius = 4; Radius <= 64; Radius *= 2)
+	{
+		TArray<float> Reference;
+		double CPUStart = FPlatformTime::Seconds();
+		FSummedAreaTableCPU::SeparableBoxBlur(Values, Size, Size, Radius, Reference);
+		const double CPUSeparableMilliseconds = (FPlatformTime::Seconds() - CPUStart) * 1000.0;
+
+		TArray<float> CPUTable;
+		TArray<float> CPUBoxFilter;
+		CPUStart = FPlatformTime::Seconds();
+		const float Offset = FSummedAreaTableCPU::Build(Values, Size, Size, CPUTable);
+		FSummedAreaTableCPU::BoxFilter(CPUTable, Offset, Size, Size, Radius, CPUBoxFilter);
+		const double CPUTableMilliseconds = (FPlatformTime::Seconds() - CPUStart) * 1000.0;
+
+		TArray<float> GPUBoxFilter;
+		const double GPUTableMilliseconds = TimeGPU([ShaderMap, Radius](FRDGBuilder& GraphBuilder, FRDGTextureRef InputTexture)
+		{
+			return AddBoxFilter(GraphBuilder, ShaderMap, AddBuild(GraphBuilder, ShaderMap, InputTexture), Radius);
+		}, GPUBoxFilter);
+
+		TArray<float> GPUSeparable;
+		const double GPUSeparableMilliseconds = TimeGPU([ShaderMap, Radius](FRDGBuilder& GraphBuilder, FRDGTextureRef InputTexture)
+		{
+			return AddSeparableBoxBlur(GraphBuilder, ShaderMap, InputTexture, Radius);
+		}, GPUSeparable);
+
+		UE_LOG(LogTemp, Log, TEXT("  Radius %2d: GPU table %7.3f ms (error %g), separable %7.3f ms (error %g) | CPU table %8.3f ms (error %g), separable %8.3f ms"),
+			Radius, GPUTableMilliseconds, FSummedAreaTableCPU::MaxAbsDifference(GPUBoxFilter, Reference),
+			GPUSeparableMilliseconds, FSummedAreaTableCPU::MaxAbsDifference(GPUSeparable, Reference),
+			CPUTableMilliseconds, FSummedAreaTableCPU::MaxAbsDifference(CPUBoxFilter, Reference), CPUSeparableMilliseconds);
+	}
+}
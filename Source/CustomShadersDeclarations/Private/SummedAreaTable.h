@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "SummedAreaTableCPU.h"
+
+//A table and what its users need to sample it, see SummedAreaTable.ush
+struct FSummedAreaTable
+{
+	//PF_R32_FLOAT, same size as the source
+	FRDGTextureRef Table = nullptr;
+	//PF_R32_FLOAT buffer holding the sum of the source in its first element, the offset is this sum divided by the number of texels
+	FRDGBufferRef SourceSum = nullptr;
+};
+
+/// <summary>
+/// Builds summed-area tables of any compute output on the GPU, see SummedAreaTableCS.usf. A box filter of any radius then costs four loads per texel
+/// The mean of the source is found with FComputePrimitives::AddReduce and subtracted from every texel, which keeps the float entries precise.
+/// FSummedAreaTableCPU is the CPU counterpart
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FSummedAreaTableCompute
+{
+public:
+	//Table of the first channel of Source
+	static FSummedAreaTable AddBuild(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source);
+
+	//Returns a PF_R32_FLOAT texture holding the mean over the (2 Radius + 1)^2 box around every texel, clipped to the texture
+	static FRDGTextureRef AddBoxFilter(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, const FSummedAreaTable& Table, int32 Radius);
+
+	//Same result computed with a horizontal and a vertical pass of 2 Radius + 1 taps, the reference the benchmark compares against
+	static FRDGTextureRef AddSeparableBoxBlur(FRDGBuilder& GraphBuilder, FGlobalShaderMap* ShaderMap, FRDGTextureRef Source, int32 Radius);
+
+	//Times building the table plus a box filter against the separable blur at radii 4 to 64 on a Size x Size random texture,
+	//checks both against FSummedAreaTableCPU::SeparableBoxBlur and logs the results. Stalls the GPU, render thread only
+	static void RunBenchmark(FRHICommandListImmediate& RHICmdList, int32 Size, int32 NumIterations);
+};
@@ -0,0 +1,108 @@
+#include "SummedAreaTableCPU.h"
+
+#include "Async/ParallelFor.h"
+#include "PrimitivesCPU.h"
+
+namespace
+{
+	//Columns scanned by one task, walked row by row
+	constexpr int32 ColumnBandWidth = 64;
+
+	float RectSum(const float* Table, int32 Width, FIntPoint Min, FIntPoint Max)
+	{
+		const float Corner = Table[Max.Y * Width + Max.X];
+		const float Left = Min.X > 0 ? Table[Max.Y * Width + Min.X - 1] : 0.f;
+		const float Top = Min.Y > 0 ? Table[(Min.Y - 1) * Width + Max.X] : 0.f;
+		const float TopLeft = Min.X > 0 && Min.Y > 0 ? Table[(Min.Y - 1) * Width + Min.X - 1] : 0.f;
+		return (Corner - Left) - (Top - TopLeft);
+	}
+
+	void BlurLines(const float* Input, float* Output, int32 NumLines, int32 LineLength, int32 LineStride, int32 TapStride, int32 Radius)
+	{
+		ParallelFor(NumLines, [=](int32 Line)
+		{
+			const float* LineInput = Input + Line * LineStride;
+			float* LineOutput = Output + Line * LineStride;
+			for (int32 Center = 0; Center < LineLength; ++Center)
+			{
+				const int32 First = FMath::Max(Center - Radius, 0);
+				const int32 Last = FMath::Min(Center + Radius, LineLength - 1);
+				float Sum = 0.f;
+				for (int32 Tap = First; Tap <= Last; ++Tap)
+				{
+					Sum += LineInput[Tap * TapStride];
+				}
+				LineOutput[Center * TapStride] = Sum / (float)(Last - First + 1);
+			}
+		});
+	}
+}
+
+float FSummedAreaTableCPU::Build(TArrayView<const float> Values, int32 Width, int32 Height, TArray<float>& OutTable)
+{
+	check(Values.Num() == Width * Height);
+	const float Offset = FPrimitivesCPU::Reduce(Values, EReduceOp::Sum) / Values.Num();
+	OutTable.SetNumUninitialized(Values.Num());
+	float* Table = OutTable.GetData();
+
+	ParallelFor(Height, [&Values, Table, Width, Offset](int32 Y)
+	{
+		float Sum = 0.f;
+		for (int32 X = 0; X < Width; ++X)
+		{
+			Sum += Values[Y * Width + X] - Offset;
+			Table[Y * Width + X] = Sum;
+		}
+	});
+
+	ParallelFor(FMath::DivideAndRoundUp(Width, ColumnBandWidth), [Table, Width, Height](int32 Band)
+	{
+		const int32 FirstColumn = Band * ColumnBandWidth;
+		const int32 LastColumn = FMath::Min(FirstColumn + ColumnBandWidth, Width);
+		for (int32 Y = 1; Y < Height; ++Y)
+		{
+			for (int32 X = FirstColumn; X < LastColumn; ++X)
+			{
+				Table[Y * Width + X] += Table[(Y - 1) * Width + X];
+			}
+		}
+	});
+	return Offset;
+}
+
+void FSummedAreaTableCPU::BoxFilter(TArrayView<const float> Table, float Offset, int32 Width, int32 Height, int32 Radius, TArray<float>& OutValues)
+{
+	check(Table.Num() == Width * Height);
+	OutValues.SetNumUninitialized(Table.Num());
+	ParallelFor(Height, [&Table, &OutValues, Offset, Width, Height, Radius](int32 Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			const FIntPoint Min(FMath::Max(X - Radius, 0), FMath::Max(Y - Radius, 0));
+			const FIntPoint Max(FMath::Min(X + Radius, Width - 1), FMath::Min(Y + Radius, Height - 1));
+			const FIntPoint Extent = Max - Min + FIntPoint(1, 1);
+			OutValues[Y * Width + X] = RectSum(Table.GetData(), Width, Min, Max) / (float)(Extent.X * Extent.Y) + Offset;
+		}
+	});
+}
+
+void FSummedAreaTableCPU::SeparableBoxBlur(TArrayView<const float> Values, int32 Width, int32 Height, int32 Radius, TArray<float>& OutValues)
+{
+	check(Values.Num() == Width * Height);
+	TArray<float> Horizontal;
+	Horizontal.SetNumUninitialized(Values.Num());
+	OutValues.SetNumUninitialized(Values.Num());
+	BlurLines(Values.GetData(), Horizontal.GetData(), Height, Width, Width, 1, Radius);
+	BlurLines(Horizontal.GetData(), OutValues.GetData(), Width, Height, 1, Width, Radius);
+}
+
+float FSummedAreaTableCPU::MaxAbsDifference(TArrayView<const float> A, TArrayView<const float> B)
+{
+	check(A.Num() == B.Num());
+	float MaxDifference = 0.f;
+	for (int32 Index = 0; Index < A.Num(); ++Index)
+	{
+		MaxDifference = FMath::Max(MaxDifference, FMath::Abs(A[Index] - B[Index]));
+	}
+	return MaxDifference;
+}
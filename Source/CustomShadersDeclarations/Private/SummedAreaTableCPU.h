@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// <summary>
+/// CPU implementation of the kernels in SummedAreaTableCS.usf. Rows are scanned in parallel, then columns in parallel bands of columns
+/// walked row by row so the accesses stay contiguous
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FSummedAreaTableCPU
+{
+	//Mirrors RowScanCS and ColumnScanCS. OutTable holds the sums of Values - Offset, returns the Offset (the mean of Values)
+	static float Build(TArrayView<const float> Values, int32 Width, int32 Height, TArray<float>& OutTable);
+
+	//Mirrors BoxFilterCS: mean over the (2 Radius + 1)^2 box around every texel clipped to the texture, four table lookups per texel
+	static void BoxFilter(TArrayView<const float> Table, float Offset, int32 Width, int32 Height, int32 Radius, TArray<float>& OutValues);
+
+	//Mirrors the two SeparableBlurCS passes, 2 Radius + 1 taps per texel and direction. Same result as BoxFilter up to rounding
+	static void SeparableBoxBlur(TArrayView<const float> Values, int32 Width, int32 Height, int32 Radius, TArray<float>& OutValues);
+
+	//Largest absolute difference between two images of the same size
+	static float MaxAbsDifference(TArrayView<const float> A, TArrayView<const float> B);
+};
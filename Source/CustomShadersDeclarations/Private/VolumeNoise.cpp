@@ -0,0 +1,170 @@
+#include "VolumeNoise.h"
+
+#include "HAL/IConsoleManager.h"
+#include "ShaderParameterStruct.h"
+#include "Core/TileScheduling.h"
+
+#define NUM_THREADS_PER_GROUP_DIMENSION 4
+
+static TAutoConsoleVariable<int32> CVarVolumePoolBudget(
+	TEXT("CustomShaders.Volume.PoolBudgetMB"),
+	0,
+	TEXT("Render target pool memory a volume noise brick may use, in MB.\n")
+	TEXT(" 0: what r.RenderTargetPoolMin leaves after the targets the pool already holds (default)"),
+	ECVF_RenderThreadSafe);
+
+/// <summary>
+/// Generates a brick of slices of 3D white noise, one thread per voxel in 4x4x4 groups
+/// </summary>
+class FVolumeNoiseCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FVolumeNoiseCS);
+	SHADER_USE_PARAMETER_STRUCT(FVolumeNoiseCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture3D<float>, OutputVolume)
+		SHADER_PARAMETER(FIntVector, VolumeSize)
+		SHADER_PARAMETER(UINT, VolumeSliceOffset)
+		SHADER_PARAMETER(UINT, TimeStamp)
+		SHADER_PARAMETER(UINT, Seed)
+	END_SHADER_PARAMETER_STRUCT()
+
+public:
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static inline void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_X"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Y"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("THREADGROUPSIZE_Z"), NUM_THREADS_PER_GROUP_DIMENSION);
+		OutEnvironment.SetDefine(TEXT("COARSENING"), 0);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FVolumeNoiseCS, "/CustomShaders/WhiteNoiseCS.usf", "VolumeComputeShader", SF_Compute);
+
+
+//Static members
+FVolumeNoiseCSManager* FVolumeNoiseCSManager::instance = nullptr;
+
+void FVolumeNoiseCSManager::BeginRendering()
+{
+	if (!(bCachedParamsAreValid && cachedParams.RenderTarget))
+	{
+		return;
+	}
+
+	ENQUEUE_RENDER_COMMAND(VolumeNoiseCommand)
+		(
+			[Parameters = cachedParams](FRHICommandListImmediate& RHICmdList)
+			{
+				FVolumeNoiseCSManager::Get()->UpdateResults(RHICmdList, Parameters);
+			}
+		);
+}
+
+void FVolumeNoiseCSManager::EndRendering()
+{
+	bCachedParamsAreValid = false;
+	ENQUEUE_RENDER_COMMAND(VolumeNoiseReleaseCommand)
+		(
+			[](FRHICommandListImmediate& RHICmdList)
+			{
+				FVolumeNoiseCSManager::Get()->GeneratedTexture.SafeRelease();
+			}
+		);
+}
+
+void FVolumeNoiseCSManager::UpdateParameters(const FVolumeNoiseCSParameters& Parameters)
+{
+	cachedParams = Parameters;
+	bCachedParamsAreValid = true;
+}
+
+int64 FVolumeNoiseCSManager::GetPoolBudgetBytes()
+{
+	const int32 BudgetMB = CVarVolumePoolBudget.GetValueOnRenderThread();
+	if (BudgetMB > 0)
+	{
+		return (int64)BudgetMB * 1024 * 1024;
+	}
+
+	static const IConsoleVariable* CVarPoolMin = IConsoleManager::Get().FindConsoleVariable(TEXT("r.RenderTargetPoolMin"));
+	const int64 PoolMinBytes = (int64)(CVarPoolMin ? CVarPoolMin->GetInt() : 400) * 1024 * 1024;
+	uint32 WholeCount = 0;
+	uint32 WholePoolInKB = 0;
+	uint32 UsedInKB = 0;
+	GRenderTargetPool.GetStats(WholeCount, WholePoolInKB, UsedInKB);
+	return FMath::Max<int64>(PoolMinBytes - (int64)UsedInKB * 1024, 0);
+}
+
+int32 FVolumeNoiseCSManager::GetBrickDepth(FIntVector Size, int32 BytesPerVoxel, int64 BudgetBytes)
+{
+	return FTileScheduling::GetBrickDepth(Size.X, Size.Y, Size.Z, BytesPerVoxel, BudgetBytes, NUM_THREADS_PER_GROUP_DIMENSION);
+}
+
+void FVolumeNoiseCSManager::UpdateResults(FRHICommandListImmediate& RHICmdList, const FVolumeNoiseCSParameters& Parameters)
+{
+	check(IsInRenderingThread());
+	FTextureRenderTargetResource* RenderTargetResource = Parameters.RenderTarget->GetRenderTargetResource();
+	if (!RenderTargetResource || !RenderTargetResource->TextureRHI)
+	{
+		return;
+	}
+
+	FTextureRHIRef OutTexture = RenderTargetResource->TextureRHI;
+	if (OutTexture == GeneratedTexture && Parameters.TimeStamp == GeneratedTimeStamp && Parameters.Seed == GeneratedSeed)
+	{
+		return;
+	}
+
+	const FIntVector Size = OutTexture->GetSizeXYZ();
+	const EPixelFormat Format = OutTexture->GetFormat();
+	const int32 BrickDepth = GetBrickDepth(Size, GPixelFormats[Format].BlockBytes, GetPoolBudgetBytes());
+	if (BrickDepth != LastBrickDepth)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Volume noise %dx%dx%d generated in bricks of %d slices"), Size.X, Size.Y, Size.Z, BrickDepth);
+		LastBrickDepth = BrickDepth;
+	}
+
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+	TShaderMapRef<FVolumeNoiseCS> ComputeShader(ShaderMap);
+
+	for (int32 SliceOffset = 0; SliceOffset < Size.Z; SliceOffset += BrickDepth)
+	{
+		const int32 Depth = FMath::Min(BrickDepth, Size.Z - SliceOffset);
+
+		FRDGBuilder GraphBuilder(RHICmdList);
+		FRDGTextureRef Brick = GraphBuilder.CreateTexture(
+			FRDGTextureDesc::CreateVolumeDesc(Size.X, Size.Y, Depth, Format, FClearValueBinding::None, TexCreate_None, TexCreate_ShaderResource | TexCreate_UAV, false),
+			TEXT("VolumeNoiseBrick"));
+
+		FVolumeNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FVolumeNoiseCS::FParameters>();
+		PassParameters->OutputVolume = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(Brick));
+		PassParameters->VolumeSize = Size;
+		PassParameters->VolumeSliceOffset = SliceOffset;
+		PassParameters->TimeStamp = Parameters.TimeStamp;
+		PassParameters->Seed = Parameters.Seed;
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("VolumeNoise slices %d-%d", SliceOffset, SliceOffset + Depth - 1), ComputeShader, PassParameters,
+									 FComputeShaderUtils::GetGroupCount(FIntVector(Size.X, Size.Y, Depth), FIntVector(NUM_THREADS_PER_GROUP_DIMENSION)));
+
+		TRefCountPtr<IPooledRenderTarget> PooledBrick;
+		GraphBuilder.QueueTextureExtraction(Brick, &PooledBrick);
+		GraphBuilder.Execute();
+
+		FRHICopyTextureInfo CopyInfo;
+		CopyInfo.Size = FIntVector(Size.X, Size.Y, Depth);
+		CopyInfo.DestPosition = FIntVector(0, 0, SliceOffset);
+		RHICmdList.CopyTexture(PooledBrick->GetRenderTargetItem().ShaderResourceTexture, OutTexture, CopyInfo);
+		//PooledBrick goes back to the pool here, the next brick reuses it
+	}
+
+	GeneratedTexture = OutTexture;
+	GeneratedTimeStamp = Parameters.TimeStamp;
+	GeneratedSeed = Parameters.Seed;
+}
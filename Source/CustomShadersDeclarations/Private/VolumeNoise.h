@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+#include "Runtime/Engine/Classes/Engine/TextureRenderTargetVolume.h"
+
+//This struct act as a container for all the parameters that the client needs to pass to the Volume Noise Manager.
+struct FVolumeNoiseCSParameters
+{
+	//Receives the noise, one value per voxel in its first channel
+	UTextureRenderTargetVolume* RenderTarget = nullptr;
+	uint32 TimeStamp = 1;
+	uint32 Seed = 0;
+
+	FVolumeNoiseCSParameters() { }
+	FVolumeNoiseCSParameters(UTextureRenderTargetVolume* IORenderTarget)
+		: RenderTarget(IORenderTarget)
+	{ }
+};
+
+/// <summary>
+/// A singleton manager that fills a volume render target with 3D white noise, e.g. as volumetric fog density
+/// The volume is generated in bricks of whole slices. A brick is a pooled 3D texture sized to fit the render target pool budget
+/// (CustomShaders.Volume.PoolBudgetMB), it is copied into the render target and returned to the pool before the next brick,
+/// so large volumes never need a second full size copy in the pool. The volume is only regenerated when the seed, the time stamp or the target change
+/// FWhiteNoiseCPU::GenerateVolume is the CPU counterpart
+/// </summary>
+class CUSTOMSHADERSDECLARATIONS_API FVolumeNoiseCSManager
+{
+public:
+	//Get the instance
+	static FVolumeNoiseCSManager* Get()
+	{
+		if (!instance)
+			instance = new FVolumeNoiseCSManager();
+		return instance;
+	};
+
+	// Generates the volume on the render thread with the last parameters
+	void BeginRendering();
+
+	// Forgets the last generated volume
+	void EndRendering();
+
+	// Call this whenever you have new parameters to share.
+	void UpdateParameters(const FVolumeNoiseCSParameters& Parameters);
+
+	void UpdateResults(FRHICommandListImmediate& RHICmdList, const FVolumeNoiseCSParameters& Parameters);
+
+	//Bytes of the render target pool a brick may use
+	static int64 GetPoolBudgetBytes();
+
+	//Number of slices per brick so that a brick of a Size volume with BytesPerVoxel fits in BudgetBytes. At least one slice,
+	//a multiple of the thread group depth when possible
+	static int32 GetBrickDepth(FIntVector Size, int32 BytesPerVoxel, int64 BudgetBytes);
+
+private:
+	//Private constructor to prevent client from instanciating
+	FVolumeNoiseCSManager() = default;
+
+	//The singleton instance
+	static FVolumeNoiseCSManager* instance;
+
+	//Cached parameters, written on the game thread and copied to the render thread by BeginRendering
+	FVolumeNoiseCSParameters cachedParams;
+	bool bCachedParamsAreValid = false;
+
+	//Render thread state: what the target currently holds
+	FTextureRHIRef GeneratedTexture;
+	uint32 GeneratedTimeStamp = 0;
+	uint32 GeneratedSeed = 0;
+	int32 LastBrickDepth = 0;
+};
@@ -0,0 +1,90 @@
+#include "WhiteNoiseCPU.h"
+
+#include "Async/ParallelFor.h"
+
+void FWhiteNoiseCPU::Generate(ENoiseType Type, FIntPoint Size, uint32 Seed, uint32 TimeStamp, TArray<float>& OutValues, ENoiseHash Hash)
+{
+	check(Size.X > 0 && Size.Y > 0);
+	OutValues.SetNumUninitialized(Size.X * Size.Y);
+	float* Values = OutValues.GetData();
+
+	switch (Type)
+	{
+	case ENoiseType::White:
+		ParallelFor(Size.Y, [Values, Size, Seed, TimeStamp, Hash](int32 Y)
+		{
+			FNoiseMath::GenerateWhiteNoiseRow(Y, Size.X, Seed, TimeStamp, Values + Y * Size.X, Hash);
+		});
+		break;
+	default:
+		checkNoEntry();
+		break;
+	}
+}
+
+uint64 FWhiteNoiseCPU::Checksum(FIntPoint Size, uint32 Seed, uint32 TimeStamp, ENoiseHash Hash)
+{
+	check(Size.X > 0 && Size.Y > 0);
+	TArray<uint64> RowChecksums;
+	RowChecksums.SetNumUninitialized(Size.Y);
+	uint64* Rows = RowChecksums.GetData();
+	ParallelFor(Size.Y, [Rows, Size, Seed, TimeStamp, Hash](int32 Y)
+	{
+		Rows[Y] = FNoiseMath::ChecksumWhiteNoiseRow(Y, Size.X, Seed, TimeStamp, Hash);
+	});
+
+	uint64 Checksum = 0;
+	for (const uint64 RowChecksum : RowChecksums)
+	{
+		Checksum ^= RowChecksum;
+	}
+	return Checksum;
+}
+
+void FWhiteNoiseCPU::GenerateNormals(FIntPoint Size, uint32 Seed, uint32 TimeStamp, ENoiseHash Hash, float Strength, TArray<FVector4>& OutNormals)
+{
+	TArray<float> Heights;
+	Generate(ENoiseType::White, Size, Seed, TimeStamp, Heights, Hash);
+	OutNormals.SetNumUninitialized(Size.X * Size.Y);
+	const float* Values = Heights.GetData();
+	FVector4* Normals = OutNormals.GetData();
+
+	ParallelFor(Size.Y, [Values, Normals, Size, Strength](int32 Y)
+	{
+		const float* Above = Values + FMath::Max(Y - 1, 0) * Size.X;
+		const float* Row = Values + Y * Size.X;
+		const float* Below = Values + FMath::Min(Y + 1, Size.Y - 1) * Size.X;
+		for (int32 X = 0; X < Size.X; ++X)
+		{
+			const int32 Left = FMath::Max(X - 1, 0);
+			const int32 Right = FMath::Min(X + 1, Size.X - 1);
+			//Same kernels and scale as WriteFusedNormal
+			const float SlopeX = ((Above[Right] + 2.f * Row[Right] + Below[Right]) - (Above[Left] + 2.f * Row[Left] + Below[Left])) * (Strength / 8.f);
+			const float SlopeY = ((Below[Left] + 2.f * Below[X] + Below[Right]) - (Above[Left] + 2.f * Above[X] + Above[Right])) * (Strength / 8.f);
+			Normals[Y * Size.X + X] = FVector4(FVector(-SlopeX, -SlopeY, 1.f).GetUnsafeNormal(), Row[X]);
+		}
+	});
+}
+
+void FWhiteNoiseCPU::GenerateVolume(FIntVector Size, uint32 Seed, uint32 TimeStamp, TArray<float>& OutValues)
+{
+	check(Size.X > 0 && Size.Y > 0 && Size.Z > 0);
+	OutValues.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+	float* Values = OutValues.GetData();
+
+	//One task per row of every slice
+	ParallelFor(Size.Y * Size.Z, [Values, Size, Seed, TimeStamp](int32 RowIndex)
+	{
+		FNoiseMath::GenerateVolumeRow(RowIndex % Size.Y, RowIndex / Size.Y, Size.X, Seed, TimeStamp, Values + RowIndex * Size.X);
+	});
+}
+
+bool FWhiteNoiseCPU::ParseNoiseType(const FString& Name, ENoiseType& OutType)
+{
+	if (Name.Equals(TEXT("White"), ESearchCase::IgnoreCase))
+	{
+		OutType = ENoiseType::White;
+		return true;
+	}
+	return false;
+}
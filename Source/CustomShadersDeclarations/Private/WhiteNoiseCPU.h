@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/NoiseMath.h"
+
+//The procedural outputs that can be generated. Used by the bake manifest and the CPU kernels
+enum class ENoiseType : uint8
+{
+	White,
+};
+
+/// <summary>
+/// CPU implementation of the kernels in WhiteNoiseCS.usf
+/// Every function mirrors its HLSL counterpart line by line so the results can be used for headless bakes and to validate the GPU output.
+/// The hash math itself is the engine-free FNoiseMath, this adds the engine containers and spreads the work across the worker threads
+/// </summary>
+struct CUSTOMSHADERSDECLARATIONS_API FWhiteNoiseCPU
+{
+	//Mirrors hash12 in WhiteNoiseCS.usf
+	static float Hash12(float X, float Y) { return FNoiseMath::Hash12(X, Y); }
+
+	//Mirrors HashAxis and hash12_axes, the split version of hash12 that lets a row or a column share its setup
+	static float HashAxis(uint32 LatticeCoord) { return FNoiseMath::HashAxis(LatticeCoord); }
+	static float Hash12Axes(float AxisX, float AxisY) { return FNoiseMath::Hash12Axes(AxisX, AxisY); }
+	//Mirrors hash13_axes
+	static float Hash13Axes(float AxisX, float AxisY, float AxisZ) { return FNoiseMath::Hash13Axes(AxisX, AxisY, AxisZ); }
+
+	//Mirrors MainComputeShader for the texel at (X, Y), with the HASH_FUNCTION permutation of Hash
+	static float EvaluateWhiteNoise(uint32 X, uint32 Y, uint32 Seed, uint32 TimeStamp, ENoiseHash Hash = ENoiseHash::Hash12)
+	{
+		return FNoiseMath::EvaluateWhiteNoise(X, Y, Seed, TimeStamp, Hash);
+	}
+
+	//Mirrors VolumeComputeShader for the voxel at (X, Y, Z)
+	static float EvaluateWhiteNoise3D(uint32 X, uint32 Y, uint32 Z, uint32 Seed, uint32 TimeStamp)
+	{
+		return FNoiseMath::EvaluateWhiteNoise3D(X, Y, Z, Seed, TimeStamp);
+	}
+
+	//Fills OutValues with Size.X * Size.Y texels (row-major). Rows are spread across all the worker threads
+	static void Generate(ENoiseType Type, FIntPoint Size, uint32 Seed, uint32 TimeStamp, TArray<float>& OutValues, ENoiseHash Hash = ENoiseHash::Hash12);
+
+	//64 bit checksum of the white noise output, the reference for the GPU checksum of FOutputChecksumMonitor. Rows are spread across the worker threads
+	static uint64 Checksum(FIntPoint Size, uint32 Seed, uint32 TimeStamp, ENoiseHash Hash = ENoiseHash::Hash12);
+
+	//Mirrors the FUSED_NORMAL output of MainComputeShader: the Sobel normal of the white noise seen as a height field, clamped at the borders,
+	//in xyz and the height in w. Fills OutNormals with Size.X * Size.Y texels (row-major), rows are spread across the worker threads
+	static void GenerateNormals(FIntPoint Size, uint32 Seed, uint32 TimeStamp, ENoiseHash Hash, float Strength, TArray<FVector4>& OutNormals);
+
+	//Fills OutValues with Size.X * Size.Y * Size.Z voxels, slice after slice. Used to validate the volume output headless, a 128^3 volume is 8MB
+	static void GenerateVolume(FIntVector Size, uint32 Seed, uint32 TimeStamp, TArray<float>& OutValues);
+
+	//Converts a manifest/command line name ("White") to a noise type. Returns false if the name is unknown
+	static bool ParseNoiseType(const FString& Name, ENoiseType& OutType);
+};
@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "NoiseMath.h"
+
+//Texel by texel, what MainComputeShader does with COARSENING 0
+static void BM_EvaluateWhiteNoise(benchmark::State& State)
+{
+	const int32_t Size = (int32_t)State.range(0);
+	std::vector<float> Values((size_t)Size * Size);
+	for (auto _ : State)
+	{
+		for (int32_t Y = 0; Y < Size; ++Y)
+		{
+			for (int32_t X = 0; X < Size; ++X)
+			{
+				Values[(size_t)Y * Size + X] = FNoiseMath::EvaluateWhiteNoise(X, Y, 7, 3);
+			}
+		}
+		benchmark::DoNotOptimize(Values.data());
+	}
+	State.SetItemsProcessed(State.iterations() * Size * Size);
+}
+BENCHMARK(BM_EvaluateWhiteNoise)->Arg(256)->Arg(1024);
+
+//Rows sharing their Y axis setup, what FWhiteNoiseCPU::Generate runs on every worker
+static void BM_GenerateWhiteNoiseRow(benchmark::State& State)
+{
+	const int32_t Size = (int32_t)State.range(0);
+	std::vector<float> Values((size_t)Size * Size);
+	for (auto _ : State)
+	{
+		for (int32_t Y = 0; Y < Size; ++Y)
+		{
+			FNoiseMath::GenerateWhiteNoiseRow(Y, Size, 7, 3, Values.data() + (size_t)Y * Size);
+		}
+		benchmark::DoNotOptimize(Values.data());
+	}
+	State.SetItemsProcessed(State.iterations() * Size * Size);
+}
+BENCHMARK(BM_GenerateWhiteNoiseRow)->Arg(256)->Arg(1024);
+
+//Every hash family of the HASH_FUNCTION permutation on 1024x1024 rows, the CPU column of the speed/quality comparison. NoiseQuality
+//scores the same families and ShaderHarness --hash all times them on the Vulkan device
+static void BM_WhiteNoiseHash(benchmark::State& State)
+{
+	const int32_t Size = 1024;
+	const ENoiseHash Hash = (ENoiseHash)State.range(0);
+	std::vector<float> Values((size_t)Size * Size);
+	for (auto _ : State)
+	{
+		for (int32_t Y = 0; Y < Size; ++Y)
+		{
+			FNoiseMath::GenerateWhiteNoiseRow(Y, Size, 7, 3, Values.data() + (size_t)Y * Size, Hash);
+		}
+		benchmark::DoNotOptimize(Values.data());
+	}
+	State.SetItemsProcessed(State.iterations() * Size * Size);
+	State.SetLabel(FNoiseMath::GetHashName(Hash));
+}
+BENCHMARK(BM_WhiteNoiseHash)->DenseRange(0, (int)ENoiseHash::Count - 1);
+
+//The CPU reference of the output checksum, the same rows hashed instead of stored
+static void BM_ChecksumWhiteNoiseRow(benchmark::State& State)
+{
+	const int32_t Size = (int32_t)State.range(0);
+	for (auto _ : State)
+	{
+		uint64_t Checksum = 0;
+		for (int32_t Y = 0; Y < Size; ++Y)
+		{
+			Checksum ^= FNoiseMath::ChecksumWhiteNoiseRow(Y, Size, 7, 3);
+		}
+		benchmark::DoNotOptimize(Checksum);
+	}
+	State.SetItemsProcessed(State.iterations() * Size * Size);
+}
+BENCHMARK(BM_ChecksumWhiteNoiseRow)->Arg(256)->Arg(1024);
+
+static void BM_GenerateVolumeRow(benchmark::State& State)
+{
+	const int32_t Size = (int32_t)State.range(0);
+	std::vector<float> Values((size_t)Size * Size * Size);
+	for (auto _ : State)
+	{
+		for (int32_t Z = 0; Z < Size; ++Z)
+		{
+			for (int32_t Y = 0; Y < Size; ++Y)
+			{
+				FNoiseMath::GenerateVolumeRow(Y, Z, Size, 7, 3, Values.data() + ((size_t)Z * Size + Y) * Size);
+			}
+		}
+		benchmark::DoNotOptimize(Values.data());
+	}
+	State.SetItemsProcessed(State.iterations() * Size * Size * Size);
+}
+BENCHMARK(BM_GenerateVolumeRow)->Arg(64)->Arg(128);
@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "DispatchSizing.h"
+#include "ParameterPacking.h"
+#include "TileScheduling.h"
+
+//Group counts of every size up to Range x Range, for the three white noise permutations
+static void BM_GetGroupCount2D(benchmark::State& State)
+{
+	const int32_t Range = (int32_t)State.range(0);
+	for (auto _ : State)
+	{
+		int64_t NumGroups = 0;
+		for (int32_t Coarsening = 0; Coarsening < 3; ++Coarsening)
+		{
+			int32_t BlockX, BlockY;
+			FDispatchSizing::GetWhiteNoiseBlockSize(Coarsening, BlockX, BlockY);
+			for (int32_t Size = 1; Size <= Range; ++Size)
+			{
+				const FGroupCount GroupCount = FDispatchSizing::GetGroupCount2D(Size, Size, 32, BlockX, BlockY);
+				NumGroups += GroupCount.X * GroupCount.Y;
+			}
+		}
+		benchmark::DoNotOptimize(NumGroups);
+	}
+	State.SetItemsProcessed(State.iterations() * 3 * Range);
+}
+BENCHMARK(BM_GetGroupCount2D)->Arg(4096);
+
+//Tiles of a fluid simulation of Size x Size cells with every tile dispatched
+static void BM_ForEachDenseTile(benchmark::State& State)
+{
+	const int32_t Size = (int32_t)State.range(0);
+	std::vector<FTileRect> Tiles;
+	for (auto _ : State)
+	{
+		Tiles.clear();
+		FTileScheduling::ForEachDenseTile(Size, Size, 64, [&Tiles](const FTileRect& Tile) { Tiles.push_back(Tile); });
+		benchmark::DoNotOptimize(Tiles.data());
+	}
+}
+BENCHMARK(BM_ForEachDenseTile)->Arg(1024)->Arg(4096);
+
+//Dilation and run merging of the 8x8 activity tiles of a Size x Size simulation, a disc of active tiles in the middle like a single emitter
+static void BM_SparseTileRuns(benchmark::State& State)
+{
+	const int32_t Size = (int32_t)State.range(0);
+	const int32_t ActivityTileSize = 8;
+	const int32_t Grid = FDispatchSizing::DivideAndRoundUp(Size, ActivityTileSize);
+	std::vector<uint8_t> Active((size_t)Grid * Grid);
+	for (int32_t Y = 0; Y < Grid; ++Y)
+	{
+		for (int32_t X = 0; X < Grid; ++X)
+		{
+			const int32_t DX = X - Grid / 2;
+			const int32_t DY = Y - Grid / 2;
+			Active[(size_t)Y * Grid + X] = DX * DX + DY * DY < Grid * Grid / 16 ? 1 : 0;
+		}
+	}
+	std::vector<uint8_t> Dispatched(Active.size());
+	std::vector<FTileRect> Tiles;
+	for (auto _ : State)
+	{
+		for (int32_t Y = 0; Y < Grid; ++Y)
+		{
+			for (int32_t X = 0; X < Grid; ++X)
+			{
+				Dispatched[(size_t)Y * Grid + X] = FTileScheduling::IsTileDispatched(Active.data(), Grid, Grid, X, Y) ? 1 : 0;
+			}
+		}
+		Tiles.clear();
+		FTileScheduling::ForEachTileRun(Dispatched.data(), Grid, Grid, ActivityTileSize, 8, Size, Size, [&Tiles](const FTileRect& Tile) { Tiles.push_back(Tile); });
+		benchmark::DoNotOptimize(Tiles.data());
+	}
+	State.SetItemsProcessed(State.iterations() * Grid * Grid);
+}
+BENCHMARK(BM_SparseTileRuns)->Arg(1024)->Arg(4096);
+
+//Round trip of the x | y << 16 texel indices of a Size x Size texture
+static void BM_PackTexelIndex(benchmark::State& State)
+{
+	const uint32_t Size = (uint32_t)State.range(0);
+	for (auto _ : State)
+	{
+		uint64_t Checksum = 0;
+		for (uint32_t Y = 0; Y < Size; ++Y)
+		{
+			for (uint32_t X = 0; X < Size; ++X)
+			{
+				uint32_t UnpackedX, UnpackedY;
+				FParameterPacking::UnpackTexelIndex(FParameterPacking::PackTexelIndex(X, Y), UnpackedX, UnpackedY);
+				Checksum += UnpackedX ^ UnpackedY;
+			}
+		}
+		benchmark::DoNotOptimize(Checksum);
+	}
+	State.SetItemsProcessed(State.iterations() * Size * Size);
+}
+BENCHMARK(BM_PackTexelIndex)->Arg(1024);
+
+static void BM_GetBrickDepth(benchmark::State& State)
+{
+	for (auto _ : State)
+	{
+		int64_t Slices = 0;
+		for (int32_t Size = 4; Size <= 512; Size += 4)
+		{
+			Slices += FTileScheduling::GetBrickDepth(Size, Size, Size, 4, 64ll * 1024 * 1024, 4);
+		}
+		benchmark::DoNotOptimize(Slices);
+	}
+}
+BENCHMARK(BM_GetBrickDepth);
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "NoiseMath.h"
+
+//Known answers of the integer hashes, computed from the published algorithms independently of FNoiseMath. A change here means the CPU
+//twins no longer match what WhiteNoiseCS.usf computes
+namespace
+{
+	struct FLatticePoint
+	{
+		uint32_t X;
+		uint32_t Y;
+	};
+
+	const FLatticePoint LatticePoints[] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1973, 9277 }, { 123456789, 987654321 }, { 0xFFFFFFFFu, 0xFFFFFFFFu } };
+
+	uint32_t FloatBits(float Value)
+	{
+		uint32_t Bits;
+		std::memcpy(&Bits, &Value, sizeof(Bits));
+		return Bits;
+	}
+}
+
+TEST(NoiseMath, PCG2DKnownAnswers)
+{
+	const uint32_t Expected[] = { 0x055DF4D1u, 0x857B19DFu, 0xF003BE1Cu, 0xCCF1C6BCu, 0x67E3836Cu, 0x6C463194u };
+	for (int32_t Index = 0; Index < 6; ++Index)
+	{
+		EXPECT_EQ(FNoiseMath::PCG2D(LatticePoints[Index].X, LatticePoints[Index].Y), Expected[Index]) << "point " << Index;
+		EXPECT_EQ(FNoiseMath::HashLattice(ENoiseHash::PCG2D, LatticePoints[Index].X, LatticePoints[Index].Y), Expected[Index]);
+	}
+}
+
+TEST(NoiseMath, XXHash32KnownAnswers)
+{
+	const uint32_t Expected[] = { 0x34560F83u, 0x8287B9F0u, 0x9485C89Bu, 0x85D278E6u, 0xE3A49AF8u, 0x1D1D3FE1u };
+	for (int32_t Index = 0; Index < 6; ++Index)
+	{
+		EXPECT_EQ(FNoiseMath::XXHash32(LatticePoints[Index].X, LatticePoints[Index].Y), Expected[Index]) << "point " << Index;
+		EXPECT_EQ(FNoiseMath::HashLattice(ENoiseHash::XXHash32, LatticePoints[Index].X, LatticePoints[Index].Y), Expected[Index]);
+	}
+}
+
+TEST(NoiseMath, WangKnownAnswers)
+{
+	const uint32_t Values[] = { 0, 1, 61, 0x12345678u, 0xFFFFFFFFu };
+	const uint32_t Expected[] = { 0xC0A9496Au, 0x27922C9Du, 0x00000000u, 0x45ADCDD4u, 0x70F499D3u };
+	for (int32_t Index = 0; Index < 5; ++Index)
+	{
+		EXPECT_EQ(FNoiseMath::WangHash(Values[Index]), Expected[Index]) << "value " << Index;
+	}
+
+	//Nested over the lattice: wang(x + wang(y))
+	const uint32_t ExpectedLattice[] = { 0xB74D7928u, 0x78A44F01u, 0x679CC3CEu, 0x91915099u, 0xFDD32954u, 0xB44B3FE8u };
+	for (int32_t Index = 0; Index < 6; ++Index)
+	{
+		EXPECT_EQ(FNoiseMath::HashLattice(ENoiseHash::Wang, LatticePoints[Index].X, LatticePoints[Index].Y), ExpectedLattice[Index]) << "point " << Index;
+	}
+}
+
+TEST(NoiseMath, IQIntKnownAnswers)
+{
+	const uint32_t Expected[] = { 0x00000000u, 0xEF386249u, 0xC2A29A69u, 0x9017BB7Au, 0x2013716Eu, 0x50000000u };
+	for (int32_t Index = 0; Index < 6; ++Index)
+	{
+		EXPECT_EQ(FNoiseMath::IQIntHash(LatticePoints[Index].X, LatticePoints[Index].Y), Expected[Index]) << "point " << Index;
+		EXPECT_EQ(FNoiseMath::HashLattice(ENoiseHash::IQInt, LatticePoints[Index].X, LatticePoints[Index].Y), Expected[Index]);
+	}
+}
+
+//hash12 in single precision, one rounding per operation like the precise shader
+TEST(NoiseMath, Hash12KnownAnswers)
+{
+	const float Points[][2] = { { 0.f, 0.f }, { 1.f, 0.f }, { 1973.f, 9277.f }, { 4096.f, 4096.f }, { 100000.f, 3.f } };
+	const uint32_t Expected[] = { 0x00000000u, 0x3F660A80u, 0x3D0D0000u, 0x3F3C8000u, 0x3F3CFF00u };
+	for (int32_t Index = 0; Index < 5; ++Index)
+	{
+		EXPECT_EQ(FloatBits(FNoiseMath::Hash12(Points[Index][0], Points[Index][1])), Expected[Index]) << "point " << Index;
+	}
+}
+
+TEST(NoiseMath, MixChecksumKnownAnswers)
+{
+	EXPECT_EQ(FNoiseMath::MixChecksum(0), 0u);
+	EXPECT_EQ(FNoiseMath::MixChecksum(1), 0x514E28B7u);
+	EXPECT_EQ(FNoiseMath::MixChecksum(0xDEADBEEFu), 0x0DE5C6A9u);
+}
+
+TEST(NoiseMath, HashToUnormKeepsTheTop24Bits)
+{
+	EXPECT_EQ(FNoiseMath::HashToUnorm(0), 0.f);
+	EXPECT_EQ(FNoiseMath::HashToUnorm(0xFFu), 0.f);
+	EXPECT_EQ(FNoiseMath::HashToUnorm(0x100u), 1.f / 16777216.f);
+	EXPECT_EQ(FNoiseMath::HashToUnorm(0x80000000u), 0.5f);
+	EXPECT_LT(FNoiseMath::HashToUnorm(0xFFFFFFFFu), 1.f);
+}
+
+//The row generators share the per axis setup, they must still produce EvaluateWhiteNoise for every texel
+TEST(NoiseMath, RowsMatchTheTexelEvaluation)
+{
+	const int32_t Width = 67;
+	std::vector<float> Row(Width);
+	for (int32_t HashIndex = 0; HashIndex < (int32_t)ENoiseHash::Count; ++HashIndex)
+	{
+		const ENoiseHash Hash = (ENoiseHash)HashIndex;
+		for (uint32_t Y : { 0u, 5u, 4095u })
+		{
+			FNoiseMath::GenerateWhiteNoiseRow(Y, Width, 3, 7, Row.data(), Hash);
+			for (int32_t X = 0; X < Width; ++X)
+			{
+				ASSERT_EQ(FloatBits(Row[X]), FloatBits(FNoiseMath::EvaluateWhiteNoise(X, Y, 3, 7, Hash))) << FNoiseMath::GetHashName(Hash) << " (" << X << ", " << Y << ")";
+			}
+		}
+	}
+}
+
+TEST(NoiseMath, VolumeRowsMatchTheVoxelEvaluation)
+{
+	const int32_t Width = 33;
+	std::vector<float> Row(Width);
+	FNoiseMath::GenerateVolumeRow(9, 4, Width, 2, 1, Row.data());
+	for (int32_t X = 0; X < Width; ++X)
+	{
+		ASSERT_EQ(FloatBits(Row[X]), FloatBits(FNoiseMath::EvaluateWhiteNoise3D(X, 9, 4, 2, 1))) << X;
+	}
+}
+
+TEST(NoiseMath, RowChecksumIsTheXorOfTheTexelChecksums)
+{
+	const int32_t Width = 50;
+	const uint32_t Y = 3;
+	for (int32_t HashIndex = 0; HashIndex < (int32_t)ENoiseHash::Count; ++HashIndex)
+	{
+		const ENoiseHash Hash = (ENoiseHash)HashIndex;
+		uint64_t Expected = 0;
+		for (int32_t X = 0; X < Width; ++X)
+		{
+			Expected ^= FNoiseMath::ChecksumTexel(Y * Width + X, FNoiseMath::EvaluateWhiteNoise(X, Y, 1, 1, Hash));
+		}
+		EXPECT_EQ(FNoiseMath::ChecksumWhiteNoiseRow(Y, Width, 1, 1, Hash), Expected) << FNoiseMath::GetHashName(Hash);
+	}
+}
+
+TEST(NoiseMath, ChecksumTexelDependsOnTheIndexAndTheValue)
+{
+	EXPECT_NE(FNoiseMath::ChecksumTexel(0, 0.5f), FNoiseMath::ChecksumTexel(1, 0.5f));
+	EXPECT_NE(FNoiseMath::ChecksumTexel(0, 0.5f), FNoiseMath::ChecksumTexel(0, 0.25f));
+}
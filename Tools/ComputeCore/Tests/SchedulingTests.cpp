@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "DispatchSizing.h"
+#include "ParameterPacking.h"
+#include "TileScheduling.h"
+
+namespace
+{
+	std::vector<FTileRect> GetDenseTiles(int32_t Width, int32_t Height, int32_t TileSize)
+	{
+		std::vector<FTileRect> Tiles;
+		FTileScheduling::ForEachDenseTile(Width, Height, TileSize, [&Tiles](const FTileRect& Tile) { Tiles.push_back(Tile); });
+		return Tiles;
+	}
+
+	std::vector<FTileRect> GetTileRuns(const std::vector<uint8_t>& Dispatched, int32_t GridX, int32_t GridY, int32_t TileSize, int32_t MaxRunLength,
+									   int32_t Width, int32_t Height)
+	{
+		std::vector<FTileRect> Runs;
+		FTileScheduling::ForEachTileRun(Dispatched.data(), GridX, GridY, TileSize, MaxRunLength, Width, Height,
+										[&Runs](const FTileRect& Run) { Runs.push_back(Run); });
+		return Runs;
+	}
+
+	bool operator==(const FTileRect& A, const FTileRect& B)
+	{
+		return A.MinX == B.MinX && A.MinY == B.MinY && A.MaxX == B.MaxX && A.MaxY == B.MaxY;
+	}
+}
+
+TEST(DispatchSizing, DivideAndRoundUp)
+{
+	EXPECT_EQ(FDispatchSizing::DivideAndRoundUp(1, 32), 1);
+	EXPECT_EQ(FDispatchSizing::DivideAndRoundUp(32, 32), 1);
+	EXPECT_EQ(FDispatchSizing::DivideAndRoundUp(33, 32), 2);
+	EXPECT_EQ(FDispatchSizing::DivideAndRoundUp(0, 32), 0);
+}
+
+//Every coarsening block at sizes that are and aren't multiples of the group footprint: the groups cover the output, and one group less wouldn't
+TEST(DispatchSizing, GroupCountCoversEveryTexelOfEveryCoarsening)
+{
+	const int32_t ThreadsPerGroup = 32;
+	const int32_t Sizes[] = { 1, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1000, 1920, 4095, 4096, 4097 };
+	for (int32_t Coarsening = 0; Coarsening < 3; ++Coarsening)
+	{
+		int32_t BlockX, BlockY;
+		FDispatchSizing::GetWhiteNoiseBlockSize(Coarsening, BlockX, BlockY);
+		for (const int32_t Width : Sizes)
+		{
+			for (const int32_t Height : { 1, 33, 1080 })
+			{
+				const FGroupCount GroupCount = FDispatchSizing::GetGroupCount2D(Width, Height, ThreadsPerGroup, BlockX, BlockY);
+				EXPECT_GE(GroupCount.X * ThreadsPerGroup * BlockX, Width) << "coarsening " << Coarsening;
+				EXPECT_LT((GroupCount.X - 1) * ThreadsPerGroup * BlockX, Width) << "coarsening " << Coarsening;
+				EXPECT_GE(GroupCount.Y * ThreadsPerGroup * BlockY, Height) << "coarsening " << Coarsening;
+				EXPECT_LT((GroupCount.Y - 1) * ThreadsPerGroup * BlockY, Height) << "coarsening " << Coarsening;
+				EXPECT_EQ(GroupCount.Z, 1);
+			}
+		}
+	}
+}
+
+TEST(DispatchSizing, WhiteNoiseBlockSizes)
+{
+	const int32_t Expected[][2] = { { 1, 1 }, { 2, 2 }, { 4, 1 } };
+	for (int32_t Coarsening = 0; Coarsening < 3; ++Coarsening)
+	{
+		int32_t BlockX, BlockY;
+		FDispatchSizing::GetWhiteNoiseBlockSize(Coarsening, BlockX, BlockY);
+		EXPECT_EQ(BlockX, Expected[Coarsening][0]);
+		EXPECT_EQ(BlockY, Expected[Coarsening][1]);
+	}
+
+	//Out of range values are clamped
+	int32_t BlockX, BlockY;
+	FDispatchSizing::GetWhiteNoiseBlockSize(-1, BlockX, BlockY);
+	EXPECT_EQ(BlockX, 1);
+	EXPECT_EQ(BlockY, 1);
+	FDispatchSizing::GetWhiteNoiseBlockSize(7, BlockX, BlockY);
+	EXPECT_EQ(BlockX, 4);
+	EXPECT_EQ(BlockY, 1);
+}
+
+TEST(TileScheduling, DenseTilesCoverTheGridOnceAndAreClipped)
+{
+	const std::vector<FTileRect> Tiles = GetDenseTiles(130, 70, 64);
+	ASSERT_EQ(Tiles.size(), 6u);
+	EXPECT_TRUE(Tiles[0] == (FTileRect{ 0, 0, 64, 64 }));
+	EXPECT_TRUE(Tiles[2] == (FTileRect{ 128, 0, 130, 64 }));
+	EXPECT_TRUE(Tiles[5] == (FTileRect{ 128, 64, 130, 70 }));
+
+	int64_t Area = 0;
+	for (const FTileRect& Tile : Tiles)
+	{
+		Area += (int64_t)(Tile.MaxX - Tile.MinX) * (Tile.MaxY - Tile.MinY);
+	}
+	EXPECT_EQ(Area, 130 * 70);
+	EXPECT_TRUE(GetDenseTiles(0, 0, 64).empty());
+}
+
+//A tile is dispatched when it or one of its 8 neighbours is active, like BuildTileListsCS
+TEST(TileScheduling, DispatchedTilesAreTheDilatedActiveTiles)
+{
+	const int32_t Grid = 5;
+	std::vector<uint8_t> Active(Grid * Grid, 0);
+	Active[2 * Grid + 2] = 1;
+	for (int32_t Y = 0; Y < Grid; ++Y)
+	{
+		for (int32_t X = 0; X < Grid; ++X)
+		{
+			const bool bNeighbour = X >= 1 && X <= 3 && Y >= 1 && Y <= 3;
+			EXPECT_EQ(FTileScheduling::IsTileDispatched(Active.data(), Grid, Grid, X, Y), bNeighbour) << X << ", " << Y;
+		}
+	}
+
+	//Corners don't read outside the grid
+	std::vector<uint8_t> Corner(Grid * Grid, 0);
+	Corner[0] = 1;
+	EXPECT_TRUE(FTileScheduling::IsTileDispatched(Corner.data(), Grid, Grid, 1, 1));
+	EXPECT_FALSE(FTileScheduling::IsTileDispatched(Corner.data(), Grid, Grid, 2, 0));
+}
+
+TEST(TileScheduling, TileRunsAreMergedCutAndClipped)
+{
+	//Row 0: tiles 0-4 dispatched, row 1: tiles 1 and 3, row 2: nothing
+	const int32_t GridX = 5;
+	const int32_t GridY = 3;
+	const std::vector<uint8_t> Dispatched = { 1, 1, 1, 1, 1,
+											  0, 1, 0, 1, 0,
+											  0, 0, 0, 0, 0 };
+	const std::vector<FTileRect> Runs = GetTileRuns(Dispatched, GridX, GridY, 8, 3, 36, 20);
+	ASSERT_EQ(Runs.size(), 4u);
+	//The first row is cut after 3 tiles, its last run is clipped to the width
+	EXPECT_TRUE(Runs[0] == (FTileRect{ 0, 0, 24, 8 }));
+	EXPECT_TRUE(Runs[1] == (FTileRect{ 24, 0, 36, 8 }));
+	EXPECT_TRUE(Runs[2] == (FTileRect{ 8, 8, 16, 16 }));
+	EXPECT_TRUE(Runs[3] == (FTileRect{ 24, 8, 32, 16 }));
+
+	//Without a cut a full row is one run, the last row is clipped to the height
+	const std::vector<uint8_t> AllDispatched(GridX * GridY, 1);
+	const std::vector<FTileRect> FullRuns = GetTileRuns(AllDispatched, GridX, GridY, 8, GridX, 40, 20);
+	ASSERT_EQ(FullRuns.size(), 3u);
+	EXPECT_TRUE(FullRuns[2] == (FTileRect{ 0, 16, 40, 20 }));
+}
+
+TEST(TileScheduling, BrickDepthFitsTheBudget)
+{
+	const int32_t BytesPerVoxel = 4;
+	const int64_t SliceBytes = 64 * 64 * BytesPerVoxel;
+
+	//The whole volume fits, or the budget is exactly the volume
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, SliceBytes * 1000, 4), 64);
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, SliceBytes * 64, 4), 64);
+	//Less than one slice still makes progress
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, SliceBytes - 1, 4), 1);
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, 0, 4), 1);
+	//Partial bricks are rounded down to the group depth when that leaves more than one group
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, SliceBytes * 11, 4), 8);
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, SliceBytes * 63, 4), 60);
+	//...and kept as they are when they are one group or less
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, SliceBytes * 3, 4), 3);
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(64, 64, 64, BytesPerVoxel, SliceBytes * 4, 4), 4);
+	//Empty slices don't divide by zero
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(0, 64, 16, BytesPerVoxel, 1, 4), 16);
+	//Slices over 2 GB don't overflow
+	EXPECT_EQ(FTileScheduling::GetBrickDepth(32768, 32768, 8, BytesPerVoxel, (int64_t)32768 * 32768 * BytesPerVoxel * 2, 4), 2);
+}
+
+//The offsets the harness writes $Globals with, checked against the HLSL packing rules
+TEST(ParameterPacking, ConstantOffsets)
+{
+	EXPECT_EQ(FParameterPacking::GetConstantOffset(0, 8), 0u);
+	EXPECT_EQ(FParameterPacking::GetConstantOffset(8, 4), 8u);
+	EXPECT_EQ(FParameterPacking::GetConstantOffset(9, 4), 12u);
+	//A float2 after 12 bytes would straddle the register, it moves to the next one
+	EXPECT_EQ(FParameterPacking::GetConstantOffset(12, 8), 16u);
+	EXPECT_EQ(FParameterPacking::GetConstantOffset(4, 12), 4u);
+	EXPECT_EQ(FParameterPacking::GetConstantOffset(8, 12), 16u);
+
+	EXPECT_EQ(offsetof(FWhiteNoiseGlobals, Dimensions), 0u);
+	EXPECT_EQ(offsetof(FWhiteNoiseGlobals, TimeStamp), 8u);
+	EXPECT_EQ(offsetof(FWhiteNoiseGlobals, Seed), 12u);
+	EXPECT_EQ(sizeof(FWhiteNoiseGlobals), 16u);
+
+	const FWhiteNoiseGlobals Globals = FParameterPacking::PackWhiteNoise(1920, 1080, 7, 3);
+	EXPECT_EQ(Globals.Dimensions[0], 1920.f);
+	EXPECT_EQ(Globals.Dimensions[1], 1080.f);
+	EXPECT_EQ(Globals.TimeStamp, 7u);
+	EXPECT_EQ(Globals.Seed, 3u);
+}
+
+TEST(ParameterPacking, TexelIndicesRoundTrip)
+{
+	const uint32_t Texels[][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 65535, 65535 }, { 1234, 4321 } };
+	for (const auto& Texel : Texels)
+	{
+		uint32_t X, Y;
+		FParameterPacking::UnpackTexelIndex(FParameterPacking::PackTexelIndex(Texel[0], Texel[1]), X, Y);
+		EXPECT_EQ(X, Texel[0]);
+		EXPECT_EQ(Y, Texel[1]);
+	}
+	EXPECT_EQ(FParameterPacking::PackTexelIndex(3, 2), 0x20003u);
+}
+
+//Slice z of the ring is generated for FrameRingFirstTimeStamp + z, the slice of a timestamp must be the one generated for it
+TEST(ParameterPacking, FrameRingSliceHoldsTheTimeStamp)
+{
+	for (const uint32_t NumSlices : { 1u, 3u, 16u })
+	{
+		for (uint32_t Slice = 0; Slice < NumSlices; ++Slice)
+		{
+			const uint32_t TimeStamp = FParameterPacking::FrameRingFirstTimeStamp + Slice;
+			EXPECT_EQ(FParameterPacking::GetFrameRingSlice(TimeStamp, NumSlices), Slice) << NumSlices << " slices";
+			//The ring repeats
+			EXPECT_EQ(FParameterPacking::GetFrameRingSlice(TimeStamp + 5 * NumSlices, NumSlices), Slice) << NumSlices << " slices";
+		}
+	}
+	//TimeStamp 0 is the end of the cycle before the first one, unsigned arithmetic doesn't wrap into another slice
+	EXPECT_EQ(FParameterPacking::GetFrameRingSlice(0, 16), 15u);
+	EXPECT_EQ(FParameterPacking::GetFrameRingSlice(0xFFFFFFFFu, 16), (0xFFFFFFFFu - FParameterPacking::FrameRingFirstTimeStamp) % 16u);
+	EXPECT_EQ(FParameterPacking::GetFrameRingSlice(5, 0), 0u);
+}
@@ -0,0 +1,79 @@
+#include "Generators.h"
+
+#include "NoiseMath.h"
+
+namespace
+{
+	//MainComputeShader with each HASH_FUNCTION permutation
+	template <ENoiseHash Hash>
+	float EvaluateWhiteNoise(uint32_t X, uint32_t Y, uint32_t Seed, uint32_t Frame)
+	{
+		return FNoiseMath::EvaluateWhiteNoise(X, Y, Seed, Frame, Hash);
+	}
+
+	template <ENoiseHash Hash>
+	void GenerateWhiteNoiseRow(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t Frame, float* OutRow)
+	{
+		FNoiseMath::GenerateWhiteNoiseRow(Y, Width, Seed, Frame, OutRow, Hash);
+	}
+
+	//The volume is sampled at TimeStamp 1, so the lattice is the voxel coordinates themselves
+	float EvaluateHash13(uint32_t X, uint32_t Y, uint32_t Seed, uint32_t Frame)
+	{
+		return FNoiseMath::EvaluateWhiteNoise3D(X, Y, Frame, Seed, 1);
+	}
+
+	void GenerateHash13Row(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t Frame, float* OutRow)
+	{
+		FNoiseMath::GenerateVolumeRow(Y, Frame, Width, Seed, 1, OutRow);
+	}
+
+	//splitmix64 finalizer, a bijection of 64 bits where every input bit flips every output bit with probability 1/2
+	uint64_t SplitMix64(uint64_t Value)
+	{
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+
+	//A hash known to pass every test here, tells a weak kernel from a broken test. The frame and seed are mixed first,
+	//then the packed coordinates, so every output bit depends on all four inputs
+	uint64_t ReferenceRowKey(uint32_t Seed, uint32_t Frame)
+	{
+		return SplitMix64(((uint64_t)Frame << 32) | Seed);
+	}
+
+	float ReferenceToFloat(uint32_t X, uint32_t Y, uint64_t RowKey)
+	{
+		const uint64_t Hash = SplitMix64(RowKey ^ (((uint64_t)Y << 32) | X));
+		return (float)(Hash >> 40) * (1.f / 16777216.f);
+	}
+
+	float EvaluateReference(uint32_t X, uint32_t Y, uint32_t Seed, uint32_t Frame)
+	{
+		return ReferenceToFloat(X, Y, ReferenceRowKey(Seed, Frame));
+	}
+
+	void GenerateReferenceRow(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t Frame, float* OutRow)
+	{
+		const uint64_t RowKey = ReferenceRowKey(Seed, Frame);
+		for (int32_t X = 0; X < Width; ++X)
+		{
+			OutRow[X] = ReferenceToFloat((uint32_t)X, Y, RowKey);
+		}
+	}
+}
+
+const std::vector<FNoiseGenerator>& GetNoiseGenerators()
+{
+	static const std::vector<FNoiseGenerator> Generators = {
+		{ "hash12", "MainComputeShader, frame = TimeStamp", &EvaluateWhiteNoise<ENoiseHash::Hash12>, &GenerateWhiteNoiseRow<ENoiseHash::Hash12>, true },
+		{ "pcg2d", "MainComputeShader HASH_FUNCTION=1", &EvaluateWhiteNoise<ENoiseHash::PCG2D>, &GenerateWhiteNoiseRow<ENoiseHash::PCG2D>, true },
+		{ "xxhash32", "MainComputeShader HASH_FUNCTION=2", &EvaluateWhiteNoise<ENoiseHash::XXHash32>, &GenerateWhiteNoiseRow<ENoiseHash::XXHash32>, true },
+		{ "wang", "MainComputeShader HASH_FUNCTION=3", &EvaluateWhiteNoise<ENoiseHash::Wang>, &GenerateWhiteNoiseRow<ENoiseHash::Wang>, true },
+		{ "iqint", "MainComputeShader HASH_FUNCTION=4", &EvaluateWhiteNoise<ENoiseHash::IQInt>, &GenerateWhiteNoiseRow<ENoiseHash::IQInt>, true },
+		{ "hash13", "VolumeComputeShader, frame = slice", &EvaluateHash13, &GenerateHash13Row, false },
+		{ "reference", "splitmix64 of the packed coordinates, control", &EvaluateReference, &GenerateReferenceRow, false },
+	};
+	return Generators;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//A noise kernel under test. Frame is the TimeStamp of the 2D kernels and the slice of the 3D ones. GenerateRow must give the same values as
+//Evaluate, it is what the streaming tests run on, Evaluate is used for the tiles of the spectral tests
+struct FNoiseGenerator
+{
+	const char* Name;
+	const char* Description;
+	float (*Evaluate)(uint32_t X, uint32_t Y, uint32_t Seed, uint32_t Frame);
+	void (*GenerateRow)(uint32_t Y, int32_t Width, uint32_t Seed, uint32_t Frame, float* OutRow);
+	//The 2D kernels sample the lattice at Frame * (X, Y) + a seed offset, so a frame revisits points of the frames before it
+	bool bScaledLattice;
+};
+
+//Every kernel the tool knows. A replacement hash is tested by adding it here next to the one it would replace
+const std::vector<FNoiseGenerator>& GetNoiseGenerators();
@@ -0,0 +1,344 @@
+//NoiseQuality: streams samples from the CPU copies of the noise kernels through a battery of statistical tests on every core and prints
+//a single report. Meant to be run before a hash is swapped for a faster one, the reference generator shows what a good hash scores.
+//Exits with 1 if a test fails (p < 1e-6)
+//
+//NoiseQuality [--generator Name|all] [--width N] [--height N] [--frames N] [--first-frame N] [--seed N] [--tiles N] [--tile-size N]
+//             [--threads N] [--report File] [--help]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Generators.h"
+#include "QualityTests.h"
+
+namespace
+{
+	struct FOptions
+	{
+		std::string Generator = "all";
+		int32_t Width = 4096;
+		int32_t Height = 4096;
+		//4096x4096x64 is a billion samples per generator
+		uint32_t NumFrames = 64;
+		//Frame 0 is a constant image for the 2D kernels, everything is multiplied by the TimeStamp
+		uint32_t FirstFrame = 1;
+		uint32_t Seed = 0;
+		int32_t NumTiles = 512;
+		int32_t TileSize = 256;
+		int32_t NumThreads = (int32_t)std::max(1u, std::thread::hardware_concurrency());
+		std::string ReportPath;
+		bool bHelp = false;
+	};
+
+	const char* const Usage =
+		"Usage: NoiseQuality [--generator Name|all] [--width N] [--height N] [--frames N] [--first-frame N] [--seed N] [--tiles N]\n"
+		"                    [--tile-size N] [--threads N] [--report File] [--help]\n"
+		"Streams every frame of each generator through the statistical tests, 4096x4096x64 from frame 1 by default, and averages the\n"
+		"power spectrum of --tiles distinct tiles of --tile-size texels. Exits with 1 when a test fails (p < 1e-6), 2 on bad arguments\n";
+
+	//p-values below these are reported as failures and weaknesses
+	const double FailPValue = 1e-6;
+	const double WeakPValue = 1e-3;
+
+	//Rows of a frame handled by one task. The vertical correlation skips the first row of each task
+	const int32_t RowsPerTask = 64;
+
+	//(cell, frame) pairs the spectrum can draw its tiles from
+	int64_t GetNumDistinctTiles(const FOptions& Options)
+	{
+		return (int64_t)(Options.Width / Options.TileSize) * (Options.Height / Options.TileSize) * Options.NumFrames;
+	}
+
+	bool ParseOptions(int ArgCount, char** Args, FOptions& OutOptions)
+	{
+		for (int Index = 1; Index < ArgCount; ++Index)
+		{
+			const std::string Name = Args[Index];
+			if (Name == "--help" || Name == "-h")
+			{
+				OutOptions.bHelp = true;
+				return true;
+			}
+			if (Index + 1 >= ArgCount)
+			{
+				std::fprintf(stderr, "Missing value for %s\n%s", Name.c_str(), Usage);
+				return false;
+			}
+			const std::string Value = Args[++Index];
+			if (Name == "--generator") OutOptions.Generator = Value;
+			else if (Name == "--width") OutOptions.Width = std::atoi(Value.c_str());
+			else if (Name == "--height") OutOptions.Height = std::atoi(Value.c_str());
+			else if (Name == "--frames") OutOptions.NumFrames = (uint32_t)std::strtoul(Value.c_str(), nullptr, 10);
+			else if (Name == "--first-frame") OutOptions.FirstFrame = (uint32_t)std::strtoul(Value.c_str(), nullptr, 10);
+			else if (Name == "--seed") OutOptions.Seed = (uint32_t)std::strtoul(Value.c_str(), nullptr, 10);
+			else if (Name == "--tiles") OutOptions.NumTiles = std::atoi(Value.c_str());
+			else if (Name == "--tile-size") OutOptions.TileSize = std::atoi(Value.c_str());
+			else if (Name == "--threads") OutOptions.NumThreads = std::max(1, std::atoi(Value.c_str()));
+			else if (Name == "--report") OutOptions.ReportPath = Value;
+			else
+			{
+				std::fprintf(stderr, "Unknown option %s\n%s", Name.c_str(), Usage);
+				return false;
+			}
+		}
+		const bool bPowerOfTwoTile = OutOptions.TileSize >= 8 && (OutOptions.TileSize & (OutOptions.TileSize - 1)) == 0;
+		if (OutOptions.Width < 2 || OutOptions.Height < 2 || OutOptions.NumFrames == 0 || OutOptions.NumTiles < 0 || !bPowerOfTwoTile
+			|| OutOptions.TileSize > OutOptions.Width || OutOptions.TileSize > OutOptions.Height)
+		{
+			std::fprintf(stderr, "Invalid size, frame count or tile size (a power of two no larger than the frame)\n");
+			return false;
+		}
+		//The spectrum averages distinct tiles, a repeated one would only count its own noise twice
+		const int64_t NumDistinctTiles = GetNumDistinctTiles(OutOptions);
+		if (OutOptions.NumTiles > NumDistinctTiles)
+		{
+			std::fprintf(stderr, "Only %lld distinct tiles of %dx%d in %u frames, --tiles clamped\n", (long long)NumDistinctTiles,
+						 OutOptions.TileSize, OutOptions.TileSize, OutOptions.NumFrames);
+			OutOptions.NumTiles = (int32_t)NumDistinctTiles;
+		}
+		return true;
+	}
+
+	//Runs Task(ThreadIndex, TaskIndex) for every task on NumThreads threads, tasks are handed out in order
+	template <typename TaskFunc>
+	void ParallelTasks(int32_t NumThreads, int64_t NumTasks, TaskFunc Task)
+	{
+		std::atomic<int64_t> NextTask(0);
+		std::vector<std::thread> Threads;
+		for (int32_t ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+		{
+			Threads.emplace_back([&NextTask, &Task, NumTasks, ThreadIndex]()
+			{
+				for (int64_t TaskIndex = NextTask++; TaskIndex < NumTasks; TaskIndex = NextTask++)
+				{
+					Task(ThreadIndex, TaskIndex);
+				}
+			});
+		}
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+	}
+
+	//Flags the texels of row Y of Frame whose lattice point was already sampled by an earlier streamed frame, for the generators with a
+	//scaled lattice. Frame * (X, Y) is EarlierFrame * (X', Y') when X and Y are multiples of EarlierFrame / gcd(Frame, EarlierFrame), and
+	//(X', Y') is in the frame when Frame * (X, Y) < EarlierFrame * (Width, Height). The seed offset is the same in every frame, it
+	//doesn't change which points repeat. Returns whether any texel of the row repeats
+	bool MarkLatticeRepeats(const FOptions& Options, uint32_t Frame, uint32_t Y, std::vector<uint8_t>& OutRepeats)
+	{
+		std::fill(OutRepeats.begin(), OutRepeats.end(), (uint8_t)0);
+		bool bAnyRepeat = false;
+		if (Frame == 0)
+		{
+			//Frame 0 is the seed offset everywhere, its first texel is the only distinct one
+			std::fill(OutRepeats.begin() + (Y == 0 ? 1 : 0), OutRepeats.end(), (uint8_t)1);
+			return Y > 0 || OutRepeats.size() > 1;
+		}
+		for (uint32_t EarlierFrame = Options.FirstFrame; EarlierFrame < Frame; ++EarlierFrame)
+		{
+			if (EarlierFrame == 0)
+			{
+				OutRepeats[0] |= Y == 0 ? 1 : 0;
+				bAnyRepeat |= Y == 0;
+				continue;
+			}
+			const uint32_t Step = EarlierFrame / std::gcd(Frame, EarlierFrame);
+			if (Y % Step != 0 || (uint64_t)Frame * Y >= (uint64_t)EarlierFrame * Options.Height)
+			{
+				continue;
+			}
+			for (uint32_t X = 0; (uint64_t)Frame * X < (uint64_t)EarlierFrame * Options.Width; X += Step)
+			{
+				OutRepeats[X] = 1;
+				bAnyRepeat = true;
+			}
+		}
+		return bAnyRepeat;
+	}
+
+	//Every frame row by row, the first row of each task is also generated in the next frame for the temporal correlation.
+	//Lattice points an earlier frame already sampled are left out of the distribution tests, see MarkLatticeRepeats
+	FStreamStatistics RunStream(const FOptions& Options, const FNoiseGenerator& Generator)
+	{
+		std::vector<FStreamStatistics> PerThread(Options.NumThreads);
+		const int64_t TasksPerFrame = (Options.Height + RowsPerTask - 1) / RowsPerTask;
+		ParallelTasks(Options.NumThreads, TasksPerFrame * Options.NumFrames, [&](int32_t ThreadIndex, int64_t TaskIndex)
+		{
+			const uint32_t Frame = Options.FirstFrame + (uint32_t)(TaskIndex / TasksPerFrame);
+			const int32_t FirstRow = (int32_t)(TaskIndex % TasksPerFrame) * RowsPerTask;
+			const int32_t EndRow = std::min(FirstRow + RowsPerTask, Options.Height);
+
+			std::vector<float> Rows[2] = { std::vector<float>(Options.Width), std::vector<float>(Options.Width) };
+			std::vector<uint8_t> Repeats(Options.Width);
+			FStreamStatistics& Statistics = PerThread[ThreadIndex];
+			for (int32_t Y = FirstRow; Y < EndRow; ++Y)
+			{
+				std::vector<float>& Row = Rows[Y & 1];
+				Generator.GenerateRow(Y, Options.Width, Options.Seed, Frame, Row.data());
+				const bool bRepeats = Generator.bScaledLattice && MarkLatticeRepeats(Options, Frame, (uint32_t)Y, Repeats);
+				Statistics.AddRow(Row.data(), Y > FirstRow ? Rows[(Y - 1) & 1].data() : nullptr, Options.Width, bRepeats ? Repeats.data() : nullptr);
+				if (Y == FirstRow)
+				{
+					std::vector<float> NextFrame(Options.Width);
+					Generator.GenerateRow(Y, Options.Width, Options.Seed, Frame + 1, NextFrame.data());
+					Statistics.AddTemporalPair(Row.data(), NextFrame.data(), Options.Width);
+				}
+			}
+		});
+
+		for (int32_t ThreadIndex = 1; ThreadIndex < Options.NumThreads; ++ThreadIndex)
+		{
+			PerThread[0].Merge(PerThread[ThreadIndex]);
+		}
+		return PerThread[0];
+	}
+
+	//Distinct tiles spread over the frames and over the frame area, far from the origin too where the lattice coordinates are large.
+	//NumTiles is at most GetNumDistinctTiles, see ParseOptions
+	FSpectrumStatistics RunSpectrum(const FOptions& Options, const FNoiseGenerator& Generator)
+	{
+		std::vector<FSpectrumStatistics> PerThread(Options.NumThreads, FSpectrumStatistics(Options.TileSize));
+		const int64_t TilesX = Options.Width / Options.TileSize;
+		const int64_t NumPairs = GetNumDistinctTiles(Options);
+		//A stride coprime with the pair count visits every pair once before repeating
+		int64_t Stride = 7919;
+		while (std::gcd(Stride, NumPairs) != 1)
+		{
+			++Stride;
+		}
+		ParallelTasks(Options.NumThreads, Options.NumTiles, [&](int32_t ThreadIndex, int64_t TaskIndex)
+		{
+			const int64_t Pair = (TaskIndex * Stride) % NumPairs;
+			const uint32_t Frame = Options.FirstFrame + (uint32_t)(Pair % Options.NumFrames);
+			const int64_t Cell = Pair / Options.NumFrames;
+			const uint32_t OriginX = (uint32_t)((Cell % TilesX) * Options.TileSize);
+			const uint32_t OriginY = (uint32_t)((Cell / TilesX) * Options.TileSize);
+
+			std::vector<float> Tile((size_t)Options.TileSize * Options.TileSize);
+			for (int32_t Y = 0; Y < Options.TileSize; ++Y)
+			{
+				for (int32_t X = 0; X < Options.TileSize; ++X)
+				{
+					Tile[(size_t)Y * Options.TileSize + X] = Generator.Evaluate(OriginX + X, OriginY + Y, Options.Seed, Frame);
+				}
+			}
+			PerThread[ThreadIndex].AddTile(Tile.data());
+		});
+
+		for (int32_t ThreadIndex = 1; ThreadIndex < Options.NumThreads; ++ThreadIndex)
+		{
+			PerThread[0].Merge(PerThread[ThreadIndex]);
+		}
+		return PerThread[0];
+	}
+
+	const char* GetVerdict(double PValue)
+	{
+		return PValue < FailPValue ? "FAIL" : PValue < WeakPValue ? "WEAK" : "pass";
+	}
+
+	void Print(std::string& Report, const char* Text, ...)
+	{
+		char Buffer[512];
+		va_list Arguments;
+		va_start(Arguments, Text);
+		std::vsnprintf(Buffer, sizeof(Buffer), Text, Arguments);
+		va_end(Arguments);
+		std::fputs(Buffer, stdout);
+		std::fflush(stdout);
+		Report += Buffer;
+	}
+}
+
+int main(int ArgCount, char** Args)
+{
+	FOptions Options;
+	if (!ParseOptions(ArgCount, Args, Options))
+	{
+		return 2;
+	}
+	if (Options.bHelp)
+	{
+		std::fputs(Usage, stdout);
+		return 0;
+	}
+
+	std::vector<const FNoiseGenerator*> Generators;
+	for (const FNoiseGenerator& Generator : GetNoiseGenerators())
+	{
+		if (Options.Generator == "all" || Options.Generator == Generator.Name)
+		{
+			Generators.push_back(&Generator);
+		}
+	}
+	if (Generators.empty())
+	{
+		std::fprintf(stderr, "Unknown generator %s, available:", Options.Generator.c_str());
+		for (const FNoiseGenerator& Generator : GetNoiseGenerators())
+		{
+			std::fprintf(stderr, " %s", Generator.Name);
+		}
+		std::fprintf(stderr, "\n");
+		return 2;
+	}
+
+	std::string Report;
+	Print(Report, "NoiseQuality: %dx%d, %u frames from %u, seed %u, %d tiles of %dx%d, %d threads\n", Options.Width, Options.Height,
+		  Options.NumFrames, Options.FirstFrame, Options.Seed, Options.NumTiles, Options.TileSize, Options.TileSize, Options.NumThreads);
+
+	int NumFailures = 0;
+	for (const FNoiseGenerator* Generator : Generators)
+	{
+		const auto Start = std::chrono::steady_clock::now();
+		std::vector<FTestResult> Results;
+		const FStreamStatistics Stream = RunStream(Options, *Generator);
+		Stream.GetResults(Results);
+		if (Options.NumTiles > 0)
+		{
+			RunSpectrum(Options, *Generator).GetResults(Results);
+		}
+		const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+		Print(Report, "\n%s (%s): %llu samples in %.1f s\n", Generator->Name, Generator->Description, (unsigned long long)Stream.GetNumSamples(), Seconds);
+		if (Stream.GetNumRepeats() > 0)
+		{
+			Print(Report, "  %llu samples (%.2f%%) revisit lattice points of earlier frames, left out of uniformity and serial pairs\n",
+				  (unsigned long long)Stream.GetNumRepeats(), 100.0 * Stream.GetNumRepeats() / Stream.GetNumSamples());
+		}
+		int NumPassed = 0;
+		double WorstPValue = 1.0;
+		for (const FTestResult& Result : Results)
+		{
+			Print(Report, "  %-20s %-36s p %-10.3g %s\n", Result.Name.c_str(), Result.Statistic.c_str(), Result.PValue, GetVerdict(Result.PValue));
+			NumFailures += Result.PValue < FailPValue ? 1 : 0;
+			NumPassed += Result.PValue >= WeakPValue ? 1 : 0;
+			WorstPValue = std::min(WorstPValue, Result.PValue);
+		}
+		//The score to pick a hash by: tests passed without weakness, then the worst p-value
+		Print(Report, "  score                %d/%d, worst p %.3g\n", NumPassed, (int)Results.size(), WorstPValue);
+	}
+	Print(Report, "\n%d failed tests\n", NumFailures);
+
+	if (!Options.ReportPath.empty())
+	{
+		FILE* File = std::fopen(Options.ReportPath.c_str(), "w");
+		if (!File || std::fputs(Report.c_str(), File) < 0)
+		{
+			std::fprintf(stderr, "Can't write %s\n", Options.ReportPath.c_str());
+		}
+		if (File)
+		{
+			std::fclose(File);
+		}
+	}
+	return NumFailures > 0 ? 1 : 0;
+}
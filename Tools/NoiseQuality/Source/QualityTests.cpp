@@ -0,0 +1,378 @@
+#include "QualityTests.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	const double Pi = 3.14159265358979323846;
+
+	//Two sided p-value of a standard normal deviate
+	double NormalPValue(double Z)
+	{
+		return std::erfc(std::fabs(Z) / std::sqrt(2.0));
+	}
+
+	//Upper tail of the chi-square distribution, Wilson-Hilferty approximation. Accurate to a few percent for hundreds of degrees of freedom
+	double ChiSquarePValue(double ChiSquare, double DegreesOfFreedom)
+	{
+		const double Variance = 2.0 / (9.0 * DegreesOfFreedom);
+		const double Z = (std::cbrt(ChiSquare / DegreesOfFreedom) - (1.0 - Variance)) / std::sqrt(Variance);
+		return 0.5 * std::erfc(Z / std::sqrt(2.0));
+	}
+
+	double ChiSquare(const std::vector<uint64_t>& Counts)
+	{
+		uint64_t Total = 0;
+		for (const uint64_t Count : Counts)
+		{
+			Total += Count;
+		}
+		const double Expected = (double)Total / Counts.size();
+		double Sum = 0.0;
+		for (const uint64_t Count : Counts)
+		{
+			const double Difference = (double)Count - Expected;
+			Sum += Difference * Difference / Expected;
+		}
+		return Sum;
+	}
+
+	std::string Format(const char* Text, double A, double B = 0.0, double C = 0.0)
+	{
+		char Buffer[128];
+		std::snprintf(Buffer, sizeof(Buffer), Text, A, B, C);
+		return Buffer;
+	}
+
+	int BinOf(float Value, int NumBins, uint64_t& NumOutOfRange)
+	{
+		const int Bin = (int)(Value * NumBins);
+		if (Bin < 0 || Bin >= NumBins || !(Value == Value))
+		{
+			++NumOutOfRange;
+			return Value > 0.5f ? NumBins - 1 : 0;
+		}
+		return Bin;
+	}
+
+	//In place radix-2 FFT of Count values Stride apart
+	void TransformLine(std::complex<double>* Data, int32_t Count, int32_t Stride, bool bInverse)
+	{
+		for (int32_t Index = 1, Reversed = 0; Index < Count; ++Index)
+		{
+			int32_t Bit = Count >> 1;
+			for (; Reversed & Bit; Bit >>= 1)
+			{
+				Reversed ^= Bit;
+			}
+			Reversed ^= Bit;
+			if (Index < Reversed)
+			{
+				std::swap(Data[Index * Stride], Data[Reversed * Stride]);
+			}
+		}
+		for (int32_t Length = 2; Length <= Count; Length <<= 1)
+		{
+			const double Angle = (bInverse ? 2.0 : -2.0) * Pi / Length;
+			const std::complex<double> Step(std::cos(Angle), std::sin(Angle));
+			for (int32_t Start = 0; Start < Count; Start += Length)
+			{
+				std::complex<double> Twiddle(1.0, 0.0);
+				for (int32_t Offset = 0; Offset < Length / 2; ++Offset)
+				{
+					std::complex<double>& Even = Data[(Start + Offset) * Stride];
+					std::complex<double>& Odd = Data[(Start + Offset + Length / 2) * Stride];
+					const std::complex<double> Product = Odd * Twiddle;
+					Odd = Even - Product;
+					Even += Product;
+					Twiddle *= Step;
+				}
+			}
+		}
+	}
+}
+
+void TransformSquare(std::vector<std::complex<double>>& Data, int32_t Size, bool bInverse)
+{
+	for (int32_t Row = 0; Row < Size; ++Row)
+	{
+		TransformLine(Data.data() + Row * Size, Size, 1, bInverse);
+	}
+	for (int32_t Column = 0; Column < Size; ++Column)
+	{
+		TransformLine(Data.data() + Column, Size, Size, bInverse);
+	}
+}
+
+FStreamStatistics::FStreamStatistics()
+	: Histogram(NumBins, 0)
+	, PairHistogram(NumPairCells * NumPairCells, 0)
+{
+}
+
+void FStreamStatistics::AddPairs(FCorrelation& Correlation, const float* X, const float* Y, int32_t Width)
+{
+	//Row sums in local variables first, the compiler keeps them in registers
+	double SumX = 0.0, SumY = 0.0, SumXX = 0.0, SumYY = 0.0, SumXY = 0.0;
+	for (int32_t Index = 0; Index < Width; ++Index)
+	{
+		const double CenteredX = X[Index] - 0.5;
+		const double CenteredY = Y[Index] - 0.5;
+		SumX += CenteredX;
+		SumY += CenteredY;
+		SumXX += CenteredX * CenteredX;
+		SumYY += CenteredY * CenteredY;
+		SumXY += CenteredX * CenteredY;
+	}
+	Correlation.Count += Width;
+	Correlation.SumX += SumX;
+	Correlation.SumY += SumY;
+	Correlation.SumXX += SumXX;
+	Correlation.SumYY += SumYY;
+	Correlation.SumXY += SumXY;
+}
+
+void FStreamStatistics::AddRow(const float* Row, const float* Above, int32_t Width, const uint8_t* Repeats)
+{
+	//Out of range samples are counted once, by the histogram
+	uint64_t Ignored = 0;
+	if (Repeats)
+	{
+		for (int32_t X = 0; X < Width; ++X)
+		{
+			if (Repeats[X])
+			{
+				++NumRepeats;
+				continue;
+			}
+			++Histogram[BinOf(Row[X], NumBins, NumOutOfRange)];
+		}
+		for (int32_t X = 0; X + 1 < Width; X += 2)
+		{
+			if (!Repeats[X] && !Repeats[X + 1])
+			{
+				++PairHistogram[BinOf(Row[X], NumPairCells, Ignored) * NumPairCells + BinOf(Row[X + 1], NumPairCells, Ignored)];
+			}
+		}
+	}
+	else
+	{
+		for (int32_t X = 0; X < Width; ++X)
+		{
+			++Histogram[BinOf(Row[X], NumBins, NumOutOfRange)];
+		}
+		for (int32_t X = 0; X + 1 < Width; X += 2)
+		{
+			++PairHistogram[BinOf(Row[X], NumPairCells, Ignored) * NumPairCells + BinOf(Row[X + 1], NumPairCells, Ignored)];
+		}
+	}
+	AddPairs(Horizontal, Row, Row + 1, Width - 1);
+	if (Above)
+	{
+		AddPairs(Vertical, Above, Row, Width);
+	}
+	NumSamples += Width;
+}
+
+void FStreamStatistics::AddTemporalPair(const float* Row, const float* NextFrameRow, int32_t Width)
+{
+	AddPairs(Temporal, Row, NextFrameRow, Width);
+}
+
+void FStreamStatistics::FCorrelation::Merge(const FCorrelation& Other)
+{
+	Count += Other.Count;
+	SumX += Other.SumX;
+	SumY += Other.SumY;
+	SumXX += Other.SumXX;
+	SumYY += Other.SumYY;
+	SumXY += Other.SumXY;
+}
+
+double FStreamStatistics::FCorrelation::Get() const
+{
+	const double Covariance = Count * SumXY - SumX * SumY;
+	const double VarianceProduct = (Count * SumXX - SumX * SumX) * (Count * SumYY - SumY * SumY);
+	return VarianceProduct > 0.0 ? Covariance / std::sqrt(VarianceProduct) : 0.0;
+}
+
+void FStreamStatistics::Merge(const FStreamStatistics& Other)
+{
+	for (int Bin = 0; Bin < NumBins; ++Bin)
+	{
+		Histogram[Bin] += Other.Histogram[Bin];
+	}
+	for (size_t Cell = 0; Cell < PairHistogram.size(); ++Cell)
+	{
+		PairHistogram[Cell] += Other.PairHistogram[Cell];
+	}
+	Horizontal.Merge(Other.Horizontal);
+	Vertical.Merge(Other.Vertical);
+	Temporal.Merge(Other.Temporal);
+	NumSamples += Other.NumSamples;
+	NumRepeats += Other.NumRepeats;
+	NumOutOfRange += Other.NumOutOfRange;
+}
+
+void FStreamStatistics::GetResults(std::vector<FTestResult>& OutResults) const
+{
+	const double Uniformity = ChiSquare(Histogram);
+	OutResults.push_back({ "uniformity", Format("chi2 %.1f, %.0f dof", Uniformity, NumBins - 1), ChiSquarePValue(Uniformity, NumBins - 1) });
+
+	const double Pairs = ChiSquare(PairHistogram);
+	const double PairDegrees = NumPairCells * NumPairCells - 1;
+	OutResults.push_back({ "serial pairs", Format("chi2 %.1f, %.0f dof", Pairs, PairDegrees), ChiSquarePValue(Pairs, PairDegrees) });
+
+	const struct { const char* Name; const FCorrelation& Correlation; } Correlations[] = {
+		{ "correlation x", Horizontal },
+		{ "correlation y", Vertical },
+		{ "correlation time", Temporal },
+	};
+	for (const auto& Entry : Correlations)
+	{
+		const double R = Entry.Correlation.Get();
+		const double Z = R * std::sqrt(Entry.Correlation.Count);
+		OutResults.push_back({ Entry.Name, Format("r %+.2e, z %+.2f", R, Z), Entry.Correlation.Count > 0.0 ? NormalPValue(Z) : 1.0 });
+	}
+
+	if (NumOutOfRange > 0)
+	{
+		OutResults.push_back({ "range", Format("%.0f samples outside [0, 1)", (double)NumOutOfRange), 0.0 });
+	}
+}
+
+FSpectrumStatistics::FSpectrumStatistics(int32_t InTileSize)
+	: TileSize(InTileSize)
+	, PowerSum((size_t)InTileSize * InTileSize, 0.0)
+	, Scratch((size_t)InTileSize * InTileSize)
+{
+}
+
+void FSpectrumStatistics::AddTile(const float* Tile)
+{
+	const size_t NumTexels = Scratch.size();
+	double Mean = 0.0;
+	for (size_t Index = 0; Index < NumTexels; ++Index)
+	{
+		Mean += Tile[Index];
+	}
+	Mean /= NumTexels;
+	for (size_t Index = 0; Index < NumTexels; ++Index)
+	{
+		Scratch[Index] = std::complex<double>(Tile[Index] - Mean, 0.0);
+	}
+
+	TransformSquare(Scratch, TileSize, false);
+	for (size_t Index = 0; Index < NumTexels; ++Index)
+	{
+		PowerSum[Index] += std::norm(Scratch[Index]) / NumTexels;
+	}
+	++NumTiles;
+}
+
+void FSpectrumStatistics::Merge(const FSpectrumStatistics& Other)
+{
+	for (size_t Index = 0; Index < PowerSum.size(); ++Index)
+	{
+		PowerSum[Index] += Other.PowerSum[Index];
+	}
+	NumTiles += Other.NumTiles;
+}
+
+void FSpectrumStatistics::GetResults(std::vector<FTestResult>& OutResults) const
+{
+	if (NumTiles == 0)
+	{
+		return;
+	}
+
+	//Mean power of the non DC bins, the variance of the samples
+	const size_t NumTexels = PowerSum.size();
+	double MeanPower = 0.0;
+	double MeanLogPower = 0.0;
+	for (size_t Index = 1; Index < NumTexels; ++Index)
+	{
+		const double Power = PowerSum[Index] / NumTiles;
+		MeanPower += Power;
+		MeanLogPower += std::log(std::max(Power, 1e-300));
+	}
+	MeanPower /= NumTexels - 1;
+	MeanLogPower /= NumTexels - 1;
+
+	//Geometric over arithmetic mean. Averaging T exponentially distributed periodogram bins leaves it about 1 - 1 / (2T) for white noise
+	const double Flatness = std::exp(MeanLogPower) / MeanPower;
+	const double ExpectedFlatness = 1.0 - 1.0 / (2.0 * NumTiles);
+	//Half of the bins are independent, the log of each averaged bin has a variance of about 1 / T
+	const double FlatnessZ = (Flatness - ExpectedFlatness) * std::sqrt(NumTiles * (NumTexels - 1) / 2.0);
+	OutResults.push_back({ "spectral flatness", Format("%.5f, expected %.5f", Flatness, ExpectedFlatness), NormalPValue(FlatnessZ) });
+
+	//Radial bands up to the Nyquist radius, each has the relative standard deviation of its independent bins averaged over the tiles
+	std::vector<double> BandPower(NumRadialBands, 0.0);
+	std::vector<double> BandBins(NumRadialBands, 0.0);
+	const int32_t Half = TileSize / 2;
+	for (int32_t Y = 0; Y < TileSize; ++Y)
+	{
+		for (int32_t X = 0; X < TileSize; ++X)
+		{
+			const int32_t FrequencyX = X <= Half ? X : X - TileSize;
+			const int32_t FrequencyY = Y <= Half ? Y : Y - TileSize;
+			const double Radius = std::sqrt((double)FrequencyX * FrequencyX + (double)FrequencyY * FrequencyY) / Half;
+			if ((X == 0 && Y == 0) || Radius >= 1.0)
+			{
+				continue;
+			}
+			const int Band = (int)(Radius * NumRadialBands);
+			BandPower[Band] += PowerSum[(size_t)Y * TileSize + X] / NumTiles;
+			BandBins[Band] += 1.0;
+		}
+	}
+	double MaxBandZ = 0.0;
+	int WorstBand = 0;
+	for (int Band = 0; Band < NumRadialBands; ++Band)
+	{
+		if (BandBins[Band] == 0.0)
+		{
+			continue;
+		}
+		const double Z = (BandPower[Band] / BandBins[Band] / MeanPower - 1.0) * std::sqrt(NumTiles * BandBins[Band] / 2.0);
+		if (std::fabs(Z) > std::fabs(MaxBandZ))
+		{
+			MaxBandZ = Z;
+			WorstBand = Band;
+		}
+	}
+	OutResults.push_back({ "spectral bands", Format("worst band %.0f of 32, z %+.2f", WorstBand, MaxBandZ),
+						   std::min(1.0, NumRadialBands * NormalPValue(MaxBandZ)) });
+
+	//Autocorrelation = inverse transform of the power spectrum
+	std::vector<std::complex<double>> Autocorrelation(NumTexels);
+	for (size_t Index = 0; Index < NumTexels; ++Index)
+	{
+		Autocorrelation[Index] = std::complex<double>(Index == 0 ? 0.0 : PowerSum[Index] / NumTiles, 0.0);
+	}
+	TransformSquare(Autocorrelation, TileSize, true);
+	const double Variance = Autocorrelation[0].real();
+	const double LagSigma = 1.0 / std::sqrt((double)NumTiles * NumTexels);
+	double MaxLagZ = 0.0;
+	int32_t WorstX = 0, WorstY = 0;
+	for (int32_t LagY = 0; LagY <= MaxLag; ++LagY)
+	{
+		//Half plane, the other half mirrors it
+		for (int32_t LagX = LagY == 0 ? 1 : -MaxLag; LagX <= MaxLag; ++LagX)
+		{
+			const size_t Index = (size_t)LagY * TileSize + (LagX + TileSize) % TileSize;
+			const double Z = Autocorrelation[Index].real() / Variance / LagSigma;
+			if (std::fabs(Z) > std::fabs(MaxLagZ))
+			{
+				MaxLagZ = Z;
+				WorstX = LagX;
+				WorstY = LagY;
+			}
+		}
+	}
+	const int NumLags = ((2 * MaxLag + 1) * (2 * MaxLag + 1) - 1) / 2;
+	OutResults.push_back({ "autocorrelation 2D", Format("worst lag (%.0f, %.0f), z %+.2f", WorstX, WorstY, MaxLagZ),
+						   std::min(1.0, NumLags * NormalPValue(MaxLagZ)) });
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Outcome of one test
+struct FTestResult
+{
+	std::string Name;
+	//What was measured, e.g. "chi2 1012.3, 1023 dof"
+	std::string Statistic;
+	//Probability of a deviation at least this large from ideal white noise. The tests looking at many values at once report the
+	//Bonferroni corrected p-value of the largest one
+	double PValue = 1.0;
+};
+
+/// <summary>
+/// Tests run on the sample stream, row by row: uniformity (chi-square over 1024 bins), serial pairs (chi-square of non overlapping
+/// horizontal pairs over 32x32 cells) and the lag 1 correlations along x, y and time. Every thread fills its own and they are merged
+/// </summary>
+class FStreamStatistics
+{
+public:
+	FStreamStatistics();
+
+	//Accumulates a row. Above is the row above it, nullptr for the first row a thread handles. Samples flagged in Repeats are the same
+	//lattice points as samples already streamed: they are left out of the uniformity and serial pairs, that would count them twice
+	void AddRow(const float* Row, const float* Above, int32_t Width, const uint8_t* Repeats = nullptr);
+
+	//The same texels in two consecutive frames
+	void AddTemporalPair(const float* Row, const float* NextFrameRow, int32_t Width);
+
+	void Merge(const FStreamStatistics& Other);
+	void GetResults(std::vector<FTestResult>& OutResults) const;
+
+	uint64_t GetNumSamples() const { return NumSamples; }
+	uint64_t GetNumRepeats() const { return NumRepeats; }
+
+private:
+	static constexpr int NumBins = 1024;
+	static constexpr int NumPairCells = 32;
+
+	//Pearson correlation of centered samples
+	struct FCorrelation
+	{
+		double Count = 0.0;
+		double SumX = 0.0;
+		double SumY = 0.0;
+		double SumXX = 0.0;
+		double SumYY = 0.0;
+		double SumXY = 0.0;
+
+		void Merge(const FCorrelation& Other);
+		double Get() const;
+	};
+
+	static void AddPairs(FCorrelation& Correlation, const float* X, const float* Y, int32_t Width);
+
+	std::vector<uint64_t> Histogram;
+	std::vector<uint64_t> PairHistogram;
+	FCorrelation Horizontal;
+	FCorrelation Vertical;
+	FCorrelation Temporal;
+	uint64_t NumSamples = 0;
+	//Samples flagged as repeats, see AddRow
+	uint64_t NumRepeats = 0;
+	//Samples outside [0, 1), counted in the closest bin
+	uint64_t NumOutOfRange = 0;
+};
+
+/// <summary>
+/// Tests on the power spectrum averaged over square tiles: spectral flatness and radial bands (white noise has the same power at every
+/// frequency) and the 2D autocorrelation at small lags, obtained from the averaged spectrum by Wiener-Khinchin
+/// </summary>
+class FSpectrumStatistics
+{
+public:
+	//TileSize must be a power of two
+	explicit FSpectrumStatistics(int32_t InTileSize);
+
+	//Adds the power spectrum of a TileSize x TileSize tile, rows packed
+	void AddTile(const float* Tile);
+
+	void Merge(const FSpectrumStatistics& Other);
+	void GetResults(std::vector<FTestResult>& OutResults) const;
+
+private:
+	static constexpr int NumRadialBands = 32;
+	static constexpr int MaxLag = 8;
+
+	int32_t TileSize;
+	//Sum over the tiles of |DFT|^2 / NumTexels of the tile minus its mean
+	std::vector<double> PowerSum;
+	uint64_t NumTiles = 0;
+	std::vector<std::complex<double>> Scratch;
+};
+
+//Radix-2 FFT of Size x Size complex values in place, rows packed. Inverse is not normalized
+void TransformSquare(std::vector<std::complex<double>>& Data, int32_t Size, bool bInverse);
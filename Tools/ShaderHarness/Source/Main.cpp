@@ -0,0 +1,249 @@
+//ShaderHarness: compiles MainComputeShader of WhiteNoiseCS.usf to SPIR-V with dxc, runs every COARSENING permutation on a Vulkan device
+//(a software ICD such as lavapipe by default) and compares the output with the CPU reference. Exits with 1 if any permutation fails.
+//--hash all runs every HASH_FUNCTION family too and reports their ALU instruction counts and dispatch times
+//
+//ShaderHarness [--project Dir] [--dxc Path] [--work-dir Dir] [--device NameFilter] [--width N] [--height N] [--timestamp N] [--seed N]
+//              [--coarsening 0|1|2|all] [--hash Name|all] [--iterations N] [--tolerance E] [--max-mismatch-fraction F]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "DispatchSizing.h"
+#include "NoiseMath.h"
+#include "ParameterPacking.h"
+#include "ShaderCompiler.h"
+#include "SpirvReflection.h"
+#include "VulkanCompute.h"
+
+namespace
+{
+	struct FOptions
+	{
+		std::string ProjectDir = SHADER_HARNESS_PROJECT_DIR;
+		std::string DxcPath = "dxc";
+		std::string WorkDir = (std::filesystem::temp_directory_path() / "ShaderHarness").string();
+		std::string DeviceFilter;
+		uint32_t Width = 1024;
+		uint32_t Height = 1024;
+		uint32_t TimeStamp = 1;
+		uint32_t Seed = 0;
+		//-1 runs every permutation
+		int Coarsening = -1;
+		//-1 runs every hash family
+		int Hash = (int)ENoiseHash::Hash12;
+		int Iterations = 10;
+		//hash12 is precise (NoContraction in SPIR-V) and should match exactly, a few texels are allowed to land elsewhere after frac on an ICD that fuses anyway
+		float Tolerance = 1e-4f;
+		double MaxMismatchFraction = 0.001;
+	};
+
+	//Hash family from its name (FNoiseMath::GetHashName), -2 if unknown
+	int ParseHash(const std::string& Name)
+	{
+		for (int Hash = 0; Hash < (int)ENoiseHash::Count; ++Hash)
+		{
+			if (Name == FNoiseMath::GetHashName((ENoiseHash)Hash))
+			{
+				return Hash;
+			}
+		}
+		return -2;
+	}
+
+	bool ParseOptions(int ArgCount, char** Args, FOptions& OutOptions)
+	{
+		for (int Index = 1; Index < ArgCount; ++Index)
+		{
+			const std::string Name = Args[Index];
+			if (Index + 1 >= ArgCount)
+			{
+				std::fprintf(stderr, "Missing value for %s\n", Name.c_str());
+				return false;
+			}
+			const std::string Value = Args[++Index];
+			if (Name == "--project") OutOptions.ProjectDir = Value;
+			else if (Name == "--dxc") OutOptions.DxcPath = Value;
+			else if (Name == "--work-dir") OutOptions.WorkDir = Value;
+			else if (Name == "--device") OutOptions.DeviceFilter = Value;
+			else if (Name == "--width") OutOptions.Width = (uint32_t)std::strtoul(Value.c_str(), nullptr, 10);
+			else if (Name == "--height") OutOptions.Height = (uint32_t)std::strtoul(Value.c_str(), nullptr, 10);
+			else if (Name == "--timestamp") OutOptions.TimeStamp = (uint32_t)std::strtoul(Value.c_str(), nullptr, 10);
+			else if (Name == "--seed") OutOptions.Seed = (uint32_t)std::strtoul(Value.c_str(), nullptr, 10);
+			else if (Name == "--coarsening") OutOptions.Coarsening = Value == "all" ? -1 : std::atoi(Value.c_str());
+			else if (Name == "--hash") OutOptions.Hash = Value == "all" ? -1 : ParseHash(Value);
+			else if (Name == "--iterations") OutOptions.Iterations = std::max(1, std::atoi(Value.c_str()));
+			else if (Name == "--tolerance") OutOptions.Tolerance = std::strtof(Value.c_str(), nullptr);
+			else if (Name == "--max-mismatch-fraction") OutOptions.MaxMismatchFraction = std::strtod(Value.c_str(), nullptr);
+			else
+			{
+				std::fprintf(stderr, "Unknown option %s\n", Name.c_str());
+				return false;
+			}
+		}
+		if (OutOptions.Width == 0 || OutOptions.Height == 0 || OutOptions.Coarsening < -1 || OutOptions.Coarsening > 2 || OutOptions.Hash < -1)
+		{
+			std::fprintf(stderr, "Invalid size, coarsening or hash\n");
+			return false;
+		}
+		return true;
+	}
+
+	template <typename T>
+	void WriteGlobal(const FSpirvReflection& Reflection, const char* Name, const T& Value, std::vector<uint8_t>& Globals, size_t PackedOffset)
+	{
+		const auto Offset = Reflection.GlobalOffsets.find(Name);
+		//dxc strips the parameters the entry point doesn't read
+		if (Offset != Reflection.GlobalOffsets.end() && Offset->second + sizeof(T) <= Globals.size())
+		{
+			if (Offset->second != PackedOffset)
+			{
+				std::fprintf(stderr, "Warning: %s is at offset %u, FWhiteNoiseGlobals expects %u\n", Name, Offset->second, (uint32_t)PackedOffset);
+			}
+			std::memcpy(Globals.data() + Offset->second, &Value, sizeof(T));
+		}
+	}
+
+	//Compiles, runs and checks one permutation. Returns true if it matches the reference
+	bool RunPermutation(const FOptions& Options, const FShaderCompiler& Compiler, FVulkanCompute& Vulkan, const std::string& ThreadGroupSize,
+						int Coarsening, ENoiseHash Hash, const std::vector<float>& Reference)
+	{
+		const std::string Permutation = "COARSENING=" + std::to_string(Coarsening) + " " + FNoiseMath::GetHashName(Hash);
+		FShaderCompileRequest Request;
+		Request.ShaderPath = "/CustomShaders/WhiteNoiseCS.usf";
+		Request.EntryPoint = "MainComputeShader";
+		Request.Defines = { { "THREADGROUPSIZE_X", ThreadGroupSize }, { "THREADGROUPSIZE_Y", ThreadGroupSize }, { "THREADGROUPSIZE_Z", "1" },
+							{ "COARSENING", std::to_string(Coarsening) }, { "HASH_FUNCTION", std::to_string((int)Hash) } };
+
+		std::vector<uint32_t> Spirv;
+		std::string Error;
+		FSpirvReflection Reflection;
+		if (!Compiler.Compile(Request, Spirv, Error))
+		{
+			std::fprintf(stderr, "%s: %s\n", Permutation.c_str(), Error.c_str());
+			return false;
+		}
+		if (!Reflection.Parse(Spirv) || !Reflection.Bindings.count("OutputTexture"))
+		{
+			std::fprintf(stderr, "%s: can't find OutputTexture in the SPIR-V\n", Permutation.c_str());
+			return false;
+		}
+
+		//Same group count as FWhiteNoiseCSManager::Execute_RenderThread. The shader doesn't check bounds, so the image covers every group
+		int32_t BlockX, BlockY;
+		FDispatchSizing::GetWhiteNoiseBlockSize(Coarsening, BlockX, BlockY);
+		const FGroupCount GroupCount = FDispatchSizing::GetGroupCount2D(Options.Width, Options.Height, (int32_t)Reflection.LocalSize[0], BlockX, BlockY);
+		FStorageImageDispatch Dispatch;
+		Dispatch.Spirv = std::move(Spirv);
+		Dispatch.EntryPoint = Request.EntryPoint;
+		Dispatch.ImageBinding = Reflection.Bindings.at("OutputTexture");
+		Dispatch.GroupCount[0] = GroupCount.X;
+		Dispatch.GroupCount[1] = GroupCount.Y;
+		Dispatch.ImageWidth = GroupCount.X * Reflection.LocalSize[0] * BlockX;
+		Dispatch.ImageHeight = GroupCount.Y * Reflection.LocalSize[1] * BlockY;
+		Dispatch.NumIterations = Options.Iterations;
+
+		const auto GlobalsBinding = Reflection.Bindings.find("$Globals");
+		if (GlobalsBinding != Reflection.Bindings.end())
+		{
+			Dispatch.GlobalsBinding = GlobalsBinding->second;
+			Dispatch.Globals.assign(Reflection.GlobalsSize, 0);
+			//Written at the reflected offsets, a layout that differs from the packed one is reported
+			const FWhiteNoiseGlobals Globals = FParameterPacking::PackWhiteNoise(Options.Width, Options.Height, Options.TimeStamp, Options.Seed);
+			WriteGlobal(Reflection, "Dimensions", Globals.Dimensions, Dispatch.Globals, offsetof(FWhiteNoiseGlobals, Dimensions));
+			WriteGlobal(Reflection, "TimeStamp", Globals.TimeStamp, Dispatch.Globals, offsetof(FWhiteNoiseGlobals, TimeStamp));
+			WriteGlobal(Reflection, "Seed", Globals.Seed, Dispatch.Globals, offsetof(FWhiteNoiseGlobals, Seed));
+		}
+
+		FDispatchResult Result;
+		if (!Vulkan.Run(Dispatch, Result, Error))
+		{
+			std::fprintf(stderr, "%s: %s\n", Permutation.c_str(), Error.c_str());
+			return false;
+		}
+
+		//Only the requested region is compared, the padding is there to keep the writes in bounds
+		float MaxError = 0.f;
+		uint64_t NumMismatches = 0;
+		for (uint32_t Y = 0; Y < Options.Height; ++Y)
+		{
+			for (uint32_t X = 0; X < Options.Width; ++X)
+			{
+				const float Value = Result.Texels[((size_t)Y * Dispatch.ImageWidth + X) * 4];
+				const float Difference = std::fabs(Value - Reference[(size_t)Y * Options.Width + X]);
+				MaxError = std::max(MaxError, Difference);
+				NumMismatches += Difference > Options.Tolerance ? 1 : 0;
+			}
+		}
+		const double MismatchFraction = (double)NumMismatches / ((double)Options.Width * Options.Height);
+		const bool bPassed = MismatchFraction <= Options.MaxMismatchFraction;
+
+		std::printf("%s (%ux%u groups of %ux%u, %u ALU instructions): max error %g, %.4f%% above %g: %s", Permutation.c_str(), Dispatch.GroupCount[0],
+					Dispatch.GroupCount[1], Reflection.LocalSize[0], Reflection.LocalSize[1], Reflection.NumAluInstructions, MaxError, 100.0 * MismatchFraction,
+					Options.Tolerance, bPassed ? "passed" : "FAILED");
+		if (!Result.DispatchMilliseconds.empty())
+		{
+			std::vector<double> Sorted = Result.DispatchMilliseconds;
+			std::sort(Sorted.begin(), Sorted.end());
+			std::printf(", dispatch min %.3fms median %.3fms over %d iterations, %.1f Mtexels/s", Sorted.front(), Sorted[Sorted.size() / 2], (int)Sorted.size(),
+						(double)Options.Width * Options.Height / (Sorted[Sorted.size() / 2] * 1000.0));
+		}
+		std::printf("\n");
+		return bPassed;
+	}
+}
+
+int main(int ArgCount, char** Args)
+{
+	FOptions Options;
+	if (!ParseOptions(ArgCount, Args, Options))
+	{
+		return 2;
+	}
+
+	//Compile with the thread group size the engine uses, so a change to the C++ side is picked up without touching the harness
+	const std::string DeclarationFile = (std::filesystem::path(Options.ProjectDir) / "Source/CustomShadersDeclarations/Private/ComputeShaderDeclaration.cpp").string();
+	std::string ThreadGroupSize;
+	if (!FShaderCompiler::ReadDefine(DeclarationFile, "NUM_THREADS_PER_GROUP_DIMENSION", ThreadGroupSize))
+	{
+		std::fprintf(stderr, "Can't read NUM_THREADS_PER_GROUP_DIMENSION from %s\n", DeclarationFile.c_str());
+		return 2;
+	}
+
+	FVulkanCompute Vulkan;
+	std::string Error;
+	if (!Vulkan.Initialize(Options.DeviceFilter, Error))
+	{
+		std::fprintf(stderr, "%s\n", Error.c_str());
+		return 2;
+	}
+	std::printf("Device: %s, %ux%u, TimeStamp %u, Seed %u\n", Vulkan.GetDeviceName().c_str(), Options.Width, Options.Height, Options.TimeStamp, Options.Seed);
+
+	const FShaderCompiler Compiler(Options.ProjectDir, Options.DxcPath, Options.WorkDir);
+	std::vector<float> Reference((size_t)Options.Width * Options.Height);
+	bool bAllPassed = true;
+	for (int Hash = 0; Hash < (int)ENoiseHash::Count; ++Hash)
+	{
+		if (Options.Hash != -1 && Options.Hash != Hash)
+		{
+			continue;
+		}
+		for (uint32_t Y = 0; Y < Options.Height; ++Y)
+		{
+			FNoiseMath::GenerateWhiteNoiseRow(Y, (int32_t)Options.Width, Options.Seed, Options.TimeStamp, Reference.data() + (size_t)Y * Options.Width, (ENoiseHash)Hash);
+		}
+		for (int Coarsening = 0; Coarsening < 3; ++Coarsening)
+		{
+			if (Options.Coarsening == -1 || Options.Coarsening == Coarsening)
+			{
+				bAllPassed &= RunPermutation(Options, Compiler, Vulkan, ThreadGroupSize, Coarsening, (ENoiseHash)Hash, Reference);
+			}
+		}
+	}
+	return bAllPassed ? 0 : 1;
+}
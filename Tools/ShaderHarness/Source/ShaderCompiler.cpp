@@ -0,0 +1,160 @@
+#include "ShaderCompiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+namespace
+{
+	bool ReadTextFile(const std::string& Path, std::string& OutText)
+	{
+		std::ifstream File(Path, std::ios::binary);
+		if (!File)
+		{
+			return false;
+		}
+		std::ostringstream Stream;
+		Stream << File.rdbuf();
+		OutText = Stream.str();
+		return true;
+	}
+
+	//Quotes an argument for the shell
+	std::string Quote(const std::string& Argument)
+	{
+		std::string Quoted = "'";
+		for (char Character : Argument)
+		{
+			Quoted += Character == '\'' ? std::string("'\\''") : std::string(1, Character);
+		}
+		return Quoted + "'";
+	}
+}
+
+FShaderCompiler::FShaderCompiler(std::string InProjectDir, std::string InDxcPath, std::string InWorkDir)
+	: ProjectDir(std::move(InProjectDir))
+	, DxcPath(std::move(InDxcPath))
+	, WorkDir(std::move(InWorkDir))
+{
+}
+
+std::string FShaderCompiler::ResolveVirtualPath(const std::string& VirtualPath) const
+{
+	const std::filesystem::path Project(ProjectDir);
+	static const std::string CustomShaders = "/CustomShaders/";
+	static const std::string Engine = "/Engine/";
+	if (VirtualPath.compare(0, CustomShaders.size(), CustomShaders) == 0)
+	{
+		return (Project / "Shaders" / "Private" / VirtualPath.substr(CustomShaders.size())).string();
+	}
+	if (VirtualPath.compare(0, Engine.size(), Engine) == 0)
+	{
+		return (Project / "Tools" / "ShaderHarness" / "EngineStubs" / VirtualPath.substr(Engine.size())).string();
+	}
+	return std::string();
+}
+
+bool FShaderCompiler::RewriteIncludes(const std::string& VirtualPath, std::vector<std::string>& Visited, std::string& OutPath, std::string& OutError) const
+{
+	OutPath = (std::filesystem::path(WorkDir) / VirtualPath.substr(1)).string();
+	if (std::find(Visited.begin(), Visited.end(), VirtualPath) != Visited.end())
+	{
+		return true;
+	}
+	Visited.push_back(VirtualPath);
+
+	const std::string SourcePath = ResolveVirtualPath(VirtualPath);
+	std::string Text;
+	if (SourcePath.empty() || !ReadTextFile(SourcePath, Text))
+	{
+		OutError = "Can't read " + VirtualPath + (SourcePath.empty() ? std::string(" (unmapped virtual path)") : " (" + SourcePath + ")");
+		return false;
+	}
+
+	static const std::regex IncludePattern("^\\s*#\\s*include\\s*\"(/[^\"]+)\"");
+	std::istringstream Lines(Text);
+	std::ostringstream Rewritten;
+	std::string Line;
+	while (std::getline(Lines, Line))
+	{
+		std::smatch Match;
+		if (std::regex_search(Line, Match, IncludePattern))
+		{
+			std::string IncludedPath;
+			if (!RewriteIncludes(Match[1].str(), Visited, IncludedPath, OutError))
+			{
+				return false;
+			}
+			Line = "#include \"" + IncludedPath + "\"";
+		}
+		Rewritten << Line << '\n';
+	}
+
+	std::filesystem::create_directories(std::filesystem::path(OutPath).parent_path());
+	std::ofstream Output(OutPath, std::ios::binary);
+	Output << Rewritten.str();
+	if (!Output)
+	{
+		OutError = "Can't write " + OutPath;
+		return false;
+	}
+	return true;
+}
+
+bool FShaderCompiler::Compile(const FShaderCompileRequest& Request, std::vector<uint32_t>& OutSpirv, std::string& OutError) const
+{
+	std::vector<std::string> Visited;
+	std::string SourcePath;
+	if (!RewriteIncludes(Request.ShaderPath, Visited, SourcePath, OutError))
+	{
+		return false;
+	}
+
+	const std::string OutputPath = SourcePath + "." + Request.EntryPoint + ".spv";
+	const std::string LogPath = SourcePath + "." + Request.EntryPoint + ".log";
+	//HLSL 2018 is what the shaders are written against. The globals end up in the $Globals uniform buffer, FSpirvReflection finds their offsets
+	std::string Command = Quote(DxcPath) + " -spirv -T cs_6_0 -HV 2018 -fspv-target-env=vulkan1.1 -E " + Quote(Request.EntryPoint);
+	for (const FShaderDefine& Define : Request.Defines)
+	{
+		Command += " -D " + Quote(Define.Name + "=" + Define.Value);
+	}
+	Command += " -Fo " + Quote(OutputPath) + " " + Quote(SourcePath) + " > " + Quote(LogPath) + " 2>&1";
+
+	if (std::system(Command.c_str()) != 0)
+	{
+		std::string Log;
+		ReadTextFile(LogPath, Log);
+		OutError = "dxc failed on " + Request.ShaderPath + ":" + Request.EntryPoint + "\n" + Log;
+		return false;
+	}
+
+	std::string Binary;
+	if (!ReadTextFile(OutputPath, Binary) || Binary.size() % sizeof(uint32_t) != 0)
+	{
+		OutError = "Can't read the SPIR-V dxc wrote to " + OutputPath;
+		return false;
+	}
+	OutSpirv.resize(Binary.size() / sizeof(uint32_t));
+	std::copy(Binary.begin(), Binary.end(), reinterpret_cast<char*>(OutSpirv.data()));
+	return true;
+}
+
+bool FShaderCompiler::ReadDefine(const std::string& File, const std::string& Name, std::string& OutValue)
+{
+	std::string Text;
+	if (!ReadTextFile(File, Text))
+	{
+		return false;
+	}
+	const std::regex DefinePattern("#\\s*define\\s+" + Name + "\\s+([^\\s/]+)");
+	std::smatch Match;
+	if (!std::regex_search(Text, Match, DefinePattern))
+	{
+		return false;
+	}
+	OutValue = Match[1].str();
+	return true;
+}
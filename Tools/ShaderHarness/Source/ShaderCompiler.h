@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct FShaderDefine
+{
+	std::string Name;
+	std::string Value;
+};
+
+struct FShaderCompileRequest
+{
+	//Virtual path, as given to IMPLEMENT_GLOBAL_SHADER ("/CustomShaders/WhiteNoiseCS.usf")
+	std::string ShaderPath;
+	std::string EntryPoint;
+	std::vector<FShaderDefine> Defines;
+};
+
+/// <summary>
+/// Compiles the project's compute shaders to SPIR-V with dxc, outside the engine.
+/// The virtual include paths are resolved like the engine does: /CustomShaders/ is the project's Shaders/Private directory (see
+/// FCustomShadersDeclarationsModule::StartupModule) and /Engine/ is the EngineStubs directory of the harness. Every file is copied to the work
+/// directory with its includes rewritten to real paths before dxc sees it
+/// </summary>
+class FShaderCompiler
+{
+public:
+	FShaderCompiler(std::string InProjectDir, std::string InDxcPath, std::string InWorkDir);
+
+	//Returns false and describes the failure in OutError
+	bool Compile(const FShaderCompileRequest& Request, std::vector<uint32_t>& OutSpirv, std::string& OutError) const;
+
+	//Reads the value of "#define Name Value" from a C++ or shader file, so the harness compiles with the values ModifyCompilationEnvironment sets
+	static bool ReadDefine(const std::string& File, const std::string& Name, std::string& OutValue);
+
+	const std::string& GetProjectDir() const { return ProjectDir; }
+
+private:
+	std::string ProjectDir;
+	std::string DxcPath;
+	std::string WorkDir;
+
+	//Real path of a virtual shader path, empty if it isn't mapped
+	std::string ResolveVirtualPath(const std::string& VirtualPath) const;
+
+	//Writes the copy of VirtualPath and of everything it includes to the work directory. Returns the path of the copy
+	bool RewriteIncludes(const std::string& VirtualPath, std::vector<std::string>& Visited, std::string& OutPath, std::string& OutError) const;
+};
@@ -0,0 +1,141 @@
+#include "SpirvReflection.h"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr uint32_t SpirvMagic = 0x07230203;
+	constexpr uint32_t HeaderWords = 5;
+
+	enum ESpirvOp : uint32_t
+	{
+		OpName = 5,
+		OpMemberName = 6,
+		OpExtInst = 12,
+		OpExecutionMode = 16,
+		OpTypePointer = 32,
+		OpVariable = 59,
+		OpDecorate = 71,
+		OpMemberDecorate = 72,
+		//First and last of the conversion, arithmetic, relational, logical and bit instructions, which are numbered contiguously
+		OpConvertFToU = 109,
+		OpBitCount = 205,
+	};
+
+	constexpr uint32_t DecorationBinding = 33;
+	constexpr uint32_t DecorationDescriptorSet = 34;
+	constexpr uint32_t DecorationOffset = 35;
+	constexpr uint32_t ExecutionModeLocalSize = 17;
+
+	//Nul terminated UTF-8 string packed in the words starting at First
+	std::string ReadString(const std::vector<uint32_t>& Spirv, size_t First, size_t End)
+	{
+		std::string String;
+		for (size_t Word = First; Word < End; ++Word)
+		{
+			for (int Byte = 0; Byte < 4; ++Byte)
+			{
+				const char Character = (char)((Spirv[Word] >> (Byte * 8)) & 0xFF);
+				if (Character == '\0')
+				{
+					return String;
+				}
+				String += Character;
+			}
+		}
+		return String;
+	}
+}
+
+bool FSpirvReflection::Parse(const std::vector<uint32_t>& Spirv)
+{
+	if (Spirv.size() < HeaderWords || Spirv[0] != SpirvMagic)
+	{
+		return false;
+	}
+
+	std::map<uint32_t, std::string> Names;
+	std::map<uint32_t, std::map<uint32_t, std::string>> MemberNames;
+	std::map<uint32_t, std::map<uint32_t, uint32_t>> MemberOffsets;
+	std::map<uint32_t, FSpirvBinding> IdBindings;
+	std::map<uint32_t, uint32_t> PointeeTypes;
+	std::map<uint32_t, uint32_t> VariableTypes;
+
+	for (size_t Word = HeaderWords; Word < Spirv.size();)
+	{
+		const uint32_t NumWords = Spirv[Word] >> 16;
+		const uint32_t Opcode = Spirv[Word] & 0xFFFF;
+		if (NumWords == 0 || Word + NumWords > Spirv.size())
+		{
+			return false;
+		}
+		const size_t End = Word + NumWords;
+		if (Opcode == OpExtInst || (Opcode >= OpConvertFToU && Opcode <= OpBitCount))
+		{
+			++NumAluInstructions;
+		}
+
+		switch (Opcode)
+		{
+		case OpName:
+			Names[Spirv[Word + 1]] = ReadString(Spirv, Word + 2, End);
+			break;
+		case OpMemberName:
+			MemberNames[Spirv[Word + 1]][Spirv[Word + 2]] = ReadString(Spirv, Word + 3, End);
+			break;
+		case OpExecutionMode:
+			if (Spirv[Word + 2] == ExecutionModeLocalSize && NumWords >= 6)
+			{
+				std::copy(&Spirv[Word + 3], &Spirv[Word + 6], LocalSize);
+			}
+			break;
+		case OpTypePointer:
+			PointeeTypes[Spirv[Word + 1]] = Spirv[Word + 3];
+			break;
+		case OpVariable:
+			VariableTypes[Spirv[Word + 2]] = Spirv[Word + 1];
+			break;
+		case OpDecorate:
+			if (Spirv[Word + 2] == DecorationBinding)
+			{
+				IdBindings[Spirv[Word + 1]].Binding = Spirv[Word + 3];
+			}
+			else if (Spirv[Word + 2] == DecorationDescriptorSet)
+			{
+				IdBindings[Spirv[Word + 1]].Set = Spirv[Word + 3];
+			}
+			break;
+		case OpMemberDecorate:
+			if (Spirv[Word + 3] == DecorationOffset)
+			{
+				MemberOffsets[Spirv[Word + 1]][Spirv[Word + 2]] = Spirv[Word + 4];
+			}
+			break;
+		default:
+			break;
+		}
+		Word = End;
+	}
+
+	for (const auto& IdBinding : IdBindings)
+	{
+		const std::string& Name = Names[IdBinding.first];
+		Bindings[Name] = IdBinding.second;
+		if (Name != "$Globals")
+		{
+			continue;
+		}
+
+		//The variable points to the struct holding the globals
+		const uint32_t StructType = PointeeTypes[VariableTypes[IdBinding.first]];
+		uint32_t LastOffset = 0;
+		for (const auto& MemberOffset : MemberOffsets[StructType])
+		{
+			GlobalOffsets[MemberNames[StructType][MemberOffset.first]] = MemberOffset.second;
+			LastOffset = std::max(LastOffset, MemberOffset.second);
+		}
+		//Every member is at most 16 bytes wide in the shaders this runs
+		GlobalsSize = (LastOffset + 16 + 15) & ~15u;
+	}
+	return true;
+}
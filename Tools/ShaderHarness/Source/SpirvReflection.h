@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct FSpirvBinding
+{
+	uint32_t Set = 0;
+	uint32_t Binding = 0;
+};
+
+/// <summary>
+/// The little of a SPIR-V module the harness needs to bind it: where every named resource is bound, where every member of the $Globals uniform
+/// buffer dxc generates for the loose shader parameters lives, and the thread group size
+/// </summary>
+struct FSpirvReflection
+{
+	//Resource variable name (OutputTexture, $Globals) to its binding. Resources the entry point doesn't use may be missing
+	std::map<std::string, FSpirvBinding> Bindings;
+	//$Globals member name to its byte offset
+	std::map<std::string, uint32_t> GlobalOffsets;
+	//Bytes the $Globals buffer needs, rounded up to 16
+	uint32_t GlobalsSize = 0;
+	uint32_t LocalSize[3] = { 1, 1, 1 };
+	//Conversion, arithmetic, relational, logical, bit and extended (GLSL.std.450) instructions of the module. dxc inlines everything into
+	//the entry point, so this is the static ALU cost of a thread, before the driver's own optimizations
+	uint32_t NumAluInstructions = 0;
+
+	//Returns false if Spirv isn't a SPIR-V module
+	bool Parse(const std::vector<uint32_t>& Spirv);
+};
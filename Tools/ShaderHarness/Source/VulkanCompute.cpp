@@ -0,0 +1,449 @@
+#include "VulkanCompute.h"
+
+#include <cstring>
+
+namespace
+{
+	//Handles created by one Run, destroyed in reverse order whatever path leaves it
+	struct FRunResources
+	{
+		VkDevice Device = VK_NULL_HANDLE;
+		VkImage Image = VK_NULL_HANDLE;
+		VkDeviceMemory ImageMemory = VK_NULL_HANDLE;
+		VkImageView ImageView = VK_NULL_HANDLE;
+		VkBuffer GlobalsBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory GlobalsMemory = VK_NULL_HANDLE;
+		VkBuffer ReadbackBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory ReadbackMemory = VK_NULL_HANDLE;
+		VkDescriptorSetLayout SetLayout = VK_NULL_HANDLE;
+		VkPipelineLayout PipelineLayout = VK_NULL_HANDLE;
+		VkShaderModule ShaderModule = VK_NULL_HANDLE;
+		VkPipeline Pipeline = VK_NULL_HANDLE;
+		VkDescriptorPool DescriptorPool = VK_NULL_HANDLE;
+		VkQueryPool QueryPool = VK_NULL_HANDLE;
+		VkCommandPool CommandPool = VK_NULL_HANDLE;
+		VkFence Fence = VK_NULL_HANDLE;
+
+		~FRunResources()
+		{
+			vkDestroyFence(Device, Fence, nullptr);
+			vkDestroyCommandPool(Device, CommandPool, nullptr);
+			vkDestroyQueryPool(Device, QueryPool, nullptr);
+			vkDestroyDescriptorPool(Device, DescriptorPool, nullptr);
+			vkDestroyPipeline(Device, Pipeline, nullptr);
+			vkDestroyShaderModule(Device, ShaderModule, nullptr);
+			vkDestroyPipelineLayout(Device, PipelineLayout, nullptr);
+			vkDestroyDescriptorSetLayout(Device, SetLayout, nullptr);
+			vkDestroyBuffer(Device, ReadbackBuffer, nullptr);
+			vkFreeMemory(Device, ReadbackMemory, nullptr);
+			vkDestroyBuffer(Device, GlobalsBuffer, nullptr);
+			vkFreeMemory(Device, GlobalsMemory, nullptr);
+			vkDestroyImageView(Device, ImageView, nullptr);
+			vkDestroyImage(Device, Image, nullptr);
+			vkFreeMemory(Device, ImageMemory, nullptr);
+		}
+	};
+
+	bool Succeeded(VkResult Result, const char* What, std::string& OutError)
+	{
+		if (Result != VK_SUCCESS)
+		{
+			OutError = std::string(What) + " failed with VkResult " + std::to_string((int)Result);
+			return false;
+		}
+		return true;
+	}
+}
+
+FVulkanCompute::~FVulkanCompute()
+{
+	if (Device)
+	{
+		vkDestroyDevice(Device, nullptr);
+	}
+	if (Instance)
+	{
+		vkDestroyInstance(Instance, nullptr);
+	}
+}
+
+uint32_t FVulkanCompute::FindMemoryType(uint32_t TypeBits, VkMemoryPropertyFlags Properties) const
+{
+	for (uint32_t Type = 0; Type < MemoryProperties.memoryTypeCount; ++Type)
+	{
+		if ((TypeBits & (1u << Type)) && (MemoryProperties.memoryTypes[Type].propertyFlags & Properties) == Properties)
+		{
+			return Type;
+		}
+	}
+	return UINT32_MAX;
+}
+
+bool FVulkanCompute::Initialize(const std::string& DeviceFilter, std::string& OutError)
+{
+	VkApplicationInfo ApplicationInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+	ApplicationInfo.pApplicationName = "ShaderHarness";
+	ApplicationInfo.apiVersion = VK_API_VERSION_1_1;
+	VkInstanceCreateInfo InstanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	InstanceInfo.pApplicationInfo = &ApplicationInfo;
+	if (!Succeeded(vkCreateInstance(&InstanceInfo, nullptr, &Instance), "vkCreateInstance", OutError))
+	{
+		return false;
+	}
+
+	uint32_t NumDevices = 0;
+	vkEnumeratePhysicalDevices(Instance, &NumDevices, nullptr);
+	std::vector<VkPhysicalDevice> Devices(NumDevices);
+	vkEnumeratePhysicalDevices(Instance, &NumDevices, Devices.data());
+	for (VkPhysicalDevice Candidate : Devices)
+	{
+		VkPhysicalDeviceProperties Properties;
+		vkGetPhysicalDeviceProperties(Candidate, &Properties);
+		const bool bMatches = DeviceFilter.empty() ? Properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU
+												   : std::strstr(Properties.deviceName, DeviceFilter.c_str()) != nullptr;
+		if (bMatches || (DeviceFilter.empty() && !PhysicalDevice))
+		{
+			PhysicalDevice = Candidate;
+			DeviceName = Properties.deviceName;
+			TimestampPeriod = Properties.limits.timestampPeriod;
+			if (bMatches)
+			{
+				break;
+			}
+		}
+	}
+	if (!PhysicalDevice)
+	{
+		OutError = DeviceFilter.empty() ? "No Vulkan device found" : "No Vulkan device matches " + DeviceFilter;
+		return false;
+	}
+	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &MemoryProperties);
+
+	uint32_t NumFamilies = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &NumFamilies, nullptr);
+	std::vector<VkQueueFamilyProperties> Families(NumFamilies);
+	vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &NumFamilies, Families.data());
+	QueueFamily = UINT32_MAX;
+	for (uint32_t Family = 0; Family < NumFamilies && QueueFamily == UINT32_MAX; ++Family)
+	{
+		if (Families[Family].queueFlags & VK_QUEUE_COMPUTE_BIT)
+		{
+			QueueFamily = Family;
+			TimestampPeriod = Families[Family].timestampValidBits > 0 ? TimestampPeriod : 0.0;
+		}
+	}
+	if (QueueFamily == UINT32_MAX)
+	{
+		OutError = DeviceName + " has no compute queue";
+		return false;
+	}
+
+	//RWTexture2D<float3> has no matching storage format, dxc declares it without one
+	VkPhysicalDeviceFeatures SupportedFeatures;
+	vkGetPhysicalDeviceFeatures(PhysicalDevice, &SupportedFeatures);
+	VkPhysicalDeviceFeatures Features = {};
+	Features.shaderStorageImageWriteWithoutFormat = SupportedFeatures.shaderStorageImageWriteWithoutFormat;
+
+	const float Priority = 1.f;
+	VkDeviceQueueCreateInfo QueueInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+	QueueInfo.queueFamilyIndex = QueueFamily;
+	QueueInfo.queueCount = 1;
+	QueueInfo.pQueuePriorities = &Priority;
+	VkDeviceCreateInfo DeviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	DeviceInfo.queueCreateInfoCount = 1;
+	DeviceInfo.pQueueCreateInfos = &QueueInfo;
+	DeviceInfo.pEnabledFeatures = &Features;
+	if (!Succeeded(vkCreateDevice(PhysicalDevice, &DeviceInfo, nullptr, &Device), "vkCreateDevice", OutError))
+	{
+		return false;
+	}
+	vkGetDeviceQueue(Device, QueueFamily, 0, &Queue);
+	return true;
+}
+
+bool FVulkanCompute::Run(const FStorageImageDispatch& Dispatch, FDispatchResult& OutResult, std::string& OutError)
+{
+	FRunResources Resources;
+	Resources.Device = Device;
+	const bool bHasGlobals = !Dispatch.Globals.empty();
+	const VkDeviceSize ReadbackSize = (VkDeviceSize)Dispatch.ImageWidth * Dispatch.ImageHeight * 4 * sizeof(float);
+
+	//Storage image the shader writes
+	{
+		VkImageCreateInfo ImageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+		ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+		ImageInfo.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		ImageInfo.extent = { Dispatch.ImageWidth, Dispatch.ImageHeight, 1 };
+		ImageInfo.mipLevels = 1;
+		ImageInfo.arrayLayers = 1;
+		ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		ImageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (!Succeeded(vkCreateImage(Device, &ImageInfo, nullptr, &Resources.Image), "vkCreateImage", OutError))
+		{
+			return false;
+		}
+		VkMemoryRequirements Requirements;
+		vkGetImageMemoryRequirements(Device, Resources.Image, &Requirements);
+		VkMemoryAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		AllocateInfo.allocationSize = Requirements.size;
+		AllocateInfo.memoryTypeIndex = FindMemoryType(Requirements.memoryTypeBits, 0);
+		if (!Succeeded(vkAllocateMemory(Device, &AllocateInfo, nullptr, &Resources.ImageMemory), "vkAllocateMemory (image)", OutError)
+			|| !Succeeded(vkBindImageMemory(Device, Resources.Image, Resources.ImageMemory, 0), "vkBindImageMemory", OutError))
+		{
+			return false;
+		}
+
+		VkImageViewCreateInfo ViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		ViewInfo.image = Resources.Image;
+		ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		ViewInfo.format = ImageInfo.format;
+		ViewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		if (!Succeeded(vkCreateImageView(Device, &ViewInfo, nullptr, &Resources.ImageView), "vkCreateImageView", OutError))
+		{
+			return false;
+		}
+	}
+
+	//Host visible buffers: the globals, and the copy of the image
+	auto CreateHostBuffer = [this, &OutError](VkDeviceSize Size, VkBufferUsageFlags Usage, VkBuffer& OutBuffer, VkDeviceMemory& OutMemory)
+	{
+		VkBufferCreateInfo BufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		BufferInfo.size = Size;
+		BufferInfo.usage = Usage;
+		if (!Succeeded(vkCreateBuffer(Device, &BufferInfo, nullptr, &OutBuffer), "vkCreateBuffer", OutError))
+		{
+			return false;
+		}
+		VkMemoryRequirements Requirements;
+		vkGetBufferMemoryRequirements(Device, OutBuffer, &Requirements);
+		VkMemoryAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		AllocateInfo.allocationSize = Requirements.size;
+		AllocateInfo.memoryTypeIndex = FindMemoryType(Requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		return Succeeded(vkAllocateMemory(Device, &AllocateInfo, nullptr, &OutMemory), "vkAllocateMemory (buffer)", OutError)
+			&& Succeeded(vkBindBufferMemory(Device, OutBuffer, OutMemory, 0), "vkBindBufferMemory", OutError);
+	};
+	if (!CreateHostBuffer(ReadbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Resources.ReadbackBuffer, Resources.ReadbackMemory))
+	{
+		return false;
+	}
+	if (bHasGlobals)
+	{
+		if (!CreateHostBuffer(Dispatch.Globals.size(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, Resources.GlobalsBuffer, Resources.GlobalsMemory))
+		{
+			return false;
+		}
+		void* Mapped = nullptr;
+		if (!Succeeded(vkMapMemory(Device, Resources.GlobalsMemory, 0, VK_WHOLE_SIZE, 0, &Mapped), "vkMapMemory (globals)", OutError))
+		{
+			return false;
+		}
+		std::memcpy(Mapped, Dispatch.Globals.data(), Dispatch.Globals.size());
+		vkUnmapMemory(Device, Resources.GlobalsMemory);
+	}
+
+	//Pipeline. dxc puts every resource in set 0 unless told otherwise
+	if (Dispatch.ImageBinding.Set != 0 || (bHasGlobals && Dispatch.GlobalsBinding.Set != 0))
+	{
+		OutError = "Only descriptor set 0 is supported";
+		return false;
+	}
+	std::vector<VkDescriptorSetLayoutBinding> LayoutBindings(1);
+	LayoutBindings[0] = { Dispatch.ImageBinding.Binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+	if (bHasGlobals)
+	{
+		LayoutBindings.push_back({ Dispatch.GlobalsBinding.Binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr });
+	}
+	VkDescriptorSetLayoutCreateInfo SetLayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	SetLayoutInfo.bindingCount = (uint32_t)LayoutBindings.size();
+	SetLayoutInfo.pBindings = LayoutBindings.data();
+	VkPipelineLayoutCreateInfo PipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+	PipelineLayoutInfo.setLayoutCount = 1;
+	PipelineLayoutInfo.pSetLayouts = &Resources.SetLayout;
+	VkShaderModuleCreateInfo ModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	ModuleInfo.codeSize = Dispatch.Spirv.size() * sizeof(uint32_t);
+	ModuleInfo.pCode = Dispatch.Spirv.data();
+	if (!Succeeded(vkCreateDescriptorSetLayout(Device, &SetLayoutInfo, nullptr, &Resources.SetLayout), "vkCreateDescriptorSetLayout", OutError)
+		|| !Succeeded(vkCreatePipelineLayout(Device, &PipelineLayoutInfo, nullptr, &Resources.PipelineLayout), "vkCreatePipelineLayout", OutError)
+		|| !Succeeded(vkCreateShaderModule(Device, &ModuleInfo, nullptr, &Resources.ShaderModule), "vkCreateShaderModule", OutError))
+	{
+		return false;
+	}
+	VkComputePipelineCreateInfo PipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+	PipelineInfo.stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+	PipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	PipelineInfo.stage.module = Resources.ShaderModule;
+	PipelineInfo.stage.pName = Dispatch.EntryPoint.c_str();
+	PipelineInfo.layout = Resources.PipelineLayout;
+	if (!Succeeded(vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &PipelineInfo, nullptr, &Resources.Pipeline), "vkCreateComputePipelines", OutError))
+	{
+		return false;
+	}
+
+	//Descriptors
+	const VkDescriptorPoolSize PoolSizes[] = { { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 }, { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 } };
+	VkDescriptorPoolCreateInfo PoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	PoolInfo.maxSets = 1;
+	PoolInfo.poolSizeCount = 2;
+	PoolInfo.pPoolSizes = PoolSizes;
+	VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+	VkDescriptorSetAllocateInfo SetInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	SetInfo.descriptorSetCount = 1;
+	SetInfo.pSetLayouts = &Resources.SetLayout;
+	if (!Succeeded(vkCreateDescriptorPool(Device, &PoolInfo, nullptr, &Resources.DescriptorPool), "vkCreateDescriptorPool", OutError))
+	{
+		return false;
+	}
+	SetInfo.descriptorPool = Resources.DescriptorPool;
+	if (!Succeeded(vkAllocateDescriptorSets(Device, &SetInfo, &DescriptorSet), "vkAllocateDescriptorSets", OutError))
+	{
+		return false;
+	}
+	const VkDescriptorImageInfo ImageDescriptor = { VK_NULL_HANDLE, Resources.ImageView, VK_IMAGE_LAYOUT_GENERAL };
+	const VkDescriptorBufferInfo GlobalsDescriptor = { Resources.GlobalsBuffer, 0, VK_WHOLE_SIZE };
+	std::vector<VkWriteDescriptorSet> Writes(1, { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET });
+	Writes[0].dstSet = DescriptorSet;
+	Writes[0].dstBinding = Dispatch.ImageBinding.Binding;
+	Writes[0].descriptorCount = 1;
+	Writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	Writes[0].pImageInfo = &ImageDescriptor;
+	if (bHasGlobals)
+	{
+		Writes.push_back({ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET });
+		Writes[1].dstSet = DescriptorSet;
+		Writes[1].dstBinding = Dispatch.GlobalsBinding.Binding;
+		Writes[1].descriptorCount = 1;
+		Writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		Writes[1].pBufferInfo = &GlobalsDescriptor;
+	}
+	vkUpdateDescriptorSets(Device, (uint32_t)Writes.size(), Writes.data(), 0, nullptr);
+
+	//Commands: every iteration between two timestamps, a barrier between iterations so they don't overlap, then the copy to the readback buffer
+	const int NumIterations = Dispatch.NumIterations > 0 ? Dispatch.NumIterations : 1;
+	const bool bTimestamps = TimestampPeriod > 0.0;
+	if (bTimestamps)
+	{
+		VkQueryPoolCreateInfo QueryInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+		QueryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		QueryInfo.queryCount = 2 * NumIterations;
+		if (!Succeeded(vkCreateQueryPool(Device, &QueryInfo, nullptr, &Resources.QueryPool), "vkCreateQueryPool", OutError))
+		{
+			return false;
+		}
+	}
+
+	VkCommandPoolCreateInfo CommandPoolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	CommandPoolInfo.queueFamilyIndex = QueueFamily;
+	VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+	VkCommandBufferAllocateInfo CommandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	CommandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	CommandBufferInfo.commandBufferCount = 1;
+	if (!Succeeded(vkCreateCommandPool(Device, &CommandPoolInfo, nullptr, &Resources.CommandPool), "vkCreateCommandPool", OutError))
+	{
+		return false;
+	}
+	CommandBufferInfo.commandPool = Resources.CommandPool;
+	if (!Succeeded(vkAllocateCommandBuffers(Device, &CommandBufferInfo, &CommandBuffer), "vkAllocateCommandBuffers", OutError))
+	{
+		return false;
+	}
+
+	VkCommandBufferBeginInfo BeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+	if (bTimestamps)
+	{
+		vkCmdResetQueryPool(CommandBuffer, Resources.QueryPool, 0, 2 * NumIterations);
+	}
+
+	VkImageMemoryBarrier ImageBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	ImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	ImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	ImageBarrier.image = Resources.Image;
+	ImageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	ImageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	ImageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	ImageBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &ImageBarrier);
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Resources.Pipeline);
+	vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Resources.PipelineLayout, 0, 1, &DescriptorSet, 0, nullptr);
+	for (int Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		if (Iteration > 0)
+		{
+			VkMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+			Barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			Barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &Barrier, 0, nullptr, 0, nullptr);
+		}
+		if (bTimestamps)
+		{
+			vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Resources.QueryPool, 2 * Iteration);
+		}
+		vkCmdDispatch(CommandBuffer, Dispatch.GroupCount[0], Dispatch.GroupCount[1], Dispatch.GroupCount[2]);
+		if (bTimestamps)
+		{
+			vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Resources.QueryPool, 2 * Iteration + 1);
+		}
+	}
+
+	ImageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+	ImageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	ImageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	ImageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &ImageBarrier);
+	VkBufferImageCopy Copy = {};
+	Copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	Copy.imageExtent = { Dispatch.ImageWidth, Dispatch.ImageHeight, 1 };
+	vkCmdCopyImageToBuffer(CommandBuffer, Resources.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Resources.ReadbackBuffer, 1, &Copy);
+	VkBufferMemoryBarrier HostBarrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+	HostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	HostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	HostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	HostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	HostBarrier.buffer = Resources.ReadbackBuffer;
+	HostBarrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &HostBarrier, 0, nullptr);
+	if (!Succeeded(vkEndCommandBuffer(CommandBuffer), "vkEndCommandBuffer", OutError))
+	{
+		return false;
+	}
+
+	VkFenceCreateInfo FenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	VkSubmitInfo SubmitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	SubmitInfo.commandBufferCount = 1;
+	SubmitInfo.pCommandBuffers = &CommandBuffer;
+	if (!Succeeded(vkCreateFence(Device, &FenceInfo, nullptr, &Resources.Fence), "vkCreateFence", OutError)
+		|| !Succeeded(vkQueueSubmit(Queue, 1, &SubmitInfo, Resources.Fence), "vkQueueSubmit", OutError)
+		|| !Succeeded(vkWaitForFences(Device, 1, &Resources.Fence, VK_TRUE, UINT64_MAX), "vkWaitForFences", OutError))
+	{
+		return false;
+	}
+
+	OutResult.DispatchMilliseconds.clear();
+	if (bTimestamps)
+	{
+		std::vector<uint64_t> Timestamps(2 * NumIterations);
+		if (!Succeeded(vkGetQueryPoolResults(Device, Resources.QueryPool, 0, 2 * NumIterations, Timestamps.size() * sizeof(uint64_t), Timestamps.data(),
+											 sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT), "vkGetQueryPoolResults", OutError))
+		{
+			return false;
+		}
+		for (int Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			OutResult.DispatchMilliseconds.push_back((Timestamps[2 * Iteration + 1] - Timestamps[2 * Iteration]) * TimestampPeriod * 1e-6);
+		}
+	}
+
+	void* Mapped = nullptr;
+	if (!Succeeded(vkMapMemory(Device, Resources.ReadbackMemory, 0, VK_WHOLE_SIZE, 0, &Mapped), "vkMapMemory (readback)", OutError))
+	{
+		return false;
+	}
+	OutResult.Texels.resize(ReadbackSize / sizeof(float));
+	std::memcpy(OutResult.Texels.data(), Mapped, ReadbackSize);
+	vkUnmapMemory(Device, Resources.ReadbackMemory);
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "SpirvReflection.h"
+
+//One compute shader writing a PF_A32B32G32R32F storage image, run NumIterations times back to back
+struct FStorageImageDispatch
+{
+	std::vector<uint32_t> Spirv;
+	std::string EntryPoint;
+	FSpirvBinding ImageBinding;
+	//Contents of the $Globals uniform buffer, left unbound when empty
+	std::vector<uint8_t> Globals;
+	FSpirvBinding GlobalsBinding;
+	uint32_t ImageWidth = 0;
+	uint32_t ImageHeight = 0;
+	uint32_t GroupCount[3] = { 1, 1, 1 };
+	int NumIterations = 1;
+};
+
+struct FDispatchResult
+{
+	//Four floats per texel, rows packed
+	std::vector<float> Texels;
+	//GPU time of every iteration, empty when the device has no timestamps
+	std::vector<double> DispatchMilliseconds;
+};
+
+/// <summary>
+/// Minimal Vulkan compute context for the harness. Picks a software ICD (lavapipe, SwiftShader) unless told otherwise, so it runs on machines
+/// without a GPU. Every Run creates and destroys its own resources, nothing is cached between shaders
+/// </summary>
+class FVulkanCompute
+{
+public:
+	~FVulkanCompute();
+
+	//DeviceFilter selects the first device whose name contains it. When empty, a CPU device is preferred
+	bool Initialize(const std::string& DeviceFilter, std::string& OutError);
+
+	bool Run(const FStorageImageDispatch& Dispatch, FDispatchResult& OutResult, std::string& OutError);
+
+	const std::string& GetDeviceName() const { return DeviceName; }
+
+private:
+	VkInstance Instance = VK_NULL_HANDLE;
+	VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+	VkDevice Device = VK_NULL_HANDLE;
+	VkQueue Queue = VK_NULL_HANDLE;
+	uint32_t QueueFamily = 0;
+	VkPhysicalDeviceMemoryProperties MemoryProperties = {};
+	//Nanoseconds per timestamp tick, 0 when the queue can't write timestamps
+	double TimestampPeriod = 0.0;
+	std::string DeviceName;
+
+	//Index of a memory type allowed by TypeBits that has the Properties, or UINT32_MAX
+	uint32_t FindMemoryType(uint32_t TypeBits, VkMemoryPropertyFlags Properties) const;
+};